@@ -37,6 +37,60 @@ typedef enum _dpu_launch_policy_t {
     DPU_SYNCHRONOUS,
 } dpu_launch_policy_t;
 
+/**
+ * @enum _dpu_completion_flags_t
+ * @brief When the completion callback registered with dpu_launch_async is called.
+ * @var DPU_COMPLETION_PER_RANK The callback is called once for each rank of the set, as soon as the rank is done.
+ * @var DPU_COMPLETION_PER_SET  The callback is called once, when all the ranks of the set are done.
+ */
+typedef enum _dpu_completion_flags_t {
+    DPU_COMPLETION_PER_RANK,
+    DPU_COMPLETION_PER_SET,
+} dpu_completion_flags_t;
+
+/**
+ * @brief Host function called when DPUs launched with dpu_launch_async complete their execution.
+ *
+ * The callback runs on the thread polling the DPUs. It may transfer data from the DPUs given as parameter, or
+ * launch them again, but must not wait for the future of the launch it is notified for.
+ *
+ * @param dpu_set the DPUs which are done: one rank of the launched set, or the whole set
+ * @param rank_index the index of the rank in the launched set (0 when called for the whole set)
+ * @param status the status of the execution, DPU_ERR_DPU_FAULT if a DPU is in fault
+ * @param args the argument given to dpu_launch_async
+ */
+typedef void (*dpu_completion_callback_t)(struct dpu_set_t dpu_set, uint32_t rank_index, dpu_error_t status, void *args);
+
+/**
+ * @brief Handle on an asynchronous launch, created by dpu_launch_async.
+ */
+struct dpu_future_t;
+
+/**
+ * @brief Handle on a memory transfer prepared once and pushed several times, created by dpu_prepared_xfer_create.
+ */
+struct dpu_prepared_xfer_t;
+
+/**
+ * @brief Host function called by dpu_pipeline_run for one batch of one rank.
+ *
+ * The callbacks of different ranks run concurrently, on the threads polling the ranks. A fill callback must set,
+ * with dpu_prepare_xfer, the input buffer of the DPUs of the rank which take part in the batch. A drain callback may
+ * transfer the results of the batch from the DPUs of the rank.
+ *
+ * @param dpu_set the DPUs of the rank
+ * @param rank_index the index of the rank in the pipelined set
+ * @param batch the index of the batch, which is also its sequence number
+ * @param args the argument given to dpu_pipeline_run
+ * @return Whether the operation was successful. An error stops the pipeline.
+ */
+typedef dpu_error_t (*dpu_pipeline_callback_t)(struct dpu_set_t dpu_set, uint32_t rank_index, uint32_t batch, void *args);
+
+/**
+ * @brief Handle on a pipelined execution, created by dpu_pipeline_create.
+ */
+struct dpu_pipeline_t;
+
 /**
  * @enum dpu_xfer_t
  * @brief Direction for a DPU memory transfer.
@@ -284,6 +338,10 @@ dpu_load(struct dpu_set_t dpu_set, const char *binary_path, struct dpu_program_t
 /**
  * @fn dpu_get_symbol
  * @brief Get the requested symbol information.
+ *
+ * The symbol information stays valid as long as the program is loaded: it can be resolved once and given to the
+ * `_symbol` variants of the transfer functions, which do not look the name up again.
+ *
  * @param program the DPU program information
  * @param symbol_name the name of the symbol to look for
  * @param symbol where to store the symbol information if found
@@ -292,6 +350,17 @@ dpu_load(struct dpu_set_t dpu_set, const char *binary_path, struct dpu_program_t
 dpu_error_t
 dpu_get_symbol(struct dpu_program_t *program, const char *symbol_name, struct dpu_symbol_t *symbol);
 
+/**
+ * @fn dpu_get_set_symbol
+ * @brief Get the requested symbol information from the program loaded on all the DPUs of the DPU set.
+ * @param dpu_set the identifier of the DPU set
+ * @param symbol_name the name of the symbol to look for
+ * @param symbol where to store the symbol information if found, valid as long as the program stays loaded
+ * @return Whether the symbol was found.
+ */
+dpu_error_t
+dpu_get_set_symbol(struct dpu_set_t dpu_set, const char *symbol_name, struct dpu_symbol_t *symbol);
+
 /**
  * @fn dpu_launch
  * @brief Request the boot of all the DPUs in a DPU set.
@@ -302,6 +371,117 @@ dpu_get_symbol(struct dpu_program_t *program, const char *symbol_name, struct dp
 dpu_error_t
 dpu_launch(struct dpu_set_t dpu_set, dpu_launch_policy_t policy);
 
+/**
+ * @fn dpu_launch_async
+ * @brief Boot all the DPUs in a DPU set without waiting for them, and get notified of their completion.
+ *
+ * Each rank is polled by its own thread, so that the completion of one rank is reported without waiting for the
+ * slowest rank of the set.
+ *
+ * @param dpu_set the identifier of the DPU set we want to boot
+ * @param callback the function called when the DPUs are done, can be NULL
+ * @param args the argument given to the callback
+ * @param flags whether the callback is called for each rank or once for the whole set
+ * @param future where to store the handle on the launch, can be NULL. The handle must be released with
+ *        dpu_future_free. When the boot fails after some ranks were launched, the handle is still returned and
+ *        completes with the boot error once the launched ranks are done.
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_launch_async(struct dpu_set_t dpu_set,
+    dpu_completion_callback_t callback,
+    void *args,
+    dpu_completion_flags_t flags,
+    struct dpu_future_t **future);
+
+/**
+ * @fn dpu_future_poll
+ * @brief Check, without blocking, whether an asynchronous launch is complete.
+ * @param future the handle on the launch
+ * @param done whether all the DPUs of the launch are done and the callbacks returned
+ * @return The status of the execution when done, DPU_OK otherwise.
+ */
+dpu_error_t
+dpu_future_poll(struct dpu_future_t *future, bool *done);
+
+/**
+ * @fn dpu_future_wait
+ * @brief Wait for the end of an asynchronous launch, including its callbacks.
+ * @param future the handle on the launch
+ * @return The status of the execution.
+ */
+dpu_error_t
+dpu_future_wait(struct dpu_future_t *future);
+
+/**
+ * @fn dpu_future_free
+ * @brief Wait for the end of an asynchronous launch and release its handle.
+ * @param future the handle on the launch
+ * @return The status of the execution.
+ */
+dpu_error_t
+dpu_future_free(struct dpu_future_t *future);
+
+/**
+ * @fn dpu_pipeline_create
+ * @brief Describe the staging slots used to stream batches of input to the DPUs of a DPU set.
+ *
+ * Batch `n` is pushed into slot `n % nr_slots` of the slots symbol, then its sequence number `n` is written as a
+ * `uint32_t` at the start of the sequence symbol before the DPUs are booted: the DPU program reads its input from
+ * `slots + (sequence % nr_slots) * slot_size`. With two slots or more, the input of the previous batch is still in
+ * MRAM when a batch runs.
+ *
+ * @param dpu_set the identifier of the DPU set, whose program must stay loaded while the pipeline is used
+ * @param slots_symbol_name the name of the DPU symbol holding the slots, at least `nr_slots * slot_size` bytes
+ * @param slot_size the number of bytes pushed into a slot for each batch
+ * @param nr_slots the number of slots
+ * @param sequence_symbol_name the name of the DPU symbol receiving the sequence number of the batch
+ * @param pipeline where to store the handle on the pipeline, to be released with dpu_pipeline_free
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_pipeline_create(struct dpu_set_t dpu_set,
+    const char *slots_symbol_name,
+    uint32_t slot_size,
+    uint32_t nr_slots,
+    const char *sequence_symbol_name,
+    struct dpu_pipeline_t **pipeline);
+
+/**
+ * @fn dpu_pipeline_run
+ * @brief Stream batches through each rank of the pipelined set, and wait for the end of the last ones.
+ *
+ * Each rank runs the batches `0` to `nr_batches - 1` on its own: as soon as a rank is done with a batch, its results
+ * are drained, the input of its next batch is filled and pushed, and it is launched again, while the other ranks
+ * keep computing. The host cannot access the MRAM of a running DPU, so the transfers of a rank overlap with the
+ * execution of the other ranks, not with its own.
+ *
+ * When a batch fails (a DPU fault included), its rank is not launched again and the other ranks stop at the end of
+ * their current batch. The DPUs in fault are left as they are, to be debugged or cleared by the caller.
+ *
+ * @param pipeline the handle on the pipeline
+ * @param nr_batches the number of batches run by each rank
+ * @param fill the function setting the input buffers of a batch
+ * @param drain the function fetching the results of a batch, can be NULL
+ * @param args the argument given to the callbacks
+ * @return The first error of the callbacks, of the transfers or of the executions, DPU_OK otherwise.
+ */
+dpu_error_t
+dpu_pipeline_run(struct dpu_pipeline_t *pipeline,
+    uint32_t nr_batches,
+    dpu_pipeline_callback_t fill,
+    dpu_pipeline_callback_t drain,
+    void *args);
+
+/**
+ * @fn dpu_pipeline_free
+ * @brief Release a pipeline handle.
+ * @param pipeline the handle on the pipeline
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_pipeline_free(struct dpu_pipeline_t *pipeline);
+
 /**
  * @fn dpu_status
  * @brief Fetch the current state of the DPU set.
@@ -316,6 +496,11 @@ dpu_status(struct dpu_set_t dpu_set, bool *done, bool *fault);
 /**
  * @fn dpu_sync
  * @brief Wait for the end of the execution on the DPU set.
+ *
+ * How the host thread waits is chosen with the "syncStrategy" profile property: "spin" (default), "yield",
+ * "backoff" (sleeps up to "syncMaxSleep" microseconds between polls) or "adaptive" (sleeps for the duration of
+ * the previous runs of the same program before polling).
+ *
  * @param dpu_set the identifier of the DPU set
  * @return Whether the operation was successful.
  */
@@ -374,6 +559,48 @@ dpu_copy_to_symbol(struct dpu_set_t dpu_set, struct dpu_symbol_t symbol, uint32_
 dpu_error_t
 dpu_copy_from_symbol(struct dpu_set_t dpu_set, struct dpu_symbol_t symbol, uint32_t symbol_offset, void *dst, size_t length);
 
+/**
+ * @fn dpu_gather_from
+ * @brief Copy data from one of the DPU memories of each DPU of the DPU set into a single Host memory buffer.
+ *
+ * The DPUs are stored in the order of DPU_FOREACH: the n-th DPU of the set is copied at `dst + n * stride`.
+ * The data is fetched with one transfer per rank.
+ *
+ * @param dpu_set the identifier of the DPU set
+ * @param symbol_name the name of the DPU symbol from where to copy the data
+ * @param symbol_offset the byte offset from the base DPU symbol address from where to copy the data
+ * @param dst the host buffer where the data is copied
+ * @param length the number of bytes to copy from each DPU
+ * @param stride the byte distance between the data of two consecutive DPUs in the host buffer, at least `length`
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_gather_from(struct dpu_set_t dpu_set,
+    const char *symbol_name,
+    uint32_t symbol_offset,
+    void *dst,
+    size_t length,
+    size_t stride);
+
+/**
+ * @fn dpu_gather_from_symbol
+ * @brief Copy data from one of the DPU memories of each DPU of the DPU set into a single Host memory buffer.
+ * @param dpu_set the identifier of the DPU set
+ * @param symbol the DPU symbol from where the data is copied
+ * @param symbol_offset the byte offset from the base DPU symbol address from where to copy the data
+ * @param dst the host buffer where the data is copied, the n-th DPU of the set being copied at `dst + n * stride`
+ * @param length the number of bytes to copy from each DPU
+ * @param stride the byte distance between the data of two consecutive DPUs in the host buffer, at least `length`
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_gather_from_symbol(struct dpu_set_t dpu_set,
+    struct dpu_symbol_t symbol,
+    uint32_t symbol_offset,
+    void *dst,
+    size_t length,
+    size_t stride);
+
 /**
  * @fn dpu_prepare_xfer
  * @brief Set the Host buffer of all DPUs of the DPU set for the next memory transfer.
@@ -436,6 +663,106 @@ dpu_push_xfer_symbol(struct dpu_set_t dpu_set,
     size_t length,
     dpu_xfer_flags_t flags);
 
+/**
+ * @fn dpu_prepared_xfer_create
+ * @brief Capture a memory transfer on the DPU set, to execute it several times with dpu_prepared_xfer_push
+ *
+ * The host buffers previously defined by `dpu_prepare_xfer` are captured, and cleared from the DPUs. They are used by
+ * every push, until the prepared transfer is freed.
+ *
+ * @param dpu_set the identifier of the DPU set
+ * @param xfer direction of the transfer
+ * @param symbol_name the name of the DPU symbol where the transfer starts
+ * @param symbol_offset the byte offset from the base DPU symbol address where the transfer starts
+ * @param length the number of bytes to copy
+ * @param prepared_xfer where to store the handle on the transfer, to be released with dpu_prepared_xfer_free
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_prepared_xfer_create(struct dpu_set_t dpu_set,
+    dpu_xfer_t xfer,
+    const char *symbol_name,
+    uint32_t symbol_offset,
+    size_t length,
+    struct dpu_prepared_xfer_t **prepared_xfer);
+
+/**
+ * @fn dpu_prepared_xfer_create_symbol
+ * @brief Capture a memory transfer on the DPU set, to execute it several times with dpu_prepared_xfer_push
+ *
+ * The host buffers previously defined by `dpu_prepare_xfer` are captured, and cleared from the DPUs. They are used by
+ * every push, until the prepared transfer is freed.
+ *
+ * @param dpu_set the identifier of the DPU set
+ * @param xfer direction of the transfer
+ * @param symbol the DPU symbol where the transfer starts
+ * @param symbol_offset the byte offset from the base DPU symbol address where the transfer starts
+ * @param length the number of bytes to copy
+ * @param prepared_xfer where to store the handle on the transfer, to be released with dpu_prepared_xfer_free
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_prepared_xfer_create_symbol(struct dpu_set_t dpu_set,
+    dpu_xfer_t xfer,
+    struct dpu_symbol_t symbol,
+    uint32_t symbol_offset,
+    size_t length,
+    struct dpu_prepared_xfer_t **prepared_xfer);
+
+/**
+ * @fn dpu_prepared_xfer_push
+ * @brief Execute a prepared memory transfer, with the content of its host buffers at the time of the call.
+ * @param prepared_xfer the handle on the transfer
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_prepared_xfer_push(struct dpu_prepared_xfer_t *prepared_xfer);
+
+/**
+ * @fn dpu_prepared_xfer_free
+ * @brief Release a prepared memory transfer.
+ * @param prepared_xfer the handle on the transfer
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_prepared_xfer_free(struct dpu_prepared_xfer_t *prepared_xfer);
+
+/**
+ * @def DPU_HOST_BUFFER_STRIDE
+ * @brief Distance between the buffers of two consecutive DPUs in a buffer allocated by dpu_host_buffer_alloc.
+ * @param size_per_dpu the size given to dpu_host_buffer_alloc
+ */
+#define DPU_HOST_BUFFER_STRIDE(size_per_dpu) ((((size_t)(size_per_dpu)) + 63) & ~((size_t)63))
+
+/**
+ * @fn dpu_host_buffer_alloc
+ * @brief Allocate a host buffer tuned for the memory transfers of the DPU set.
+ *
+ * The buffer holds one slot of `size_per_dpu` bytes for each DPU of the set, the n-th DPU of the set (in the
+ * `DPU_FOREACH` order) using `buffer + n * DPU_HOST_BUFFER_STRIDE(size_per_dpu)`, aligned on a cache line. The memory is
+ * backed by huge pages when some are available, allocated on the NUMA node of the first rank of the set, faulted in and
+ * locked. The transfers from the DPUs into the buffer avoid polluting the host caches.
+ *
+ * The buffer may outlive the DPU set: freeing the set unregisters the buffer from its ranks, and the buffer is then
+ * only host memory until dpu_host_buffer_free releases it.
+ *
+ * @param dpu_set the identifier of the DPU set
+ * @param size_per_dpu the number of bytes of the slot of each DPU
+ * @param buffer where to store the address of the buffer, to be released with dpu_host_buffer_free
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_host_buffer_alloc(struct dpu_set_t dpu_set, size_t size_per_dpu, void **buffer);
+
+/**
+ * @fn dpu_host_buffer_free
+ * @brief Release a buffer allocated by dpu_host_buffer_alloc.
+ * @param buffer the address of the buffer
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_host_buffer_free(void *buffer);
+
 /**
  * @def DPU_INCBIN
  * @brief Embed a binary inside the ELF program.
@@ -17,6 +17,20 @@
  * @brief C API for DPU rank description.
  */
 
+/**
+ * @brief Strategies used by dpu_sync and by the launches (synchronous ones and poll threads) to wait for the end of the DPUs.
+ */
+typedef enum _dpu_sync_strategy_t {
+    /** Polls the DPU status continuously. */
+    DPU_SYNC_SPIN,
+    /** Polls the DPU status, yielding the CPU between polls once the first polls failed. */
+    DPU_SYNC_SPIN_YIELD,
+    /** Polls the DPU status, sleeping between polls with an exponentially growing, bounded delay. */
+    DPU_SYNC_BACKOFF,
+    /** Sleeps for the duration of the previous runs of the program, then polls as DPU_SYNC_SPIN_YIELD. */
+    DPU_SYNC_ADAPTIVE,
+} dpu_sync_strategy_t;
+
 /**
  * @struct dpu_description_t
  * @brief Description of the characteristics of a DPU rank
@@ -69,6 +83,15 @@ typedef struct _dpu_description_t {
 
         struct dpu_bit_config pcb_transformation;
         uint32_t fck_frequency_in_mhz;
+
+        bool enable_parallel_dispatch;
+
+        dpu_sync_strategy_t sync_strategy;
+        uint32_t sync_max_sleep_in_us;
+
+        bool confirm_ci_results;
+
+        bool enable_ufi_planner;
     } configuration;
 
     uint32_t refcount;
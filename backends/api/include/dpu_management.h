@@ -129,6 +129,23 @@ dpu_is_enabled(struct dpu_t *dpu);
 dpu_description_t
 dpu_get_description(struct dpu_rank_t *rank);
 
+/**
+ * @fn dpu_get_ci_command_stats
+ * @brief Fetches the counters of the control interface commands executed on the rank.
+ * @param rank the unique identifier of the rank
+ * @param stats filled with the counters accumulated since the rank allocation or the last reset
+ */
+void
+dpu_get_ci_command_stats(struct dpu_rank_t *rank, struct dpu_ci_command_stats *stats);
+
+/**
+ * @fn dpu_reset_ci_command_stats
+ * @brief Resets the counters of the control interface commands executed on the rank.
+ * @param rank the unique identifier of the rank
+ */
+void
+dpu_reset_ci_command_stats(struct dpu_rank_t *rank);
+
 /**
  * @fn dpu_set_from_rank
  * @brief Creates a DPU set from a single DPU rank
@@ -156,6 +156,94 @@ dpu_copy_from_address_dpu(struct dpu_t *dpu, dpu_mem_max_addr_t address, void *d
 dpu_error_t
 dpu_copy_from_address_matrix(struct dpu_rank_t *rank, dpu_mem_max_addr_t address, dpu_mem_max_size_t length);
 
+/**
+ * @fn dpu_prepare_address_matrix
+ * @brief Fill a transfer matrix with the Host memory buffers previously defined with `dpu_prepare_xfer` on the whole DPU
+ * rank, so that the transfer can be run several times with `dpu_copy_to_address_prepared` or
+ * `dpu_copy_from_address_prepared`.
+ * @param rank the DPU rank
+ * @param address the DPU address of the transfer
+ * @param length the number of bytes to copy
+ * @param transfer_matrix the matrix to fill, allocated with `dpu_transfer_matrix_allocate`
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_prepare_address_matrix(struct dpu_rank_t *rank,
+    dpu_mem_max_addr_t address,
+    dpu_mem_max_size_t length,
+    struct dpu_transfer_mram *transfer_matrix);
+
+/**
+ * @fn dpu_copy_to_address_prepared
+ * @brief Copy data from the Host memory buffers of a matrix filled by `dpu_prepare_address_matrix` to one of the DPU
+ * memories on the whole DPU rank.
+ * @param rank the DPU rank
+ * @param address the DPU address where the data is copied, as given to `dpu_prepare_address_matrix`
+ * @param length the number of bytes to copy, as given to `dpu_prepare_address_matrix`
+ * @param transfer_matrix the matrix filled by `dpu_prepare_address_matrix`
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_copy_to_address_prepared(struct dpu_rank_t *rank,
+    dpu_mem_max_addr_t address,
+    dpu_mem_max_size_t length,
+    struct dpu_transfer_mram *transfer_matrix);
+
+/**
+ * @fn dpu_copy_from_address_prepared
+ * @brief Copy data from one of the DPU memories to the Host memory buffers of a matrix filled by
+ * `dpu_prepare_address_matrix` on the whole DPU rank.
+ * @param rank the DPU rank
+ * @param address the DPU address from where the data is copied, as given to `dpu_prepare_address_matrix`
+ * @param length the number of bytes to copy, as given to `dpu_prepare_address_matrix`
+ * @param transfer_matrix the matrix filled by `dpu_prepare_address_matrix`
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_copy_from_address_prepared(struct dpu_rank_t *rank,
+    dpu_mem_max_addr_t address,
+    dpu_mem_max_size_t length,
+    struct dpu_transfer_mram *transfer_matrix);
+
+/**
+ * @fn dpu_copy_from_symbol_gather
+ * @brief Copy data from one of the DPU memories of each DPU of the rank into a single Host buffer.
+ * @param rank the DPU rank
+ * @param symbol the DPU symbol from where the data is copied
+ * @param symbol_offset the byte offset from the base DPU symbol address from where to copy the data
+ * @param dst the host buffer where the data is copied, the n-th enabled DPU of the rank being copied at `dst + n * stride`
+ * @param length the number of bytes to copy from each DPU
+ * @param stride the byte distance between the data of two consecutive DPUs in the host buffer
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_copy_from_symbol_gather(struct dpu_rank_t *rank,
+    struct dpu_symbol_t symbol,
+    uint32_t symbol_offset,
+    void *dst,
+    size_t length,
+    size_t stride);
+
+/**
+ * @fn dpu_copy_from_address_gather
+ * @brief Copy data from one of the DPU memories of each DPU of the rank into a single Host buffer.
+ *
+ * MRAM data is fetched with a single transfer matrix for the whole rank.
+ *
+ * @param rank the DPU rank
+ * @param address the DPU address from where the data is copied
+ * @param dst the host buffer where the data is copied, the n-th enabled DPU of the rank being copied at `dst + n * stride`
+ * @param length the number of bytes to copy from each DPU
+ * @param stride the byte distance between the data of two consecutive DPUs in the host buffer
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_copy_from_address_gather(struct dpu_rank_t *rank,
+    dpu_mem_max_addr_t address,
+    void *dst,
+    dpu_mem_max_size_t length,
+    size_t stride);
+
 /**
  * @fn dpu_copy_to_iram_for_rank
  * @brief Copy some instructions to the IRAM of all DPUs of a rank.
@@ -298,4 +386,28 @@ dpu_copy_to_mrams(struct dpu_rank_t *rank, const struct dpu_transfer_mram *trans
 dpu_error_t
 dpu_copy_from_mrams(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
 
+/**
+ * @fn dpu_copy_to_mrams_iovec
+ * @brief Copy data to the MRAMs, from several Host buffers for each DPU, in one pass over the rank when the backend
+ * supports it.
+ * @param rank the DPU rank
+ * @param iovec_matrix matrix allocated by `dpu_transfer_iovec_matrix_allocate` describing the segments of each DPU
+ * @return ``DPU_OK`` in case of success, ``DPU_ERR_MRAM_BUSY`` means the host cannot write at the moment to the
+ * MRAM and the access must be retried later, another value precising the error otherwise.
+ */
+dpu_error_t
+dpu_copy_to_mrams_iovec(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix);
+
+/**
+ * @fn dpu_copy_from_mrams_iovec
+ * @brief Copy data from the MRAMs, to several Host buffers for each DPU, in one pass over the rank when the backend
+ * supports it.
+ * @param rank the DPU rank
+ * @param iovec_matrix matrix allocated by `dpu_transfer_iovec_matrix_allocate` describing the segments of each DPU
+ * @return ``DPU_OK`` in case of success, ``DPU_ERR_MRAM_BUSY`` means the host cannot write at the moment to the
+ * MRAM and the access must be retried later, another value precising the error otherwise.
+ */
+dpu_error_t
+dpu_copy_from_mrams_iovec(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix);
+
 #endif // DPU_MEMORY_H
@@ -42,6 +42,10 @@ typedef struct _dpu_profiling_context_t {
     iram_addr_t mcount_address;
     iram_addr_t ret_mcount_address;
     wram_addr_t thread_profiling_address;
+
+    /* In stat and sample modes, the profiled DPU is read once every poll_period polls of its rank */
+    uint32_t poll_period;
+    uint32_t nr_polls;
 } * dpu_profiling_context_t;
 
 dpu_error_t
@@ -25,6 +25,9 @@ struct dpu_program_t {
     int32_t printf_write_pointer_address;
     int32_t printf_buffer_has_wrapped_address;
     dpu_elf_symbols_t *symbols;
+    /* Open-addressing hash table on the symbol names: each slot holds an index in symbols->map plus one, 0 if free */
+    uint32_t *symbol_table;
+    uint32_t symbol_table_mask;
 
     int32_t mcount_address;
     int32_t ret_mcount_address;
@@ -35,6 +38,9 @@ struct dpu_program_t {
 
     uint32_t reference_count;
 
+    /* Smoothed duration of the previous runs, used by the adaptive dpu_sync strategy (0 when unknown) */
+    uint64_t expected_run_time_in_ns;
+
     char *program_path;
 };
 
@@ -45,6 +51,16 @@ dpu_take_program_ref(struct dpu_program_t *program);
 void
 dpu_free_program(struct dpu_program_t *program);
 
+/**
+ * @fn dpu_program_find_symbol
+ * @brief Looks for a symbol of the program by its name.
+ * @param program the DPU program
+ * @param symbol_name the name of the symbol
+ * @return The symbol, NULL if the program has no such symbol.
+ */
+dpu_elf_symbol_t *
+dpu_program_find_symbol(struct dpu_program_t *program, const char *symbol_name);
+
 /**
  * @fn dpu_get_program
  * @brief Fetches the program runtime context of the specified DPU.
@@ -51,4 +51,30 @@ dpu_transfer_matrix_get_ptr(struct dpu_t *dpu, struct dpu_transfer_mram *transfe
 uint32_t
 dpu_transfer_matrix_get_size(struct dpu_t *dpu, struct dpu_transfer_mram *transfer_matrix);
 
+/**
+ * @struct dpu_transfer_mram_iovec
+ * @brief Context of a DPU MRAM transfer made of several segments.
+ */
+struct dpu_transfer_mram_iovec;
+
+dpu_error_t
+dpu_transfer_iovec_matrix_allocate(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec **iovec_matrix);
+void
+dpu_transfer_iovec_matrix_free(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix);
+/* Segments of a DPU must not overlap in the MRAM */
+dpu_error_t
+dpu_transfer_iovec_matrix_add_segment(struct dpu_t *dpu,
+    struct dpu_transfer_mram_iovec *iovec_matrix,
+    void *buffer,
+    mram_size_t size,
+    mram_addr_t offset_in_mram);
+void
+dpu_transfer_iovec_matrix_clear_all(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix);
+
+/* A registered transfer matrix must not be modified until it is unregistered: the backend may prepare it only once */
+dpu_error_t
+dpu_transfer_matrix_register(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
+void
+dpu_transfer_matrix_unregister(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
+
 #endif // DPU_TRANSFER_MATRIX_H
@@ -264,6 +264,19 @@ struct dpu_repair_config {
     uint8_t odd_index;
 };
 
+/**
+ * @struct dpu_ci_command_stats
+ * @brief Counters of the commands executed on the control interfaces of a rank.
+ */
+struct dpu_ci_command_stats {
+    /** Number of commands committed and waited for. */
+    uint64_t nr_commands;
+    /** Number of reads of the control interfaces, polling and confirming reads included. */
+    uint64_t nr_reads;
+    /** Time spent between the commit of the commands and their validated results. */
+    uint64_t total_latency_in_ns;
+};
+
 enum dpu_temperature {
     DPU_TEMPERATURE_LESS_THAN_50 = 0,
     DPU_TEMPERATURE_BETWEEN_50_AND_60 = 1,
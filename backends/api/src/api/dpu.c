@@ -3,6 +3,10 @@
  * found in the LICENSE file.
  */
 
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+
 #include <dpu.h>
 
 #include <dpu_attributes.h>
@@ -20,6 +24,7 @@
 #include <dpu_program.h>
 #include <dpu_error.h>
 #include <dpu_types.h>
+#include <dpu_rank_dispatch.h>
 
 static dpu_error_t
 dpu_load_rank(struct dpu_rank_t *rank, struct dpu_program_t *program, dpu_elf_file_t elf_info);
@@ -27,9 +32,11 @@ static dpu_error_t
 dpu_load_dpu(struct dpu_t *dpu, struct dpu_program_t *program, dpu_elf_file_t elf_info);
 
 static dpu_error_t
-dpu_boot_rank(struct dpu_rank_t *rank, dpu_launch_policy_t policy);
+dpu_boot_rank(struct dpu_rank_t *rank, dpu_launch_policy_t policy, struct dpu_future_t *future, uint32_t future_index);
 static dpu_error_t
-dpu_boot_dpu(struct dpu_t *dpu, dpu_launch_policy_t policy);
+dpu_boot_dpu(struct dpu_t *dpu, dpu_launch_policy_t policy, struct dpu_future_t *future, uint32_t future_index);
+static void
+dpu_future_complete(struct dpu_future_t *future, uint32_t index, dpu_error_t status);
 static dpu_error_t
 run_all_one_loop_iteration(struct dpu_rank_t *rank,
     bool *must_stop,
@@ -356,6 +363,25 @@ dpu_set_dpu_iterator_next(struct dpu_set_dpu_iterator_t *iterator)
     }
 }
 
+static double
+elapsed_ms_since(const struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) * 1e3 + (double)(now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static dpu_error_t
+dispatch_reset_rank(struct dpu_rank_t *rank, __attribute__((unused)) uint32_t rank_idx, __attribute__((unused)) void *args)
+{
+    if (rank->description->configuration.disable_reset_on_alloc) {
+        return DPU_OK;
+    }
+
+    return dpu_reset_rank(rank);
+}
+
 __API_SYMBOL__ dpu_error_t
 dpu_alloc(uint32_t nr_dpus, const char *profile, struct dpu_set_t *dpu_set)
 {
@@ -367,6 +393,10 @@ dpu_alloc(uint32_t nr_dpus, const char *profile, struct dpu_set_t *dpu_set)
     uint32_t current_nr_of_dpus = 0;
     uint32_t current_nr_of_ranks = 0;
     dpu_error_t status;
+    struct timespec phase_start;
+    double allocation_time, reset_time;
+
+    clock_gettime(CLOCK_MONOTONIC, &phase_start);
 
     while (current_nr_of_dpus < nr_dpus) {
         if (current_nr_of_ranks == capacity) {
@@ -417,14 +447,22 @@ dpu_alloc(uint32_t nr_dpus, const char *profile, struct dpu_set_t *dpu_set)
         }
     }
 reset_ranks:
-    for (uint32_t each_rank = 0; each_rank < current_nr_of_ranks; ++each_rank) {
-        if (!current_ranks[each_rank]->description->configuration.disable_reset_on_alloc) {
-            if ((status = dpu_reset_rank(current_ranks[each_rank])) != DPU_OK) {
-                goto free_ranks;
-            }
-        }
+    allocation_time = elapsed_ms_since(&phase_start);
+    clock_gettime(CLOCK_MONOTONIC, &phase_start);
+
+    if ((status = dpu_rank_dispatch(current_ranks, current_nr_of_ranks, dispatch_reset_rank, NULL, DPU_DISPATCH_FIRST_ERROR))
+        != DPU_OK) {
+        goto free_ranks;
     }
 
+    reset_time = elapsed_ms_since(&phase_start);
+    LOG_FN(INFO,
+        "%u ranks, %u dpus: allocation %.3f ms, reset %.3f ms",
+        current_nr_of_ranks,
+        current_nr_of_dpus,
+        allocation_time,
+        reset_time);
+
     // Making sure that the whole structure is initialized
     // (in particular, we are using memcmp in set_allocator_find)
     memset(dpu_set, 0, sizeof(*dpu_set));
@@ -521,6 +559,19 @@ typedef dpu_error_t (*load_elf_program_fct_t)(dpu_elf_file_t *elf_info,
     struct dpu_program_t *program,
     mram_size_t mram_size_hint);
 
+struct dispatch_load_args_t {
+    struct dpu_program_t *program;
+    dpu_elf_file_t elf_info;
+};
+
+static dpu_error_t
+dispatch_load_rank(struct dpu_rank_t *rank, __attribute__((unused)) uint32_t rank_idx, void *args)
+{
+    struct dispatch_load_args_t *load = args;
+
+    return dpu_load_rank(rank, load->program, load->elf_info);
+}
+
 static dpu_error_t
 dpu_load_generic(struct dpu_set_t dpu_set,
     const char *path,
@@ -532,6 +583,10 @@ dpu_load_generic(struct dpu_set_t dpu_set,
     dpu_error_t status;
     dpu_elf_file_t elf_info;
     struct dpu_program_t *runtime;
+    struct timespec phase_start;
+    double elf_time;
+
+    clock_gettime(CLOCK_MONOTONIC, &phase_start);
 
     if ((runtime = malloc(sizeof(*runtime))) == NULL) {
         status = DPU_ERR_SYSTEM;
@@ -546,14 +601,20 @@ dpu_load_generic(struct dpu_set_t dpu_set,
         goto end;
     }
 
+    elf_time = elapsed_ms_since(&phase_start);
+    clock_gettime(CLOCK_MONOTONIC, &phase_start);
+
     switch (dpu_set.kind) {
-        case DPU_SET_RANKS:
-            for (uint32_t each_rank = 0; each_rank < dpu_set.list.nr_ranks; ++each_rank) {
-                if ((status = dpu_load_rank(dpu_set.list.ranks[each_rank], runtime, elf_info)) != DPU_OK) {
-                    goto free_runtime;
-                }
+        case DPU_SET_RANKS: {
+            struct dispatch_load_args_t args = { .program = runtime, .elf_info = elf_info };
+
+            if ((status = dpu_rank_dispatch(
+                     dpu_set.list.ranks, dpu_set.list.nr_ranks, dispatch_load_rank, &args, DPU_DISPATCH_FIRST_ERROR))
+                != DPU_OK) {
+                goto free_runtime;
             }
             break;
+        }
         case DPU_SET_DPU:
             if ((status = dpu_load_dpu(dpu_set.dpu, runtime, elf_info)) != DPU_OK) {
                 goto free_runtime;
@@ -564,6 +625,8 @@ dpu_load_generic(struct dpu_set_t dpu_set,
             goto free_runtime;
     }
 
+    LOG_FN(INFO, "elf %.3f ms, load %.3f ms", elf_time, elapsed_ms_since(&phase_start));
+
     if (program != NULL) {
         *program = runtime;
     }
@@ -629,23 +692,42 @@ dpu_get_symbol(struct dpu_program_t *program, const char *symbol_name, struct dp
 {
     LOG_FN(VERBOSE, "\"%s\"", symbol_name);
 
-    dpu_error_t status = DPU_OK;
+    dpu_elf_symbol_t *elf_symbol;
 
-    uint32_t nr_symbols = program->symbols->nr_symbols;
+    /* No program is loaded */
+    if (program == NULL) {
+        return DPU_ERR_UNKNOWN_SYMBOL;
+    }
 
-    for (uint32_t each_symbol = 0; each_symbol < nr_symbols; ++each_symbol) {
-        dpu_elf_symbol_t *elf_symbol = program->symbols->map + each_symbol;
-        if (strcmp(symbol_name, elf_symbol->name) == 0) {
-            symbol->address = elf_symbol->value;
-            symbol->size = elf_symbol->size;
-            goto end;
-        }
+    if ((elf_symbol = dpu_program_find_symbol(program, symbol_name)) == NULL) {
+        return DPU_ERR_UNKNOWN_SYMBOL;
     }
 
-    status = DPU_ERR_UNKNOWN_SYMBOL;
+    symbol->address = elf_symbol->value;
+    symbol->size = elf_symbol->size;
 
-end:
-    return status;
+    return DPU_OK;
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_get_set_symbol(struct dpu_set_t dpu_set, const char *symbol_name, struct dpu_symbol_t *symbol)
+{
+    LOG_FN(VERBOSE, "\"%s\"", symbol_name);
+
+    dpu_error_t status;
+    struct dpu_program_t *program;
+
+    if ((status = dpu_get_common_program(&dpu_set, &program)) != DPU_OK) {
+        return status;
+    }
+
+    return dpu_get_symbol(program, symbol_name, symbol);
+}
+
+static dpu_error_t
+dispatch_boot_rank(struct dpu_rank_t *rank, __attribute__((unused)) uint32_t rank_idx, __attribute__((unused)) void *args)
+{
+    return dpu_boot_rank(rank, DPU_ASYNCHRONOUS, NULL, 0);
 }
 
 __API_SYMBOL__ dpu_error_t
@@ -654,23 +736,222 @@ dpu_launch(struct dpu_set_t dpu_set, dpu_launch_policy_t policy)
     LOG_FN(VERBOSE, "%s", dpu_launch_policy_to_string(policy));
 
     switch (dpu_set.kind) {
-        case DPU_SET_RANKS:
-            for (uint32_t each_rank = 0; each_rank < dpu_set.list.nr_ranks; ++each_rank) {
-                dpu_error_t status;
+        case DPU_SET_RANKS: {
+            dpu_error_t status;
 
-                if ((status = dpu_boot_rank(dpu_set.list.ranks[each_rank], DPU_ASYNCHRONOUS)) != DPU_OK) {
-                    return status;
-                }
+            if ((status = dpu_rank_dispatch(
+                     dpu_set.list.ranks, dpu_set.list.nr_ranks, dispatch_boot_rank, NULL, DPU_DISPATCH_FIRST_ERROR))
+                != DPU_OK) {
+                return status;
             }
             if (policy == DPU_SYNCHRONOUS) {
                 return dpu_sync(dpu_set);
             }
             return DPU_OK;
+        }
+        case DPU_SET_DPU:
+            return dpu_boot_dpu(dpu_set.dpu, policy, NULL, 0);
+        default:
+            return DPU_ERR_INTERNAL;
+    }
+}
+
+struct dpu_future_t {
+    struct dpu_set_t set;
+    dpu_completion_callback_t callback;
+    void *callback_args;
+    dpu_completion_flags_t flags;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t nr_pending;
+    dpu_error_t status;
+    bool done;
+    bool owned_by_caller;
+};
+
+static void
+dpu_future_destroy(struct dpu_future_t *future)
+{
+    pthread_cond_destroy(&future->cond);
+    pthread_mutex_destroy(&future->mutex);
+    free(future);
+}
+
+static void
+dpu_future_release(struct dpu_future_t *future, dpu_error_t status)
+{
+    bool is_last;
+    bool must_free;
+
+    pthread_mutex_lock(&future->mutex);
+    if ((status != DPU_OK) && (future->status == DPU_OK)) {
+        future->status = status;
+    }
+    is_last = (future->nr_pending != 0) && (--future->nr_pending == 0);
+    status = future->status;
+    pthread_mutex_unlock(&future->mutex);
+
+    if (!is_last) {
+        return;
+    }
+
+    if ((future->callback != NULL) && (future->flags == DPU_COMPLETION_PER_SET)) {
+        future->callback(future->set, 0, status, future->callback_args);
+    }
+
+    pthread_mutex_lock(&future->mutex);
+    future->done = true;
+    must_free = !future->owned_by_caller;
+    pthread_cond_broadcast(&future->cond);
+    pthread_mutex_unlock(&future->mutex);
+
+    if (must_free) {
+        dpu_future_destroy(future);
+    }
+}
+
+/* Called once for each launched rank (or for the launched DPU), by its poll thread or on boot failure */
+static void
+dpu_future_complete(struct dpu_future_t *future, uint32_t index, dpu_error_t status)
+{
+    if ((future->callback != NULL) && (future->flags == DPU_COMPLETION_PER_RANK)) {
+        struct dpu_set_t rank_set = future->set;
+
+        if (rank_set.kind == DPU_SET_RANKS) {
+            rank_set.list.nr_ranks = 1;
+            rank_set.list.ranks = future->set.list.ranks + index;
+        }
+        future->callback(rank_set, index, status, future->callback_args);
+    }
+
+    dpu_future_release(future, status);
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_launch_async(struct dpu_set_t dpu_set,
+    dpu_completion_callback_t callback,
+    void *args,
+    dpu_completion_flags_t flags,
+    struct dpu_future_t **future)
+{
+    LOG_FN(VERBOSE, "%s", (flags == DPU_COMPLETION_PER_RANK) ? "per rank" : "per set");
+
+    struct dpu_future_t *new_future;
+    dpu_error_t status = DPU_OK;
+    uint32_t nr_units;
+
+    switch (dpu_set.kind) {
+        case DPU_SET_RANKS:
+            nr_units = dpu_set.list.nr_ranks;
+            break;
         case DPU_SET_DPU:
-            return dpu_boot_dpu(dpu_set.dpu, policy);
+            nr_units = 1;
+            break;
         default:
             return DPU_ERR_INTERNAL;
     }
+
+    if ((flags != DPU_COMPLETION_PER_RANK) && (flags != DPU_COMPLETION_PER_SET)) {
+        return DPU_ERR_INVALID_LAUNCH_POLICY;
+    }
+
+    if ((new_future = malloc(sizeof(*new_future))) == NULL) {
+        return DPU_ERR_SYSTEM;
+    }
+
+    new_future->set = dpu_set;
+    new_future->callback = callback;
+    new_future->callback_args = args;
+    new_future->flags = flags;
+    new_future->status = DPU_OK;
+    new_future->done = false;
+    new_future->owned_by_caller = (future != NULL);
+    /* One extra unit, released below, so that the future cannot complete while ranks are still being booted */
+    new_future->nr_pending = nr_units + 1;
+
+    if (pthread_mutex_init(&new_future->mutex, NULL) != 0) {
+        free(new_future);
+        return DPU_ERR_SYSTEM;
+    }
+    if (pthread_cond_init(&new_future->cond, NULL) != 0) {
+        pthread_mutex_destroy(&new_future->mutex);
+        free(new_future);
+        return DPU_ERR_SYSTEM;
+    }
+
+    if (future != NULL) {
+        *future = new_future;
+    }
+
+    for (uint32_t each_unit = 0; each_unit < nr_units; ++each_unit) {
+        dpu_error_t unit_status;
+
+        if (status != DPU_OK) {
+            /* Not booted: complete the unit now so that the future still gets done */
+            dpu_future_complete(new_future, each_unit, status);
+            continue;
+        }
+
+        if (dpu_set.kind == DPU_SET_RANKS) {
+            unit_status = dpu_boot_rank(dpu_set.list.ranks[each_unit], DPU_ASYNCHRONOUS, new_future, each_unit);
+        } else {
+            unit_status = dpu_boot_dpu(dpu_set.dpu, DPU_ASYNCHRONOUS, new_future, each_unit);
+        }
+
+        if (unit_status != DPU_OK) {
+            status = unit_status;
+            dpu_future_complete(new_future, each_unit, status);
+        }
+    }
+
+    dpu_future_release(new_future, DPU_OK);
+
+    return status;
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_future_poll(struct dpu_future_t *future, bool *done)
+{
+    LOG_FN(VERBOSE, "");
+
+    dpu_error_t status;
+
+    pthread_mutex_lock(&future->mutex);
+    *done = future->done;
+    status = future->done ? future->status : DPU_OK;
+    pthread_mutex_unlock(&future->mutex);
+
+    return status;
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_future_wait(struct dpu_future_t *future)
+{
+    LOG_FN(VERBOSE, "");
+
+    dpu_error_t status;
+
+    pthread_mutex_lock(&future->mutex);
+    while (!future->done) {
+        pthread_cond_wait(&future->cond, &future->mutex);
+    }
+    status = future->status;
+    pthread_mutex_unlock(&future->mutex);
+
+    return status;
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_future_free(struct dpu_future_t *future)
+{
+    LOG_FN(VERBOSE, "");
+
+    dpu_error_t status = dpu_future_wait(future);
+
+    dpu_future_destroy(future);
+
+    return status;
 }
 
 __API_SYMBOL__ dpu_error_t
@@ -704,6 +985,177 @@ dpu_status(struct dpu_set_t dpu_set, bool *done, bool *fault)
     }
 }
 
+/* Number of unsuccessful polls before yielding or sleeping: keeps the latency of short runs close to pure spinning */
+#define SYNC_NR_OF_POLLS_BEFORE_WAITING 64
+/* Part of the expected run time which is slept by the adaptive strategy, in 1/8 */
+#define SYNC_ADAPTIVE_SLEEP_RATIO 7
+
+static uint64_t
+timespec_to_ns(const struct timespec *time)
+{
+    return (uint64_t)time->tv_sec * 1000000000ULL + (uint64_t)time->tv_nsec;
+}
+
+static void
+sleep_ns(uint64_t duration_in_ns)
+{
+    struct timespec duration = { .tv_sec = duration_in_ns / 1000000000ULL, .tv_nsec = duration_in_ns % 1000000000ULL };
+
+    while ((nanosleep(&duration, &duration) != 0) && (errno == EINTR)) {
+    }
+}
+
+static const struct timespec *
+get_set_launch_time(struct dpu_set_t *set)
+{
+    switch (set->kind) {
+        case DPU_SET_RANKS:
+            return &dpu_get_run_context(set->list.ranks[0])->launch_time;
+        case DPU_SET_DPU:
+            return &dpu_get_run_context(set->dpu->rank)->launch_time;
+        default:
+            return NULL;
+    }
+}
+
+/* Wait between the polls of a run, following the sync strategy of the DPUs: used by dpu_sync and by the launches */
+struct sync_waiter {
+    dpu_sync_strategy_t strategy;
+    uint64_t max_sleep_in_ns;
+    uint64_t sleep_in_ns;
+    uint32_t nr_polls;
+    /* Program whose expected run time is used and updated by the adaptive strategy */
+    struct dpu_program_t *program;
+    uint64_t launch_time_in_ns;
+};
+
+static void
+sync_waiter_init(struct sync_waiter *waiter, struct dpu_set_t *dpu_set, dpu_sync_strategy_t strategy)
+{
+    dpu_description_t description = get_set_description(dpu_set);
+
+    waiter->strategy = strategy;
+    waiter->max_sleep_in_ns = (uint64_t)description->configuration.sync_max_sleep_in_us * 1000;
+    waiter->sleep_in_ns = 1000;
+    waiter->nr_polls = 0;
+    waiter->program = NULL;
+    waiter->launch_time_in_ns = 0;
+
+    if (strategy == DPU_SYNC_ADAPTIVE) {
+        const struct timespec *launch_time = get_set_launch_time(dpu_set);
+
+        if ((launch_time == NULL) || (dpu_get_common_program(dpu_set, &waiter->program) != DPU_OK)
+            || (waiter->program == NULL)) {
+            waiter->program = NULL;
+            waiter->strategy = DPU_SYNC_SPIN_YIELD;
+        } else {
+            uint64_t expected_run_time_in_ns = __atomic_load_n(&waiter->program->expected_run_time_in_ns, __ATOMIC_RELAXED);
+            struct timespec now;
+
+            waiter->launch_time_in_ns = timespec_to_ns(launch_time);
+            clock_gettime(CLOCK_MONOTONIC, &now);
+
+            uint64_t wake_up_time_in_ns = waiter->launch_time_in_ns + (expected_run_time_in_ns * SYNC_ADAPTIVE_SLEEP_RATIO) / 8;
+            uint64_t now_in_ns = timespec_to_ns(&now);
+
+            if (wake_up_time_in_ns > now_in_ns) {
+                sleep_ns(wake_up_time_in_ns - now_in_ns);
+            }
+        }
+    }
+}
+
+/* Called after each poll which did not see the end of the run */
+static void
+sync_waiter_wait(struct sync_waiter *waiter)
+{
+    if (++waiter->nr_polls <= SYNC_NR_OF_POLLS_BEFORE_WAITING) {
+        return;
+    }
+
+    switch (waiter->strategy) {
+        case DPU_SYNC_SPIN_YIELD:
+        case DPU_SYNC_ADAPTIVE:
+            sched_yield();
+            break;
+        case DPU_SYNC_BACKOFF:
+            sleep_ns(waiter->sleep_in_ns);
+            waiter->sleep_in_ns
+                = (2 * waiter->sleep_in_ns > waiter->max_sleep_in_ns) ? waiter->max_sleep_in_ns : 2 * waiter->sleep_in_ns;
+            break;
+        default:
+            break;
+    }
+}
+
+/* When the DPUs were already done at the first poll, the end of the run is unknown: the estimation is updated only when
+ * the previous one was too long (the sleep overshot) or when the end was observed while polling.
+ */
+static void
+sync_waiter_done(struct sync_waiter *waiter)
+{
+    struct timespec now;
+    uint64_t expected_run_time_in_ns;
+
+    if (waiter->program == NULL) {
+        return;
+    }
+
+    expected_run_time_in_ns = __atomic_load_n(&waiter->program->expected_run_time_in_ns, __ATOMIC_RELAXED);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t run_time_in_ns = timespec_to_ns(&now) - waiter->launch_time_in_ns;
+
+    if ((waiter->nr_polls != 0) || (run_time_in_ns < expected_run_time_in_ns)) {
+        expected_run_time_in_ns
+            = (expected_run_time_in_ns == 0) ? run_time_in_ns : (3 * expected_run_time_in_ns + run_time_in_ns) / 4;
+        __atomic_store_n(&waiter->program->expected_run_time_in_ns, expected_run_time_in_ns, __ATOMIC_RELAXED);
+    }
+}
+
+/* Returns whether a run was in flight */
+static bool
+wait_for_poll_thread(struct dpu_poll_thread_context_t *poll_thread)
+{
+    bool was_running;
+
+    if (!poll_thread->thr_exists) {
+        return false;
+    }
+
+    pthread_mutex_lock(&poll_thread->thr_mutex);
+    was_running = poll_thread->thr_running;
+    while (poll_thread->thr_running) {
+        pthread_cond_wait(&poll_thread->thr_cond, &poll_thread->thr_mutex);
+    }
+    pthread_mutex_unlock(&poll_thread->thr_mutex);
+
+    return was_running;
+}
+
+/* The runs of the asynchronous launches are polled by their poll thread only: dpu_sync sleeps until they end */
+static bool
+wait_for_poll_threads(struct dpu_set_t *dpu_set)
+{
+    bool was_running = false;
+
+    switch (dpu_set->kind) {
+        case DPU_SET_RANKS:
+            for (uint32_t each_rank = 0; each_rank < dpu_set->list.nr_ranks; ++each_rank) {
+                was_running = wait_for_poll_thread(&dpu_get_run_context(dpu_set->list.ranks[each_rank])->poll_thread)
+                    || was_running;
+            }
+            break;
+        case DPU_SET_DPU:
+            was_running = wait_for_poll_thread(&dpu_get_run_context(dpu_set->dpu->rank)->poll_thread);
+            was_running = wait_for_poll_thread(&dpu_set->dpu->poll_thread) || was_running;
+            break;
+        default:
+            break;
+    }
+
+    return was_running;
+}
+
 __API_SYMBOL__ dpu_error_t
 dpu_sync(struct dpu_set_t dpu_set)
 {
@@ -712,14 +1164,29 @@ dpu_sync(struct dpu_set_t dpu_set)
     dpu_error_t status;
     bool fault;
     bool done;
+    dpu_sync_strategy_t strategy = get_set_description(&dpu_set)->configuration.sync_strategy;
+    struct sync_waiter waiter;
 
-    do {
+    /* The poll threads already keep the estimation of the run time of the asynchronous launches */
+    if (wait_for_poll_threads(&dpu_set) && (strategy == DPU_SYNC_ADAPTIVE)) {
+        strategy = DPU_SYNC_SPIN_YIELD;
+    }
+
+    sync_waiter_init(&waiter, &dpu_set, strategy);
+
+    while (true) {
         if ((status = dpu_status(dpu_set, &done, &fault)) != DPU_OK) {
             return status;
         }
 
-        // todo: add a sleep here to reduce the CPU load?
-    } while (!done);
+        if (done) {
+            break;
+        }
+
+        sync_waiter_wait(&waiter);
+    }
+
+    sync_waiter_done(&waiter);
 
     return fault ? DPU_ERR_DPU_FAULT : DPU_OK;
 }
@@ -759,23 +1226,34 @@ dpu_copy_from(struct dpu_set_t dpu_set, const char *symbol_name, uint32_t symbol
     }
 }
 
+struct dispatch_copy_to_symbol_args_t {
+    struct dpu_symbol_t symbol;
+    uint32_t symbol_offset;
+    const void *src;
+    size_t length;
+};
+
+static dpu_error_t
+dispatch_copy_to_symbol_rank(struct dpu_rank_t *rank, __attribute__((unused)) uint32_t rank_idx, void *args)
+{
+    struct dispatch_copy_to_symbol_args_t *copy = args;
+
+    return dpu_copy_to_symbol_rank(rank, copy->symbol, copy->symbol_offset, copy->src, copy->length);
+}
+
 __API_SYMBOL__ dpu_error_t
 dpu_copy_to_symbol(struct dpu_set_t dpu_set, struct dpu_symbol_t symbol, uint32_t symbol_offset, const void *src, size_t length)
 {
     LOG_FN(VERBOSE, "0x%08x, %d, %d, %p, %zd)", symbol.address, symbol.size, symbol_offset, src, length);
 
-    dpu_error_t status;
-
     switch (dpu_set.kind) {
-        case DPU_SET_RANKS:
-            for (uint32_t each_rank = 0; each_rank < dpu_set.list.nr_ranks; ++each_rank) {
-                if ((status = dpu_copy_to_symbol_rank(dpu_set.list.ranks[each_rank], symbol, symbol_offset, src, length))
-                    != DPU_OK) {
-                    return status;
-                }
-            }
+        case DPU_SET_RANKS: {
+            struct dispatch_copy_to_symbol_args_t args
+                = { .symbol = symbol, .symbol_offset = symbol_offset, .src = src, .length = length };
 
-            return DPU_OK;
+            return dpu_rank_dispatch(
+                dpu_set.list.ranks, dpu_set.list.nr_ranks, dispatch_copy_to_symbol_rank, &args, DPU_DISPATCH_FIRST_ERROR);
+        }
         case DPU_SET_DPU:
             return dpu_copy_to_symbol_dpu(dpu_set.dpu, symbol, symbol_offset, src, length);
         default:
@@ -799,35 +1277,130 @@ dpu_copy_from_symbol(struct dpu_set_t dpu_set, struct dpu_symbol_t symbol, uint3
 }
 
 __API_SYMBOL__ dpu_error_t
-dpu_prepare_xfer(struct dpu_set_t dpu_set, void *buffer)
+dpu_gather_from(struct dpu_set_t dpu_set,
+    const char *symbol_name,
+    uint32_t symbol_offset,
+    void *dst,
+    size_t length,
+    size_t stride)
 {
-    LOG_FN(VERBOSE, "%p", buffer);
+    LOG_FN(VERBOSE, "\"%s\", %d, %p, %zd, %zd)", symbol_name, symbol_offset, dst, length, stride);
 
-    dpu_error_t status = DPU_OK;
+    dpu_error_t status;
+    struct dpu_program_t *program;
+    struct dpu_symbol_t symbol;
+
+    if ((status = dpu_get_common_program(&dpu_set, &program)) != DPU_OK) {
+        return status;
+    }
+
+    if ((status = dpu_get_symbol(program, symbol_name, &symbol)) != DPU_OK) {
+        return status;
+    }
+
+    return dpu_gather_from_symbol(dpu_set, symbol, symbol_offset, dst, length, stride);
+}
+
+struct dispatch_gather_args_t {
+    struct dpu_symbol_t symbol;
+    uint32_t symbol_offset;
+    size_t length;
+    size_t stride;
+    uint8_t **rank_dsts;
+};
+
+static dpu_error_t
+dispatch_gather_rank(struct dpu_rank_t *rank, uint32_t rank_idx, void *args)
+{
+    struct dispatch_gather_args_t *gather = args;
+
+    return dpu_copy_from_symbol_gather(
+        rank, gather->symbol, gather->symbol_offset, gather->rank_dsts[rank_idx], gather->length, gather->stride);
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_gather_from_symbol(struct dpu_set_t dpu_set,
+    struct dpu_symbol_t symbol,
+    uint32_t symbol_offset,
+    void *dst,
+    size_t length,
+    size_t stride)
+{
+    LOG_FN(VERBOSE, "0x%08x, %d, %d, %p, %zd, %zd)", symbol.address, symbol.size, symbol_offset, dst, length, stride);
+
+    if (stride < length) {
+        return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
 
     switch (dpu_set.kind) {
-        case DPU_SET_RANKS:
+        case DPU_SET_RANKS: {
+            dpu_error_t status;
+            uint8_t *rank_dst = dst;
+            struct dispatch_gather_args_t args = { .symbol = symbol,
+                .symbol_offset = symbol_offset,
+                .length = length,
+                .stride = stride };
+
+            if ((args.rank_dsts = malloc(dpu_set.list.nr_ranks * sizeof(*args.rank_dsts))) == NULL) {
+                return DPU_ERR_SYSTEM;
+            }
+
+            /* Each rank fills the slots of its enabled DPUs, following the DPU_FOREACH order */
             for (uint32_t each_rank = 0; each_rank < dpu_set.list.nr_ranks; ++each_rank) {
-                struct dpu_rank_t *rank = dpu_set.list.ranks[each_rank];
-                uint8_t nr_cis = rank->description->topology.nr_of_control_interfaces;
-                uint8_t nr_dpus_per_ci = rank->description->topology.nr_of_dpus_per_control_interface;
+                args.rank_dsts[each_rank] = rank_dst;
+                rank_dst += get_nr_of_dpus_in_rank(dpu_set.list.ranks[each_rank]) * stride;
+            }
 
-                for (uint8_t each_ci = 0; each_ci < nr_cis; ++each_ci) {
-                    for (uint8_t each_dpu = 0; each_dpu < nr_dpus_per_ci; ++each_dpu) {
-                        struct dpu_t *dpu = DPU_GET_UNSAFE(rank, each_ci, each_dpu);
+            status = dpu_rank_dispatch(
+                dpu_set.list.ranks, dpu_set.list.nr_ranks, dispatch_gather_rank, &args, DPU_DISPATCH_FIRST_ERROR);
 
-                        if (!dpu_is_enabled(dpu)) {
-                            continue;
-                        }
+            free(args.rank_dsts);
+            return status;
+        }
+        case DPU_SET_DPU:
+            return dpu_copy_from_symbol_dpu(dpu_set.dpu, symbol, symbol_offset, dst, length);
+        default:
+            return DPU_ERR_INTERNAL;
+    }
+}
 
-                        dpu_error_t buffer_status;
-                        if ((buffer_status = dpu_set_transfer_buffer_safe(dpu, buffer)) != DPU_OK) {
-                            status = buffer_status;
-                        }
-                    }
-                }
+static dpu_error_t
+dispatch_prepare_xfer_rank(struct dpu_rank_t *rank, __attribute__((unused)) uint32_t rank_idx, void *buffer)
+{
+    dpu_error_t status = DPU_OK;
+    uint8_t nr_cis = rank->description->topology.nr_of_control_interfaces;
+    uint8_t nr_dpus_per_ci = rank->description->topology.nr_of_dpus_per_control_interface;
+
+    for (uint8_t each_ci = 0; each_ci < nr_cis; ++each_ci) {
+        for (uint8_t each_dpu = 0; each_dpu < nr_dpus_per_ci; ++each_dpu) {
+            struct dpu_t *dpu = DPU_GET_UNSAFE(rank, each_ci, each_dpu);
+
+            if (!dpu_is_enabled(dpu)) {
+                continue;
             }
 
+            dpu_error_t buffer_status;
+            if ((buffer_status = dpu_set_transfer_buffer_safe(dpu, buffer)) != DPU_OK) {
+                status = buffer_status;
+            }
+        }
+    }
+
+    return status;
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_prepare_xfer(struct dpu_set_t dpu_set, void *buffer)
+{
+    LOG_FN(VERBOSE, "%p", buffer);
+
+    dpu_error_t status = DPU_OK;
+
+    switch (dpu_set.kind) {
+        case DPU_SET_RANKS:
+            status = dpu_rank_dispatch(
+                dpu_set.list.ranks, dpu_set.list.nr_ranks, dispatch_prepare_xfer_rank, buffer, DPU_DISPATCH_LAST_ERROR);
+
             break;
         case DPU_SET_DPU: {
             struct dpu_t *dpu = dpu_set.dpu;
@@ -880,6 +1453,28 @@ dpu_push_xfer(struct dpu_set_t dpu_set,
     return dpu_push_xfer_symbol(dpu_set, xfer, symbol, symbol_offset, length, flags);
 }
 
+struct dispatch_push_xfer_args_t {
+    dpu_xfer_t xfer;
+    struct dpu_symbol_t symbol;
+    uint32_t symbol_offset;
+    size_t length;
+};
+
+static dpu_error_t
+dispatch_push_xfer_rank(struct dpu_rank_t *rank, __attribute__((unused)) uint32_t rank_idx, void *args)
+{
+    struct dispatch_push_xfer_args_t *push = args;
+
+    switch (push->xfer) {
+        case DPU_XFER_TO_DPU:
+            return dpu_copy_to_symbol_matrix(rank, push->symbol, push->symbol_offset, push->length);
+        case DPU_XFER_FROM_DPU:
+            return dpu_copy_from_symbol_matrix(rank, push->symbol, push->symbol_offset, push->length);
+        default:
+            return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
+}
+
 __API_SYMBOL__ dpu_error_t
 dpu_push_xfer_symbol(struct dpu_set_t dpu_set,
     dpu_xfer_t xfer,
@@ -900,25 +1495,21 @@ dpu_push_xfer_symbol(struct dpu_set_t dpu_set,
     dpu_error_t status;
 
     switch (dpu_set.kind) {
-        case DPU_SET_RANKS:
-            for (uint32_t each_rank = 0; each_rank < dpu_set.list.nr_ranks; ++each_rank) {
-                switch (xfer) {
-                    case DPU_XFER_TO_DPU:
-                        if ((status = dpu_copy_to_symbol_matrix(dpu_set.list.ranks[each_rank], symbol, symbol_offset, length))) {
-                            return status;
-                        }
-                        break;
-                    case DPU_XFER_FROM_DPU:
-                        if ((status
-                                = dpu_copy_from_symbol_matrix(dpu_set.list.ranks[each_rank], symbol, symbol_offset, length))) {
-                            return status;
-                        }
-                        break;
-                    default:
-                        return DPU_ERR_INVALID_MEMORY_TRANSFER;
-                }
+        case DPU_SET_RANKS: {
+            struct dispatch_push_xfer_args_t args
+                = { .xfer = xfer, .symbol = symbol, .symbol_offset = symbol_offset, .length = length };
+
+            if ((xfer != DPU_XFER_TO_DPU) && (xfer != DPU_XFER_FROM_DPU)) {
+                return DPU_ERR_INVALID_MEMORY_TRANSFER;
+            }
+
+            if ((status = dpu_rank_dispatch(
+                     dpu_set.list.ranks, dpu_set.list.nr_ranks, dispatch_push_xfer_rank, &args, DPU_DISPATCH_FIRST_ERROR))
+                != DPU_OK) {
+                return status;
             }
             break;
+        }
         case DPU_SET_DPU: {
             struct dpu_t *dpu = dpu_set.dpu;
             void *buffer = dpu->transfer_buffer;
@@ -952,6 +1543,423 @@ dpu_push_xfer_symbol(struct dpu_set_t dpu_set,
     return DPU_OK;
 }
 
+struct dpu_prepared_xfer_t {
+    struct dpu_set_t set;
+    dpu_xfer_t xfer;
+    dpu_mem_max_addr_t address;
+    size_t length;
+    /* Host buffer of each DPU, one matrix for each rank of the set */
+    struct dpu_transfer_mram **rank_matrices;
+};
+
+static void
+prepared_xfer_destroy(struct dpu_prepared_xfer_t *prepared_xfer)
+{
+    for (uint32_t each_rank = 0; each_rank < prepared_xfer->set.list.nr_ranks; ++each_rank) {
+        struct dpu_rank_t *rank = prepared_xfer->set.list.ranks[each_rank];
+        struct dpu_transfer_mram *matrix = prepared_xfer->rank_matrices[each_rank];
+
+        if (matrix != NULL) {
+            dpu_transfer_matrix_unregister(rank, matrix);
+            dpu_transfer_matrix_free(rank, matrix);
+        }
+    }
+
+    free(prepared_xfer->rank_matrices);
+    free(prepared_xfer);
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_prepared_xfer_create(struct dpu_set_t dpu_set,
+    dpu_xfer_t xfer,
+    const char *symbol_name,
+    uint32_t symbol_offset,
+    size_t length,
+    struct dpu_prepared_xfer_t **prepared_xfer)
+{
+    LOG_FN(VERBOSE, "%s, %s, %d, %zd", dpu_transfer_to_string(xfer), symbol_name, symbol_offset, length);
+
+    dpu_error_t status;
+    struct dpu_program_t *program;
+    struct dpu_symbol_t symbol;
+
+    if ((status = dpu_get_common_program(&dpu_set, &program)) != DPU_OK) {
+        return status;
+    }
+
+    if ((status = dpu_get_symbol(program, symbol_name, &symbol)) != DPU_OK) {
+        return status;
+    }
+
+    return dpu_prepared_xfer_create_symbol(dpu_set, xfer, symbol, symbol_offset, length, prepared_xfer);
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_prepared_xfer_create_symbol(struct dpu_set_t dpu_set,
+    dpu_xfer_t xfer,
+    struct dpu_symbol_t symbol,
+    uint32_t symbol_offset,
+    size_t length,
+    struct dpu_prepared_xfer_t **prepared_xfer)
+{
+    LOG_FN(VERBOSE,
+        "%s, 0x%08x, %d, %d, %zd",
+        dpu_transfer_to_string(xfer),
+        symbol.address,
+        symbol.size,
+        symbol_offset,
+        length);
+
+    dpu_error_t status = DPU_OK;
+    struct dpu_prepared_xfer_t *new_prepared_xfer;
+
+    if (dpu_set.kind != DPU_SET_RANKS) {
+        return DPU_ERR_INVALID_DPU_SET;
+    }
+
+    if ((xfer != DPU_XFER_TO_DPU) && (xfer != DPU_XFER_FROM_DPU)) {
+        return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
+
+    if ((symbol_offset + length) > symbol.size) {
+        return DPU_ERR_INVALID_SYMBOL_ACCESS;
+    }
+
+    if ((new_prepared_xfer = malloc(sizeof(*new_prepared_xfer))) == NULL) {
+        return DPU_ERR_SYSTEM;
+    }
+
+    new_prepared_xfer->set = dpu_set;
+    new_prepared_xfer->xfer = xfer;
+    new_prepared_xfer->address = symbol.address + symbol_offset;
+    new_prepared_xfer->length = length;
+
+    if ((new_prepared_xfer->rank_matrices = calloc(dpu_set.list.nr_ranks, sizeof(*new_prepared_xfer->rank_matrices)))
+        == NULL) {
+        free(new_prepared_xfer);
+        return DPU_ERR_SYSTEM;
+    }
+
+    for (uint32_t each_rank = 0; (each_rank < dpu_set.list.nr_ranks) && (status == DPU_OK); ++each_rank) {
+        struct dpu_rank_t *rank = dpu_set.list.ranks[each_rank];
+        struct dpu_transfer_mram **matrix = &new_prepared_xfer->rank_matrices[each_rank];
+
+        if ((status = dpu_transfer_matrix_allocate(rank, matrix)) != DPU_OK) {
+            break;
+        }
+
+        if ((status = dpu_prepare_address_matrix(rank, new_prepared_xfer->address, length, *matrix)) != DPU_OK) {
+            break;
+        }
+
+        status = dpu_transfer_matrix_register(rank, *matrix);
+    }
+
+    /* The buffers now belong to the prepared transfer, as after a push */
+    dpu_prepare_xfer(dpu_set, NULL);
+
+    if (status != DPU_OK) {
+        prepared_xfer_destroy(new_prepared_xfer);
+        return status;
+    }
+
+    *prepared_xfer = new_prepared_xfer;
+
+    return DPU_OK;
+}
+
+static dpu_error_t
+dispatch_prepared_xfer_rank(struct dpu_rank_t *rank, uint32_t rank_idx, void *args)
+{
+    struct dpu_prepared_xfer_t *prepared_xfer = args;
+
+    switch (prepared_xfer->xfer) {
+        case DPU_XFER_TO_DPU:
+            return dpu_copy_to_address_prepared(
+                rank, prepared_xfer->address, prepared_xfer->length, prepared_xfer->rank_matrices[rank_idx]);
+        case DPU_XFER_FROM_DPU:
+            return dpu_copy_from_address_prepared(
+                rank, prepared_xfer->address, prepared_xfer->length, prepared_xfer->rank_matrices[rank_idx]);
+        default:
+            return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_prepared_xfer_push(struct dpu_prepared_xfer_t *prepared_xfer)
+{
+    LOG_FN(VERBOSE, "%p", prepared_xfer);
+
+    return dpu_rank_dispatch(prepared_xfer->set.list.ranks,
+        prepared_xfer->set.list.nr_ranks,
+        dispatch_prepared_xfer_rank,
+        prepared_xfer,
+        DPU_DISPATCH_FIRST_ERROR);
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_prepared_xfer_free(struct dpu_prepared_xfer_t *prepared_xfer)
+{
+    LOG_FN(VERBOSE, "%p", prepared_xfer);
+
+    prepared_xfer_destroy(prepared_xfer);
+
+    return DPU_OK;
+}
+
+struct dpu_pipeline_t {
+    struct dpu_set_t set;
+    struct dpu_symbol_t slots;
+    struct dpu_symbol_t sequence;
+    uint32_t slot_size;
+    uint32_t nr_slots;
+
+    /* State of the current dpu_pipeline_run */
+    dpu_pipeline_callback_t fill;
+    dpu_pipeline_callback_t drain;
+    void *args;
+    uint32_t nr_batches;
+    uint32_t *rank_batches;
+    bool *rank_launch_pending;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t nr_running_ranks;
+    dpu_error_t status;
+};
+
+__API_SYMBOL__ dpu_error_t
+dpu_pipeline_create(struct dpu_set_t dpu_set,
+    const char *slots_symbol_name,
+    uint32_t slot_size,
+    uint32_t nr_slots,
+    const char *sequence_symbol_name,
+    struct dpu_pipeline_t **pipeline)
+{
+    LOG_FN(VERBOSE, "\"%s\", %d, %d, \"%s\"", slots_symbol_name, slot_size, nr_slots, sequence_symbol_name);
+
+    dpu_error_t status;
+    struct dpu_program_t *program;
+    struct dpu_pipeline_t *new_pipeline;
+
+    if (dpu_set.kind != DPU_SET_RANKS) {
+        return DPU_ERR_INVALID_DPU_SET;
+    }
+
+    if ((slot_size == 0) || (nr_slots == 0)) {
+        return DPU_ERR_INVALID_SYMBOL_ACCESS;
+    }
+
+    if ((new_pipeline = calloc(1, sizeof(*new_pipeline))) == NULL) {
+        return DPU_ERR_SYSTEM;
+    }
+
+    if ((status = dpu_get_common_program(&dpu_set, &program)) != DPU_OK) {
+        goto free_pipeline;
+    }
+    if ((status = dpu_get_symbol(program, slots_symbol_name, &new_pipeline->slots)) != DPU_OK) {
+        goto free_pipeline;
+    }
+    if ((status = dpu_get_symbol(program, sequence_symbol_name, &new_pipeline->sequence)) != DPU_OK) {
+        goto free_pipeline;
+    }
+
+    if (((uint64_t)slot_size * nr_slots > new_pipeline->slots.size) || (new_pipeline->sequence.size < sizeof(uint32_t))) {
+        status = DPU_ERR_INVALID_SYMBOL_ACCESS;
+        goto free_pipeline;
+    }
+
+    new_pipeline->rank_batches = malloc(dpu_set.list.nr_ranks * sizeof(*new_pipeline->rank_batches));
+    new_pipeline->rank_launch_pending = malloc(dpu_set.list.nr_ranks * sizeof(*new_pipeline->rank_launch_pending));
+    if ((new_pipeline->rank_batches == NULL) || (new_pipeline->rank_launch_pending == NULL)) {
+        status = DPU_ERR_SYSTEM;
+        goto free_pipeline;
+    }
+
+    if (pthread_mutex_init(&new_pipeline->mutex, NULL) != 0) {
+        status = DPU_ERR_SYSTEM;
+        goto free_pipeline;
+    }
+    if (pthread_cond_init(&new_pipeline->cond, NULL) != 0) {
+        pthread_mutex_destroy(&new_pipeline->mutex);
+        status = DPU_ERR_SYSTEM;
+        goto free_pipeline;
+    }
+
+    new_pipeline->set = dpu_set;
+    new_pipeline->slot_size = slot_size;
+    new_pipeline->nr_slots = nr_slots;
+    *pipeline = new_pipeline;
+
+    return DPU_OK;
+
+free_pipeline:
+    free(new_pipeline->rank_launch_pending);
+    free(new_pipeline->rank_batches);
+    free(new_pipeline);
+    return status;
+}
+
+static struct dpu_set_t
+pipeline_rank_set(struct dpu_pipeline_t *pipeline, uint32_t rank_index)
+{
+    struct dpu_set_t rank_set = pipeline->set;
+
+    rank_set.list.nr_ranks = 1;
+    rank_set.list.ranks = pipeline->set.list.ranks + rank_index;
+
+    return rank_set;
+}
+
+static void
+pipeline_rank_end(struct dpu_pipeline_t *pipeline, dpu_error_t status)
+{
+    pthread_mutex_lock(&pipeline->mutex);
+    if ((status != DPU_OK) && (pipeline->status == DPU_OK)) {
+        pipeline->status = status;
+    }
+    if (--pipeline->nr_running_ranks == 0) {
+        pthread_cond_broadcast(&pipeline->cond);
+    }
+    pthread_mutex_unlock(&pipeline->mutex);
+}
+
+static void
+pipeline_batch_done(struct dpu_set_t dpu_set, uint32_t rank_index, dpu_error_t status, void *args);
+
+/* Fills, pushes and launches the current batch of a rank; the rank is ended here on failure */
+static void
+pipeline_start_batch(struct dpu_pipeline_t *pipeline, uint32_t rank_index)
+{
+    dpu_error_t status;
+    struct dpu_set_t rank_set = pipeline_rank_set(pipeline, rank_index);
+    uint32_t sequence = pipeline->rank_batches[rank_index];
+    uint32_t slot_offset = (sequence % pipeline->nr_slots) * pipeline->slot_size;
+
+    if ((status = pipeline->fill(rank_set, rank_index, sequence, pipeline->args)) != DPU_OK) {
+        dpu_prepare_xfer(rank_set, NULL);
+        goto end;
+    }
+
+    if ((status = dpu_push_xfer_symbol(
+             rank_set, DPU_XFER_TO_DPU, pipeline->slots, slot_offset, pipeline->slot_size, DPU_XFER_DEFAULT))
+        != DPU_OK) {
+        dpu_prepare_xfer(rank_set, NULL);
+        goto end;
+    }
+
+    if ((status = dpu_copy_to_symbol(rank_set, pipeline->sequence, 0, &sequence, sizeof(sequence))) != DPU_OK) {
+        goto end;
+    }
+
+    /* A boot failure is reported to the completion callback, which ends the rank, before dpu_launch_async returns */
+    pipeline->rank_launch_pending[rank_index] = true;
+    if (((status = dpu_launch_async(rank_set, pipeline_batch_done, pipeline, DPU_COMPLETION_PER_RANK, NULL)) == DPU_OK)
+        || !pipeline->rank_launch_pending[rank_index]) {
+        return;
+    }
+    pipeline->rank_launch_pending[rank_index] = false;
+
+end:
+    pipeline_rank_end(pipeline, status);
+}
+
+static void
+pipeline_batch_done(struct dpu_set_t dpu_set, __attribute__((unused)) uint32_t index, dpu_error_t status, void *args)
+{
+    struct dpu_pipeline_t *pipeline = args;
+    uint32_t rank_index = (uint32_t)(dpu_set.list.ranks - pipeline->set.list.ranks);
+    uint32_t batch = pipeline->rank_batches[rank_index];
+    bool must_stop;
+
+    pipeline->rank_launch_pending[rank_index] = false;
+
+    /* A faulting batch is neither drained nor followed by another one: its status is returned by dpu_pipeline_run */
+    if (status != DPU_OK) {
+        pipeline_rank_end(pipeline, status);
+        return;
+    }
+
+    if ((pipeline->drain != NULL) && ((status = pipeline->drain(dpu_set, rank_index, batch, pipeline->args)) != DPU_OK)) {
+        pipeline_rank_end(pipeline, status);
+        return;
+    }
+
+    /* The other ranks stop at the end of their current batch once one of them failed */
+    pthread_mutex_lock(&pipeline->mutex);
+    must_stop = (pipeline->status != DPU_OK) || (batch + 1 == pipeline->nr_batches);
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    if (must_stop) {
+        pipeline_rank_end(pipeline, DPU_OK);
+        return;
+    }
+
+    pipeline->rank_batches[rank_index] = batch + 1;
+    pipeline_start_batch(pipeline, rank_index);
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_pipeline_run(struct dpu_pipeline_t *pipeline,
+    uint32_t nr_batches,
+    dpu_pipeline_callback_t fill,
+    dpu_pipeline_callback_t drain,
+    void *args)
+{
+    LOG_FN(VERBOSE, "%d", nr_batches);
+
+    uint32_t nr_ranks = pipeline->set.list.nr_ranks;
+    dpu_error_t status;
+
+    if (fill == NULL) {
+        return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
+
+    if (nr_batches == 0) {
+        return DPU_OK;
+    }
+
+    pipeline->fill = fill;
+    pipeline->drain = drain;
+    pipeline->args = args;
+    pipeline->nr_batches = nr_batches;
+    pipeline->nr_running_ranks = nr_ranks;
+    pipeline->status = DPU_OK;
+
+    for (uint32_t each_rank = 0; each_rank < nr_ranks; ++each_rank) {
+        pipeline->rank_batches[each_rank] = 0;
+        pipeline->rank_launch_pending[each_rank] = false;
+    }
+
+    /* The first batch of a rank is pushed while the ranks started before it are already running */
+    for (uint32_t each_rank = 0; each_rank < nr_ranks; ++each_rank) {
+        pipeline_start_batch(pipeline, each_rank);
+    }
+
+    pthread_mutex_lock(&pipeline->mutex);
+    while (pipeline->nr_running_ranks != 0) {
+        pthread_cond_wait(&pipeline->cond, &pipeline->mutex);
+    }
+    status = pipeline->status;
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    return status;
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_pipeline_free(struct dpu_pipeline_t *pipeline)
+{
+    LOG_FN(VERBOSE, "");
+
+    pthread_cond_destroy(&pipeline->cond);
+    pthread_mutex_destroy(&pipeline->mutex);
+    free(pipeline->rank_launch_pending);
+    free(pipeline->rank_batches);
+    free(pipeline);
+
+    return DPU_OK;
+}
+
 static dpu_error_t
 dpu_load_rank(struct dpu_rank_t *rank, struct dpu_program_t *program, dpu_elf_file_t elf_info)
 {
@@ -1039,7 +2047,7 @@ end:
 }
 
 static dpu_error_t
-dpu_boot_rank(struct dpu_rank_t *rank, dpu_launch_policy_t policy)
+dpu_boot_rank(struct dpu_rank_t *rank, dpu_launch_policy_t policy, struct dpu_future_t *future, uint32_t future_index)
 {
     LOG_RANK(VERBOSE, rank, "%s", dpu_launch_policy_to_string(policy));
 
@@ -1074,6 +2082,8 @@ dpu_boot_rank(struct dpu_rank_t *rank, dpu_launch_policy_t policy)
         goto free_bitfield;
     }
 
+    clock_gettime(CLOCK_MONOTONIC, &run_context->launch_time);
+
     dpu_unlock_rank(rank);
 
     switch (policy) {
@@ -1117,10 +2127,14 @@ dpu_boot_rank(struct dpu_rank_t *rank, dpu_launch_policy_t policy)
              */
             pthread_mutex_lock(&(run_context->poll_thread.thr_mutex));
             run_context->poll_thread.thr_has_work = 1;
+            run_context->poll_thread.thr_running = true;
+            run_context->poll_thread.future = future;
+            run_context->poll_thread.future_index = future_index;
             pthread_mutex_unlock(&(run_context->poll_thread.thr_mutex));
 
             // Not sure if the signal should be in mutex or not.
-            res = pthread_cond_signal(&run_context->poll_thread.thr_cond);
+            /* dpu_sync may wait on the condition too */
+            res = pthread_cond_broadcast(&run_context->poll_thread.thr_cond);
             if (res) {
                 status = DPU_ERR_SYSTEM;
             }
@@ -1143,7 +2157,7 @@ end:
 }
 
 static dpu_error_t
-dpu_boot_dpu(struct dpu_t *dpu, dpu_launch_policy_t policy)
+dpu_boot_dpu(struct dpu_t *dpu, dpu_launch_policy_t policy, struct dpu_future_t *future, uint32_t future_index)
 {
     LOG_DPU(VERBOSE, dpu, "%s", dpu_launch_policy_to_string(policy));
 
@@ -1178,6 +2192,8 @@ dpu_boot_dpu(struct dpu_t *dpu, dpu_launch_policy_t policy)
         goto end;
     }
 
+    clock_gettime(CLOCK_MONOTONIC, &run_context->launch_time);
+
     dpu_unlock_rank(rank);
 
     switch (policy) {
@@ -1222,10 +2238,14 @@ dpu_boot_dpu(struct dpu_t *dpu, dpu_launch_policy_t policy)
              */
             pthread_mutex_lock(&(poll_thread->thr_mutex));
             poll_thread->thr_has_work = 1;
+            poll_thread->thr_running = true;
+            poll_thread->future = future;
+            poll_thread->future_index = future_index;
             pthread_mutex_unlock(&(poll_thread->thr_mutex));
 
             // Not sure if the signal should be in mutex or not.
-            res = pthread_cond_signal(&poll_thread->thr_cond);
+            /* dpu_sync may wait on the condition too */
+            res = pthread_cond_broadcast(&poll_thread->thr_cond);
             if (res) {
                 /* signal failed, let the error path get rid of the thread created above. */
                 status = DPU_ERR_SYSTEM;
@@ -1308,6 +2328,8 @@ do_generic_run_all(struct dpu_rank_t *rank)
     bool must_stop = false;
     dpu_bitfield_t *dpu_is_running;
     dpu_bitfield_t *dpu_is_in_fault;
+    struct dpu_set_t rank_set = { .kind = DPU_SET_RANKS, .list = { .nr_ranks = 1, .ranks = &rank } };
+    struct sync_waiter waiter;
 
     if ((dpu_is_running = malloc(nr_of_control_interfaces * sizeof(*dpu_is_running))) == NULL) {
         return DPU_ERR_SYSTEM;
@@ -1318,6 +2340,8 @@ do_generic_run_all(struct dpu_rank_t *rank)
         return DPU_ERR_SYSTEM;
     }
 
+    sync_waiter_init(&waiter, &rank_set, description->configuration.sync_strategy);
+
     while (!must_stop) {
         dpu_lock_rank(rank);
 
@@ -1325,8 +2349,14 @@ do_generic_run_all(struct dpu_rank_t *rank)
         status = run_all_one_loop_iteration(rank, &must_stop, dpu_is_running, dpu_is_in_fault);
 
         dpu_unlock_rank(rank);
+
+        if (!must_stop) {
+            sync_waiter_wait(&waiter);
+        }
     }
 
+    sync_waiter_done(&waiter);
+
     if (status == DPU_OK) {
         bool dpu_fault = false;
         uint8_t nr_of_dpus_per_control_interface = description->topology.nr_of_dpus_per_control_interface;
@@ -1361,11 +2391,21 @@ do_simple_run_dpu(struct dpu_t *dpu)
 {
     dpu_error_t status = DPU_OK;
     bool must_stop = false;
+    struct dpu_set_t dpu_set = { .kind = DPU_SET_DPU, .dpu = dpu };
+    struct sync_waiter waiter;
+
+    sync_waiter_init(&waiter, &dpu_set, dpu_get_description(dpu_get_rank(dpu))->configuration.sync_strategy);
 
     while (!must_stop) {
         status = run_dpu_one_loop_iteration(dpu, &must_stop);
+
+        if (!must_stop) {
+            sync_waiter_wait(&waiter);
+        }
     }
 
+    sync_waiter_done(&waiter);
+
     return status;
 }
 
@@ -1412,23 +2452,38 @@ static void *
 do_run_all_thread(struct dpu_rank_t *rank)
 {
     dpu_run_context_t run_context = dpu_get_run_context(rank);
+    struct dpu_future_t *future;
+    uint32_t future_index;
+    dpu_error_t status;
 
     while (1) {
         pthread_mutex_lock(&(run_context->poll_thread.thr_mutex));
         while (!*((volatile int *)&(run_context->poll_thread.thr_has_work)))
             pthread_cond_wait(&(run_context->poll_thread.thr_cond), &(run_context->poll_thread.thr_mutex));
 
-        if (run_context->poll_thread.thr_has_work == -1)
-            goto end;
+        if (run_context->poll_thread.thr_has_work == -1) {
+            pthread_mutex_unlock(&(run_context->poll_thread.thr_mutex));
+            break;
+        }
 
         run_context->poll_thread.thr_has_work = 0;
+        future = run_context->poll_thread.future;
+        future_index = run_context->poll_thread.future_index;
+        run_context->poll_thread.future = NULL;
         pthread_mutex_unlock(&(run_context->poll_thread.thr_mutex));
 
-        if (do_run_all(rank) != DPU_OK)
-            goto end;
+        /* A fault only ends this run: the thread keeps serving the next launches until the rank is freed */
+        status = do_run_all(rank);
+
+        pthread_mutex_lock(&(run_context->poll_thread.thr_mutex));
+        run_context->poll_thread.thr_running = false;
+        pthread_cond_broadcast(&(run_context->poll_thread.thr_cond));
+        pthread_mutex_unlock(&(run_context->poll_thread.thr_mutex));
+
+        if (future != NULL)
+            dpu_future_complete(future, future_index, status);
     }
 
-end:
     return NULL;
 }
 
@@ -1436,23 +2491,37 @@ static void *
 do_run_dpu_thread(struct dpu_t *dpu)
 {
     struct dpu_poll_thread_context_t *poll_thread = &dpu->poll_thread;
+    struct dpu_future_t *future;
+    uint32_t future_index;
+    dpu_error_t status;
 
     while (1) {
         pthread_mutex_lock(&(poll_thread->thr_mutex));
         while (!*((volatile int *)&(poll_thread->thr_has_work)))
             pthread_cond_wait(&(poll_thread->thr_cond), &(poll_thread->thr_mutex));
 
-        if (poll_thread->thr_has_work == -1)
-            goto end;
+        if (poll_thread->thr_has_work == -1) {
+            pthread_mutex_unlock(&(poll_thread->thr_mutex));
+            break;
+        }
 
         poll_thread->thr_has_work = 0;
+        future = poll_thread->future;
+        future_index = poll_thread->future_index;
+        poll_thread->future = NULL;
         pthread_mutex_unlock(&(poll_thread->thr_mutex));
 
-        if (do_run_dpu(dpu) != DPU_OK)
-            goto end;
+        status = do_run_dpu(dpu);
+
+        pthread_mutex_lock(&(poll_thread->thr_mutex));
+        poll_thread->thr_running = false;
+        pthread_cond_broadcast(&(poll_thread->thr_cond));
+        pthread_mutex_unlock(&(poll_thread->thr_mutex));
+
+        if (future != NULL)
+            dpu_future_complete(future, future_index, status);
     }
 
-end:
     return NULL;
 }
 
@@ -1517,9 +2586,7 @@ dpu_copy_from_dpu(struct dpu_t *dpu, const char *symbol_name, uint32_t symbol_of
 
     dpu_lock_rank(rank);
 
-    if ((program = dpu_get_program(dpu)) == NULL) {
-        goto unlock_rank;
-    }
+    program = dpu_get_program(dpu);
 
     if ((status = dpu_get_symbol(program, symbol_name, &symbol)) != DPU_OK) {
         goto unlock_rank;
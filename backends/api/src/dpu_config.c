@@ -271,6 +271,8 @@ dpu_reset_rank(struct dpu_rank_t *rank)
 
     FF(dpu_custom_for_rank(rank, DPU_COMMAND_EVENT_START, (dpu_custom_command_args_t)DPU_EVENT_RESET));
 
+    FF(ufi_begin_plan(rank));
+
     FF(dpu_byte_order(rank));
     FF(dpu_soft_reset(rank, DPU_CLOCK_DIV8));
     FF(dpu_bit_config(rank, bit_config));
@@ -302,10 +304,16 @@ dpu_reset_rank(struct dpu_rank_t *rank)
     FF(dpu_init_mram_mux(rank));
     FF(dpu_init_groups(rank, all_dpus_are_enabled_save, enabled_dpus_save));
 
+    FF(ufi_end_plan(rank));
+
     FF(dpu_custom_for_rank(rank, DPU_COMMAND_ALL_SOFT_RESET, NULL));
     FF(dpu_custom_for_rank(rank, DPU_COMMAND_EVENT_END, (dpu_custom_command_args_t)DPU_EVENT_RESET));
 
 end:
+    /* Still open when a step failed: the commands planned before it are dropped */
+    if (status != DPU_OK) {
+        ufi_abort_plan(rank);
+    }
     dpu_unlock_rank(rank);
     return status;
 }
@@ -118,6 +118,14 @@ read_and_validate_header(elf_fd info)
         return false;
     }
 
+    /* libelf loads the program header table lazily: do it now, so that
+     * dpu_elf_load can run concurrently on several ranks with the same file.
+     */
+    if ((info->phnum != 0) && (elf32_getphdr(info->elf) == NULL)) {
+        report_error("file '%s' is corrupted: no program header table\n", path);
+        return false;
+    }
+
     report("shnum    = %d\n", (int)(info->shnum));
     report("shstrndx = %d\n", (int)(info->shstrndx));
     report("phnum    = %d\n", (int)(info->phnum));
@@ -176,10 +184,38 @@ read_symbol_value(GElf_Sym symbol, uint32_t *value, uint32_t *size)
     return DPU_OK;
 }
 
+/* Section of a symbol in the symbol maps: SHN_ABS is stored after the regular sections, returns false for the
+ * symbols which are not recorded. */
+static bool
+get_symbol_map_index(elf_fd info, char **section_names, GElf_Sym *symbol, unsigned int *section_index)
+{
+    unsigned int index = (unsigned int)symbol->st_shndx;
+    char *section_name;
+
+    if (index == SHN_ABS) {
+        index = info->shnum;
+        section_name = "ABS";
+    } else if (index >= info->shnum) {
+        return false;
+    } else {
+        section_name = section_names[index];
+    }
+
+    char *symbol_name = elf_strptr(info->elf, (size_t)info->strtab_index, symbol->st_name);
+
+    // May have irrelevant information... No need to record.
+    if ((symbol_name == NULL) || (section_name == NULL) || (symbol_name[0] == '\0') || (section_name[0] == '\0'))
+        return false;
+
+    *section_index = index;
+    return true;
+}
+
 static dpu_error_t
 setup_symbols_map(elf_fd info)
 {
     dpu_error_t err = DPU_OK;
+    char **section_names;
 
     Elf_Scn *symtab_scn = elf_getscn(info->elf, info->symtab_index);
     Elf_Data *sym_data;
@@ -195,61 +231,73 @@ setup_symbols_map(elf_fd info)
         goto end;
     }
 
+    /* Section names are resolved once, instead of once per symbol */
+    if ((section_names = (char **)calloc(info->shnum, sizeof(char *))) == NULL) {
+        report_error("could not allocate more memory!\n");
+        err = DPU_ERR_SYSTEM;
+        goto end;
+    }
+
     unsigned int each_section;
     for (each_section = 0; each_section < info->shnum; each_section++) {
-        info->symbol_maps[each_section].nr_symbols = 0;
-        info->symbol_maps[each_section].map = NULL;
+        err = get_section_name(info, elf_getscn(info->elf, each_section), &section_names[each_section]);
+        if (err != DPU_OK) {
+            goto free_section_names;
+        }
     }
 
     unsigned int each_symbol;
+    unsigned int section_index;
     GElf_Sym current_symbol;
 
+    /* First pass: count the symbols of each section, so that each map is allocated once */
     for (each_symbol = 0; gelf_getsym(sym_data, each_symbol, &current_symbol) == &current_symbol; each_symbol++) {
-        unsigned int section_index = (unsigned int)current_symbol.st_shndx;
-        Elf_Scn *section_scn = elf_getscn(info->elf, section_index);
-        char *section_name = NULL;
-        if (section_index == SHN_ABS) {
-            section_index = info->shnum;
-            section_name = "ABS";
-        } else if (section_index >= info->shnum) {
+        if (get_symbol_map_index(info, section_names, &current_symbol, &section_index)) {
+            info->symbol_maps[section_index].nr_symbols++;
+        }
+    }
+
+    for (each_section = 0; each_section < info->shnum + 1; each_section++) {
+        dpu_elf_symbols_t *map = &(info->symbol_maps[each_section]);
+
+        if (map->nr_symbols == 0) {
             continue;
-        } else {
-            err = get_section_name(info, section_scn, &section_name);
-            if (err != DPU_OK) {
-                return err;
-            }
         }
-        char *symbol_name = elf_strptr(info->elf, (size_t)info->strtab_index, current_symbol.st_name);
 
-        // May have irrelevant information... No need to record.
-        if ((symbol_name == NULL) || (section_name == NULL) || (strlen(symbol_name) == 0) || (strlen(section_name) == 0))
+        map->map = (dpu_elf_symbol_t *)malloc(map->nr_symbols * sizeof(dpu_elf_symbol_t));
+        if (map->map == NULL) {
+            report_error("could not allocate more memory!\n");
+            err = DPU_ERR_SYSTEM;
+            goto free_section_names;
+        }
+        map->nr_symbols = 0;
+    }
+
+    /* Second pass: fill the maps */
+    for (each_symbol = 0; gelf_getsym(sym_data, each_symbol, &current_symbol) == &current_symbol; each_symbol++) {
+        if (!get_symbol_map_index(info, section_names, &current_symbol, &section_index)) {
             continue;
+        }
+
+        char *symbol_name = elf_strptr(info->elf, (size_t)info->strtab_index, current_symbol.st_name);
 
-        report("symbol #%u in section #%u - symbol name='%s' - section name='%s'\n",
-            each_symbol,
-            section_index,
-            symbol_name,
-            section_name);
+        report("symbol #%u in section #%u - symbol name='%s'\n", each_symbol, section_index, symbol_name);
         uint32_t symbol_value, symbol_size;
 
         err = read_symbol_value(current_symbol, &symbol_value, &symbol_size);
         if (err != DPU_OK) {
-            return err;
+            goto free_section_names;
         }
 
         dpu_elf_symbols_t *map = &(info->symbol_maps[section_index]);
+        map->map[map->nr_symbols].name = symbol_name;
+        map->map[map->nr_symbols].size = symbol_size;
+        map->map[map->nr_symbols].value = symbol_value;
         map->nr_symbols++;
-        map->map = (dpu_elf_symbol_t *)realloc(map->map, map->nr_symbols * sizeof(dpu_elf_symbol_t));
-        if (map->map == NULL) {
-            report_error("could not allocate more memory!\n");
-            err = DPU_ERR_SYSTEM;
-            goto end;
-        }
-        map->map[map->nr_symbols - 1].name = symbol_name;
-        map->map[map->nr_symbols - 1].size = symbol_size;
-        map->map[map->nr_symbols - 1].value = symbol_value;
     }
 
+free_section_names:
+    free(section_names);
 end:
     return err;
 }
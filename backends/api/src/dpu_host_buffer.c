@@ -0,0 +1,295 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#define _GNU_SOURCE
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <dpu.h>
+
+#include <dpu_attributes.h>
+#include <dpu_management.h>
+#include <dpu_rank.h>
+#include <dpu_api_log.h>
+#include <dpu_internals.h>
+
+#define HUGE_PAGE_2MB_SHIFT 21
+#define HUGE_PAGE_1GB_SHIFT 30
+
+/* Registration of a host buffer on one of its ranks, listed on the rank */
+struct dpu_rank_host_buffer {
+    struct dpu_host_buffer *host_buffer;
+    /* NULL once the rank is freed: the set given to dpu_host_buffer_alloc may be freed before the buffer */
+    struct dpu_rank_t *rank;
+    struct dpu_rank_host_buffer *next;
+};
+
+struct dpu_host_buffer {
+    void *buffer;
+    size_t mapped_size;
+    struct dpu_rank_host_buffer *registrations;
+    uint32_t nr_ranks;
+    struct dpu_host_buffer *next;
+};
+
+/* Protects the host buffers and the host buffers of the ranks */
+static pthread_mutex_t host_buffers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct dpu_host_buffer *host_buffers;
+
+static void *
+map_host_buffer(size_t size, size_t *mapped_size, size_t *page_size)
+{
+    static const unsigned int huge_page_shifts[] = { HUGE_PAGE_1GB_SHIFT, HUGE_PAGE_2MB_SHIFT };
+    void *buffer;
+
+    for (unsigned int each_shift = 0; each_shift < sizeof(huge_page_shifts) / sizeof(huge_page_shifts[0]); ++each_shift) {
+        size_t huge_page_size = ((size_t)1) << huge_page_shifts[each_shift];
+
+        /* Do not waste most of a 1GB page on a small buffer */
+        if ((huge_page_shifts[each_shift] == HUGE_PAGE_1GB_SHIFT) && (size < huge_page_size / 2)) {
+            continue;
+        }
+
+        *mapped_size = (size + huge_page_size - 1) & ~(huge_page_size - 1);
+        buffer = mmap(NULL,
+            *mapped_size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (huge_page_shifts[each_shift] << MAP_HUGE_SHIFT),
+            -1,
+            0);
+        if (buffer != MAP_FAILED) {
+            *page_size = huge_page_size;
+            return buffer;
+        }
+    }
+
+    /* No huge page reserved for this size: fall back to transparent huge pages, when enabled */
+    *page_size = (size_t)sysconf(_SC_PAGESIZE);
+    *mapped_size = (size + *page_size - 1) & ~(*page_size - 1);
+    buffer = mmap(NULL, *mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED) {
+        return NULL;
+    }
+    madvise(buffer, *mapped_size, MADV_HUGEPAGE);
+
+    return buffer;
+}
+
+static int
+get_set_numa_node(struct dpu_set_t dpu_set)
+{
+    for (uint32_t each_rank = 0; each_rank < dpu_set.list.nr_ranks; ++each_rank) {
+        if (dpu_set.list.ranks[each_rank]->numa_node >= 0) {
+            return dpu_set.list.ranks[each_rank]->numa_node;
+        }
+    }
+
+    return -1;
+}
+
+static void
+fault_in_host_buffer(void *buffer, size_t mapped_size, size_t page_size)
+{
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(buffer, mapped_size, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+
+    /* Kernels before 5.14 */
+    for (size_t offset = 0; offset < mapped_size; offset += page_size) {
+        ((volatile uint8_t *)buffer)[offset] = 0;
+    }
+}
+
+static void
+unregister_host_buffer(struct dpu_rank_t *rank, void *buffer)
+{
+    dpu_rank_handler_t handler = rank->handler_context->handler;
+
+    if (handler->unregister_host_buffer != NULL) {
+        dpu_lock_rank(rank);
+        handler->unregister_host_buffer(rank, buffer);
+        dpu_unlock_rank(rank);
+    }
+}
+
+void
+dpu_host_buffer_release_rank(struct dpu_rank_t *rank)
+{
+    pthread_mutex_lock(&host_buffers_mutex);
+    for (struct dpu_rank_host_buffer *registration = rank->host_buffers; registration != NULL;
+         registration = registration->next) {
+        unregister_host_buffer(rank, registration->host_buffer->buffer);
+        registration->rank = NULL;
+    }
+    rank->host_buffers = NULL;
+    pthread_mutex_unlock(&host_buffers_mutex);
+}
+
+/* Must be called with the host buffers locked */
+static void
+remove_rank_host_buffer(struct dpu_rank_host_buffer *registration)
+{
+    struct dpu_rank_host_buffer **each_registration = &registration->rank->host_buffers;
+
+    while (*each_registration != registration) {
+        each_registration = &(*each_registration)->next;
+    }
+    *each_registration = registration->next;
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_host_buffer_alloc(struct dpu_set_t dpu_set, size_t size_per_dpu, void **buffer)
+{
+    LOG_FN(VERBOSE, "%zd", size_per_dpu);
+
+    dpu_error_t status;
+    struct dpu_host_buffer *host_buffer;
+    size_t page_size;
+    uint32_t nr_dpus, each_rank;
+    int numa_node;
+
+    if (dpu_set.kind != DPU_SET_RANKS) {
+        return DPU_ERR_INVALID_DPU_SET;
+    }
+
+    if ((status = dpu_get_nr_dpus(dpu_set, &nr_dpus)) != DPU_OK) {
+        return status;
+    }
+
+    if ((size_per_dpu == 0) || (nr_dpus == 0)) {
+        return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
+
+    if ((host_buffer = malloc(sizeof(*host_buffer))) == NULL) {
+        return DPU_ERR_SYSTEM;
+    }
+
+    host_buffer->nr_ranks = dpu_set.list.nr_ranks;
+    if ((host_buffer->registrations = calloc(host_buffer->nr_ranks, sizeof(*host_buffer->registrations))) == NULL) {
+        status = DPU_ERR_SYSTEM;
+        goto free_host_buffer;
+    }
+
+    host_buffer->buffer = map_host_buffer(nr_dpus * DPU_HOST_BUFFER_STRIDE(size_per_dpu), &host_buffer->mapped_size, &page_size);
+    if (host_buffer->buffer == NULL) {
+        status = DPU_ERR_SYSTEM;
+        goto free_registrations;
+    }
+
+    /* Must be done before the pages are faulted in */
+    if ((numa_node = get_set_numa_node(dpu_set)) >= 0) {
+        unsigned long nodemask[(numa_node / (8 * sizeof(unsigned long))) + 1];
+
+        memset(nodemask, 0, sizeof(nodemask));
+        nodemask[numa_node / (8 * sizeof(unsigned long))] = 1UL << (numa_node % (8 * sizeof(unsigned long)));
+        /* The kernel ignores the last bit of the mask */
+        if (syscall(SYS_mbind, host_buffer->buffer, host_buffer->mapped_size, MPOL_PREFERRED, nodemask, numa_node + 2, 0) != 0) {
+            LOG_FN(DEBUG, "cannot allocate the host buffer on NUMA node %d", numa_node);
+        }
+    }
+
+    fault_in_host_buffer(host_buffer->buffer, host_buffer->mapped_size, page_size);
+
+    /* Huge pages are never swapped out, but transparent huge pages can be split and reclaimed */
+    if (mlock(host_buffer->buffer, host_buffer->mapped_size) != 0) {
+        LOG_FN(DEBUG, "cannot lock the host buffer in memory (RLIMIT_MEMLOCK)");
+    }
+
+    LOG_FN(DEBUG, "%zd bytes mapped with %zd-byte pages on NUMA node %d", host_buffer->mapped_size, page_size, numa_node);
+
+    for (each_rank = 0; each_rank < dpu_set.list.nr_ranks; ++each_rank) {
+        struct dpu_rank_t *rank = dpu_set.list.ranks[each_rank];
+        dpu_rank_handler_t handler = rank->handler_context->handler;
+        dpu_rank_status_e rank_status = DPU_RANK_SUCCESS;
+
+        if (handler->register_host_buffer == NULL) {
+            continue;
+        }
+
+        dpu_lock_rank(rank);
+        rank_status = handler->register_host_buffer(rank, host_buffer->buffer, host_buffer->mapped_size);
+        dpu_unlock_rank(rank);
+
+        if (rank_status != DPU_RANK_SUCCESS) {
+            status = DPU_ERR_DRIVER;
+            goto unregister_host_buffer;
+        }
+    }
+
+    pthread_mutex_lock(&host_buffers_mutex);
+    for (each_rank = 0; each_rank < dpu_set.list.nr_ranks; ++each_rank) {
+        struct dpu_rank_host_buffer *registration = &host_buffer->registrations[each_rank];
+
+        registration->host_buffer = host_buffer;
+        registration->rank = dpu_set.list.ranks[each_rank];
+        registration->next = registration->rank->host_buffers;
+        registration->rank->host_buffers = registration;
+    }
+    host_buffer->next = host_buffers;
+    host_buffers = host_buffer;
+    pthread_mutex_unlock(&host_buffers_mutex);
+
+    *buffer = host_buffer->buffer;
+
+    return DPU_OK;
+
+unregister_host_buffer:
+    for (uint32_t each_registered_rank = 0; each_registered_rank < each_rank; ++each_registered_rank) {
+        unregister_host_buffer(dpu_set.list.ranks[each_registered_rank], host_buffer->buffer);
+    }
+    munmap(host_buffer->buffer, host_buffer->mapped_size);
+free_registrations:
+    free(host_buffer->registrations);
+free_host_buffer:
+    free(host_buffer);
+    return status;
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_host_buffer_free(void *buffer)
+{
+    LOG_FN(VERBOSE, "%p", buffer);
+
+    struct dpu_host_buffer **each_host_buffer, *host_buffer = NULL;
+
+    pthread_mutex_lock(&host_buffers_mutex);
+    for (each_host_buffer = &host_buffers; *each_host_buffer != NULL; each_host_buffer = &(*each_host_buffer)->next) {
+        if ((*each_host_buffer)->buffer == buffer) {
+            host_buffer = *each_host_buffer;
+            *each_host_buffer = host_buffer->next;
+            break;
+        }
+    }
+
+    /* The ranks already freed have unregistered the buffer: only the host memory is left to release for them */
+    if (host_buffer != NULL) {
+        for (uint32_t each_rank = 0; each_rank < host_buffer->nr_ranks; ++each_rank) {
+            struct dpu_rank_host_buffer *registration = &host_buffer->registrations[each_rank];
+
+            if (registration->rank != NULL) {
+                unregister_host_buffer(registration->rank, host_buffer->buffer);
+                remove_rank_host_buffer(registration);
+            }
+        }
+    }
+    pthread_mutex_unlock(&host_buffers_mutex);
+
+    if (host_buffer == NULL) {
+        return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
+
+    munmap(host_buffer->buffer, host_buffer->mapped_size);
+    free(host_buffer->registrations);
+    free(host_buffer);
+
+    return DPU_OK;
+}
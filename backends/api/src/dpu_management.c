@@ -16,6 +16,7 @@
 #include <dpu_api_log.h>
 #include <dpu_properties_loader.h>
 #include <dpu_internals.h>
+#include <dpu_rank_dispatch.h>
 
 #define API_DEFAULT_BACKEND HW
 
@@ -62,6 +63,22 @@ dpu_get_description(struct dpu_rank_t *rank)
     return rank->description;
 }
 
+__API_SYMBOL__ void
+dpu_get_ci_command_stats(struct dpu_rank_t *rank, struct dpu_ci_command_stats *stats)
+{
+    dpu_lock_rank(rank);
+    *stats = rank->runtime.control_interface.command_stats;
+    dpu_unlock_rank(rank);
+}
+
+__API_SYMBOL__ void
+dpu_reset_ci_command_stats(struct dpu_rank_t *rank)
+{
+    dpu_lock_rank(rank);
+    memset(&rank->runtime.control_interface.command_stats, 0, sizeof(rank->runtime.control_interface.command_stats));
+    dpu_unlock_rank(rank);
+}
+
 __API_SYMBOL__ dpu_id_t
 dpu_get_id(struct dpu_t *dpu)
 {
@@ -152,6 +169,43 @@ end:
     return status;
 }
 
+#define SYNC_MAX_SLEEP_IN_US_DEFAULT 100
+
+static dpu_error_t
+dpu_get_sync_properties(struct dpu_rank_t *dpu_rank, dpu_properties_t properties)
+{
+    char *sync_strategy;
+    uint32_t sync_max_sleep;
+    dpu_error_t status = DPU_OK;
+
+    if (!fetch_integer_property(properties, DPU_PROFILE_PROPERTY_SYNC_MAX_SLEEP, &sync_max_sleep, SYNC_MAX_SLEEP_IN_US_DEFAULT))
+        return DPU_ERR_INTERNAL;
+
+    dpu_rank->description->configuration.sync_max_sleep_in_us = sync_max_sleep;
+
+    if (!fetch_string_property(properties, DPU_PROFILE_PROPERTY_SYNC_STRATEGY, &sync_strategy, "spin"))
+        return DPU_ERR_INTERNAL;
+
+    if (!strcmp(sync_strategy, "spin")) {
+        dpu_rank->description->configuration.sync_strategy = DPU_SYNC_SPIN;
+    } else if (!strcmp(sync_strategy, "yield")) {
+        dpu_rank->description->configuration.sync_strategy = DPU_SYNC_SPIN_YIELD;
+    } else if (!strcmp(sync_strategy, "backoff")) {
+        dpu_rank->description->configuration.sync_strategy = DPU_SYNC_BACKOFF;
+    } else if (!strcmp(sync_strategy, "adaptive")) {
+        dpu_rank->description->configuration.sync_strategy = DPU_SYNC_ADAPTIVE;
+    } else {
+        LOG_RANK(WARNING, dpu_rank, "Sync strategy %s is unknown", sync_strategy);
+        status = DPU_ERR_INVALID_PROFILE;
+    }
+
+    free(sync_strategy);
+
+    return status;
+}
+
+#define PROFILING_POLL_PERIOD_DEFAULT 8
+
 static dpu_error_t
 dpu_get_profiling_properties(struct dpu_rank_t *dpu_rank, dpu_properties_t properties)
 {
@@ -239,6 +293,17 @@ dpu_get_profiling_properties(struct dpu_rank_t *dpu_rank, dpu_properties_t prope
             free(thread_profiling_address);
         } else
             dpu_rank->profiling_context.thread_profiling_address = 0;
+
+        if (!fetch_integer_property(properties,
+                DPU_PROFILE_PROPERTY_PROFILING_POLL_PERIOD,
+                &dpu_rank->profiling_context.poll_period,
+                PROFILING_POLL_PERIOD_DEFAULT))
+            return DPU_ERR_INTERNAL;
+
+        if (dpu_rank->profiling_context.poll_period == 0) {
+            LOG_RANK(WARNING, dpu_rank, "Profiling poll period must not be 0");
+            return DPU_ERR_INTERNAL;
+        }
     }
 
     return DPU_OK;
@@ -252,7 +317,7 @@ dpu_get_rank_of_type(const char *profile, struct dpu_rank_t **rank)
     dpu_error_t status;
     struct dpu_rank_t *dpu_rank;
     dpu_properties_t properties;
-    bool disable_mux_switch, disable_reset_on_alloc;
+    bool disable_mux_switch, disable_reset_on_alloc, parallel_dispatch, confirm_ci_results, ufi_planner;
     uint64_t debug_cmds_buffer_size;
 
     properties = dpu_properties_load_from_profile(profile);
@@ -267,6 +332,8 @@ dpu_get_rank_of_type(const char *profile, struct dpu_rank_t **rank)
         goto delete_properties;
     }
 
+    dpu_rank->numa_node = -1;
+
     if ((status = determine_backend_type_from_complete_profile(properties, &dpu_rank->type)) != DPU_OK) {
         goto free_link;
     }
@@ -304,6 +371,32 @@ dpu_get_rank_of_type(const char *profile, struct dpu_rank_t **rank)
     }
     dpu_rank->description->configuration.disable_reset_on_alloc = disable_reset_on_alloc;
 
+    /* Parallel rank-set operations */
+    if (!fetch_boolean_property(properties, DPU_PROFILE_PROPERTY_PARALLEL_DISPATCH, &parallel_dispatch, false)) {
+        status = DPU_ERR_INTERNAL;
+        goto free_dpus;
+    }
+    dpu_rank->description->configuration.enable_parallel_dispatch = parallel_dispatch;
+
+    /* Confirming read of the control interface results */
+    if (!fetch_boolean_property(properties, DPU_PROFILE_PROPERTY_CONFIRM_CI_RESULTS, &confirm_ci_results, false)) {
+        status = DPU_ERR_INTERNAL;
+        goto free_dpus;
+    }
+    dpu_rank->description->configuration.confirm_ci_results = confirm_ci_results;
+
+    /* UFI command planner */
+    if (!fetch_boolean_property(properties, DPU_PROFILE_PROPERTY_UFI_PLANNER, &ufi_planner, false)) {
+        status = DPU_ERR_INTERNAL;
+        goto free_dpus;
+    }
+    dpu_rank->description->configuration.enable_ufi_planner = ufi_planner;
+
+    /* dpu_sync strategy */
+    status = dpu_get_sync_properties(dpu_rank, properties);
+    if (status != DPU_OK)
+        goto free_dpus;
+
     /* Debug commands buffer */
 #define DEBUG_CMDS_BUFFER_SIZE_DEFAULT 1000
     if (!fetch_long_property(
@@ -365,13 +458,16 @@ dpu_free_rank(struct dpu_rank_t *rank)
 
     uint8_t nr_threads = rank->description->dpu.nr_of_threads;
 
+    dpu_rank_dispatch_stop(rank);
+    dpu_host_buffer_release_rank(rank);
+
     if (rank->runtime.run_context.poll_thread.thr_exists) {
         pthread_mutex_lock(&(rank->runtime.run_context.poll_thread.thr_mutex));
         rank->runtime.run_context.poll_thread.thr_has_work = -1;
         pthread_mutex_unlock(&(rank->runtime.run_context.poll_thread.thr_mutex));
 
         /* Ok if we can't signal a thread, let's go on anyway... */
-        pthread_cond_signal(&(rank->runtime.run_context.poll_thread.thr_cond));
+        pthread_cond_broadcast(&(rank->runtime.run_context.poll_thread.thr_cond));
         pthread_join(rank->runtime.run_context.poll_thread.thr_id, NULL);
     }
 
@@ -384,7 +480,7 @@ dpu_free_rank(struct dpu_rank_t *rank)
             pthread_mutex_unlock(&(dpu->poll_thread.thr_mutex));
 
             /* Ok if we can't signal a thread, let's go on anyway... */
-            pthread_cond_signal(&(dpu->poll_thread.thr_cond));
+            pthread_cond_broadcast(&(dpu->poll_thread.thr_cond));
             pthread_join(dpu->poll_thread.thr_id, NULL);
         }
 
@@ -52,6 +52,8 @@ static dpu_error_t
 host_get_access_for_transfer_matrix(struct dpu_rank_t *rank, const struct dpu_transfer_mram *transfer_matrix);
 static dpu_error_t
 host_release_access_for_transfer_matrix(struct dpu_rank_t *rank, const struct dpu_transfer_mram *transfer_matrix);
+static inline uint32_t
+_transfer_matrix_index(struct dpu_t *dpu);
 
 dpu_error_t __API_SYMBOL__
 dpu_copy_to_symbol_dpu(struct dpu_t *dpu, struct dpu_symbol_t symbol, uint32_t symbol_offset, const void *src, size_t length)
@@ -483,6 +485,249 @@ dpu_copy_from_address_matrix(struct dpu_rank_t *rank, dpu_mem_max_addr_t address
     return DPU_OK;
 }
 
+dpu_error_t __API_SYMBOL__
+dpu_prepare_address_matrix(struct dpu_rank_t *rank,
+    dpu_mem_max_addr_t address,
+    dpu_mem_max_size_t length,
+    struct dpu_transfer_mram *transfer_matrix)
+{
+    dpu_error_t status;
+    uint8_t nr_cis = rank->description->topology.nr_of_control_interfaces;
+    uint8_t nr_dpus_per_ci = rank->description->topology.nr_of_dpus_per_control_interface;
+    bool is_iram = (address & IRAM_MASK) == IRAM_MASK;
+    bool is_mram = !is_iram && ((address & MRAM_MASK) == MRAM_MASK);
+    uint32_t align_mask = is_iram ? IRAM_ALIGN_MASK : WRAM_ALIGN_MASK;
+
+    if (!is_mram && (((address & ~align_mask) != 0) || ((length & ~align_mask) != 0))) {
+        return is_iram ? DPU_ERR_INVALID_IRAM_ACCESS : DPU_ERR_INVALID_WRAM_ACCESS;
+    }
+
+    for (uint8_t each_ci = 0; each_ci < nr_cis; ++each_ci) {
+        for (uint8_t each_dpu = 0; each_dpu < nr_dpus_per_ci; ++each_dpu) {
+            struct dpu_t *dpu = DPU_GET_UNSAFE(rank, each_ci, each_dpu);
+
+            if (!dpu_is_enabled(dpu)) {
+                continue;
+            }
+
+            void *buffer = dpu->transfer_buffer;
+
+            if (buffer == NULL) {
+                continue;
+            }
+
+            if (!is_mram && ((((uintptr_t)buffer) & ~align_mask) != 0)) {
+                return is_iram ? DPU_ERR_INVALID_IRAM_ACCESS : DPU_ERR_INVALID_WRAM_ACCESS;
+            }
+
+            /* IRAM and WRAM transfers only use the buffer and the size of the entries */
+            if ((status = dpu_transfer_matrix_add_dpu(
+                     dpu, transfer_matrix, buffer, length, is_mram ? address & ~MRAM_MASK : 0, DPU_PRIMARY_MRAM))
+                != DPU_OK) {
+                return status;
+            }
+        }
+    }
+
+    return DPU_OK;
+}
+
+/* IRAM or WRAM transfer of the buffers of a matrix, whose MRAM offsets are ignored: the DPUs with the same member id are
+ * selected together on all the CIs, and served by one rank-wide read or write.
+ */
+static dpu_error_t
+copy_wram_iram_matrix(struct dpu_rank_t *rank,
+    dpu_transfer_type_t type,
+    dpu_mem_max_addr_t address,
+    dpu_mem_max_size_t length,
+    struct dpu_transfer_mram *transfer_matrix)
+{
+    dpu_error_t status = DPU_OK;
+    uint8_t nr_cis = rank->description->topology.nr_of_control_interfaces;
+    uint8_t nr_dpus_per_ci = rank->description->topology.nr_of_dpus_per_control_interface;
+    bool is_iram = (address & IRAM_MASK) == IRAM_MASK;
+    iram_addr_t iram_address = (address & ~IRAM_MASK) >> IRAM_ALIGN;
+    iram_size_t nb_of_instructions = length >> IRAM_ALIGN;
+    wram_addr_t wram_address = address >> WRAM_ALIGN;
+    wram_size_t nb_of_words = length >> WRAM_ALIGN;
+
+    if (is_iram) {
+        verify_iram_access(iram_address, nb_of_instructions, rank);
+    } else {
+        verify_wram_access(wram_address, nb_of_words, rank);
+    }
+
+    dpu_lock_rank(rank);
+
+    for (dpu_member_id_t each_dpu = 0; each_dpu < nr_dpus_per_ci; ++each_dpu) {
+        void *buffers[DPU_MAX_NR_CIS];
+        uint8_t mask = 0;
+
+        for (dpu_slice_id_t each_ci = 0; each_ci < nr_cis; ++each_ci) {
+            struct dpu_t *dpu = DPU_GET_UNSAFE(rank, each_ci, each_dpu);
+            void *buffer = transfer_matrix[_transfer_matrix_index(dpu)].ptr;
+
+            if (dpu_is_enabled(dpu) && (buffer != NULL)) {
+                buffers[each_ci] = buffer;
+                mask |= CI_MASK_ONE(each_ci);
+            }
+        }
+
+        if (mask == 0) {
+            continue;
+        }
+
+        FF(ufi_select_dpu(rank, &mask, each_dpu));
+
+        if (is_iram) {
+            dpuinstruction_t **iram_array = (dpuinstruction_t **)buffers;
+
+            FF((type == DPU_TRANSFER_TO_MRAM) ? ufi_iram_write(rank, mask, iram_array, iram_address, nb_of_instructions)
+                                              : ufi_iram_read(rank, mask, iram_array, iram_address, nb_of_instructions));
+        } else {
+            dpuword_t **wram_array = (dpuword_t **)buffers;
+
+            FF((type == DPU_TRANSFER_TO_MRAM) ? ufi_wram_write(rank, mask, wram_array, wram_address, nb_of_words)
+                                              : ufi_wram_read(rank, mask, wram_array, wram_address, nb_of_words));
+        }
+    }
+
+end:
+    dpu_unlock_rank(rank);
+    return status;
+}
+
+static dpu_error_t
+copy_address_prepared(struct dpu_rank_t *rank,
+    dpu_transfer_type_t type,
+    dpu_mem_max_addr_t address,
+    dpu_mem_max_size_t length,
+    struct dpu_transfer_mram *transfer_matrix)
+{
+    if ((address & IRAM_MASK) != IRAM_MASK && (address & MRAM_MASK) == MRAM_MASK) {
+        return (type == DPU_TRANSFER_TO_MRAM) ? dpu_copy_to_mrams(rank, transfer_matrix)
+                                              : dpu_copy_from_mrams(rank, transfer_matrix);
+    }
+
+    return copy_wram_iram_matrix(rank, type, address, length, transfer_matrix);
+}
+
+
+dpu_error_t __API_SYMBOL__
+dpu_copy_to_address_prepared(struct dpu_rank_t *rank,
+    dpu_mem_max_addr_t address,
+    dpu_mem_max_size_t length,
+    struct dpu_transfer_mram *transfer_matrix)
+{
+    return copy_address_prepared(rank, DPU_TRANSFER_TO_MRAM, address, length, transfer_matrix);
+}
+
+dpu_error_t __API_SYMBOL__
+dpu_copy_from_address_prepared(struct dpu_rank_t *rank,
+    dpu_mem_max_addr_t address,
+    dpu_mem_max_size_t length,
+    struct dpu_transfer_mram *transfer_matrix)
+{
+    return copy_address_prepared(rank, DPU_TRANSFER_FROM_MRAM, address, length, transfer_matrix);
+}
+
+dpu_error_t __API_SYMBOL__
+dpu_copy_from_symbol_gather(struct dpu_rank_t *rank,
+    struct dpu_symbol_t symbol,
+    uint32_t symbol_offset,
+    void *dst,
+    size_t length,
+    size_t stride)
+{
+    dpu_error_t status;
+
+    if ((symbol_offset + length) > symbol.size) {
+        status = DPU_ERR_INVALID_SYMBOL_ACCESS;
+        goto end;
+    }
+
+    if ((status = dpu_copy_from_address_gather(rank, symbol.address + symbol_offset, dst, length, stride)) != DPU_OK) {
+        goto end;
+    }
+
+end:
+    return status;
+}
+
+dpu_error_t __API_SYMBOL__
+dpu_copy_from_address_gather(struct dpu_rank_t *rank,
+    dpu_mem_max_addr_t address,
+    void *dst,
+    dpu_mem_max_size_t length,
+    size_t stride)
+{
+    dpu_error_t status;
+    uint8_t nr_cis = rank->description->topology.nr_of_control_interfaces;
+    uint8_t nr_dpus_per_ci = rank->description->topology.nr_of_dpus_per_control_interface;
+    uint32_t nr_dpus = nr_cis * nr_dpus_per_ci;
+    bool is_iram = (address & IRAM_MASK) == IRAM_MASK;
+    bool is_mram = !is_iram && ((address & MRAM_MASK) == MRAM_MASK);
+    uint8_t *buffer = dst;
+    struct dpu_transfer_mram *matrix;
+
+    if (stride < length) {
+        return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
+
+    if (is_iram) {
+        if ((address & ~IRAM_ALIGN_MASK) != 0) {
+            return DPU_ERR_INVALID_IRAM_ACCESS;
+        }
+        if ((length & ~IRAM_ALIGN_MASK) != 0) {
+            return DPU_ERR_INVALID_IRAM_ACCESS;
+        }
+        if (((((uintptr_t)dst) | stride) & ~IRAM_ALIGN_MASK) != 0) {
+            return DPU_ERR_INVALID_IRAM_ACCESS;
+        }
+    } else if (!is_mram) {
+        if ((address & ~WRAM_ALIGN_MASK) != 0) {
+            return DPU_ERR_INVALID_WRAM_ACCESS;
+        }
+        if ((length & ~WRAM_ALIGN_MASK) != 0) {
+            return DPU_ERR_INVALID_WRAM_ACCESS;
+        }
+        if (((((uintptr_t)dst) | stride) & ~WRAM_ALIGN_MASK) != 0) {
+            return DPU_ERR_INVALID_WRAM_ACCESS;
+        }
+    }
+
+    if ((status = dpu_transfer_matrix_allocate(rank, &matrix)) != DPU_OK) {
+        return status;
+    }
+
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        struct dpu_t *dpu = rank->dpus + each_dpu;
+
+        if (!dpu_is_enabled(dpu)) {
+            continue;
+        }
+
+        /* IRAM and WRAM transfers only use the buffer of the entries */
+        if ((status = dpu_transfer_matrix_add_dpu(
+                 dpu, matrix, buffer, length, is_mram ? address & ~MRAM_MASK : 0, DPU_PRIMARY_MRAM))
+            != DPU_OK) {
+            goto free_matrix;
+        }
+
+        buffer += stride;
+    }
+
+    if (is_mram) {
+        status = dpu_copy_from_mrams(rank, matrix);
+    } else {
+        status = copy_wram_iram_matrix(rank, DPU_TRANSFER_FROM_MRAM, address, length, matrix);
+    }
+
+free_matrix:
+    dpu_transfer_matrix_free(rank, matrix);
+    return status;
+}
+
 __PERF_PROFILING_SYMBOL__ __API_SYMBOL__ dpu_error_t
 dpu_copy_to_iram_for_rank(struct dpu_rank_t *rank,
     iram_addr_t iram_instruction_index,
@@ -790,6 +1035,170 @@ dpu_copy_from_mrams(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_
     return status;
 }
 
+/* Without support from the backend, each pass transfers the n-th segment of every DPU */
+static dpu_error_t
+copy_mrams_iovec_by_segments(struct dpu_rank_t *rank, dpu_transfer_type_t type, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    dpu_error_t status = DPU_OK;
+    uint32_t nr_dpus = rank->description->topology.nr_of_dpus_per_control_interface
+        * rank->description->topology.nr_of_control_interfaces;
+    uint32_t max_nb_segments = 0;
+    struct dpu_transfer_mram *matrix;
+
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        if (iovec_matrix[each_dpu].nb_segments > max_nb_segments) {
+            max_nb_segments = iovec_matrix[each_dpu].nb_segments;
+        }
+    }
+
+    if ((status = dpu_transfer_matrix_allocate(rank, &matrix)) != DPU_OK) {
+        return status;
+    }
+
+    dpu_lock_rank(rank);
+
+    for (uint32_t each_segment = 0; (each_segment < max_nb_segments) && (status == DPU_OK); ++each_segment) {
+        for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+            struct dpu_transfer_mram_iovec *iovec = &iovec_matrix[each_dpu];
+
+            if (each_segment < iovec->nb_segments) {
+                matrix[each_dpu].ptr = iovec->segments[each_segment].ptr;
+                matrix[each_dpu].offset_in_mram = iovec->segments[each_segment].offset_in_mram;
+                matrix[each_dpu].size = iovec->segments[each_segment].size;
+            } else {
+                matrix[each_dpu].ptr = NULL;
+                matrix[each_dpu].size = 0;
+            }
+            matrix[each_dpu].mram_number = DPU_PRIMARY_MRAM;
+        }
+
+        status = (type == DPU_TRANSFER_TO_MRAM) ? dpu_copy_to_mrams(rank, matrix) : dpu_copy_from_mrams(rank, matrix);
+    }
+
+    dpu_unlock_rank(rank);
+
+    dpu_transfer_matrix_free(rank, matrix);
+
+    return status;
+}
+
+static dpu_error_t
+do_mram_iovec_transfer(struct dpu_rank_t *rank, dpu_transfer_type_t type, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    dpu_rank_handler_t handler = rank->handler_context->handler;
+    dpu_rank_status_e rank_status = (type == DPU_TRANSFER_TO_MRAM) ? handler->copy_iovec_to_rank(rank, iovec_matrix)
+                                                                   : handler->copy_iovec_from_rank(rank, iovec_matrix);
+
+    return (rank_status == DPU_RANK_SUCCESS) ? DPU_OK : DPU_ERR_DRIVER;
+}
+
+static dpu_error_t
+copy_mrams_iovec(struct dpu_rank_t *rank, dpu_transfer_type_t type, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    dpu_error_t status;
+    dpu_rank_handler_t handler = rank->handler_context->handler;
+    uint32_t nr_dpus = rank->description->topology.nr_of_dpus_per_control_interface
+        * rank->description->topology.nr_of_control_interfaces;
+    struct dpu_transfer_mram *presence_matrix = NULL, *even_transfer_matrix = NULL, *odd_transfer_matrix = NULL;
+    struct dpu_transfer_mram_iovec *parity_iovec_matrix = NULL;
+
+    if ((handler->copy_iovec_to_rank == NULL) || (handler->copy_iovec_from_rank == NULL)
+        || rank->description->configuration.mram_access_by_dpu_only) {
+        return copy_mrams_iovec_by_segments(rank, type, iovec_matrix);
+    }
+
+    dpu_lock_rank(rank);
+
+    if (rank->runtime.run_context.nb_dpu_running > 0) {
+        LOG_RANK(WARNING,
+            rank,
+            "Host does not have access to the MRAM because %u DPU%s running.",
+            rank->runtime.run_context.nb_dpu_running,
+            rank->runtime.run_context.nb_dpu_running > 1 ? "s are" : " is");
+        status = DPU_ERR_MRAM_BUSY;
+        goto end;
+    }
+
+    /* The MRAM mux is handled as for a transfer matrix with the DPUs having at least one segment */
+    if ((status = dpu_transfer_matrix_allocate(rank, &presence_matrix)) != DPU_OK) {
+        goto end;
+    }
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        if (iovec_matrix[each_dpu].nb_segments != 0) {
+            presence_matrix[each_dpu] = (struct dpu_transfer_mram) {
+                .ptr = iovec_matrix[each_dpu].segments[0].ptr,
+                .offset_in_mram = iovec_matrix[each_dpu].segments[0].offset_in_mram,
+                .mram_number = DPU_PRIMARY_MRAM,
+                .size = iovec_matrix[each_dpu].segments[0].size,
+            };
+        }
+    }
+
+    if (!duplicate_transfer_matrix(rank, presence_matrix, &even_transfer_matrix, &odd_transfer_matrix)) {
+        bool is_full_matrix = is_transfer_matrix_full(rank, presence_matrix);
+
+        if (is_full_matrix)
+            FF(dpu_host_get_access_for_rank(rank));
+        else
+            FF(host_get_access_for_transfer_matrix(rank, presence_matrix));
+
+        FF(do_mram_iovec_transfer(rank, type, iovec_matrix));
+
+        if (is_full_matrix)
+            FF(dpu_host_release_access_for_rank(rank));
+        else
+            FF(host_release_access_for_transfer_matrix(rank, presence_matrix));
+    } else {
+        struct dpu_transfer_mram *parity_matrices[] = { even_transfer_matrix, odd_transfer_matrix };
+
+        if ((parity_iovec_matrix = malloc(nr_dpus * sizeof(*parity_iovec_matrix))) == NULL) {
+            status = DPU_ERR_SYSTEM;
+            goto end;
+        }
+
+        for (uint32_t each_parity = 0; each_parity < 2; ++each_parity) {
+            struct dpu_transfer_mram *parity_matrix = parity_matrices[each_parity];
+
+            for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+                parity_iovec_matrix[each_dpu] = iovec_matrix[each_dpu];
+                if (parity_matrix[each_dpu].ptr == NULL) {
+                    parity_iovec_matrix[each_dpu].nb_segments = 0;
+                }
+            }
+
+            FF(host_get_access_for_transfer_matrix(rank, parity_matrix));
+            FF(do_mram_iovec_transfer(rank, type, parity_iovec_matrix));
+        }
+
+        FF(host_release_access_for_transfer_matrix(rank, presence_matrix));
+    }
+
+end:
+    free(parity_iovec_matrix);
+    free(even_transfer_matrix);
+    free(odd_transfer_matrix);
+    free(presence_matrix);
+    dpu_unlock_rank(rank);
+
+    return status;
+}
+
+__PERF_PROFILING_SYMBOL__ __API_SYMBOL__ dpu_error_t
+dpu_copy_to_mrams_iovec(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    LOG_RANK(VERBOSE, rank, "%p", iovec_matrix);
+
+    return copy_mrams_iovec(rank, DPU_TRANSFER_TO_MRAM, iovec_matrix);
+}
+
+__PERF_PROFILING_SYMBOL__ __API_SYMBOL__ dpu_error_t
+dpu_copy_from_mrams_iovec(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    LOG_RANK(VERBOSE, rank, "%p", iovec_matrix);
+
+    return copy_mrams_iovec(rank, DPU_TRANSFER_FROM_MRAM, iovec_matrix);
+}
+
 static inline uint32_t
 _transfer_matrix_index(struct dpu_t *dpu)
 {
@@ -930,6 +1339,143 @@ dpu_transfer_matrix_get_size(struct dpu_t *dpu, struct dpu_transfer_mram *transf
     return transfer_matrix[dpu_index].size;
 }
 
+__API_SYMBOL__ dpu_error_t
+dpu_transfer_iovec_matrix_allocate(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec **iovec_matrix)
+{
+    LOG_RANK(VERBOSE, rank, "");
+    uint8_t nr_of_dpus_per_ci = rank->description->topology.nr_of_dpus_per_control_interface;
+    uint8_t nr_of_cis = rank->description->topology.nr_of_control_interfaces;
+
+    *iovec_matrix = calloc(nr_of_dpus_per_ci * nr_of_cis, sizeof(struct dpu_transfer_mram_iovec));
+    if (!*iovec_matrix) {
+        return DPU_ERR_SYSTEM;
+    }
+
+    return DPU_OK;
+}
+
+__API_SYMBOL__ void
+dpu_transfer_iovec_matrix_free(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    LOG_RANK(VERBOSE, rank, "%p", iovec_matrix);
+    uint8_t nr_of_dpus_per_ci = rank->description->topology.nr_of_dpus_per_control_interface;
+    uint8_t nr_of_cis = rank->description->topology.nr_of_control_interfaces;
+
+    for (uint32_t each_dpu = 0; each_dpu < (uint32_t)(nr_of_dpus_per_ci * nr_of_cis); ++each_dpu) {
+        free(iovec_matrix[each_dpu].segments);
+    }
+    free(iovec_matrix);
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_transfer_iovec_matrix_add_segment(struct dpu_t *dpu,
+    struct dpu_transfer_mram_iovec *iovec_matrix,
+    void *buffer,
+    mram_size_t size,
+    mram_addr_t offset_in_mram)
+{
+    LOG_DPU(VERBOSE, dpu, "%p, %p, %d, %d", iovec_matrix, buffer, size, offset_in_mram);
+    struct dpu_rank_t *rank = dpu_get_rank(dpu);
+    uint32_t offset = offset_in_mram & ~MRAM_MASK;
+    struct dpu_transfer_mram_iovec *iovec;
+    uint32_t each_segment;
+
+    if (buffer == NULL) {
+        return DPU_ERR_INVALID_MEMORY_TRANSFER;
+    }
+
+    verify_mram_access(buffer, offset, size, rank);
+
+    if (!dpu->enabled) {
+        return DPU_ERR_DPU_DISABLED;
+    }
+
+    iovec = &iovec_matrix[_transfer_matrix_index(dpu)];
+
+    /* Sorted insertion: the segments are usually added in order */
+    for (each_segment = iovec->nb_segments; each_segment > 0; --each_segment) {
+        if (iovec->segments[each_segment - 1].offset_in_mram < offset) {
+            break;
+        }
+    }
+
+    if (((each_segment > 0)
+            && (iovec->segments[each_segment - 1].offset_in_mram + iovec->segments[each_segment - 1].size > offset))
+        || ((each_segment < iovec->nb_segments) && (offset + size > iovec->segments[each_segment].offset_in_mram))) {
+        LOG_DPU(WARNING, dpu, "ERROR: mram segment [%d, %d) overlaps another segment", offset, offset + size);
+        return DPU_ERR_INVALID_MRAM_ACCESS;
+    }
+
+    if (iovec->nb_segments == iovec->capacity) {
+        uint32_t capacity = 2 * iovec->capacity + 2;
+        struct dpu_transfer_mram_segment *segments;
+
+        if ((segments = realloc(iovec->segments, capacity * sizeof(*segments))) == NULL) {
+            return DPU_ERR_SYSTEM;
+        }
+        iovec->segments = segments;
+        iovec->capacity = capacity;
+    }
+
+    memmove(&iovec->segments[each_segment + 1],
+        &iovec->segments[each_segment],
+        (iovec->nb_segments - each_segment) * sizeof(*iovec->segments));
+    iovec->segments[each_segment].ptr = buffer;
+    iovec->segments[each_segment].offset_in_mram = offset;
+    iovec->segments[each_segment].size = size;
+    iovec->nb_segments++;
+
+    return DPU_OK;
+}
+
+__API_SYMBOL__ void
+dpu_transfer_iovec_matrix_clear_all(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    LOG_RANK(VERBOSE, rank, "%p", iovec_matrix);
+    uint8_t nr_of_dpus_per_ci = rank->description->topology.nr_of_dpus_per_control_interface;
+    uint8_t nr_of_cis = rank->description->topology.nr_of_control_interfaces;
+
+    /* The segment arrays are kept for the next transfers */
+    for (uint32_t each_dpu = 0; each_dpu < (uint32_t)(nr_of_dpus_per_ci * nr_of_cis); ++each_dpu) {
+        iovec_matrix[each_dpu].nb_segments = 0;
+    }
+}
+
+__API_SYMBOL__ dpu_error_t
+dpu_transfer_matrix_register(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
+{
+    LOG_RANK(VERBOSE, rank, "%p", transfer_matrix);
+    dpu_rank_handler_t handler = rank->handler_context->handler;
+    dpu_error_t status = DPU_OK;
+
+    if (handler->register_transfer_matrix == NULL) {
+        return DPU_OK;
+    }
+
+    dpu_lock_rank(rank);
+    if (handler->register_transfer_matrix(rank, transfer_matrix) != DPU_RANK_SUCCESS) {
+        status = DPU_ERR_DRIVER;
+    }
+    dpu_unlock_rank(rank);
+
+    return status;
+}
+
+__API_SYMBOL__ void
+dpu_transfer_matrix_unregister(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
+{
+    LOG_RANK(VERBOSE, rank, "%p", transfer_matrix);
+    dpu_rank_handler_t handler = rank->handler_context->handler;
+
+    if (handler->unregister_transfer_matrix == NULL) {
+        return;
+    }
+
+    dpu_lock_rank(rank);
+    handler->unregister_transfer_matrix(rank, transfer_matrix);
+    dpu_unlock_rank(rank);
+}
+
 static dpu_error_t
 copy_from_mrams_using_dpu_program(struct dpu_rank_t *rank, const struct dpu_transfer_mram *transfer_matrix)
 {
@@ -16,8 +16,12 @@
 #include <dpu_types.h>
 #include <dpu_elf_internals.h>
 
+static bool
+is_section_with_host_symbols(const char *section_name);
 static dpu_error_t
 append_symbols(dpu_elf_symbols_t *new_symbols, dpu_elf_symbols_t *symbols, mram_size_t mram_size_hint);
+static dpu_error_t
+build_symbol_table(struct dpu_program_t *program);
 
 __API_SYMBOL__ struct dpu_program_t *
 dpu_get_program(struct dpu_t *dpu)
@@ -35,19 +39,23 @@ __API_SYMBOL__ void
 dpu_init_program_ref(struct dpu_program_t *program)
 {
     program->reference_count = 0;
+    program->expected_run_time_in_ns = 0;
+    program->symbols = NULL;
+    program->symbol_table = NULL;
+    program->symbol_table_mask = 0;
 }
 
 __API_SYMBOL__ void
 dpu_take_program_ref(struct dpu_program_t *program)
 {
-    program->reference_count++;
+    __atomic_fetch_add(&program->reference_count, 1, __ATOMIC_RELAXED);
 }
 
 __API_SYMBOL__ void
 dpu_free_program(struct dpu_program_t *program)
 {
     if (program != NULL) {
-        if (--program->reference_count == 0) {
+        if (__atomic_sub_fetch(&program->reference_count, 1, __ATOMIC_ACQ_REL) == 0) {
             if (program->symbols != NULL) {
                 unsigned int nr_symbols = program->symbols->nr_symbols;
 
@@ -61,6 +69,7 @@ dpu_free_program(struct dpu_program_t *program)
 
                 free(program->symbols);
             }
+            free(program->symbol_table);
             free(program->program_path);
             free(program);
         }
@@ -103,10 +112,22 @@ dpu_load_elf_program_from_elf_info(dpu_elf_file_t *elf_info, struct dpu_program_
         goto free_symbols;
     }
     elf_fd info = ((elf_fd)*elf_info);
+    uint32_t nr_symbols = 0;
+
+    for (size_t each_section = 0; each_section < info->shnum; ++each_section) {
+        if (is_section_with_host_symbols(section_names[each_section])) {
+            nr_symbols += info->symbol_maps[each_section].nr_symbols;
+        }
+    }
+
+    /* Allocated once for all the sections; append_symbols fills it */
+    if ((nr_symbols != 0) && ((symbols->map = malloc(nr_symbols * sizeof(*(symbols->map)))) == NULL)) {
+        result = DPU_ERR_SYSTEM;
+        goto free_section_names;
+    }
 
     for (size_t each_section = 0; each_section < info->shnum; ++each_section) {
-        char *section_name = section_names[each_section];
-        if ((strncmp(".data", section_name, strlen(".data")) == 0) && (strcmp(".data.__sys_host", section_name) != 0)) {
+        if (!is_section_with_host_symbols(section_names[each_section])) {
             continue;
         }
 
@@ -116,11 +137,21 @@ dpu_load_elf_program_from_elf_info(dpu_elf_file_t *elf_info, struct dpu_program_
     }
     program->symbols = symbols;
 
+    if ((result = build_symbol_table(program)) != DPU_OK) {
+        goto free_program_symbols;
+    }
+
     free(section_names);
     free_runtime_info(&runtime_info);
 
     return DPU_OK;
 
+free_program_symbols:
+    for (uint32_t each_symbol = 0; each_symbol < symbols->nr_symbols; ++each_symbol) {
+        free(symbols->map[each_symbol].name);
+    }
+    free(symbols->map);
+    program->symbols = NULL;
 free_section_names:
     free(section_names);
 free_symbols:
@@ -168,28 +199,18 @@ dpu_load_elf_program(dpu_elf_file_t *elf_info, const char *path, struct dpu_prog
     return dpu_load_elf_program_from_elf_info(elf_info, program, mram_size_hint);
 }
 
+static bool
+is_section_with_host_symbols(const char *section_name)
+{
+    return (strncmp(".data", section_name, strlen(".data")) != 0) || (strcmp(".data.__sys_host", section_name) == 0);
+}
+
 static dpu_error_t
 append_symbols(dpu_elf_symbols_t *new_symbols, dpu_elf_symbols_t *symbols, mram_size_t mram_size_hint)
 {
     uint32_t previous_nr_symbols = symbols->nr_symbols;
-    uint32_t nr_symbols = new_symbols->nr_symbols + symbols->nr_symbols;
-    dpu_elf_symbol_t *new_symbol_array;
-
-    if (previous_nr_symbols == nr_symbols) {
-        return DPU_OK;
-    }
-
-    if ((new_symbol_array = realloc(symbols->map, nr_symbols * sizeof(*(symbols->map)))) == NULL) {
-        if (symbols->map != NULL) {
-            free(symbols->map);
-        }
-        return DPU_ERR_SYSTEM;
-    }
 
-    symbols->map = new_symbol_array;
-    symbols->nr_symbols = nr_symbols;
-
-    memcpy(symbols->map + previous_nr_symbols, new_symbols->map, new_symbols->nr_symbols * sizeof(*(new_symbols->map)));
+    memcpy(symbols->map + previous_nr_symbols, new_symbols->map, new_symbols->nr_symbols * sizeof(*(symbols->map)));
 
     for (uint32_t each_symbol = 0; each_symbol < new_symbols->nr_symbols; ++each_symbol) {
         char *symbol_name = new_symbols->map[each_symbol].name;
@@ -201,6 +222,8 @@ append_symbols(dpu_elf_symbols_t *new_symbols, dpu_elf_symbols_t *symbols, mram_
                 free(symbols->map[each_allocated_symbol].name);
             }
             free(symbols->map);
+            symbols->map = NULL;
+            symbols->nr_symbols = 0;
             return DPU_ERR_SYSTEM;
         }
 
@@ -209,5 +232,79 @@ append_symbols(dpu_elf_symbols_t *new_symbols, dpu_elf_symbols_t *symbols, mram_
         }
     }
 
+    symbols->nr_symbols = previous_nr_symbols + new_symbols->nr_symbols;
+
     return DPU_OK;
 }
+
+/* FNV-1a */
+static uint32_t
+hash_symbol_name(const char *name)
+{
+    uint32_t hash = 2166136261u;
+
+    for (; *name != '\0'; ++name) {
+        hash = (hash ^ (uint8_t)*name) * 16777619u;
+    }
+
+    return hash;
+}
+
+static uint32_t *
+find_symbol_slot(struct dpu_program_t *program, const char *symbol_name)
+{
+    uint32_t slot = hash_symbol_name(symbol_name) & program->symbol_table_mask;
+
+    while (program->symbol_table[slot] != 0) {
+        if (strcmp(symbol_name, program->symbols->map[program->symbol_table[slot] - 1].name) == 0) {
+            break;
+        }
+        slot = (slot + 1) & program->symbol_table_mask;
+    }
+
+    return program->symbol_table + slot;
+}
+
+static dpu_error_t
+build_symbol_table(struct dpu_program_t *program)
+{
+    uint32_t nr_symbols = program->symbols->nr_symbols;
+    uint32_t nr_slots = 1;
+
+    /* Keep the load factor under 1/2 */
+    while (nr_slots < (2 * nr_symbols)) {
+        nr_slots <<= 1;
+    }
+
+    if ((program->symbol_table = calloc(nr_slots, sizeof(*(program->symbol_table)))) == NULL) {
+        return DPU_ERR_SYSTEM;
+    }
+    program->symbol_table_mask = nr_slots - 1;
+
+    for (uint32_t each_symbol = 0; each_symbol < nr_symbols; ++each_symbol) {
+        uint32_t *slot = find_symbol_slot(program, program->symbols->map[each_symbol].name);
+
+        /* Duplicated names resolve to the first symbol, as the previous linear lookup did */
+        if (*slot == 0) {
+            *slot = each_symbol + 1;
+        }
+    }
+
+    return DPU_OK;
+}
+
+__API_SYMBOL__ dpu_elf_symbol_t *
+dpu_program_find_symbol(struct dpu_program_t *program, const char *symbol_name)
+{
+    uint32_t index;
+
+    if (program->symbol_table == NULL) {
+        return NULL;
+    }
+
+    if ((index = *find_symbol_slot(program, symbol_name)) == 0) {
+        return NULL;
+    }
+
+    return program->symbols->map + index - 1;
+}
@@ -0,0 +1,271 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <dpu_error.h>
+#include <dpu_types.h>
+#include <dpu_rank.h>
+#include <dpu_api_log.h>
+#include <dpu_rank_dispatch.h>
+#include <dpu_cpulist.h>
+
+/* Completion record of the job of one rank, owned by the caller of dpu_rank_dispatch: several threads may dispatch on the
+ * same rank, each one reads its own status. status and done are protected by the worker mutex.
+ */
+struct dpu_rank_dispatch_job_t {
+    dpu_rank_dispatch_fct_t fct;
+    uint32_t rank_idx;
+    void *args;
+    dpu_error_t status;
+    bool done;
+};
+
+/* The worker mutex is created with the worker: the creation and the destruction of the workers are serialized here */
+static pthread_mutex_t dispatch_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void
+dispatch_thread_bind_to_numa_node(struct dpu_rank_t *rank)
+{
+    cpu_set_t cpus;
+
+    if (rank->numa_node < 0) {
+        return;
+    }
+
+    if (dpu_cpulist_get_numa_node_cpus(rank->numa_node, &cpus) != 0) {
+        LOG_RANK(DEBUG, rank, "cannot get the CPUs of NUMA node %d, worker is not pinned", rank->numa_node);
+        return;
+    }
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+        LOG_RANK(WARNING, rank, "cannot pin worker on NUMA node %d", rank->numa_node);
+    }
+}
+
+static void *
+dispatch_thread(struct dpu_rank_t *rank)
+{
+    struct dpu_dispatch_thread_context_t *context = &rank->dispatch_thread;
+
+    dispatch_thread_bind_to_numa_node(rank);
+
+    pthread_mutex_lock(&context->thread.thr_mutex);
+    while (true) {
+        while (context->thread.thr_has_work == 0) {
+            pthread_cond_wait(&context->thread.thr_cond, &context->thread.thr_mutex);
+        }
+
+        if (context->thread.thr_has_work == -1) {
+            break;
+        }
+
+        /* The slot is free for the next dispatch as soon as the job is taken */
+        struct dpu_rank_dispatch_job_t *job = context->job;
+        context->job = NULL;
+        context->thread.thr_has_work = 0;
+        pthread_cond_broadcast(&context->thread.thr_cond);
+
+        pthread_mutex_unlock(&context->thread.thr_mutex);
+        dpu_error_t status = job->fct(rank, job->rank_idx, job->args);
+        pthread_mutex_lock(&context->thread.thr_mutex);
+
+        job->status = status;
+        job->done = true;
+        pthread_cond_broadcast(&context->thread.thr_cond);
+    }
+    pthread_mutex_unlock(&context->thread.thr_mutex);
+
+    return NULL;
+}
+
+static bool
+dispatch_thread_start(struct dpu_rank_t *rank)
+{
+    struct dpu_dispatch_thread_context_t *context = &rank->dispatch_thread;
+    bool started = false;
+
+    pthread_mutex_lock(&dispatch_threads_mutex);
+
+    if (context->thread.thr_exists) {
+        started = true;
+        goto end;
+    }
+
+    if (pthread_cond_init(&context->thread.thr_cond, NULL) != 0) {
+        goto end;
+    }
+
+    if (pthread_mutex_init(&context->thread.thr_mutex, NULL) != 0) {
+        pthread_cond_destroy(&context->thread.thr_cond);
+        goto end;
+    }
+
+    context->thread.thr_has_work = 0;
+
+    if (pthread_create(&context->thread.thr_id, NULL, (void *(*)(void *))dispatch_thread, rank) != 0) {
+        pthread_mutex_destroy(&context->thread.thr_mutex);
+        pthread_cond_destroy(&context->thread.thr_cond);
+        goto end;
+    }
+
+    context->thread.thr_exists = true;
+    started = true;
+
+end:
+    pthread_mutex_unlock(&dispatch_threads_mutex);
+    return started;
+}
+
+static void
+dispatch_thread_submit(struct dpu_rank_t *rank, struct dpu_rank_dispatch_job_t *job)
+{
+    struct dpu_dispatch_thread_context_t *context = &rank->dispatch_thread;
+
+    pthread_mutex_lock(&context->thread.thr_mutex);
+    /* There is one job slot per worker: the job of another dispatch on the rank must be taken before it is overwritten */
+    while (context->thread.thr_has_work == 1) {
+        pthread_cond_wait(&context->thread.thr_cond, &context->thread.thr_mutex);
+    }
+    context->job = job;
+    context->thread.thr_has_work = 1;
+    pthread_cond_broadcast(&context->thread.thr_cond);
+    pthread_mutex_unlock(&context->thread.thr_mutex);
+}
+
+static dpu_error_t
+dispatch_thread_wait(struct dpu_rank_t *rank, struct dpu_rank_dispatch_job_t *job)
+{
+    struct dpu_dispatch_thread_context_t *context = &rank->dispatch_thread;
+    dpu_error_t status;
+
+    pthread_mutex_lock(&context->thread.thr_mutex);
+    while (!job->done) {
+        pthread_cond_wait(&context->thread.thr_cond, &context->thread.thr_mutex);
+    }
+    status = job->status;
+    pthread_mutex_unlock(&context->thread.thr_mutex);
+
+    return status;
+}
+
+static dpu_error_t
+dispatch_sequential(struct dpu_rank_t **ranks,
+    uint32_t nr_ranks,
+    dpu_rank_dispatch_fct_t fct,
+    void *args,
+    dpu_rank_dispatch_error_policy_t policy)
+{
+    dpu_error_t status = DPU_OK;
+
+    for (uint32_t each_rank = 0; each_rank < nr_ranks; ++each_rank) {
+        dpu_error_t rank_status;
+
+        if ((rank_status = fct(ranks[each_rank], each_rank, args)) != DPU_OK) {
+            status = rank_status;
+            if (policy == DPU_DISPATCH_FIRST_ERROR) {
+                break;
+            }
+        }
+    }
+
+    return status;
+}
+
+dpu_error_t
+dpu_rank_dispatch(struct dpu_rank_t **ranks,
+    uint32_t nr_ranks,
+    dpu_rank_dispatch_fct_t fct,
+    void *args,
+    dpu_rank_dispatch_error_policy_t policy)
+{
+    dpu_error_t status = DPU_OK;
+    struct dpu_rank_dispatch_job_t *jobs;
+    bool *inline_ranks;
+
+    if ((nr_ranks <= 1) || !ranks[0]->description->configuration.enable_parallel_dispatch) {
+        return dispatch_sequential(ranks, nr_ranks, fct, args, policy);
+    }
+
+    if ((jobs = calloc(nr_ranks, sizeof(*jobs))) == NULL) {
+        return dispatch_sequential(ranks, nr_ranks, fct, args, policy);
+    }
+    if ((inline_ranks = calloc(nr_ranks, sizeof(*inline_ranks))) == NULL) {
+        free(jobs);
+        return dispatch_sequential(ranks, nr_ranks, fct, args, policy);
+    }
+
+    for (uint32_t each_rank = 0; each_rank < nr_ranks; ++each_rank) {
+        struct dpu_rank_t *rank = ranks[each_rank];
+
+        jobs[each_rank].fct = fct;
+        jobs[each_rank].rank_idx = each_rank;
+        jobs[each_rank].args = args;
+
+        if (!dispatch_thread_start(rank)) {
+            LOG_RANK(WARNING, rank, "cannot create dispatch worker, running on the calling thread");
+            inline_ranks[each_rank] = true;
+            continue;
+        }
+
+        dispatch_thread_submit(rank, &jobs[each_rank]);
+    }
+
+    /* Ranks without worker run while the other ones are busy */
+    for (uint32_t each_rank = 0; each_rank < nr_ranks; ++each_rank) {
+        if (inline_ranks[each_rank]) {
+            jobs[each_rank].status = fct(ranks[each_rank], each_rank, args);
+        }
+    }
+
+    /* Merge the statuses in rank order, so that the result does not depend on the scheduling */
+    for (uint32_t each_rank = 0; each_rank < nr_ranks; ++each_rank) {
+        dpu_error_t rank_status
+            = inline_ranks[each_rank] ? jobs[each_rank].status : dispatch_thread_wait(ranks[each_rank], &jobs[each_rank]);
+
+        if ((rank_status != DPU_OK) && ((status == DPU_OK) || (policy == DPU_DISPATCH_LAST_ERROR))) {
+            status = rank_status;
+        }
+    }
+
+    free(inline_ranks);
+    free(jobs);
+
+    return status;
+}
+
+void
+dpu_rank_dispatch_stop(struct dpu_rank_t *rank)
+{
+    struct dpu_dispatch_thread_context_t *context = &rank->dispatch_thread;
+
+    pthread_mutex_lock(&dispatch_threads_mutex);
+
+    if (!context->thread.thr_exists) {
+        goto end;
+    }
+
+    pthread_mutex_lock(&context->thread.thr_mutex);
+    /* The worker would clear the request when it takes its job: it ends the job before it exits */
+    while (context->thread.thr_has_work == 1) {
+        pthread_cond_wait(&context->thread.thr_cond, &context->thread.thr_mutex);
+    }
+    context->thread.thr_has_work = -1;
+    pthread_cond_broadcast(&context->thread.thr_cond);
+    pthread_mutex_unlock(&context->thread.thr_mutex);
+
+    pthread_join(context->thread.thr_id, NULL);
+    pthread_mutex_destroy(&context->thread.thr_mutex);
+    pthread_cond_destroy(&context->thread.thr_cond);
+    context->thread.thr_exists = false;
+
+end:
+    pthread_mutex_unlock(&dispatch_threads_mutex);
+}
@@ -146,6 +146,22 @@ end:
     return status;
 }
 
+/* The profiling reads of a poll cost more than the poll itself: they are only done once every poll period, and when the
+ * profiled DPU stops, to collect its last state before dumping the profile.
+ */
+static bool
+profiling_read_is_due(struct dpu_rank_t *rank, bool profiled_dpu_stops)
+{
+    dpu_profiling_context_t context = &rank->profiling_context;
+
+    if (++context->nr_polls >= context->poll_period) {
+        context->nr_polls = 0;
+        return true;
+    }
+
+    return profiled_dpu_stops;
+}
+
 __API_SYMBOL__ dpu_error_t
 dpu_poll_rank(struct dpu_rank_t *rank, dpu_bitfield_t *dpu_is_running, dpu_bitfield_t *dpu_is_in_fault)
 {
@@ -154,8 +170,10 @@ dpu_poll_rank(struct dpu_rank_t *rank, dpu_bitfield_t *dpu_is_running, dpu_bitfi
     dpu_error_t status;
     dpu_slice_id_t slice_id_profiling = dpu_get_slice_id(rank->profiling_context.dpu);
     dpu_member_id_t dpu_id_profiling = dpu_get_member_id(rank->profiling_context.dpu);
+    dpu_selected_mask_t mask_one = dpu_mask_one(dpu_id_profiling);
     uint8_t nr_threads = rank->description->dpu.nr_of_threads;
     uint32_t profiled_address[nr_threads];
+    bool dpu_profiling_stops;
 
     uint8_t mask = ALL_CIS;
 
@@ -164,10 +182,18 @@ dpu_poll_rank(struct dpu_rank_t *rank, dpu_bitfield_t *dpu_is_running, dpu_bitfi
     FF(ufi_read_dpu_run(rank, mask, dpu_is_running));
     FF(ufi_read_dpu_fault(rank, mask, dpu_is_in_fault));
 
+    dpu_profiling_stops
+        = (((dpu_is_running[slice_id_profiling] & mask_one) == 0) || ((dpu_is_in_fault[slice_id_profiling] & mask_one) != 0))
+        && (rank->runtime.run_context.dpu_running[slice_id_profiling] & mask_one);
+
     switch (rank->profiling_context.enable_profiling) {
         default:
             break;
         case DPU_PROFILING_STATS: {
+            if (!profiling_read_is_due(rank, dpu_profiling_stops)) {
+                break;
+            }
+
             memset(profiled_address, 0, nr_threads * sizeof(uint32_t));
             dpuword_t *wram_array[DPU_MAX_NR_CIS];
             wram_array[slice_id_profiling] = profiled_address;
@@ -177,22 +203,19 @@ dpu_poll_rank(struct dpu_rank_t *rank, dpu_bitfield_t *dpu_is_running, dpu_bitfi
             FF(ufi_wram_read(
                 rank, ci_mask, wram_array, (wram_addr_t)(rank->profiling_context.thread_profiling_address / 4), nr_threads));
 
-            dpu_selected_mask_t mask_one = dpu_mask_one(dpu_id_profiling);
-            bool dpu_profiling_is_running, dpu_profiling_is_in_fault;
-
             dpu_collect_statistics_profiling(rank->profiling_context.dpu, nr_threads, profiled_address);
 
-            dpu_profiling_is_running = (dpu_is_running[slice_id_profiling] & mask_one) != 0;
-            dpu_profiling_is_in_fault = (dpu_is_in_fault[slice_id_profiling] & mask_one) != 0;
-
-            if ((!dpu_profiling_is_running || dpu_profiling_is_in_fault)
-                && (rank->runtime.run_context.dpu_running[slice_id_profiling] & mask_one)) {
+            if (dpu_profiling_stops) {
                 dpu_dump_statistics_profiling(rank->profiling_context.dpu, nr_threads);
             }
 
             break;
         }
         case DPU_PROFILING_SAMPLES: {
+            if (!profiling_read_is_due(rank, dpu_profiling_stops)) {
+                break;
+            }
+
             uint8_t ci_mask = CI_MASK_ONE(slice_id_profiling);
             iram_addr_t pc_array[DPU_MAX_NR_CIS];
 
@@ -200,18 +223,11 @@ dpu_poll_rank(struct dpu_rank_t *rank, dpu_bitfield_t *dpu_is_running, dpu_bitfi
             FF(ufi_debug_pc_sample(rank, ci_mask));
             FF(ufi_debug_pc_read(rank, ci_mask, pc_array));
 
-            dpu_selected_mask_t mask_one = dpu_mask_one(dpu_id_profiling);
-            bool dpu_profiling_is_running, dpu_profiling_is_in_fault;
-
             iram_addr_t sampled_address = pc_array[slice_id_profiling];
 
             dpu_collect_samples_profiling(rank->profiling_context.dpu, sampled_address);
 
-            dpu_profiling_is_running = (dpu_is_running[slice_id_profiling] & mask_one) != 0;
-            dpu_profiling_is_in_fault = (dpu_is_in_fault[slice_id_profiling] & mask_one) != 0;
-
-            if ((!dpu_profiling_is_running || dpu_profiling_is_in_fault)
-                && (rank->runtime.run_context.dpu_running[slice_id_profiling] & mask_one)) {
+            if (dpu_profiling_stops) {
                 dpu_dump_samples_profiling(rank->profiling_context.dpu);
             }
 
@@ -258,6 +274,7 @@ dpu_poll_dpu(struct dpu_t *dpu, bool *dpu_is_running, bool *dpu_is_in_fault)
     dpu_selected_mask_t mask_one = dpu_mask_one(member_id);
     uint8_t nr_threads = rank->description->dpu.nr_of_threads;
     uint32_t profiled_address[nr_threads];
+    bool dpu_stops;
 
     uint8_t mask = CI_MASK_ONE(slice_id);
 
@@ -266,7 +283,11 @@ dpu_poll_dpu(struct dpu_t *dpu, bool *dpu_is_running, bool *dpu_is_in_fault)
     FF(ufi_read_dpu_run(rank, mask, is_running_result));
     FF(ufi_read_dpu_fault(rank, mask, is_in_fault_result));
 
-    if (rank->profiling_context.dpu == dpu) {
+    *dpu_is_running = (is_running_result[slice_id] & mask_one) != 0;
+    *dpu_is_in_fault = (is_in_fault_result[slice_id] & mask_one) != 0;
+    dpu_stops = (!*dpu_is_running || *dpu_is_in_fault) && (rank->runtime.run_context.dpu_running[slice_id] & mask_one);
+
+    if ((rank->profiling_context.dpu == dpu) && profiling_read_is_due(rank, dpu_stops)) {
         switch (rank->profiling_context.enable_profiling) {
             default:
                 break;
@@ -294,10 +315,7 @@ dpu_poll_dpu(struct dpu_t *dpu, bool *dpu_is_running, bool *dpu_is_in_fault)
         }
     }
 
-    *dpu_is_running = (is_running_result[slice_id] & mask_one) != 0;
-    *dpu_is_in_fault = (is_in_fault_result[slice_id] & mask_one) != 0;
-
-    if ((!*dpu_is_running || *dpu_is_in_fault) && (rank->runtime.run_context.dpu_running[slice_id] & mask_one)) {
+    if (dpu_stops) {
         rank->runtime.run_context.dpu_running[slice_id] &= ~mask_one;
         rank->runtime.run_context.nb_dpu_running--;
 
@@ -120,4 +120,12 @@ dpu_get_run_context(struct dpu_rank_t *rank);
 dpu_error_t
 map_rank_status_to_api_status(dpu_rank_status_e rank_status);
 
+/**
+ * @fn dpu_host_buffer_release_rank
+ * @brief Unregisters the host buffers of a rank which is being freed: they are only host memory afterwards.
+ * @param rank the rank being freed
+ */
+void
+dpu_host_buffer_release_rank(struct dpu_rank_t *rank);
+
 #endif /* DPU_INTERNALS_H */
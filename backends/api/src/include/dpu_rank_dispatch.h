@@ -0,0 +1,59 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef DPU_RANK_DISPATCH_H
+#define DPU_RANK_DISPATCH_H
+
+#include <stdint.h>
+
+#include <dpu_error.h>
+#include <dpu_types.h>
+
+/**
+ * @brief Operation applied to each rank of a set by dpu_rank_dispatch, which also gets the index of the rank in the list.
+ */
+typedef dpu_error_t (*dpu_rank_dispatch_fct_t)(struct dpu_rank_t *rank, uint32_t rank_idx, void *args);
+
+/**
+ * @brief How the per-rank statuses are merged into the status returned by dpu_rank_dispatch.
+ */
+typedef enum _dpu_rank_dispatch_error_policy_t {
+    /** Returns the error of the first failing rank (sequential mode stops at this rank). */
+    DPU_DISPATCH_FIRST_ERROR,
+    /** Every rank is processed, the error of the last failing rank is returned. */
+    DPU_DISPATCH_LAST_ERROR,
+} dpu_rank_dispatch_error_policy_t;
+
+/**
+ * @fn dpu_rank_dispatch
+ * @brief Applies an operation on each rank of a list.
+ *
+ * When the ranks were allocated with the "parallelDispatch" profile property, the operation runs concurrently
+ * on one worker thread per rank, pinned on the NUMA node of the rank, and the call returns once every rank is
+ * done. Otherwise, the ranks are processed one after the other on the calling thread.
+ *
+ * @param ranks the ranks on which the operation is applied
+ * @param nr_ranks the number of ranks
+ * @param fct the operation
+ * @param args the operation arguments, shared by all ranks
+ * @param policy how the errors are aggregated
+ * @return Whether the operation was successful.
+ */
+dpu_error_t
+dpu_rank_dispatch(struct dpu_rank_t **ranks,
+    uint32_t nr_ranks,
+    dpu_rank_dispatch_fct_t fct,
+    void *args,
+    dpu_rank_dispatch_error_policy_t policy);
+
+/**
+ * @fn dpu_rank_dispatch_stop
+ * @brief Terminates the worker thread of the rank, if any.
+ * @param rank the rank
+ */
+void
+dpu_rank_dispatch_stop(struct dpu_rank_t *rank);
+
+#endif // DPU_RANK_DISPATCH_H
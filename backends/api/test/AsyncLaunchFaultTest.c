@@ -0,0 +1,70 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* A DPU is put in fault before an asynchronous launch, which must complete with DPU_ERR_DPU_FAULT. Once the fault is
+ * cleared, the next asynchronous launches on the same rank (and on the same DPU) must complete normally: the poll
+ * threads must still be there to serve them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <dpu.h>
+#include <dpu_debug.h>
+
+/* The simulator does not execute the reset programs, which are not available in the build tree */
+#define TEST_PROFILE "backend=simulator,disableResetOnAlloc=true"
+
+#define CHECK(call, expected)                                                                                                    \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != (expected)) {                                                                                             \
+            fprintf(stderr, "%s:%d: %s: %s (expected %s)\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status),            \
+                dpu_error_to_string(expected));                                                                                  \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+static void
+launch_and_wait(struct dpu_set_t set, dpu_error_t expected)
+{
+    struct dpu_future_t *future;
+
+    CHECK(dpu_launch_async(set, NULL, NULL, DPU_COMPLETION_PER_SET, &future), DPU_OK);
+    CHECK(dpu_future_free(future), expected);
+}
+
+int
+main(void)
+{
+    struct dpu_set_t set, rank, dpu;
+
+    CHECK(dpu_alloc(DPU_ALLOCATE_ALL, TEST_PROFILE, &set), DPU_OK);
+
+    DPU_RANK_FOREACH (set, rank) {
+        DPU_FOREACH (rank, dpu) {
+            break;
+        }
+
+        CHECK(dpu_trigger_fault_on_dpu(dpu.dpu), DPU_OK);
+        launch_and_wait(rank, DPU_ERR_DPU_FAULT);
+
+        CHECK(dpu_clear_fault_on_rank(rank.list.ranks[0]), DPU_OK);
+        launch_and_wait(rank, DPU_OK);
+        launch_and_wait(rank, DPU_OK);
+        CHECK(dpu_sync(rank), DPU_OK);
+
+        CHECK(dpu_trigger_fault_on_dpu(dpu.dpu), DPU_OK);
+        launch_and_wait(dpu, DPU_ERR_DPU_FAULT);
+
+        CHECK(dpu_clear_fault_on_dpu(dpu.dpu), DPU_OK);
+        launch_and_wait(dpu, DPU_OK);
+        launch_and_wait(dpu, DPU_OK);
+    }
+
+    CHECK(dpu_free(set), DPU_OK);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Each DPU of a simulated 8x8 rank gets its own WRAM and IRAM contents, written DPU by DPU. The rank-wide gathers, which
+ * read the DPUs with the same member id on all the CIs at once, must return the contents of each DPU at its stride.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dpu.h>
+#include <dpu_memory.h>
+
+#define TEST_PROFILE "backend=simulator,disableResetOnAlloc=true,nrCis=8,nrDpusPerCI=8"
+
+#define IRAM_MASK (0x80000000u)
+
+#define NR_WORDS 48
+#define WRAM_WORD_OFFSET 16
+#define NR_INSTRUCTIONS 24
+#define IRAM_INSTRUCTION_OFFSET 8
+#define STRIDE 512
+
+#define CHECK(call)                                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != DPU_OK) {                                                                                                 \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+static void
+check_gather(const char *memory, const uint8_t *expected, const uint8_t *gathered, uint32_t nr_dpus)
+{
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        if (memcmp(expected + each_dpu * STRIDE, gathered + each_dpu * STRIDE, STRIDE) != 0) {
+            fprintf(stderr, "%s: the gathered contents of DPU %u differ from its own\n", memory, each_dpu);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int
+main(void)
+{
+    struct dpu_set_t set, rank, dpu;
+    uint32_t nr_dpus, each_dpu;
+
+    CHECK(dpu_alloc(DPU_ALLOCATE_ALL, TEST_PROFILE, &set));
+
+    DPU_RANK_FOREACH (set, rank) {
+        CHECK(dpu_get_nr_dpus(rank, &nr_dpus));
+
+        uint8_t *expected = calloc(nr_dpus, STRIDE);
+        uint8_t *gathered = calloc(nr_dpus, STRIDE);
+
+        if ((expected == NULL) || (gathered == NULL)) {
+            return EXIT_FAILURE;
+        }
+
+        DPU_FOREACH (rank, dpu, each_dpu) {
+            uint32_t *words = (uint32_t *)(expected + each_dpu * STRIDE);
+
+            for (uint32_t each_word = 0; each_word < NR_WORDS; ++each_word) {
+                words[each_word] = (each_dpu << 16) | each_word;
+            }
+            CHECK(dpu_copy_to_wram_for_dpu(dpu.dpu, WRAM_WORD_OFFSET, words, NR_WORDS));
+        }
+
+        CHECK(dpu_copy_from_address_gather(
+            rank.list.ranks[0], WRAM_WORD_OFFSET * sizeof(uint32_t), gathered, NR_WORDS * sizeof(uint32_t), STRIDE));
+        check_gather("WRAM", expected, gathered, nr_dpus);
+
+        memset(expected, 0, nr_dpus * STRIDE);
+        memset(gathered, 0, nr_dpus * STRIDE);
+
+        DPU_FOREACH (rank, dpu, each_dpu) {
+            uint64_t *instructions = (uint64_t *)(expected + each_dpu * STRIDE);
+
+            for (uint32_t each_instruction = 0; each_instruction < NR_INSTRUCTIONS; ++each_instruction) {
+                instructions[each_instruction] = ((uint64_t)each_dpu << 32) | each_instruction;
+            }
+            CHECK(dpu_copy_to_iram_for_dpu(dpu.dpu, IRAM_INSTRUCTION_OFFSET, instructions, NR_INSTRUCTIONS));
+        }
+
+        CHECK(dpu_copy_from_address_gather(rank.list.ranks[0],
+            IRAM_MASK | (IRAM_INSTRUCTION_OFFSET * sizeof(uint64_t)),
+            gathered,
+            NR_INSTRUCTIONS * sizeof(uint64_t),
+            STRIDE));
+        check_gather("IRAM", expected, gathered, nr_dpus);
+
+        free(gathered);
+        free(expected);
+    }
+
+    CHECK(dpu_free(set));
+
+    return EXIT_SUCCESS;
+}
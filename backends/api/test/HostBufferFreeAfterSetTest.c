@@ -0,0 +1,79 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Host buffers are allocated on a simulated DPU set, which is then freed before them. The buffers must stay usable host
+ * memory after the set is gone, and dpu_host_buffer_free must release them without touching the freed ranks. A buffer
+ * freed twice, or never allocated, is rejected.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dpu.h>
+
+#define TEST_PROFILE "backend=simulator,disableResetOnAlloc=true"
+
+#define SIZE_PER_DPU 4096
+
+#define CHECK(call)                                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != DPU_OK) {                                                                                                 \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+int
+main(void)
+{
+    struct dpu_set_t set, rank;
+    uint32_t nr_ranks, nr_dpus, each_rank = 0;
+    uint8_t *set_buffer, *rank_buffer, *early_buffer;
+    int local;
+
+    CHECK(dpu_alloc(DPU_ALLOCATE_ALL, TEST_PROFILE, &set));
+    CHECK(dpu_get_nr_ranks(set, &nr_ranks));
+    CHECK(dpu_get_nr_dpus(set, &nr_dpus));
+
+    CHECK(dpu_host_buffer_alloc(set, SIZE_PER_DPU, (void **)&set_buffer));
+    CHECK(dpu_host_buffer_alloc(set, SIZE_PER_DPU, (void **)&early_buffer));
+    DPU_RANK_FOREACH (set, rank) {
+        /* The last rank holds the two buffers of the set and its own */
+        if (++each_rank == nr_ranks) {
+            CHECK(dpu_host_buffer_alloc(rank, SIZE_PER_DPU, (void **)&rank_buffer));
+        }
+    }
+
+    /* Freed while its ranks are alive: the other registrations of the ranks stay */
+    CHECK(dpu_host_buffer_free(early_buffer));
+
+    memset(set_buffer, 0xa5, nr_dpus * DPU_HOST_BUFFER_STRIDE(SIZE_PER_DPU));
+    CHECK(dpu_free(set));
+
+    for (size_t each_byte = 0; each_byte < nr_dpus * DPU_HOST_BUFFER_STRIDE(SIZE_PER_DPU); ++each_byte) {
+        if (set_buffer[each_byte] != 0xa5) {
+            fprintf(stderr, "the buffer changed when its DPU set was freed\n");
+            return EXIT_FAILURE;
+        }
+    }
+    memset(rank_buffer, 0x5a, SIZE_PER_DPU);
+
+    CHECK(dpu_host_buffer_free(rank_buffer));
+    CHECK(dpu_host_buffer_free(set_buffer));
+
+    if (dpu_host_buffer_free(set_buffer) == DPU_OK) {
+        fprintf(stderr, "a buffer was freed twice\n");
+        return EXIT_FAILURE;
+    }
+    if (dpu_host_buffer_free(&local) == DPU_OK) {
+        fprintf(stderr, "a buffer which was not allocated was freed\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
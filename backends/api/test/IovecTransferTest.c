@@ -0,0 +1,232 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Each DPU of a simulated rank gets a different number of MRAM segments, at odd offsets and of sizes which are not
+ * multiples of a word, from unaligned host pointers and added out of order for some DPUs. The scatter must write the
+ * segments and nothing around them, and the gather must read them back without touching the host bytes around them.
+ * Segments which overlap another one, go past the MRAM or have no buffer are rejected and leave the matrix unchanged.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dpu.h>
+#include <dpu_memory.h>
+#include <dpu_transfer_mram.h>
+
+#define MRAM_SIZE 65536
+#define TEST_PROFILE "backend=simulator,disableResetOnAlloc=true,mramSize=65536"
+
+#define REGION_SIZE 160
+#define BACKGROUND 0xee
+
+#define CHECK(call)                                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != DPU_OK) {                                                                                                 \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+#define CHECK_ERROR(call, expected)                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != (expected)) {                                                                                             \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+static const struct {
+    uint32_t offset;
+    uint32_t size;
+} segments[] = {
+    { 3, 5 },
+    { 13, 2 },
+    { 17, 1 },
+    { 40, 11 },
+    { 64, 8 },
+    { 97, 30 },
+};
+
+#define NR_SEGMENTS (sizeof(segments) / sizeof(segments[0]))
+
+static const struct dpu_symbol_t region = { .address = 0x08000000, .size = REGION_SIZE };
+
+static uint32_t
+nr_segments_of_dpu(uint32_t each_dpu)
+{
+    return (each_dpu % NR_SEGMENTS) + 1;
+}
+
+static void
+add_segments(struct dpu_set_t rank, struct dpu_transfer_mram_iovec *iovec_matrix, uint8_t *buffers)
+{
+    struct dpu_set_t dpu;
+    uint32_t each_dpu;
+
+    DPU_FOREACH (rank, dpu, each_dpu) {
+        uint32_t nr_segments = nr_segments_of_dpu(each_dpu);
+
+        for (uint32_t each_segment = 0; each_segment < nr_segments; ++each_segment) {
+            /* Odd DPUs add their segments backwards */
+            uint32_t segment = (each_dpu & 1) ? (nr_segments - 1 - each_segment) : each_segment;
+
+            CHECK(dpu_transfer_iovec_matrix_add_segment(dpu.dpu,
+                iovec_matrix,
+                buffers + each_dpu * REGION_SIZE + segments[segment].offset,
+                segments[segment].size,
+                segments[segment].offset));
+        }
+    }
+}
+
+/* The bytes of the segments of the DPU come from "segment_bytes", the others from "other_bytes" */
+static void
+build_expected(uint8_t *expected, uint32_t nr_dpus, const uint8_t *segment_bytes, const uint8_t *other_bytes)
+{
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        uint8_t *dpu_expected = expected + each_dpu * REGION_SIZE;
+
+        memcpy(dpu_expected, other_bytes + each_dpu * REGION_SIZE, REGION_SIZE);
+        for (uint32_t each_segment = 0; each_segment < nr_segments_of_dpu(each_dpu); ++each_segment) {
+            memcpy(dpu_expected + segments[each_segment].offset,
+                segment_bytes + each_dpu * REGION_SIZE + segments[each_segment].offset,
+                segments[each_segment].size);
+        }
+    }
+}
+
+static void
+check_mrams(const char *step, struct dpu_set_t rank, const uint8_t *expected)
+{
+    struct dpu_set_t dpu;
+    uint8_t mram[REGION_SIZE];
+    uint32_t each_dpu;
+
+    DPU_FOREACH (rank, dpu, each_dpu) {
+        CHECK(dpu_copy_from_symbol(dpu, region, 0, mram, REGION_SIZE));
+        if (memcmp(mram, expected + each_dpu * REGION_SIZE, REGION_SIZE) != 0) {
+            fprintf(stderr, "%s: the MRAM of DPU %u differs from the segments\n", step, each_dpu);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void
+check_errors(struct dpu_set_t rank, struct dpu_transfer_mram_iovec *iovec_matrix, uint8_t *buffers)
+{
+    struct dpu_set_t dpu;
+    uint8_t expected[REGION_SIZE], mram[REGION_SIZE];
+
+    DPU_FOREACH (rank, dpu) {
+        dpu_transfer_iovec_matrix_clear_all(rank.list.ranks[0], iovec_matrix);
+
+        CHECK(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers + 8, 8, 8));
+        CHECK(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers + 32, 3, 32));
+
+        /* Overlaps with the end of the previous segment, the start of the next one, or covers one */
+        CHECK_ERROR(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers + 15, 2, 15),
+            DPU_ERR_INVALID_MRAM_ACCESS);
+        CHECK_ERROR(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers + 4, 5, 4),
+            DPU_ERR_INVALID_MRAM_ACCESS);
+        CHECK_ERROR(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers + 30, 9, 30),
+            DPU_ERR_INVALID_MRAM_ACCESS);
+        CHECK_ERROR(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers + 8, 8, 8),
+            DPU_ERR_INVALID_MRAM_ACCESS);
+
+        /* Out of the MRAM */
+        CHECK_ERROR(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers, 8, MRAM_SIZE - 3),
+            DPU_ERR_INVALID_MRAM_ACCESS);
+        CHECK_ERROR(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers, 1, MRAM_SIZE),
+            DPU_ERR_INVALID_MRAM_ACCESS);
+
+        CHECK_ERROR(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, NULL, 8, 64), DPU_ERR_INVALID_MEMORY_TRANSFER);
+
+        /* Touching segments do not overlap, and empty segments are ignored */
+        CHECK(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers + 16, 16, 16));
+        CHECK(dpu_transfer_iovec_matrix_add_segment(dpu.dpu, iovec_matrix, buffers + 48, 0, 48));
+
+        /* Only the accepted segments are written */
+        memset(expected, BACKGROUND, REGION_SIZE);
+        CHECK(dpu_copy_to_symbol(dpu, region, 0, expected, REGION_SIZE));
+        CHECK(dpu_copy_to_mrams_iovec(rank.list.ranks[0], iovec_matrix));
+        memcpy(expected + 8, buffers + 8, 27);
+
+        CHECK(dpu_copy_from_symbol(dpu, region, 0, mram, REGION_SIZE));
+        if (memcmp(mram, expected, REGION_SIZE) != 0) {
+            fprintf(stderr, "errors: the MRAM differs from the accepted segments\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int
+main(void)
+{
+    struct dpu_set_t set, rank, dpu;
+
+    CHECK(dpu_alloc(DPU_ALLOCATE_ALL, TEST_PROFILE, &set));
+
+    DPU_RANK_FOREACH (set, rank) {
+        struct dpu_transfer_mram_iovec *iovec_matrix;
+        uint8_t *sources, *background, *gathered, *expected;
+        uint32_t nr_dpus, each_dpu;
+
+        CHECK(dpu_get_nr_dpus(rank, &nr_dpus));
+
+        sources = malloc(nr_dpus * REGION_SIZE);
+        background = malloc(nr_dpus * REGION_SIZE);
+        gathered = malloc(nr_dpus * REGION_SIZE);
+        expected = malloc(nr_dpus * REGION_SIZE);
+        if ((sources == NULL) || (background == NULL) || (gathered == NULL) || (expected == NULL)) {
+            return EXIT_FAILURE;
+        }
+
+        for (uint32_t each_byte = 0; each_byte < nr_dpus * REGION_SIZE; ++each_byte) {
+            sources[each_byte] = (uint8_t)(each_byte * 13 + 1);
+        }
+        memset(background, BACKGROUND, nr_dpus * REGION_SIZE);
+
+        DPU_FOREACH (rank, dpu, each_dpu) {
+            CHECK(dpu_copy_to_symbol(dpu, region, 0, background + each_dpu * REGION_SIZE, REGION_SIZE));
+        }
+
+        CHECK(dpu_transfer_iovec_matrix_allocate(rank.list.ranks[0], &iovec_matrix));
+
+        add_segments(rank, iovec_matrix, sources);
+        CHECK(dpu_copy_to_mrams_iovec(rank.list.ranks[0], iovec_matrix));
+        build_expected(expected, nr_dpus, sources, background);
+        check_mrams("scatter", rank, expected);
+
+        /* The gather goes to a host buffer whose other bytes must stay as they are */
+        memset(gathered, 0, nr_dpus * REGION_SIZE);
+        dpu_transfer_iovec_matrix_clear_all(rank.list.ranks[0], iovec_matrix);
+        add_segments(rank, iovec_matrix, gathered);
+        CHECK(dpu_copy_from_mrams_iovec(rank.list.ranks[0], iovec_matrix));
+        memset(background, 0, nr_dpus * REGION_SIZE);
+        build_expected(expected, nr_dpus, sources, background);
+        if (memcmp(gathered, expected, nr_dpus * REGION_SIZE) != 0) {
+            fprintf(stderr, "gather: the host buffers differ from the segments\n");
+            return EXIT_FAILURE;
+        }
+
+        check_errors(rank, iovec_matrix, sources);
+
+        dpu_transfer_iovec_matrix_free(rank.list.ranks[0], iovec_matrix);
+
+        free(expected);
+        free(gathered);
+        free(background);
+        free(sources);
+    }
+
+    CHECK(dpu_free(set));
+
+    return EXIT_SUCCESS;
+}
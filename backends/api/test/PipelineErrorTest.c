@@ -0,0 +1,70 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Pipelines are created on a simulated DPU set with invalid arguments: a single DPU instead of ranks, empty slots, and
+ * slot or sequence symbols which do not exist since no program is loaded. Each creation must fail with its own error
+ * and leave the handle untouched.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <dpu.h>
+
+#define TEST_PROFILE "backend=simulator,disableResetOnAlloc=true"
+
+#define SLOTS_SYMBOL_NAME "slots"
+#define SEQUENCE_SYMBOL_NAME "sequence"
+#define SLOT_SIZE 1024
+#define NR_SLOTS 2
+
+#define CHECK(call)                                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != DPU_OK) {                                                                                                 \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+#define CHECK_ERROR(call, expected)                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != (expected)) {                                                                                             \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+        if (pipeline != NULL) {                                                                                                  \
+            fprintf(stderr, "%s:%d: %s: the handle was set\n", __FILE__, __LINE__, #call);                                       \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+int
+main(void)
+{
+    struct dpu_set_t set, dpu;
+    struct dpu_pipeline_t *pipeline = NULL;
+
+    CHECK(dpu_alloc(DPU_ALLOCATE_ALL, TEST_PROFILE, &set));
+
+    DPU_FOREACH (set, dpu) {
+        CHECK_ERROR(dpu_pipeline_create(dpu, SLOTS_SYMBOL_NAME, SLOT_SIZE, NR_SLOTS, SEQUENCE_SYMBOL_NAME, &pipeline),
+            DPU_ERR_INVALID_DPU_SET);
+        break;
+    }
+
+    CHECK_ERROR(dpu_pipeline_create(set, SLOTS_SYMBOL_NAME, 0, NR_SLOTS, SEQUENCE_SYMBOL_NAME, &pipeline),
+        DPU_ERR_INVALID_SYMBOL_ACCESS);
+    CHECK_ERROR(dpu_pipeline_create(set, SLOTS_SYMBOL_NAME, SLOT_SIZE, 0, SEQUENCE_SYMBOL_NAME, &pipeline),
+        DPU_ERR_INVALID_SYMBOL_ACCESS);
+    CHECK_ERROR(dpu_pipeline_create(set, SLOTS_SYMBOL_NAME, SLOT_SIZE, NR_SLOTS, SEQUENCE_SYMBOL_NAME, &pipeline),
+        DPU_ERR_UNKNOWN_SYMBOL);
+
+    CHECK(dpu_free(set));
+
+    return EXIT_SUCCESS;
+}
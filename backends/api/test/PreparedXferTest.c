@@ -0,0 +1,175 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Prepared transfers are pushed several times to the MRAM and the WRAM of a simulated DPU set. Each push must send the
+ * contents of the host buffers at the time of the push, even when they changed since the transfer was prepared. A
+ * prepared transfer freed and created again on the same buffers, with another offset and length, must not reuse what
+ * was captured by the first one. Invalid sets, directions and accesses are rejected without creating a transfer.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <dpu.h>
+
+#define TEST_PROFILE "backend=simulator,disableResetOnAlloc=true"
+
+#define SIZE_PER_DPU 512
+#define PARTIAL_OFFSET 72
+#define PARTIAL_LENGTH 200
+
+#define CHECK(call)                                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != DPU_OK) {                                                                                                 \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+#define CHECK_ERROR(call, expected)                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != (expected)) {                                                                                             \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+static const struct {
+    const char *name;
+    struct dpu_symbol_t symbol;
+} memories[] = {
+    { "MRAM", { .address = 0x08000000, .size = SIZE_PER_DPU } },
+    { "WRAM", { .address = 0x00000000, .size = SIZE_PER_DPU } },
+};
+
+static void
+fill_buffers(uint8_t *buffers, uint32_t nr_dpus, uint8_t round)
+{
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        for (uint32_t each_byte = 0; each_byte < SIZE_PER_DPU; ++each_byte) {
+            buffers[each_dpu * SIZE_PER_DPU + each_byte] = (uint8_t)(each_dpu * 7 + each_byte + round * 31);
+        }
+    }
+}
+
+static struct dpu_prepared_xfer_t *
+prepare(struct dpu_set_t set, dpu_xfer_t xfer, struct dpu_symbol_t symbol, uint32_t offset, size_t length, uint8_t *buffers)
+{
+    struct dpu_set_t dpu;
+    struct dpu_prepared_xfer_t *prepared_xfer;
+    uint32_t each_dpu;
+
+    DPU_FOREACH (set, dpu, each_dpu) {
+        CHECK(dpu_prepare_xfer(dpu, buffers + each_dpu * SIZE_PER_DPU + offset));
+    }
+    CHECK(dpu_prepared_xfer_create_symbol(set, xfer, symbol, offset, length, &prepared_xfer));
+
+    return prepared_xfer;
+}
+
+/* Reads the DPUs back both with the prepared transfer and DPU by DPU */
+static void
+check_dpus(const char *memory,
+    struct dpu_set_t set,
+    struct dpu_symbol_t symbol,
+    struct dpu_prepared_xfer_t *read_back,
+    uint8_t *read_buffers,
+    const uint8_t *expected,
+    uint32_t nr_dpus)
+{
+    struct dpu_set_t dpu;
+    uint8_t dpu_buffer[SIZE_PER_DPU];
+    uint32_t each_dpu;
+
+    memset(read_buffers, 0, nr_dpus * SIZE_PER_DPU);
+    CHECK(dpu_prepared_xfer_push(read_back));
+
+    DPU_FOREACH (set, dpu, each_dpu) {
+        CHECK(dpu_copy_from_symbol(dpu, symbol, 0, dpu_buffer, SIZE_PER_DPU));
+
+        if ((memcmp(read_buffers + each_dpu * SIZE_PER_DPU, expected + each_dpu * SIZE_PER_DPU, SIZE_PER_DPU) != 0)
+            || (memcmp(dpu_buffer, expected + each_dpu * SIZE_PER_DPU, SIZE_PER_DPU) != 0)) {
+            fprintf(stderr, "%s: the contents of DPU %u differ from the last push\n", memory, each_dpu);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int
+main(void)
+{
+    struct dpu_set_t set, dpu;
+    struct dpu_prepared_xfer_t *push, *read_back, *invalid = NULL;
+    uint8_t *buffers, *read_buffers, *expected;
+    uint32_t nr_dpus;
+
+    CHECK(dpu_alloc(DPU_ALLOCATE_ALL, TEST_PROFILE, &set));
+    CHECK(dpu_get_nr_dpus(set, &nr_dpus));
+
+    buffers = malloc(nr_dpus * SIZE_PER_DPU);
+    read_buffers = malloc(nr_dpus * SIZE_PER_DPU);
+    expected = malloc(nr_dpus * SIZE_PER_DPU);
+    if ((buffers == NULL) || (read_buffers == NULL) || (expected == NULL)) {
+        return EXIT_FAILURE;
+    }
+
+    for (uint32_t each_memory = 0; each_memory < sizeof(memories) / sizeof(memories[0]); ++each_memory) {
+        const char *memory = memories[each_memory].name;
+        struct dpu_symbol_t symbol = memories[each_memory].symbol;
+
+        read_back = prepare(set, DPU_XFER_FROM_DPU, symbol, 0, SIZE_PER_DPU, read_buffers);
+        push = prepare(set, DPU_XFER_TO_DPU, symbol, 0, SIZE_PER_DPU, buffers);
+
+        /* The same prepared transfer pushes whatever the buffers hold */
+        for (uint8_t round = 0; round < 3; ++round) {
+            fill_buffers(buffers, nr_dpus, round);
+            memcpy(expected, buffers, nr_dpus * SIZE_PER_DPU);
+            CHECK(dpu_prepared_xfer_push(push));
+            check_dpus(memory, set, symbol, read_back, read_buffers, expected, nr_dpus);
+        }
+        CHECK(dpu_prepared_xfer_free(push));
+
+        /* Same buffers, another part of them */
+        fill_buffers(buffers, nr_dpus, 3);
+        push = prepare(set, DPU_XFER_TO_DPU, symbol, PARTIAL_OFFSET, PARTIAL_LENGTH, buffers);
+        for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+            memcpy(expected + each_dpu * SIZE_PER_DPU + PARTIAL_OFFSET,
+                buffers + each_dpu * SIZE_PER_DPU + PARTIAL_OFFSET,
+                PARTIAL_LENGTH);
+        }
+        CHECK(dpu_prepared_xfer_push(push));
+        check_dpus(memory, set, symbol, read_back, read_buffers, expected, nr_dpus);
+        CHECK(dpu_prepared_xfer_free(push));
+
+        CHECK(dpu_prepared_xfer_free(read_back));
+    }
+
+    DPU_FOREACH (set, dpu) {
+        CHECK_ERROR(dpu_prepared_xfer_create_symbol(dpu, DPU_XFER_TO_DPU, memories[0].symbol, 0, SIZE_PER_DPU, &invalid),
+            DPU_ERR_INVALID_DPU_SET);
+        break;
+    }
+    CHECK_ERROR(dpu_prepared_xfer_create_symbol(set, (dpu_xfer_t)42, memories[0].symbol, 0, SIZE_PER_DPU, &invalid),
+        DPU_ERR_INVALID_MEMORY_TRANSFER);
+    CHECK_ERROR(dpu_prepared_xfer_create_symbol(set, DPU_XFER_TO_DPU, memories[0].symbol, 8, SIZE_PER_DPU, &invalid),
+        DPU_ERR_INVALID_SYMBOL_ACCESS);
+    CHECK_ERROR(dpu_prepared_xfer_create(set, DPU_XFER_TO_DPU, "buffer", 0, SIZE_PER_DPU, &invalid), DPU_ERR_UNKNOWN_SYMBOL);
+    if (invalid != NULL) {
+        fprintf(stderr, "a prepared transfer was created from invalid arguments\n");
+        return EXIT_FAILURE;
+    }
+
+    CHECK(dpu_free(set));
+
+    free(expected);
+    free(read_buffers);
+    free(buffers);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,69 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Symbols are looked up by name on a simulated DPU set where no program is loaded. Every lookup, on the set, on one of
+ * its ranks or on one of its DPUs, must fail with DPU_ERR_UNKNOWN_SYMBOL, and the transfers by symbol name must report
+ * the same error instead of looking into a program which does not exist.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <dpu.h>
+
+#define TEST_PROFILE "backend=simulator,disableResetOnAlloc=true"
+
+#define SYMBOL_NAME "buffer"
+#define BUFFER_SIZE 64
+
+#define CHECK(call)                                                                                                              \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != DPU_OK) {                                                                                                 \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+#define CHECK_UNKNOWN_SYMBOL(call)                                                                                               \
+    do {                                                                                                                         \
+        dpu_error_t _status = (call);                                                                                            \
+        if (_status != DPU_ERR_UNKNOWN_SYMBOL) {                                                                                 \
+            fprintf(stderr, "%s:%d: %s: %s\n", __FILE__, __LINE__, #call, dpu_error_to_string(_status));                         \
+            exit(EXIT_FAILURE);                                                                                                  \
+        }                                                                                                                        \
+    } while (0)
+
+int
+main(void)
+{
+    struct dpu_set_t set, rank, dpu;
+    struct dpu_symbol_t symbol;
+    uint8_t buffer[BUFFER_SIZE] = { 0 };
+
+    CHECK(dpu_alloc(DPU_ALLOCATE_ALL, TEST_PROFILE, &set));
+
+    CHECK_UNKNOWN_SYMBOL(dpu_get_set_symbol(set, SYMBOL_NAME, &symbol));
+    CHECK_UNKNOWN_SYMBOL(dpu_get_symbol(NULL, SYMBOL_NAME, &symbol));
+
+    CHECK_UNKNOWN_SYMBOL(dpu_copy_to(set, SYMBOL_NAME, 0, buffer, sizeof(buffer)));
+
+    DPU_RANK_FOREACH (set, rank) {
+        CHECK_UNKNOWN_SYMBOL(dpu_get_set_symbol(rank, SYMBOL_NAME, &symbol));
+        CHECK_UNKNOWN_SYMBOL(dpu_copy_to(rank, SYMBOL_NAME, 0, buffer, sizeof(buffer)));
+    }
+
+    DPU_FOREACH (set, dpu) {
+        CHECK_UNKNOWN_SYMBOL(dpu_get_set_symbol(dpu, SYMBOL_NAME, &symbol));
+        CHECK_UNKNOWN_SYMBOL(dpu_copy_from(dpu, SYMBOL_NAME, 0, buffer, sizeof(buffer)));
+        CHECK(dpu_prepare_xfer(dpu, buffer));
+    }
+    CHECK_UNKNOWN_SYMBOL(dpu_push_xfer(set, DPU_XFER_TO_DPU, SYMBOL_NAME, 0, sizeof(buffer), DPU_XFER_DEFAULT));
+
+    CHECK(dpu_free(set));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Compares the MRAM bandwidth of the transfers using one malloc'd buffer for each DPU with the transfers using the
+ * slots of a buffer allocated by dpu_host_buffer_alloc. The first read goes to freshly allocated buffers, and
+ * includes the cost of faulting the malloc'd buffers in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <dpu.h>
+#include <dpu_management.h>
+#include <dpu_memory.h>
+#include <dpu_transfer_mram.h>
+
+#define NR_WARMUP_TRANSFERS 2
+#define DEFAULT_NR_DPUS 64
+#define DEFAULT_TRANSFER_SIZE (8 << 20)
+#define DEFAULT_NR_TRANSFERS 10
+
+struct bench_run {
+    struct dpu_set_t set;
+    uint32_t nr_ranks;
+    uint32_t nr_dpus;
+    uint32_t transfer_size;
+    /* Host buffer of each DPU, in the DPU_FOREACH order of the set */
+    uint8_t **buffers;
+    struct dpu_transfer_mram **matrices;
+};
+
+static double
+now_in_us(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s [<nr_dpus> (default: %u)] [<transfer_size> (default: %u)] [<nr_transfers> (default: %u)]\n",
+        program,
+        DEFAULT_NR_DPUS,
+        DEFAULT_TRANSFER_SIZE,
+        DEFAULT_NR_TRANSFERS);
+    exit(EXIT_FAILURE);
+}
+
+static void
+build_matrices(struct bench_run *run)
+{
+    struct dpu_set_t rank_set, dpu;
+    uint32_t each_rank, first_dpu = 0;
+
+    DPU_RANK_FOREACH (run->set, rank_set, each_rank) {
+        uint32_t each_dpu;
+
+        DPU_ASSERT(dpu_transfer_matrix_allocate(rank_set.list.ranks[0], &run->matrices[each_rank]));
+        DPU_FOREACH (rank_set, dpu, each_dpu) {
+            DPU_ASSERT(dpu_transfer_matrix_add_dpu(
+                dpu.dpu, run->matrices[each_rank], run->buffers[first_dpu + each_dpu], run->transfer_size, 0, DPU_PRIMARY_MRAM));
+        }
+        first_dpu += each_dpu;
+    }
+}
+
+static void
+free_matrices(struct bench_run *run)
+{
+    for (uint32_t each_rank = 0; each_rank < run->nr_ranks; ++each_rank) {
+        dpu_transfer_matrix_free(run->set.list.ranks[each_rank], run->matrices[each_rank]);
+    }
+}
+
+static double
+time_transfers(struct bench_run *run, dpu_xfer_t xfer, uint32_t nr_transfers)
+{
+    double time = now_in_us();
+
+    for (uint32_t each_transfer = 0; each_transfer < nr_transfers; ++each_transfer) {
+        for (uint32_t each_rank = 0; each_rank < run->nr_ranks; ++each_rank) {
+            struct dpu_rank_t *rank = run->set.list.ranks[each_rank];
+
+            if (xfer == DPU_XFER_TO_DPU) {
+                DPU_ASSERT(dpu_copy_to_mrams(rank, run->matrices[each_rank]));
+            } else {
+                DPU_ASSERT(dpu_copy_from_mrams(rank, run->matrices[each_rank]));
+            }
+        }
+    }
+
+    return now_in_us() - time;
+}
+
+static void
+measure(struct bench_run *run, const char *name, uint32_t nr_transfers)
+{
+    double nr_bytes = (double)run->nr_dpus * run->transfer_size;
+    double first_read_time, write_time, read_time;
+
+    build_matrices(run);
+
+    first_read_time = time_transfers(run, DPU_XFER_FROM_DPU, 1);
+
+    for (uint32_t each_dpu = 0; each_dpu < run->nr_dpus; ++each_dpu) {
+        memset(run->buffers[each_dpu], (int)each_dpu, run->transfer_size);
+    }
+    time_transfers(run, DPU_XFER_TO_DPU, NR_WARMUP_TRANSFERS);
+    time_transfers(run, DPU_XFER_FROM_DPU, NR_WARMUP_TRANSFERS);
+
+    write_time = time_transfers(run, DPU_XFER_TO_DPU, nr_transfers);
+    read_time = time_transfers(run, DPU_XFER_FROM_DPU, nr_transfers);
+
+    free_matrices(run);
+
+    /* Bytes per microsecond are MB/s */
+    printf("%-12s %14.1f %14.1f %16.1f\n",
+        name,
+        nr_bytes * nr_transfers / write_time,
+        nr_bytes * nr_transfers / read_time,
+        nr_bytes / first_read_time);
+}
+
+int
+main(int argc, char **argv)
+{
+    struct bench_run run = { .transfer_size = DEFAULT_TRANSFER_SIZE };
+    uint32_t nr_dpus = DEFAULT_NR_DPUS;
+    uint32_t nr_transfers = DEFAULT_NR_TRANSFERS;
+    uint8_t *host_buffer;
+
+    if (argc > 4) {
+        exit_usage(argv[0]);
+    }
+    if (argc > 1) {
+        nr_dpus = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        run.transfer_size = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3) {
+        nr_transfers = (uint32_t)strtoul(argv[3], NULL, 0);
+    }
+    if ((nr_dpus == 0) || (run.transfer_size == 0) || ((run.transfer_size % 8) != 0) || (nr_transfers == 0)) {
+        exit_usage(argv[0]);
+    }
+
+    DPU_ASSERT(dpu_alloc(nr_dpus, NULL, &run.set));
+    DPU_ASSERT(dpu_get_nr_ranks(run.set, &run.nr_ranks));
+    DPU_ASSERT(dpu_get_nr_dpus(run.set, &run.nr_dpus));
+
+    run.buffers = calloc(run.nr_dpus, sizeof(*run.buffers));
+    run.matrices = calloc(run.nr_ranks, sizeof(*run.matrices));
+    if ((run.buffers == NULL) || (run.matrices == NULL)) {
+        fprintf(stderr, "cannot allocate buffers\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%u DPUs in %u ranks, %u bytes per DPU, %u transfers\n", run.nr_dpus, run.nr_ranks, run.transfer_size, nr_transfers);
+    printf("%-12s %14s %14s %16s\n", "buffers", "write(MB/s)", "read(MB/s)", "first read(MB/s)");
+
+    for (uint32_t each_dpu = 0; each_dpu < run.nr_dpus; ++each_dpu) {
+        if ((run.buffers[each_dpu] = malloc(run.transfer_size)) == NULL) {
+            fprintf(stderr, "cannot allocate buffers\n");
+            return EXIT_FAILURE;
+        }
+    }
+    measure(&run, "malloc", nr_transfers);
+    for (uint32_t each_dpu = 0; each_dpu < run.nr_dpus; ++each_dpu) {
+        free(run.buffers[each_dpu]);
+    }
+
+    DPU_ASSERT(dpu_host_buffer_alloc(run.set, run.transfer_size, (void **)&host_buffer));
+    for (uint32_t each_dpu = 0; each_dpu < run.nr_dpus; ++each_dpu) {
+        run.buffers[each_dpu] = host_buffer + each_dpu * DPU_HOST_BUFFER_STRIDE(run.transfer_size);
+    }
+    measure(&run, "host buffer", nr_transfers);
+    DPU_ASSERT(dpu_host_buffer_free(host_buffer));
+
+    DPU_ASSERT(dpu_free(run.set));
+
+    free(run.matrices);
+    free(run.buffers);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Compares the sustained throughput of a stream of batches run with the serial pattern (push the input of all the
+ * ranks, launch, sync, fetch the results) and with dpu_pipeline_run, where each rank is drained, filled and launched
+ * again as soon as it is done.
+ *
+ * The DPU program must define the staging slots and the sequence number of the batch, and process in place the slot
+ * given by the sequence number:
+ *
+ *     __mram_noinit uint8_t pipeline_slots[NR_SLOTS][SLOT_SIZE];
+ *     __host uint32_t pipeline_sequence;
+ *
+ * with at least the number of slots and the slot size given to the benchmark.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <dpu.h>
+
+#define SLOTS_SYMBOL "pipeline_slots"
+#define SEQUENCE_SYMBOL "pipeline_sequence"
+
+#define NR_WARMUP_BATCHES 2
+#define DEFAULT_NR_DPUS 64
+#define DEFAULT_SLOT_SIZE (1 << 20)
+#define DEFAULT_NR_SLOTS 2
+#define DEFAULT_NR_BATCHES 20
+
+struct bench_buffers {
+    uint32_t slot_size;
+    uint32_t nr_slots;
+    /* One input and one output buffer for each DPU, in the DPU_FOREACH order of the set */
+    uint8_t **inputs;
+    uint8_t **outputs;
+    /* Index of the first DPU of each rank */
+    uint32_t *first_dpus;
+};
+
+static double
+now_in_us(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s <dpu_program_path> [<nr_dpus> (default: %u)] [<slot_size> (default: %u)] [<nr_slots> (default: %u)] "
+        "[<nr_batches> (default: %u)]\n",
+        program,
+        DEFAULT_NR_DPUS,
+        DEFAULT_SLOT_SIZE,
+        DEFAULT_NR_SLOTS,
+        DEFAULT_NR_BATCHES);
+    exit(EXIT_FAILURE);
+}
+
+static void
+fill_input(uint8_t *input, uint32_t size, uint32_t batch)
+{
+    memset(input, (int)(batch & 0xff), size);
+}
+
+static dpu_error_t
+fill_rank(struct dpu_set_t rank_set, uint32_t rank_index, uint32_t batch, void *args)
+{
+    struct bench_buffers *buffers = args;
+    struct dpu_set_t dpu;
+    uint32_t each_dpu;
+    dpu_error_t status;
+
+    DPU_FOREACH (rank_set, dpu, each_dpu) {
+        uint8_t *input = buffers->inputs[buffers->first_dpus[rank_index] + each_dpu];
+
+        fill_input(input, buffers->slot_size, batch);
+        if ((status = dpu_prepare_xfer(dpu, input)) != DPU_OK) {
+            return status;
+        }
+    }
+
+    return DPU_OK;
+}
+
+static dpu_error_t
+drain_rank(struct dpu_set_t rank_set, uint32_t rank_index, uint32_t batch, void *args)
+{
+    struct bench_buffers *buffers = args;
+    struct dpu_set_t dpu;
+    uint32_t each_dpu;
+    dpu_error_t status;
+
+    DPU_FOREACH (rank_set, dpu, each_dpu) {
+        if ((status = dpu_prepare_xfer(dpu, buffers->outputs[buffers->first_dpus[rank_index] + each_dpu])) != DPU_OK) {
+            return status;
+        }
+    }
+
+    return dpu_push_xfer(rank_set,
+        DPU_XFER_FROM_DPU,
+        SLOTS_SYMBOL,
+        (batch % buffers->nr_slots) * buffers->slot_size,
+        buffers->slot_size,
+        DPU_XFER_DEFAULT);
+}
+
+static void
+run_serial(struct dpu_set_t set, struct bench_buffers *buffers, uint32_t first_batch, uint32_t nr_batches)
+{
+    struct dpu_set_t dpu;
+    uint32_t each_dpu;
+
+    for (uint32_t batch = first_batch; batch < first_batch + nr_batches; ++batch) {
+        uint32_t slot_offset = (batch % buffers->nr_slots) * buffers->slot_size;
+
+        DPU_FOREACH (set, dpu, each_dpu) {
+            fill_input(buffers->inputs[each_dpu], buffers->slot_size, batch);
+            DPU_ASSERT(dpu_prepare_xfer(dpu, buffers->inputs[each_dpu]));
+        }
+        DPU_ASSERT(dpu_push_xfer(set, DPU_XFER_TO_DPU, SLOTS_SYMBOL, slot_offset, buffers->slot_size, DPU_XFER_DEFAULT));
+        DPU_ASSERT(dpu_copy_to(set, SEQUENCE_SYMBOL, 0, &batch, sizeof(batch)));
+
+        DPU_ASSERT(dpu_launch(set, DPU_SYNCHRONOUS));
+
+        DPU_FOREACH (set, dpu, each_dpu) {
+            DPU_ASSERT(dpu_prepare_xfer(dpu, buffers->outputs[each_dpu]));
+        }
+        DPU_ASSERT(dpu_push_xfer(set, DPU_XFER_FROM_DPU, SLOTS_SYMBOL, slot_offset, buffers->slot_size, DPU_XFER_DEFAULT));
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *binary;
+    uint32_t nr_dpus = DEFAULT_NR_DPUS;
+    uint32_t nr_batches = DEFAULT_NR_BATCHES;
+    struct bench_buffers buffers = { .slot_size = DEFAULT_SLOT_SIZE, .nr_slots = DEFAULT_NR_SLOTS };
+    struct dpu_set_t set, rank_set;
+    struct dpu_pipeline_t *pipeline;
+    uint32_t nr_allocated_dpus, nr_ranks, each_rank, first_dpu = 0;
+    double serial_time, pipeline_time, nr_megabytes;
+
+    if ((argc < 2) || (argc > 6)) {
+        exit_usage(argv[0]);
+    }
+    binary = argv[1];
+    if (argc > 2) {
+        nr_dpus = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3) {
+        buffers.slot_size = (uint32_t)strtoul(argv[3], NULL, 0);
+    }
+    if (argc > 4) {
+        buffers.nr_slots = (uint32_t)strtoul(argv[4], NULL, 0);
+    }
+    if (argc > 5) {
+        nr_batches = (uint32_t)strtoul(argv[5], NULL, 0);
+    }
+    if ((nr_dpus == 0) || (buffers.slot_size == 0) || ((buffers.slot_size % 8) != 0) || (buffers.nr_slots == 0)
+        || (nr_batches == 0)) {
+        exit_usage(argv[0]);
+    }
+
+    DPU_ASSERT(dpu_alloc(nr_dpus, NULL, &set));
+    DPU_ASSERT(dpu_load(set, binary, NULL));
+    DPU_ASSERT(dpu_get_nr_dpus(set, &nr_allocated_dpus));
+    DPU_ASSERT(dpu_get_nr_ranks(set, &nr_ranks));
+
+    buffers.inputs = calloc(nr_allocated_dpus, sizeof(*buffers.inputs));
+    buffers.outputs = calloc(nr_allocated_dpus, sizeof(*buffers.outputs));
+    buffers.first_dpus = malloc(nr_ranks * sizeof(*buffers.first_dpus));
+    if ((buffers.inputs == NULL) || (buffers.outputs == NULL) || (buffers.first_dpus == NULL)) {
+        fprintf(stderr, "cannot allocate buffers\n");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t each_dpu = 0; each_dpu < nr_allocated_dpus; ++each_dpu) {
+        if (((buffers.inputs[each_dpu] = malloc(buffers.slot_size)) == NULL)
+            || ((buffers.outputs[each_dpu] = malloc(buffers.slot_size)) == NULL)) {
+            fprintf(stderr, "cannot allocate buffers\n");
+            return EXIT_FAILURE;
+        }
+    }
+    DPU_RANK_FOREACH (set, rank_set, each_rank) {
+        uint32_t nr_rank_dpus;
+
+        DPU_ASSERT(dpu_get_nr_dpus(rank_set, &nr_rank_dpus));
+        buffers.first_dpus[each_rank] = first_dpu;
+        first_dpu += nr_rank_dpus;
+    }
+
+    DPU_ASSERT(dpu_pipeline_create(set, SLOTS_SYMBOL, buffers.slot_size, buffers.nr_slots, SEQUENCE_SYMBOL, &pipeline));
+
+    run_serial(set, &buffers, 0, NR_WARMUP_BATCHES);
+    DPU_ASSERT(dpu_pipeline_run(pipeline, NR_WARMUP_BATCHES, fill_rank, drain_rank, &buffers));
+
+    serial_time = now_in_us();
+    run_serial(set, &buffers, 0, nr_batches);
+    serial_time = now_in_us() - serial_time;
+
+    pipeline_time = now_in_us();
+    DPU_ASSERT(dpu_pipeline_run(pipeline, nr_batches, fill_rank, drain_rank, &buffers));
+    pipeline_time = now_in_us() - pipeline_time;
+
+    /* Input and results of every batch, for every DPU */
+    nr_megabytes = 2.0 * nr_allocated_dpus * buffers.slot_size * nr_batches / 1e6;
+
+    printf("%u DPUs in %u ranks, %u slots of %u bytes, %u batches\n",
+        nr_allocated_dpus,
+        nr_ranks,
+        buffers.nr_slots,
+        buffers.slot_size,
+        nr_batches);
+    printf("%-10s %14s %14s\n", "pattern", "batches/s", "MB/s");
+    printf("%-10s %14.1f %14.1f\n", "serial", nr_batches / (serial_time / 1e6), nr_megabytes / (serial_time / 1e6));
+    printf("%-10s %14.1f %14.1f\n", "pipeline", nr_batches / (pipeline_time / 1e6), nr_megabytes / (pipeline_time / 1e6));
+    printf("speedup: %.2fx\n", serial_time / pipeline_time);
+
+    DPU_ASSERT(dpu_pipeline_free(pipeline));
+    DPU_ASSERT(dpu_free(set));
+
+    for (uint32_t each_dpu = 0; each_dpu < nr_allocated_dpus; ++each_dpu) {
+        free(buffers.inputs[each_dpu]);
+        free(buffers.outputs[each_dpu]);
+    }
+    free(buffers.first_dpus);
+    free(buffers.outputs);
+    free(buffers.inputs);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Measures the cost of MRAM transfers where each DPU has its own size and offset, compared with the uniform case
+ * where every DPU of the rank transfers the same aligned range. The reported throughput only counts the bytes
+ * requested by the host.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <dpu.h>
+#include <dpu_management.h>
+#include <dpu_memory.h>
+#include <dpu_transfer_mram.h>
+
+#define NR_WARMUP_TRANSFERS 2
+#define DEFAULT_TRANSFER_SIZE (1 << 20)
+#define DEFAULT_NR_TRANSFERS 20
+
+struct xfer_shape {
+    const char *name;
+    /* The DPU index is its position in the rank */
+    uint32_t (*offset)(uint32_t dpu_index);
+    uint32_t (*size)(uint32_t dpu_index, uint32_t transfer_size);
+};
+
+static uint32_t
+offset_zero(__attribute__((unused)) uint32_t dpu_index)
+{
+    return 0;
+}
+
+static uint32_t
+offset_unaligned(__attribute__((unused)) uint32_t dpu_index)
+{
+    return 4;
+}
+
+static uint32_t
+offset_per_dpu(uint32_t dpu_index)
+{
+    return (dpu_index % 8) * 64;
+}
+
+static uint32_t
+offset_per_dpu_unaligned(uint32_t dpu_index)
+{
+    return (dpu_index % 8) * 67;
+}
+
+static uint32_t
+size_uniform(__attribute__((unused)) uint32_t dpu_index, uint32_t transfer_size)
+{
+    return transfer_size;
+}
+
+static uint32_t
+size_per_dpu(uint32_t dpu_index, uint32_t transfer_size)
+{
+    return transfer_size - (dpu_index % 8) * (transfer_size / 16);
+}
+
+static uint32_t
+size_per_dpu_unaligned(uint32_t dpu_index, uint32_t transfer_size)
+{
+    return transfer_size - (dpu_index % 8) * 1021;
+}
+
+static const struct xfer_shape shapes[] = {
+    { "uniform", offset_zero, size_uniform },
+    { "unaligned", offset_unaligned, size_uniform },
+    { "offsets", offset_per_dpu, size_uniform },
+    { "sizes", offset_zero, size_per_dpu },
+    { "ragged", offset_per_dpu_unaligned, size_per_dpu_unaligned },
+};
+#define NR_SHAPES (sizeof(shapes) / sizeof(shapes[0]))
+
+static double
+now_in_us(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s [<transfer_size> (default: %u)] [<nr_transfers> (default: %u)]\n",
+        program,
+        DEFAULT_TRANSFER_SIZE,
+        DEFAULT_NR_TRANSFERS);
+    exit(EXIT_FAILURE);
+}
+
+static uint64_t
+prepare_matrix(struct dpu_set_t rank_set,
+    struct dpu_transfer_mram *matrix,
+    uint8_t **buffers,
+    const struct xfer_shape *shape,
+    uint32_t transfer_size)
+{
+    struct dpu_set_t dpu;
+    uint32_t each_dpu;
+    uint64_t nr_bytes = 0;
+
+    DPU_FOREACH (rank_set, dpu, each_dpu) {
+        uint32_t size = shape->size(each_dpu, transfer_size);
+
+        DPU_ASSERT(
+            dpu_transfer_matrix_add_dpu(dpu.dpu, matrix, buffers[each_dpu], size, shape->offset(each_dpu), DPU_PRIMARY_MRAM));
+        nr_bytes += size;
+    }
+
+    return nr_bytes;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t transfer_size = DEFAULT_TRANSFER_SIZE;
+    uint32_t nr_transfers = DEFAULT_NR_TRANSFERS;
+    struct dpu_set_t set, rank_set;
+    struct dpu_rank_t *rank;
+    struct dpu_transfer_mram *matrix;
+    uint8_t **buffers;
+    uint32_t nr_dpus;
+    double uniform_write = 0.0, uniform_read = 0.0;
+
+    if (argc > 3) {
+        exit_usage(argv[0]);
+    }
+    if (argc > 1) {
+        transfer_size = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        nr_transfers = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    /* The shapes shrink the transfers by up to 7 * 1021 bytes */
+    if ((transfer_size < 8 * 1024) || (nr_transfers == 0)) {
+        exit_usage(argv[0]);
+    }
+
+    DPU_ASSERT(dpu_alloc(DPU_ALLOCATE_ALL, NULL, &set));
+    DPU_RANK_FOREACH (set, rank_set) {
+        break;
+    }
+    rank = rank_set.list.ranks[0];
+    DPU_ASSERT(dpu_get_nr_dpus(rank_set, &nr_dpus));
+
+    if ((buffers = calloc(nr_dpus, sizeof(*buffers))) == NULL) {
+        fprintf(stderr, "cannot allocate buffers\n");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        if ((buffers[each_dpu] = malloc(transfer_size)) == NULL) {
+            fprintf(stderr, "cannot allocate buffers\n");
+            return EXIT_FAILURE;
+        }
+        memset(buffers[each_dpu], (int)each_dpu, transfer_size);
+    }
+
+    DPU_ASSERT(dpu_transfer_matrix_allocate(rank, &matrix));
+
+    printf("%-10s %14s %10s %14s %10s\n", "shape", "write(MB/s)", "vs uniform", "read(MB/s)", "vs uniform");
+
+    for (unsigned int each_shape = 0; each_shape < NR_SHAPES; ++each_shape) {
+        uint64_t nr_bytes;
+        double write_time, read_time, write_bw, read_bw;
+
+        dpu_transfer_matrix_clear_all(rank, matrix);
+        nr_bytes = prepare_matrix(rank_set, matrix, buffers, &shapes[each_shape], transfer_size);
+
+        for (unsigned int each_transfer = 0; each_transfer < NR_WARMUP_TRANSFERS; ++each_transfer) {
+            DPU_ASSERT(dpu_copy_to_mrams(rank, matrix));
+            DPU_ASSERT(dpu_copy_from_mrams(rank, matrix));
+        }
+
+        write_time = now_in_us();
+        for (unsigned int each_transfer = 0; each_transfer < nr_transfers; ++each_transfer) {
+            DPU_ASSERT(dpu_copy_to_mrams(rank, matrix));
+        }
+        write_time = now_in_us() - write_time;
+
+        read_time = now_in_us();
+        for (unsigned int each_transfer = 0; each_transfer < nr_transfers; ++each_transfer) {
+            DPU_ASSERT(dpu_copy_from_mrams(rank, matrix));
+        }
+        read_time = now_in_us() - read_time;
+
+        /* Bytes per microsecond are MB/s */
+        write_bw = (double)(nr_bytes * nr_transfers) / write_time;
+        read_bw = (double)(nr_bytes * nr_transfers) / read_time;
+
+        if (each_shape == 0) {
+            uniform_write = write_bw;
+            uniform_read = read_bw;
+        }
+
+        printf("%-10s %14.1f %9.2fx %14.1f %9.2fx\n",
+            shapes[each_shape].name,
+            write_bw,
+            write_bw / uniform_write,
+            read_bw,
+            read_bw / uniform_read);
+    }
+
+    dpu_transfer_matrix_free(rank, matrix);
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        free(buffers[each_dpu]);
+    }
+    free(buffers);
+    DPU_ASSERT(dpu_free(set));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Compares the dpu_sync strategies: for each of them, the same program is launched several times and the benchmark
+ * reports the wall time from dpu_launch to the return of dpu_sync (the wake-up latency is its difference with the
+ * "spin" strategy) and the CPU time consumed by the waiting thread.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <dpu.h>
+
+#define NR_WARMUP_LAUNCHES 4
+#define DEFAULT_NR_DPUS 64
+#define DEFAULT_NR_LAUNCHES 100
+
+static const char *strategies[] = { "spin", "yield", "backoff", "adaptive" };
+#define NR_STRATEGIES (sizeof(strategies) / sizeof(strategies[0]))
+
+static double
+now_in_us(clockid_t clock)
+{
+    struct timespec time;
+
+    clock_gettime(clock, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static int
+compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s <dpu_program_path> [<nr_dpus> (default: %u)] [<nr_launches> (default: %u)]\n",
+        program,
+        DEFAULT_NR_DPUS,
+        DEFAULT_NR_LAUNCHES);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *binary;
+    uint32_t nr_dpus = DEFAULT_NR_DPUS;
+    uint32_t nr_launches = DEFAULT_NR_LAUNCHES;
+    double *wall_times, *cpu_times;
+    double spin_median = 0.0;
+
+    if ((argc < 2) || (argc > 4)) {
+        exit_usage(argv[0]);
+    }
+    binary = argv[1];
+    if (argc > 2) {
+        nr_dpus = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3) {
+        nr_launches = (uint32_t)strtoul(argv[3], NULL, 0);
+    }
+    if ((nr_dpus == 0) || (nr_launches == 0)) {
+        exit_usage(argv[0]);
+    }
+
+    wall_times = malloc(nr_launches * sizeof(*wall_times));
+    cpu_times = malloc(nr_launches * sizeof(*cpu_times));
+    if ((wall_times == NULL) || (cpu_times == NULL)) {
+        fprintf(stderr, "cannot allocate results\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%-10s %12s %12s %12s %14s %12s %8s\n",
+        "strategy",
+        "median(us)",
+        "p99(us)",
+        "max(us)",
+        "latency(us)",
+        "cpu(us)",
+        "cpu(%)");
+
+    for (unsigned int each_strategy = 0; each_strategy < NR_STRATEGIES; ++each_strategy) {
+        struct dpu_set_t set;
+        char profile[64];
+        double total_cpu = 0.0, total_wall = 0.0;
+
+        snprintf(profile, sizeof(profile), "syncStrategy=%s", strategies[each_strategy]);
+
+        DPU_ASSERT(dpu_alloc(nr_dpus, profile, &set));
+        DPU_ASSERT(dpu_load(set, binary, NULL));
+
+        /* Also lets the adaptive strategy learn the run time */
+        for (unsigned int each_launch = 0; each_launch < NR_WARMUP_LAUNCHES; ++each_launch) {
+            DPU_ASSERT(dpu_launch(set, DPU_SYNCHRONOUS));
+        }
+
+        for (unsigned int each_launch = 0; each_launch < nr_launches; ++each_launch) {
+            double wall_start = now_in_us(CLOCK_MONOTONIC);
+            DPU_ASSERT(dpu_launch(set, DPU_ASYNCHRONOUS));
+            double cpu_start = now_in_us(CLOCK_THREAD_CPUTIME_ID);
+            DPU_ASSERT(dpu_sync(set));
+            cpu_times[each_launch] = now_in_us(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+            wall_times[each_launch] = now_in_us(CLOCK_MONOTONIC) - wall_start;
+
+            total_cpu += cpu_times[each_launch];
+            total_wall += wall_times[each_launch];
+        }
+
+        DPU_ASSERT(dpu_free(set));
+
+        qsort(wall_times, nr_launches, sizeof(*wall_times), compare_doubles);
+
+        double median = wall_times[nr_launches / 2];
+        double p99 = wall_times[(nr_launches * 99) / 100];
+        double max = wall_times[nr_launches - 1];
+
+        if (each_strategy == 0) {
+            spin_median = median;
+        }
+
+        printf("%-10s %12.1f %12.1f %12.1f %14.1f %12.1f %8.1f\n",
+            strategies[each_strategy],
+            median,
+            p99,
+            max,
+            median - spin_median,
+            total_cpu / nr_launches,
+            100.0 * total_cpu / total_wall);
+    }
+
+    free(cpu_times);
+    free(wall_times);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Allocates 1, 8 and 40 ranks through hw_dpu_sysfs.c, as dpu_alloc does with the hw backend (the hardware chip id and
+ * description, then one available rank), over a mock libudev serving a fake sysfs tree of NR_REGIONS regions of
+ * NR_RANKS_PER_REGION ranks. The first NR_BUSY_RANKS_PER_REGION ranks of the first NR_BUSY_REGIONS regions are taken by
+ * another process. For each count, the best time of NR_REPETITIONS allocations is reported, with the number of
+ * enumerations, devices created, attributes read and device nodes opened per allocation.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <dpu_description.h>
+
+#include "hw_dpu_sysfs.h"
+#include "libudev.h"
+
+#define NR_REGIONS 8
+#define NR_RANKS_PER_REGION 8
+#define NR_BUSY_REGIONS 4
+#define NR_BUSY_RANKS_PER_REGION 2
+#define NR_REPETITIONS 20
+
+static const unsigned int nr_ranks_to_allocate[] = { 1, 8, 40 };
+
+static const struct {
+    const char *name;
+    const char *value;
+} rank_sysattrs[] = {
+    { "dpu_chip_id", "4" },
+    { "nb_ci", "8" },
+    { "nb_dpus_per_ci", "8" },
+    { "mram_size", "67108864" },
+    { "clock_division_min", "4" },
+    { "fck_frequency", "800" },
+    /* No PERF mode: the allocations do not look for a dax device */
+    { "capabilities", "0" },
+    { "ci_mapping", "0,1,2,3,4,5,6,7" },
+};
+
+static struct dpu_rank_fs rank_fs[NR_REGIONS * NR_RANKS_PER_REGION];
+
+static double
+now_in_ms(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e3 + (double)time.tv_nsec / 1e6;
+}
+
+static int
+write_file(const char *path, const char *contents)
+{
+    FILE *file;
+
+    if ((file = fopen(path, "w")) == NULL) {
+        fprintf(stderr, "cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fputs(contents, file);
+    fclose(file);
+
+    return 0;
+}
+
+static int
+create_fake_sysfs(const char *root)
+{
+    char path[PATH_MAX];
+
+    snprintf(path, sizeof(path), "%s/sys", root);
+    if (mkdir(path, 0755) != 0)
+        return -1;
+    snprintf(path, sizeof(path), "%s/dev", root);
+    if (mkdir(path, 0755) != 0)
+        return -1;
+
+    for (unsigned int each_region = 0; each_region < NR_REGIONS; ++each_region) {
+        snprintf(path, sizeof(path), "%s/sys/dpu_region%u", root, each_region);
+        if (mkdir(path, 0755) != 0)
+            return -1;
+        snprintf(path, sizeof(path), "%s/sys/dpu_region%u/numa_node", root, each_region);
+        if (write_file(path, each_region < (NR_REGIONS / 2) ? "0\n" : "1\n") != 0)
+            return -1;
+
+        for (unsigned int each_rank = 0; each_rank < NR_RANKS_PER_REGION; ++each_rank) {
+            snprintf(path, sizeof(path), "%s/sys/dpu_region%u/dpu_rank%u", root, each_region, each_rank);
+            if (mkdir(path, 0755) != 0)
+                return -1;
+
+            for (unsigned int each_sysattr = 0; each_sysattr < sizeof(rank_sysattrs) / sizeof(rank_sysattrs[0]); ++each_sysattr) {
+                snprintf(path,
+                    sizeof(path),
+                    "%s/sys/dpu_region%u/dpu_rank%u/%s",
+                    root,
+                    each_region,
+                    each_rank,
+                    rank_sysattrs[each_sysattr].name);
+                if (write_file(path, rank_sysattrs[each_sysattr].value) != 0)
+                    return -1;
+            }
+
+            snprintf(path, sizeof(path), "%s/dev/dpu_region%u_dpu_rank%u", root, each_region, each_rank);
+            if (write_file(path, "") != 0)
+                return -1;
+
+            if ((each_region < NR_BUSY_REGIONS) && (each_rank < NR_BUSY_RANKS_PER_REGION)) {
+                snprintf(path, sizeof(path), "%s/dev/dpu_region%u_dpu_rank%u.busy", root, each_region, each_rank);
+                if (write_file(path, "") != 0)
+                    return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void
+remove_fake_sysfs(const char *root)
+{
+    char *command;
+
+    if (asprintf(&command, "rm -rf '%s'", root) == -1)
+        return;
+    if (system(command) != 0)
+        fprintf(stderr, "cannot remove %s\n", root);
+    free(command);
+}
+
+static bool
+run_allocations(unsigned int nr_ranks)
+{
+    struct libudev_mock_stats start_stats, end_stats;
+    double best_time = 0.0;
+
+    libudev_mock_get_stats(&start_stats);
+
+    for (unsigned int each_repetition = 0; each_repetition < NR_REPETITIONS; ++each_repetition) {
+        double start, time;
+
+        start = now_in_ms();
+        for (unsigned int each_rank = 0; each_rank < nr_ranks; ++each_rank) {
+            static struct _dpu_description_t description;
+            uint8_t chip_id, capabilities;
+            int ret;
+
+            memset(&rank_fs[each_rank], 0, sizeof(rank_fs[each_rank]));
+            if ((dpu_sysfs_get_hardware_chip_id(&chip_id) != 0)
+                || (dpu_sysfs_get_hardware_description(&description, &capabilities) != 0)) {
+                fprintf(stderr, "cannot read the hardware description\n");
+                return false;
+            }
+            if ((ret = dpu_sysfs_get_available_rank("", -1, &rank_fs[each_rank])) != 0) {
+                fprintf(stderr, "%u ranks: allocation of rank %u failed: %s\n", nr_ranks, each_rank, strerror(-ret));
+                return false;
+            }
+        }
+        time = now_in_ms() - start;
+        if ((each_repetition == 0) || (time < best_time))
+            best_time = time;
+
+        for (unsigned int each_rank = 0; each_rank < nr_ranks; ++each_rank)
+            dpu_sysfs_free_rank(&rank_fs[each_rank]);
+    }
+
+    libudev_mock_get_stats(&end_stats);
+
+    printf("%6u %10.3f %14.1f %10.1f %12.1f %8.1f\n",
+        nr_ranks,
+        best_time,
+        (double)(end_stats.nr_enumerations - start_stats.nr_enumerations) / NR_REPETITIONS,
+        (double)(end_stats.nr_devices - start_stats.nr_devices) / NR_REPETITIONS,
+        (double)(end_stats.nr_sysattr_reads - start_stats.nr_sysattr_reads) / NR_REPETITIONS,
+        (double)(end_stats.nr_devnode_opens - start_stats.nr_devnode_opens) / NR_REPETITIONS);
+
+    return true;
+}
+
+int
+main(void)
+{
+    char root[] = "/tmp/dpu_sysfs_alloc_bench.XXXXXX";
+    bool success = true;
+
+    if (mkdtemp(root) == NULL) {
+        fprintf(stderr, "cannot create the fake sysfs: %s\n", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    if (create_fake_sysfs(root) != 0) {
+        remove_fake_sysfs(root);
+        return EXIT_FAILURE;
+    }
+    libudev_mock_set_root(root);
+
+    printf("%6s %10s %14s %10s %12s %8s\n", "ranks", "ms", "enumerations", "devices", "attr reads", "opens");
+
+    for (unsigned int each_count = 0; each_count < sizeof(nr_ranks_to_allocate) / sizeof(nr_ranks_to_allocate[0]); ++each_count)
+        success = run_allocations(nr_ranks_to_allocate[each_count]) && success;
+
+    remove_fake_sysfs(root);
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,167 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Compares the rank reset, the program load and the synchronous launch with and without the UFI planner ("ufiPlanner"
+ * profile property): for each of them, the median and the maximum times of several runs are reported. The reset is
+ * measured through dpu_alloc, which resets the ranks. The load and the launch are only measured when a DPU program is
+ * given. Any rank handler can be measured through the profile, for instance "backend=simulator".
+ */
+
+#define _GNU_SOURCE
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <dpu.h>
+
+#define NR_WARMUP_RUNS 2
+#define DEFAULT_NR_DPUS DPU_ALLOCATE_ALL
+#define DEFAULT_NR_RUNS 20
+
+enum bench_phase {
+    BENCH_RESET,
+    BENCH_LOAD,
+    BENCH_LAUNCH,
+    NR_BENCH_PHASES,
+};
+
+static const char *phase_names[NR_BENCH_PHASES] = { "reset", "load", "launch" };
+
+static double
+now_in_us(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static int
+compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s [-p <profile>] [-n <nr_dpus> (default: all)] [-r <nr_runs> (default: %u)] [<dpu_program_path>]\n",
+        program,
+        DEFAULT_NR_RUNS);
+    exit(EXIT_FAILURE);
+}
+
+static void
+run_phases(const char *profile, const char *binary, uint32_t nr_dpus, uint32_t nr_runs, double **times)
+{
+    for (uint32_t each_run = 0; each_run < NR_WARMUP_RUNS + nr_runs; ++each_run) {
+        struct dpu_set_t set;
+        double start;
+
+        start = now_in_us();
+        DPU_ASSERT(dpu_alloc(nr_dpus, profile, &set));
+        double reset_time = now_in_us() - start;
+
+        double load_time = 0.0, launch_time = 0.0;
+        if (binary != NULL) {
+            start = now_in_us();
+            DPU_ASSERT(dpu_load(set, binary, NULL));
+            load_time = now_in_us() - start;
+
+            start = now_in_us();
+            DPU_ASSERT(dpu_launch(set, DPU_SYNCHRONOUS));
+            launch_time = now_in_us() - start;
+        }
+
+        DPU_ASSERT(dpu_free(set));
+
+        if (each_run >= NR_WARMUP_RUNS) {
+            times[BENCH_RESET][each_run - NR_WARMUP_RUNS] = reset_time;
+            times[BENCH_LOAD][each_run - NR_WARMUP_RUNS] = load_time;
+            times[BENCH_LAUNCH][each_run - NR_WARMUP_RUNS] = launch_time;
+        }
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *profile = "";
+    const char *binary = NULL;
+    uint32_t nr_dpus = DEFAULT_NR_DPUS;
+    uint32_t nr_runs = DEFAULT_NR_RUNS;
+    double *times[NR_BENCH_PHASES];
+    int option;
+
+    while ((option = getopt(argc, argv, "p:n:r:")) != -1) {
+        switch (option) {
+            case 'p':
+                profile = optarg;
+                break;
+            case 'n':
+                nr_dpus = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                nr_runs = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                exit_usage(argv[0]);
+        }
+    }
+    if (optind < argc) {
+        binary = argv[optind++];
+    }
+    if ((optind != argc) || (nr_dpus == 0) || (nr_runs == 0)) {
+        exit_usage(argv[0]);
+    }
+
+    for (unsigned int each_phase = 0; each_phase < NR_BENCH_PHASES; ++each_phase) {
+        if ((times[each_phase] = malloc(nr_runs * sizeof(*times[each_phase]))) == NULL) {
+            fprintf(stderr, "cannot allocate results\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("%-8s %-8s %12s %12s\n", "planner", "phase", "median(us)", "max(us)");
+
+    for (unsigned int planner = 0; planner < 2; ++planner) {
+        char *planner_profile;
+
+        if (asprintf(&planner_profile, "%s%sufiPlanner=%s", profile, (profile[0] != '\0') ? "," : "", planner ? "true" : "false")
+            == -1) {
+            fprintf(stderr, "cannot build the profile\n");
+            return EXIT_FAILURE;
+        }
+
+        run_phases(planner_profile, binary, nr_dpus, nr_runs, times);
+
+        for (unsigned int each_phase = 0; each_phase < NR_BENCH_PHASES; ++each_phase) {
+            if ((binary == NULL) && (each_phase != BENCH_RESET)) {
+                continue;
+            }
+
+            qsort(times[each_phase], nr_runs, sizeof(*times[each_phase]), compare_doubles);
+            printf("%-8s %-8s %12.1f %12.1f\n",
+                planner ? "on" : "off",
+                phase_names[each_phase],
+                times[each_phase][nr_runs / 2],
+                times[each_phase][nr_runs - 1]);
+        }
+
+        free(planner_profile);
+    }
+
+    for (unsigned int each_phase = 0; each_phase < NR_BENCH_PHASES; ++each_phase) {
+        free(times[each_phase]);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,509 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Sweeps the host <-> DPU transfers over the memory (MRAM, WRAM, IRAM), the API entry point, the direction, the shape
+ * of the transfers (aligned, unaligned, per-DPU sizes and offsets), the transfer size and the number of ranks, and
+ * reports one result per case as CSV or JSON, so that the results of two commits can be compared.
+ *
+ * No DPU program is needed: the transfers target the whole memories through raw symbols. Any rank handler can be
+ * measured through the profile, for instance "backend=simulator" for a software-only one. The label tags the
+ * results of a run (commit, machine...).
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <dpu.h>
+#include <dpu_description.h>
+#include <dpu_management.h>
+#include <dpu_memory.h>
+#include <dpu_transfer_mram.h>
+
+#define NR_WARMUP_TRANSFERS 1
+#define DEFAULT_NR_DPUS DPU_ALLOCATE_ALL
+#define DEFAULT_NR_TRANSFERS 10
+#define DEFAULT_SIZES "64,4096,65536,1048576"
+#define MAX_NR_SIZES 16
+
+#define MRAM_SYMBOL_ADDRESS 0x08000000
+#define IRAM_SYMBOL_ADDRESS 0x80000000
+#define WRAM_SYMBOL_ADDRESS 0x00000000
+
+enum bench_memory {
+    BENCH_MRAM,
+    BENCH_WRAM,
+    BENCH_IRAM,
+    NR_BENCH_MEMORIES,
+};
+
+enum bench_api {
+    /* dpu_copy_to_symbol / dpu_copy_from_symbol on each DPU */
+    BENCH_API_COPY,
+    /* dpu_prepare_xfer on each DPU then dpu_push_xfer_symbol on the set */
+    BENCH_API_PUSH,
+    /* dpu_copy_to_symbol on the set, the same buffer to every DPU */
+    BENCH_API_BROADCAST,
+    /* dpu_copy_to_mrams / dpu_copy_from_mrams on each rank, with a transfer matrix built beforehand */
+    BENCH_API_MATRIX,
+    NR_BENCH_APIS,
+};
+
+enum bench_shape {
+    BENCH_SHAPE_ALIGNED,
+    /* Offset aligned on the access granularity of the memory only */
+    BENCH_SHAPE_UNALIGNED,
+    /* Each DPU has its own size and unaligned offset */
+    BENCH_SHAPE_RAGGED,
+    NR_BENCH_SHAPES,
+};
+
+static const char *const memory_names[NR_BENCH_MEMORIES] = { "mram", "wram", "iram" };
+static const char *const api_names[NR_BENCH_APIS] = { "copy", "push", "broadcast", "matrix" };
+static const char *const shape_names[NR_BENCH_SHAPES] = { "aligned", "unaligned", "ragged" };
+static const char *const direction_names[] = { [DPU_XFER_TO_DPU] = "to_dpu", [DPU_XFER_FROM_DPU] = "from_dpu" };
+
+struct bench_case {
+    enum bench_memory memory;
+    enum bench_api api;
+    dpu_xfer_t direction;
+    enum bench_shape shape;
+    uint32_t nr_ranks;
+    uint32_t size;
+};
+
+struct bench_suite {
+    struct dpu_set_t set;
+    uint32_t nr_ranks;
+    uint32_t nr_dpus;
+    uint32_t nr_transfers;
+    uint32_t memory_sizes[NR_BENCH_MEMORIES];
+
+    /* Host buffer of each DPU, in the DPU_FOREACH order of the set */
+    uint8_t **buffers;
+    struct dpu_transfer_mram **matrices;
+
+    const char *label;
+    const char *profile;
+    bool json;
+    FILE *output;
+    uint32_t nr_results;
+};
+
+static double
+now_in_us(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s [-p <profile>] [-n <nr_dpus> (default: all)] [-s <sizes> (default: %s)]\n"
+        "       [-t <nr_transfers> (default: %u)] [-f csv|json (default: csv)] [-o <output>] [-l <label>]\n",
+        program,
+        DEFAULT_SIZES,
+        DEFAULT_NR_TRANSFERS);
+    exit(EXIT_FAILURE);
+}
+
+static uint32_t
+parse_sizes(char *list, uint32_t *sizes)
+{
+    uint32_t nr_sizes = 0;
+
+    for (char *size = strtok(list, ","); size != NULL; size = strtok(NULL, ",")) {
+        if (nr_sizes == MAX_NR_SIZES) {
+            return 0;
+        }
+        if ((sizes[nr_sizes] = (uint32_t)strtoul(size, NULL, 0)) == 0) {
+            return 0;
+        }
+        nr_sizes++;
+    }
+
+    return nr_sizes;
+}
+
+static struct dpu_symbol_t
+memory_symbol(struct bench_suite *suite, enum bench_memory memory)
+{
+    static const uint32_t addresses[NR_BENCH_MEMORIES]
+        = { [BENCH_MRAM] = MRAM_SYMBOL_ADDRESS, [BENCH_WRAM] = WRAM_SYMBOL_ADDRESS, [BENCH_IRAM] = IRAM_SYMBOL_ADDRESS };
+
+    return (struct dpu_symbol_t) { .address = addresses[memory], .size = suite->memory_sizes[memory] };
+}
+
+/* Offset and size of the transfer of a DPU, given its position in the rank */
+static uint32_t
+case_offset(const struct bench_case *bench_case, uint32_t dpu_index)
+{
+    switch (bench_case->shape) {
+        case BENCH_SHAPE_UNALIGNED:
+            return 4;
+        case BENCH_SHAPE_RAGGED:
+            return (dpu_index % 8) * 67;
+        default:
+            return 0;
+    }
+}
+
+static uint32_t
+case_size(const struct bench_case *bench_case, uint32_t dpu_index)
+{
+    if (bench_case->shape == BENCH_SHAPE_RAGGED) {
+        return bench_case->size - (dpu_index % 8) * (bench_case->size / 16);
+    }
+
+    return bench_case->size;
+}
+
+/* The IRAM is accessed by instructions, the WRAM by words; the API transfers only the MRAM through matrices */
+static bool
+is_case_supported(struct bench_suite *suite, const struct bench_case *bench_case)
+{
+    if ((bench_case->api == BENCH_API_BROADCAST) && (bench_case->direction != DPU_XFER_TO_DPU)) {
+        return false;
+    }
+    if ((bench_case->shape == BENCH_SHAPE_RAGGED) != (bench_case->api == BENCH_API_MATRIX)) {
+        return false;
+    }
+    if ((bench_case->api == BENCH_API_MATRIX) && (bench_case->memory != BENCH_MRAM)) {
+        return false;
+    }
+    if ((bench_case->memory == BENCH_IRAM) && ((bench_case->shape != BENCH_SHAPE_ALIGNED) || (bench_case->size % 8) != 0)) {
+        return false;
+    }
+    if ((bench_case->memory == BENCH_WRAM) && ((bench_case->size % 4) != 0)) {
+        return false;
+    }
+
+    return case_offset(bench_case, 7) + bench_case->size <= suite->memory_sizes[bench_case->memory];
+}
+
+/* The first ranks of the set */
+static struct dpu_set_t
+case_set(struct bench_suite *suite, const struct bench_case *bench_case)
+{
+    struct dpu_set_t set = suite->set;
+
+    set.list.nr_ranks = bench_case->nr_ranks;
+
+    return set;
+}
+
+static uint64_t
+build_matrices(struct bench_suite *suite, const struct bench_case *bench_case)
+{
+    struct dpu_set_t set = case_set(suite, bench_case);
+    struct dpu_set_t rank_set, dpu;
+    uint32_t each_rank, first_dpu = 0;
+    uint64_t nr_bytes = 0;
+
+    DPU_RANK_FOREACH (set, rank_set, each_rank) {
+        uint32_t each_dpu;
+
+        dpu_transfer_matrix_clear_all(rank_set.list.ranks[0], suite->matrices[each_rank]);
+        DPU_FOREACH (rank_set, dpu, each_dpu) {
+            uint32_t size = case_size(bench_case, each_dpu);
+
+            DPU_ASSERT(dpu_transfer_matrix_add_dpu(dpu.dpu,
+                suite->matrices[each_rank],
+                suite->buffers[first_dpu + each_dpu],
+                size,
+                case_offset(bench_case, each_dpu),
+                DPU_PRIMARY_MRAM));
+            nr_bytes += size;
+        }
+        first_dpu += each_dpu;
+    }
+
+    return nr_bytes;
+}
+
+static void
+run_transfer(struct bench_suite *suite, const struct bench_case *bench_case)
+{
+    struct dpu_set_t set = case_set(suite, bench_case);
+    struct dpu_symbol_t symbol = memory_symbol(suite, bench_case->memory);
+    uint32_t offset = case_offset(bench_case, 0);
+    struct dpu_set_t dpu;
+    uint32_t each_dpu;
+
+    switch (bench_case->api) {
+        case BENCH_API_COPY:
+            DPU_FOREACH (set, dpu, each_dpu) {
+                if (bench_case->direction == DPU_XFER_TO_DPU) {
+                    DPU_ASSERT(dpu_copy_to_symbol(dpu, symbol, offset, suite->buffers[each_dpu], bench_case->size));
+                } else {
+                    DPU_ASSERT(dpu_copy_from_symbol(dpu, symbol, offset, suite->buffers[each_dpu], bench_case->size));
+                }
+            }
+            break;
+        case BENCH_API_PUSH:
+            DPU_FOREACH (set, dpu, each_dpu) {
+                DPU_ASSERT(dpu_prepare_xfer(dpu, suite->buffers[each_dpu]));
+            }
+            DPU_ASSERT(dpu_push_xfer_symbol(set, bench_case->direction, symbol, offset, bench_case->size, DPU_XFER_DEFAULT));
+            break;
+        case BENCH_API_BROADCAST:
+            DPU_ASSERT(dpu_copy_to_symbol(set, symbol, offset, suite->buffers[0], bench_case->size));
+            break;
+        case BENCH_API_MATRIX:
+            for (uint32_t each_rank = 0; each_rank < bench_case->nr_ranks; ++each_rank) {
+                struct dpu_rank_t *rank = set.list.ranks[each_rank];
+
+                if (bench_case->direction == DPU_XFER_TO_DPU) {
+                    DPU_ASSERT(dpu_copy_to_mrams(rank, suite->matrices[each_rank]));
+                } else {
+                    DPU_ASSERT(dpu_copy_from_mrams(rank, suite->matrices[each_rank]));
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static uint32_t
+count_dpus(struct bench_suite *suite, const struct bench_case *bench_case)
+{
+    uint32_t nr_dpus;
+
+    DPU_ASSERT(dpu_get_nr_dpus(case_set(suite, bench_case), &nr_dpus));
+
+    return nr_dpus;
+}
+
+static void
+print_header(struct bench_suite *suite)
+{
+    if (suite->json) {
+        fprintf(suite->output, "[\n");
+    } else {
+        fprintf(suite->output,
+            "label,profile,memory,api,direction,shape,nr_ranks,nr_dpus,size,nr_transfers,bytes,time_us,throughput_mbps\n");
+    }
+}
+
+static void
+print_footer(struct bench_suite *suite)
+{
+    if (suite->json) {
+        fprintf(suite->output, "\n]\n");
+    }
+}
+
+static void
+print_result(struct bench_suite *suite, const struct bench_case *bench_case, uint32_t nr_dpus, uint64_t nr_bytes, double time)
+{
+    /* Bytes per microsecond are MB/s */
+    double throughput = (double)nr_bytes / time;
+
+    if (suite->json) {
+        fprintf(suite->output,
+            "%s  {\"label\": \"%s\", \"profile\": \"%s\", \"memory\": \"%s\", \"api\": \"%s\", \"direction\": \"%s\", "
+            "\"shape\": \"%s\", \"nr_ranks\": %u, \"nr_dpus\": %u, \"size\": %u, \"nr_transfers\": %u, \"bytes\": %lu, "
+            "\"time_us\": %.1f, \"throughput_mbps\": %.1f}",
+            suite->nr_results != 0 ? ",\n" : "",
+            suite->label,
+            suite->profile,
+            memory_names[bench_case->memory],
+            api_names[bench_case->api],
+            direction_names[bench_case->direction],
+            shape_names[bench_case->shape],
+            bench_case->nr_ranks,
+            nr_dpus,
+            bench_case->size,
+            suite->nr_transfers,
+            (unsigned long)nr_bytes,
+            time,
+            throughput);
+    } else {
+        fprintf(suite->output,
+            "\"%s\",\"%s\",%s,%s,%s,%s,%u,%u,%u,%u,%lu,%.1f,%.1f\n",
+            suite->label,
+            suite->profile,
+            memory_names[bench_case->memory],
+            api_names[bench_case->api],
+            direction_names[bench_case->direction],
+            shape_names[bench_case->shape],
+            bench_case->nr_ranks,
+            nr_dpus,
+            bench_case->size,
+            suite->nr_transfers,
+            (unsigned long)nr_bytes,
+            time,
+            throughput);
+    }
+    fflush(suite->output);
+    suite->nr_results++;
+}
+
+static void
+measure(struct bench_suite *suite, const struct bench_case *bench_case)
+{
+    uint32_t nr_dpus = count_dpus(suite, bench_case);
+    uint64_t nr_bytes = (uint64_t)nr_dpus * bench_case->size;
+    double time;
+
+    if (bench_case->api == BENCH_API_MATRIX) {
+        nr_bytes = build_matrices(suite, bench_case);
+    }
+
+    for (uint32_t each_transfer = 0; each_transfer < NR_WARMUP_TRANSFERS; ++each_transfer) {
+        run_transfer(suite, bench_case);
+    }
+
+    time = now_in_us();
+    for (uint32_t each_transfer = 0; each_transfer < suite->nr_transfers; ++each_transfer) {
+        run_transfer(suite, bench_case);
+    }
+    time = now_in_us() - time;
+
+    print_result(suite, bench_case, nr_dpus, nr_bytes * suite->nr_transfers, time);
+}
+
+int
+main(int argc, char **argv)
+{
+    struct bench_suite suite = { .nr_transfers = DEFAULT_NR_TRANSFERS, .label = "", .profile = "", .output = stdout };
+    char default_sizes[] = DEFAULT_SIZES;
+    char *size_list = default_sizes;
+    uint32_t sizes[MAX_NR_SIZES], nr_sizes, max_size = 0;
+    uint32_t nr_dpus = DEFAULT_NR_DPUS;
+    const char *output_path = NULL;
+    dpu_description_t description;
+    int option;
+
+    while ((option = getopt(argc, argv, "p:n:s:t:f:o:l:")) != -1) {
+        switch (option) {
+            case 'p':
+                suite.profile = optarg;
+                break;
+            case 'n':
+                nr_dpus = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                size_list = optarg;
+                break;
+            case 't':
+                suite.nr_transfers = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                if (strcmp(optarg, "json") == 0) {
+                    suite.json = true;
+                } else if (strcmp(optarg, "csv") != 0) {
+                    exit_usage(argv[0]);
+                }
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            case 'l':
+                suite.label = optarg;
+                break;
+            default:
+                exit_usage(argv[0]);
+        }
+    }
+    if ((optind != argc) || (nr_dpus == 0) || (suite.nr_transfers == 0) || ((nr_sizes = parse_sizes(size_list, sizes)) == 0)) {
+        exit_usage(argv[0]);
+    }
+    for (uint32_t each_size = 0; each_size < nr_sizes; ++each_size) {
+        if (sizes[each_size] > max_size) {
+            max_size = sizes[each_size];
+        }
+    }
+
+    if ((output_path != NULL) && ((suite.output = fopen(output_path, "w")) == NULL)) {
+        fprintf(stderr, "cannot open %s\n", output_path);
+        return EXIT_FAILURE;
+    }
+
+    DPU_ASSERT(dpu_alloc(nr_dpus, suite.profile, &suite.set));
+    DPU_ASSERT(dpu_get_nr_ranks(suite.set, &suite.nr_ranks));
+    DPU_ASSERT(dpu_get_nr_dpus(suite.set, &suite.nr_dpus));
+
+    description = dpu_get_description(suite.set.list.ranks[0]);
+    suite.memory_sizes[BENCH_MRAM] = description->memories.mram_size;
+    suite.memory_sizes[BENCH_WRAM] = description->memories.wram_size * sizeof(uint32_t);
+    suite.memory_sizes[BENCH_IRAM] = description->memories.iram_size * sizeof(uint64_t);
+
+    suite.buffers = calloc(suite.nr_dpus, sizeof(*suite.buffers));
+    suite.matrices = calloc(suite.nr_ranks, sizeof(*suite.matrices));
+    if ((suite.buffers == NULL) || (suite.matrices == NULL)) {
+        fprintf(stderr, "cannot allocate buffers\n");
+        return EXIT_FAILURE;
+    }
+    for (uint32_t each_dpu = 0; each_dpu < suite.nr_dpus; ++each_dpu) {
+        if ((suite.buffers[each_dpu] = malloc(max_size)) == NULL) {
+            fprintf(stderr, "cannot allocate buffers\n");
+            return EXIT_FAILURE;
+        }
+        memset(suite.buffers[each_dpu], (int)each_dpu, max_size);
+    }
+    for (uint32_t each_rank = 0; each_rank < suite.nr_ranks; ++each_rank) {
+        DPU_ASSERT(dpu_transfer_matrix_allocate(suite.set.list.ranks[each_rank], &suite.matrices[each_rank]));
+    }
+
+    print_header(&suite);
+
+    for (uint32_t nr_ranks = 1;; nr_ranks = (2 * nr_ranks < suite.nr_ranks) ? 2 * nr_ranks : suite.nr_ranks) {
+        for (enum bench_memory memory = 0; memory < NR_BENCH_MEMORIES; ++memory) {
+            for (enum bench_api api = 0; api < NR_BENCH_APIS; ++api) {
+                for (enum bench_shape shape = 0; shape < NR_BENCH_SHAPES; ++shape) {
+                    for (uint32_t each_size = 0; each_size < nr_sizes; ++each_size) {
+                        struct bench_case bench_case = {
+                            .memory = memory,
+                            .api = api,
+                            .shape = shape,
+                            .nr_ranks = nr_ranks,
+                            .size = sizes[each_size],
+                        };
+
+                        bench_case.direction = DPU_XFER_TO_DPU;
+                        if (is_case_supported(&suite, &bench_case)) {
+                            measure(&suite, &bench_case);
+                        }
+                        bench_case.direction = DPU_XFER_FROM_DPU;
+                        if (is_case_supported(&suite, &bench_case)) {
+                            measure(&suite, &bench_case);
+                        }
+                    }
+                }
+            }
+        }
+
+        if (nr_ranks == suite.nr_ranks) {
+            break;
+        }
+    }
+
+    print_footer(&suite);
+
+    for (uint32_t each_rank = 0; each_rank < suite.nr_ranks; ++each_rank) {
+        dpu_transfer_matrix_free(suite.set.list.ranks[each_rank], suite.matrices[each_rank]);
+    }
+    for (uint32_t each_dpu = 0; each_dpu < suite.nr_dpus; ++each_dpu) {
+        free(suite.buffers[each_dpu]);
+    }
+    free(suite.matrices);
+    free(suite.buffers);
+
+    DPU_ASSERT(dpu_free(suite.set));
+
+    if (suite.output != stdout) {
+        fclose(suite.output);
+    }
+
+    return EXIT_SUCCESS;
+}
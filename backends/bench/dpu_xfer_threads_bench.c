@@ -0,0 +1,137 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Sweeps the number of PERF mode transfer threads of a rank ("xferThreads" profile property) and reports the MRAM
+ * write and read bandwidth for each of them. An extra profile can be given to compare thread placements, for
+ * instance "xferNumaNode=none" (unbound threads) or "xferCpus=0-3:8-11".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <dpu.h>
+#include <dpu_management.h>
+#include <dpu_memory.h>
+#include <dpu_transfer_mram.h>
+
+#define NR_WARMUP_TRANSFERS 2
+#define DEFAULT_TRANSFER_SIZE (8 << 20)
+#define DEFAULT_NR_TRANSFERS 10
+
+static const unsigned int nr_threads_sweep[] = { 1, 2, 4, 8 };
+#define NR_SWEEP_POINTS (sizeof(nr_threads_sweep) / sizeof(nr_threads_sweep[0]))
+
+static double
+now_in_us(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s [<transfer_size> (default: %u)] [<nr_transfers> (default: %u)] [<extra_profile>]\n",
+        program,
+        DEFAULT_TRANSFER_SIZE,
+        DEFAULT_NR_TRANSFERS);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t transfer_size = DEFAULT_TRANSFER_SIZE;
+    uint32_t nr_transfers = DEFAULT_NR_TRANSFERS;
+    const char *extra_profile = NULL;
+    uint8_t *buffer;
+
+    if (argc > 4) {
+        exit_usage(argv[0]);
+    }
+    if (argc > 1) {
+        transfer_size = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        nr_transfers = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3) {
+        extra_profile = argv[3];
+    }
+    if ((transfer_size == 0) || ((transfer_size % 8) != 0) || (nr_transfers == 0)) {
+        exit_usage(argv[0]);
+    }
+
+    /* Every DPU of the rank transfers the same buffer: only the MRAM side is measured */
+    if ((buffer = malloc(transfer_size)) == NULL) {
+        fprintf(stderr, "cannot allocate buffer\n");
+        return EXIT_FAILURE;
+    }
+    memset(buffer, 0x5a, transfer_size);
+
+    printf("%-8s %14s %14s\n", "threads", "write(MB/s)", "read(MB/s)");
+
+    for (unsigned int each_point = 0; each_point < NR_SWEEP_POINTS; ++each_point) {
+        struct dpu_set_t set, rank_set, dpu;
+        struct dpu_transfer_mram *matrix;
+        struct dpu_rank_t *rank;
+        char profile[256];
+        uint32_t nr_dpus;
+        uint64_t nr_bytes;
+        double write_time, read_time;
+
+        snprintf(profile,
+            sizeof(profile),
+            "xferThreads=%u%s%s",
+            nr_threads_sweep[each_point],
+            extra_profile != NULL ? "," : "",
+            extra_profile != NULL ? extra_profile : "");
+
+        DPU_ASSERT(dpu_alloc(DPU_ALLOCATE_ALL, profile, &set));
+        DPU_RANK_FOREACH (set, rank_set) {
+            break;
+        }
+        rank = rank_set.list.ranks[0];
+        DPU_ASSERT(dpu_get_nr_dpus(rank_set, &nr_dpus));
+
+        DPU_ASSERT(dpu_transfer_matrix_allocate(rank, &matrix));
+        DPU_FOREACH (rank_set, dpu) {
+            DPU_ASSERT(dpu_transfer_matrix_add_dpu(dpu.dpu, matrix, buffer, transfer_size, 0, DPU_PRIMARY_MRAM));
+        }
+        nr_bytes = (uint64_t)nr_dpus * transfer_size * nr_transfers;
+
+        for (unsigned int each_transfer = 0; each_transfer < NR_WARMUP_TRANSFERS; ++each_transfer) {
+            DPU_ASSERT(dpu_copy_to_mrams(rank, matrix));
+            DPU_ASSERT(dpu_copy_from_mrams(rank, matrix));
+        }
+
+        write_time = now_in_us();
+        for (unsigned int each_transfer = 0; each_transfer < nr_transfers; ++each_transfer) {
+            DPU_ASSERT(dpu_copy_to_mrams(rank, matrix));
+        }
+        write_time = now_in_us() - write_time;
+
+        read_time = now_in_us();
+        for (unsigned int each_transfer = 0; each_transfer < nr_transfers; ++each_transfer) {
+            DPU_ASSERT(dpu_copy_from_mrams(rank, matrix));
+        }
+        read_time = now_in_us() - read_time;
+
+        dpu_transfer_matrix_free(rank, matrix);
+        DPU_ASSERT(dpu_free(set));
+
+        /* Bytes per microsecond are MB/s */
+        printf("%-8u %14.1f %14.1f\n", nr_threads_sweep[each_point], nr_bytes / write_time, nr_bytes / read_time);
+    }
+
+    free(buffer);
+
+    return EXIT_SUCCESS;
+}
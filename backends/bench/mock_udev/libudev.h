@@ -0,0 +1,74 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Subset of libudev used by hw_dpu_sysfs.c, served by libudev_mock.c from a fake sysfs tree */
+
+#ifndef LIBUDEV_MOCK_H
+#define LIBUDEV_MOCK_H
+
+struct udev;
+struct udev_device;
+struct udev_enumerate;
+struct udev_list_entry;
+
+struct udev *
+udev_new(void);
+struct udev *
+udev_unref(struct udev *udev);
+
+struct udev_enumerate *
+udev_enumerate_new(struct udev *udev);
+struct udev_enumerate *
+udev_enumerate_unref(struct udev_enumerate *enumerate);
+int
+udev_enumerate_add_match_sysname(struct udev_enumerate *enumerate, const char *sysname);
+int
+udev_enumerate_add_match_subsystem(struct udev_enumerate *enumerate, const char *subsystem);
+int
+udev_enumerate_add_match_parent(struct udev_enumerate *enumerate, struct udev_device *parent);
+int
+udev_enumerate_scan_devices(struct udev_enumerate *enumerate);
+struct udev_list_entry *
+udev_enumerate_get_list_entry(struct udev_enumerate *enumerate);
+
+struct udev_list_entry *
+udev_list_entry_get_next(struct udev_list_entry *list_entry);
+const char *
+udev_list_entry_get_name(struct udev_list_entry *list_entry);
+
+#define udev_list_entry_foreach(list_entry, first_entry)                                                                         \
+    for (list_entry = first_entry; list_entry != NULL; list_entry = udev_list_entry_get_next(list_entry))
+
+struct udev_device *
+udev_device_new_from_syspath(struct udev *udev, const char *syspath);
+struct udev_device *
+udev_device_unref(struct udev_device *udev_device);
+struct udev_device *
+udev_device_get_parent(struct udev_device *udev_device);
+const char *
+udev_device_get_devnode(struct udev_device *udev_device);
+const char *
+udev_device_get_sysattr_value(struct udev_device *udev_device, const char *sysattr);
+int
+udev_device_set_sysattr_value(struct udev_device *udev_device, const char *sysattr, const char *value);
+
+/* Calls that reach the fake sysfs and device nodes, counted by the mock */
+struct libudev_mock_stats {
+    unsigned long nr_enumerations;
+    unsigned long nr_devices;
+    unsigned long nr_sysattr_reads;
+    unsigned long nr_devnode_opens;
+};
+
+/* The ranks are the directories <root>/sys/dpu_region<r>/dpu_rank<k>, whose device node is <root>/dev/dpu_region<r>_dpu_rank<k>.
+ * A device node opens once at a time, and never while <device node>.busy exists: the rank is taken by another process.
+ */
+void
+libudev_mock_set_root(const char *root);
+
+void
+libudev_mock_get_stats(struct libudev_mock_stats *stats);
+
+#endif /* LIBUDEV_MOCK_H */
@@ -0,0 +1,411 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* libudev over a fake sysfs tree, for the benchmarks of the rank allocation: see libudev.h for the layout. The open and
+ * close calls of the program are wrapped (-Wl,--wrap=open,--wrap=close) so that the device nodes behave as the driver
+ * does, a rank being opened by one file descriptor at a time.
+ */
+
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "libudev.h"
+
+#define MAX_NR_DEVICES 4096
+#define MAX_NR_FDS 4096
+
+struct udev {
+    int refcount;
+};
+
+struct udev_list_entry {
+    char *name;
+    struct udev_list_entry *next;
+};
+
+struct udev_enumerate {
+    struct udev_list_entry *first;
+};
+
+struct udev_sysattr {
+    char *name;
+    char *value;
+    struct udev_sysattr *next;
+};
+
+struct udev_device {
+    char *syspath;
+    char devnode[PATH_MAX];
+    /* Values read from the fake sysfs, kept until the device is released as libudev does */
+    struct udev_sysattr *sysattrs;
+    struct udev_device *parent;
+};
+
+/* Half of PATH_MAX, so that the paths built under it fit */
+static char mock_root[PATH_MAX / 2] = "/tmp";
+static struct libudev_mock_stats mock_stats;
+static bool devnode_is_open[MAX_NR_FDS];
+
+void
+libudev_mock_set_root(const char *root)
+{
+    snprintf(mock_root, sizeof(mock_root), "%s", root);
+}
+
+void
+libudev_mock_get_stats(struct libudev_mock_stats *stats)
+{
+    *stats = mock_stats;
+}
+
+struct udev *
+udev_new(void)
+{
+    return calloc(1, sizeof(struct udev));
+}
+
+struct udev *
+udev_unref(struct udev *udev)
+{
+    free(udev);
+    return NULL;
+}
+
+struct udev_enumerate *
+udev_enumerate_new(__attribute__((unused)) struct udev *udev)
+{
+    return calloc(1, sizeof(struct udev_enumerate));
+}
+
+struct udev_enumerate *
+udev_enumerate_unref(struct udev_enumerate *enumerate)
+{
+    struct udev_list_entry *list_entry, *next;
+
+    if (enumerate == NULL)
+        return NULL;
+
+    for (list_entry = enumerate->first; list_entry != NULL; list_entry = next) {
+        next = list_entry->next;
+        free(list_entry->name);
+        free(list_entry);
+    }
+    free(enumerate);
+
+    return NULL;
+}
+
+/* The fake tree only holds dpu_rank devices: the matches do not filter anything */
+int
+udev_enumerate_add_match_sysname(__attribute__((unused)) struct udev_enumerate *enumerate,
+    __attribute__((unused)) const char *sysname)
+{
+    return 0;
+}
+
+int
+udev_enumerate_add_match_subsystem(__attribute__((unused)) struct udev_enumerate *enumerate,
+    __attribute__((unused)) const char *subsystem)
+{
+    return 0;
+}
+
+int
+udev_enumerate_add_match_parent(__attribute__((unused)) struct udev_enumerate *enumerate,
+    __attribute__((unused)) struct udev_device *parent)
+{
+    return 0;
+}
+
+static int
+compare_names(const void *name0, const void *name1)
+{
+    return strcmp(*(char *const *)name0, *(char *const *)name1);
+}
+
+int
+udev_enumerate_scan_devices(struct udev_enumerate *enumerate)
+{
+    static char *names[MAX_NR_DEVICES];
+    struct udev_list_entry **tail = &enumerate->first;
+    char sys_path[PATH_MAX], region_path[PATH_MAX + 256];
+    struct dirent *region, *rank;
+    DIR *sys_dir, *region_dir;
+    unsigned int nr_names = 0;
+
+    mock_stats.nr_enumerations++;
+
+    snprintf(sys_path, sizeof(sys_path), "%s/sys", mock_root);
+    if ((sys_dir = opendir(sys_path)) == NULL)
+        return -errno;
+
+    while ((region = readdir(sys_dir)) != NULL) {
+        if (strncmp(region->d_name, "dpu_region", strlen("dpu_region")) != 0)
+            continue;
+
+        snprintf(region_path, sizeof(region_path), "%s/%s", sys_path, region->d_name);
+        if ((region_dir = opendir(region_path)) == NULL)
+            continue;
+
+        while ((rank = readdir(region_dir)) != NULL && nr_names < MAX_NR_DEVICES) {
+            if (strncmp(rank->d_name, "dpu_rank", strlen("dpu_rank")) != 0)
+                continue;
+            if (asprintf(&names[nr_names], "%s/%s", region_path, rank->d_name) != -1)
+                nr_names++;
+        }
+        closedir(region_dir);
+    }
+    closedir(sys_dir);
+
+    /* udev lists the devices in a stable order */
+    qsort(names, nr_names, sizeof(names[0]), compare_names);
+
+    for (unsigned int each_name = 0; each_name < nr_names; ++each_name) {
+        struct udev_list_entry *list_entry = calloc(1, sizeof(*list_entry));
+
+        if (list_entry == NULL) {
+            free(names[each_name]);
+            continue;
+        }
+        list_entry->name = names[each_name];
+        *tail = list_entry;
+        tail = &list_entry->next;
+    }
+
+    return 0;
+}
+
+struct udev_list_entry *
+udev_enumerate_get_list_entry(struct udev_enumerate *enumerate)
+{
+    return enumerate->first;
+}
+
+struct udev_list_entry *
+udev_list_entry_get_next(struct udev_list_entry *list_entry)
+{
+    return list_entry->next;
+}
+
+const char *
+udev_list_entry_get_name(struct udev_list_entry *list_entry)
+{
+    return list_entry->name;
+}
+
+static struct udev_device *
+new_device(const char *syspath)
+{
+    struct udev_device *udev_device = calloc(1, sizeof(*udev_device));
+
+    if (udev_device == NULL)
+        return NULL;
+
+    if ((udev_device->syspath = strdup(syspath)) == NULL) {
+        free(udev_device);
+        return NULL;
+    }
+
+    return udev_device;
+}
+
+struct udev_device *
+udev_device_new_from_syspath(__attribute__((unused)) struct udev *udev, const char *syspath)
+{
+    struct udev_device *udev_device;
+    const char *rank_name, *region_name;
+    struct stat st;
+
+    if (stat(syspath, &st) != 0)
+        return NULL;
+
+    mock_stats.nr_devices++;
+
+    if ((udev_device = new_device(syspath)) == NULL)
+        return NULL;
+
+    /* <root>/sys/dpu_region<r>/dpu_rank<k> -> <root>/dev/dpu_region<r>_dpu_rank<k> */
+    rank_name = strrchr(syspath, '/') + 1;
+    region_name = rank_name - 1;
+    while (region_name > syspath && region_name[-1] != '/')
+        region_name--;
+
+    snprintf(udev_device->devnode,
+        sizeof(udev_device->devnode),
+        "%s/dev/%.*s_%s",
+        mock_root,
+        (int)(rank_name - 1 - region_name),
+        region_name,
+        rank_name);
+
+    return udev_device;
+}
+
+static void
+free_device(struct udev_device *udev_device)
+{
+    struct udev_sysattr *sysattr, *next;
+
+    for (sysattr = udev_device->sysattrs; sysattr != NULL; sysattr = next) {
+        next = sysattr->next;
+        free(sysattr->name);
+        free(sysattr->value);
+        free(sysattr);
+    }
+    free(udev_device->syspath);
+    free(udev_device);
+}
+
+struct udev_device *
+udev_device_unref(struct udev_device *udev_device)
+{
+    if (udev_device == NULL)
+        return NULL;
+
+    /* The parent belongs to its child, as in libudev */
+    if (udev_device->parent != NULL)
+        free_device(udev_device->parent);
+    free_device(udev_device);
+
+    return NULL;
+}
+
+struct udev_device *
+udev_device_get_parent(struct udev_device *udev_device)
+{
+    if (udev_device->parent == NULL && (udev_device->parent = new_device(udev_device->syspath)) != NULL)
+        *strrchr(udev_device->parent->syspath, '/') = '\0';
+
+    return udev_device->parent;
+}
+
+const char *
+udev_device_get_devnode(struct udev_device *udev_device)
+{
+    return udev_device->devnode;
+}
+
+const char *
+udev_device_get_sysattr_value(struct udev_device *udev_device, const char *sysattr_name)
+{
+    char sysattr_path[PATH_MAX + 256], value[256];
+    struct udev_sysattr *sysattr;
+    ssize_t size;
+    int fd;
+
+    for (sysattr = udev_device->sysattrs; sysattr != NULL; sysattr = sysattr->next) {
+        if (!strcmp(sysattr->name, sysattr_name))
+            return sysattr->value;
+    }
+
+    mock_stats.nr_sysattr_reads++;
+
+    snprintf(sysattr_path, sizeof(sysattr_path), "%s/%s", udev_device->syspath, sysattr_name);
+    if ((fd = open(sysattr_path, O_RDONLY)) < 0)
+        return NULL;
+    size = read(fd, value, sizeof(value) - 1);
+    close(fd);
+    if (size < 0)
+        return NULL;
+    value[size] = '\0';
+
+    if ((sysattr = calloc(1, sizeof(*sysattr))) == NULL)
+        return NULL;
+    sysattr->name = strdup(sysattr_name);
+    sysattr->value = strdup(value);
+    sysattr->next = udev_device->sysattrs;
+    udev_device->sysattrs = sysattr;
+
+    return sysattr->value;
+}
+
+int
+udev_device_set_sysattr_value(__attribute__((unused)) struct udev_device *udev_device,
+    __attribute__((unused)) const char *sysattr,
+    __attribute__((unused)) const char *value)
+{
+    return 0;
+}
+
+int
+__real_open(const char *path, int flags, ...);
+int
+__real_close(int fd);
+
+static bool
+is_devnode(const char *path)
+{
+    size_t root_length = strlen(mock_root);
+
+    return !strncmp(path, mock_root, root_length) && !strncmp(path + root_length, "/dev/", strlen("/dev/"));
+}
+
+int
+__wrap_open(const char *path, int flags, ...)
+{
+    char busy_path[PATH_MAX + 8];
+    mode_t mode = 0;
+    int fd;
+
+    if (flags & O_CREAT) {
+        va_list args;
+
+        va_start(args, flags);
+        mode = va_arg(args, mode_t);
+        va_end(args);
+    }
+
+    if (!is_devnode(path))
+        return __real_open(path, flags, mode);
+
+    mock_stats.nr_devnode_opens++;
+
+    snprintf(busy_path, sizeof(busy_path), "%s.busy", path);
+    if (access(busy_path, F_OK) == 0) {
+        errno = EBUSY;
+        return -1;
+    }
+
+    /* Device nodes are only opened by the allocations: one fd per rank at a time, as the driver allows */
+    for (fd = 0; fd < MAX_NR_FDS; ++fd) {
+        if (devnode_is_open[fd]) {
+            char fd_path[64], opened_path[PATH_MAX];
+            ssize_t size;
+
+            snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", fd);
+            if ((size = readlink(fd_path, opened_path, sizeof(opened_path) - 1)) > 0) {
+                opened_path[size] = '\0';
+                if (!strcmp(opened_path, path)) {
+                    errno = EBUSY;
+                    return -1;
+                }
+            }
+        }
+    }
+
+    if ((fd = __real_open(path, flags, mode)) >= 0 && fd < MAX_NR_FDS)
+        devnode_is_open[fd] = true;
+
+    return fd;
+}
+
+int
+__wrap_close(int fd)
+{
+    if (fd >= 0 && fd < MAX_NR_FDS)
+        devnode_is_open[fd] = false;
+
+    return __real_close(fd);
+}
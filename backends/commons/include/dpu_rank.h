@@ -72,20 +72,53 @@ struct dpu_debug_context_t {
     struct dpu_circular_buffer_commands_t cmds_buffer;
 };
 
+#define DPU_CI_PLAN_DEPTH 64
+
+struct dpu_ci_plan_entry {
+    uint64_t command;
+    bool add_select_mask;
+    uint8_t select_mask; // Selection when the command was planned, checked in its result
+};
+
+/* Void commands are recorded here, instead of being executed, while a plan is open (see ufi_begin_plan).
+ * The commands of each CI keep their order, and the n-th commands of all the CIs share the same commit.
+ */
+struct dpu_ci_plan {
+    uint32_t nesting;
+    uint32_t nr_entries[DPU_MAX_NR_CIS];
+    struct dpu_ci_plan_entry entries[DPU_MAX_NR_CIS][DPU_CI_PLAN_DEPTH];
+};
+
 struct dpu_control_interface_context {
     dpu_ci_bitfield_t fault_decode;
     dpu_ci_bitfield_t fault_collide;
 
     dpu_ci_bitfield_t color;
     struct dpu_configuration_slice_info_t slice_info[DPU_MAX_NR_CIS]; // Used for the current application to hold slice info
+
+    struct dpu_ci_command_stats command_stats;
+
+    struct dpu_ci_plan plan;
 };
 
+struct dpu_future_t;
+struct dpu_rank_host_buffer;
+struct dpu_rank_dispatch_job_t;
+
 struct dpu_poll_thread_context_t {
     bool thr_exists;
     int thr_has_work; /* -1 means kill yourself, 0 means nothing to do, 1 means job to do */
     pthread_t thr_id;
     pthread_cond_t thr_cond;
     pthread_mutex_t thr_mutex;
+    struct dpu_future_t *future; /* notified at the end of the pending job, if any; protected by thr_mutex */
+    uint32_t future_index;
+    bool thr_running; /* from the launch to the end of its run; protected by thr_mutex, thr_cond is broadcast when cleared */
+};
+
+struct dpu_dispatch_thread_context_t {
+    struct dpu_poll_thread_context_t thread; /* thr_has_work == 1 until the worker takes job */
+    struct dpu_rank_dispatch_job_t *job; /* owned by the caller of dpu_rank_dispatch, which waits for its completion */
 };
 
 typedef struct _dpu_run_context_t {
@@ -94,6 +127,8 @@ typedef struct _dpu_run_context_t {
     uint8_t nb_dpu_running;
 
     struct dpu_poll_thread_context_t poll_thread;
+
+    struct timespec launch_time;
 } * dpu_run_context_t;
 
 struct dpu_runtime_state_t {
@@ -119,6 +154,12 @@ struct dpu_rank_t {
 
     struct timespec temperature_sample_time;
     void *_internals;
+
+    int numa_node; /* -1 when unknown */
+    struct dpu_dispatch_thread_context_t dispatch_thread;
+
+    /* Registered by dpu_host_buffer_alloc, unregistered when the rank is freed */
+    struct dpu_rank_host_buffer *host_buffers;
 };
 
 struct dpu_t {
@@ -151,4 +192,20 @@ struct dpu_transfer_mram {
 };
 #endif
 
+#ifndef struct_dpu_transfer_mram_iovec_t
+#define struct_dpu_transfer_mram_iovec_t
+struct dpu_transfer_mram_segment {
+    void *ptr;
+    uint32_t offset_in_mram;
+    uint32_t size;
+};
+
+/* Segments of the transfer of one DPU, in its primary MRAM: sorted by offset and disjoint */
+struct dpu_transfer_mram_iovec {
+    struct dpu_transfer_mram_segment *segments;
+    uint32_t nb_segments;
+    uint32_t capacity;
+};
+#endif
+
 #endif // DPU_RANK_H
@@ -41,6 +41,19 @@ typedef struct dpu_rank_handler {
         dpu_custom_command_t command,
         dpu_custom_command_args_t args);
     dpu_rank_status_e (*fill_description_from_profile)(dpu_properties_t properties, dpu_description_t description);
+
+    /* New hooks go at the end, so that the offsets of the ones above do not change for the backends built against them */
+    /* Optional: otherwise, the API transfers the segments of each DPU in several passes. */
+    dpu_rank_status_e (*copy_iovec_to_rank)(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix);
+    dpu_rank_status_e (*copy_iovec_from_rank)(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix);
+    /* Optional: the transfer matrix is pushed several times and is not modified until it is unregistered, so that the
+     * backend can prepare it once.
+     */
+    dpu_rank_status_e (*register_transfer_matrix)(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
+    void (*unregister_transfer_matrix)(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
+    /* Optional: the host buffer is resident and its DPU slots are aligned on a cache line until it is unregistered. */
+    dpu_rank_status_e (*register_host_buffer)(struct dpu_rank_t *rank, void *buffer, size_t size);
+    void (*unregister_host_buffer)(struct dpu_rank_t *rank, void *buffer);
 } * dpu_rank_handler_t;
 
 /* We need to keep a global handler for further rank allocation: the first 'allocates' it, the others get it. */
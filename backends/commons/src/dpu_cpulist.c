@@ -0,0 +1,79 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "dpu_cpulist.h"
+
+#define NUMA_NODE_CPULIST_PATH "/sys/devices/system/node/node%d/cpulist"
+
+int
+dpu_cpulist_parse(const char *cpulist, cpu_set_t *cpus)
+{
+    unsigned int first, last, cpu;
+    char *end;
+
+    CPU_ZERO(cpus);
+
+    while (*cpulist != '\0' && *cpulist != '\n') {
+        first = strtoul(cpulist, &end, 10);
+        if (end == cpulist)
+            return -EINVAL;
+        last = first;
+        cpulist = end;
+
+        if (*cpulist == '-') {
+            last = strtoul(++cpulist, &end, 10);
+            if (end == cpulist || last < first)
+                return -EINVAL;
+            cpulist = end;
+        }
+
+        for (cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+            CPU_SET(cpu, cpus);
+
+        if (*cpulist == ',' || *cpulist == ':')
+            cpulist++;
+        else if (*cpulist != '\0' && *cpulist != '\n')
+            return -EINVAL;
+    }
+
+    return CPU_COUNT(cpus) != 0 ? 0 : -EINVAL;
+}
+
+int
+dpu_cpulist_get_numa_node_cpus(int numa_node, cpu_set_t *cpus)
+{
+    char cpulist_path[64], cpulist[1024];
+    FILE *file;
+    int ret;
+
+    snprintf(cpulist_path, sizeof(cpulist_path), NUMA_NODE_CPULIST_PATH, numa_node);
+    file = fopen(cpulist_path, "r");
+    if (file == NULL)
+        return -errno;
+
+    ret = fgets(cpulist, sizeof(cpulist), file) != NULL ? dpu_cpulist_parse(cpulist, cpus) : -EIO;
+    fclose(file);
+
+    return ret;
+}
+
+int
+dpu_cpulist_get_nth_cpu(cpu_set_t *cpus, unsigned int n)
+{
+    unsigned int nb_cpus = CPU_COUNT(cpus), cpu;
+
+    n %= nb_cpus;
+    for (cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, cpus) && n-- == 0)
+            break;
+    }
+
+    return cpu;
+}
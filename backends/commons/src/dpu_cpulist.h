@@ -0,0 +1,26 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef DPU_CPULIST_H
+#define DPU_CPULIST_H
+
+/* cpu_set_t needs _GNU_SOURCE, defined by the includer before any system header */
+#include <sched.h>
+
+/* Parses a cpulist ("0-17,36-53"), where ':' also separates the ranges since ',' separates the properties of a profile.
+ * Returns 0, or -EINVAL if the list is malformed or empty.
+ */
+int
+dpu_cpulist_parse(const char *cpulist, cpu_set_t *cpus);
+
+/* Gets the CPUs of a NUMA node from sysfs: returns 0 or -errno */
+int
+dpu_cpulist_get_numa_node_cpus(int numa_node, cpu_set_t *cpus);
+
+/* Returns the n-th CPU of the set, the set being walked circularly */
+int
+dpu_cpulist_get_nth_cpu(cpu_set_t *cpus, unsigned int n);
+
+#endif /* DPU_CPULIST_H */
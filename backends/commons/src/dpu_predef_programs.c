@@ -8,43 +8,58 @@
 #include "dpu_package.h"
 
 #include <limits.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+/* A predefined program is read from its file at the first fetch, and then kept for the lifetime of the process */
+struct predef_program {
+    const char *name;
+    dpuinstruction_t *instructions;
+    iram_size_t size;
+};
+
+static pthread_mutex_t predef_programs_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct predef_program core_dump_program = { .name = "coreDump" };
+static struct predef_program restore_registers_program = { .name = "restoreRegisters" };
+static struct predef_program mram_access_program = { .name = "accessMramFromDpu" };
+static struct predef_program internal_reset_program = { .name = "internalStateReset" };
+
 static dpuinstruction_t *
-fetch_program(const char *name, iram_size_t *size);
+fetch_program(struct predef_program *program, iram_size_t *size);
 
 dpuinstruction_t *
 fetch_core_dump_program(iram_size_t *size)
 {
-    return fetch_program("coreDump", size);
+    return fetch_program(&core_dump_program, size);
 }
 
 dpuinstruction_t *
 fetch_restore_registers_program(iram_size_t *size)
 {
-    return fetch_program("restoreRegisters", size);
+    return fetch_program(&restore_registers_program, size);
 }
 
 dpuinstruction_t *
 fetch_mram_access_program(iram_size_t *size)
 {
-    return fetch_program("accessMramFromDpu", size);
+    return fetch_program(&mram_access_program, size);
 }
 
 dpuinstruction_t *
 fetch_internal_reset_program(iram_size_t *size)
 {
-    return fetch_program("internalStateReset", size);
+    return fetch_program(&internal_reset_program, size);
 }
 
 #define RELATIVE_PATH_TO_PROGRAM_DIR "/../share/upmem/include/misc/"
 #define PROGRAM_EXT ".bin"
 
 static dpuinstruction_t *
-fetch_program(const char *name, iram_size_t *size)
+load_program(const char *name, iram_size_t *size)
 {
     LOG_FN(VERBOSE, "%s", name);
 
@@ -90,6 +105,7 @@ fetch_program(const char *name, iram_size_t *size)
     iram_size_t read_size = (iram_size_t)fread(instructions, sizeof(*instructions), *size, file);
     if (read_size != *size) {
         LOG_FN(WARNING, "ERROR: did not read expected size of instructions");
+        free(instructions);
         fclose(file);
         return NULL;
     }
@@ -97,3 +113,25 @@ fetch_program(const char *name, iram_size_t *size)
     fclose(file);
     return instructions;
 }
+
+/* The caller owns the returned copy */
+static dpuinstruction_t *
+fetch_program(struct predef_program *program, iram_size_t *size)
+{
+    dpuinstruction_t *instructions = NULL;
+
+    pthread_mutex_lock(&predef_programs_mutex);
+
+    if (program->instructions == NULL) {
+        program->instructions = load_program(program->name, &program->size);
+    }
+
+    if ((program->instructions != NULL) && ((instructions = malloc(program->size * sizeof(*instructions))) != NULL)) {
+        memcpy(instructions, program->instructions, program->size * sizeof(*instructions));
+        *size = program->size;
+    }
+
+    pthread_mutex_unlock(&predef_programs_mutex);
+
+    return instructions;
+}
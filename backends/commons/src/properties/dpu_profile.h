@@ -32,14 +32,21 @@
 #define DPU_PROFILE_PROPERTY_MCOUNT_ADDRESS "mcountAddress" // Instruction address (not byte address)
 #define DPU_PROFILE_PROPERTY_RET_MCOUNT_ADDRESS "retMcountAddress" // Instruction address (not byte address)
 #define DPU_PROFILE_PROPERTY_THREAD_PROFILING_ADDRESS "threadProfilingAddress" // Instruction address (not byte address)
+#define DPU_PROFILE_PROPERTY_PROFILING_POLL_PERIOD "profilingPollPeriod" // default is 8 polls between two profiling reads
 #define DPU_PROFILE_PROPERTY_MRAM_ACCESS_BY_DPU_ONLY "mramAccessByDpuOnly"
 #define DPU_PROFILE_PROPERTY_DISABLED_MASK "disabledMask"
 #define DPU_PROFILE_PROPERTY_DISABLE_API_SAFE_CHECKS "disableSafeChecks"
 #define DPU_PROFILE_PROPERTY_DISABLE_MUX_SWITCH "disableMuxSwitch"
 #define DPU_PROFILE_PROPERTY_DISABLE_RESET_ON_ALLOC "disableResetOnAlloc"
 #define DPU_PROFILE_PROPERTY_DEBUG_CMDS_BUFFER_SIZE "cmdsBufferSize"
+#define DPU_PROFILE_PROPERTY_PARALLEL_DISPATCH "parallelDispatch" // run rank-set operations on one worker thread per rank
+#define DPU_PROFILE_PROPERTY_SYNC_STRATEGY "syncStrategy" // "spin" (default), "yield", "backoff" or "adaptive"
+#define DPU_PROFILE_PROPERTY_SYNC_MAX_SLEEP "syncMaxSleep" // in microseconds, upper bound of the "backoff" sleep
+#define DPU_PROFILE_PROPERTY_CONFIRM_CI_RESULTS "confirmCiResults" // read valid command results a second time
+#define DPU_PROFILE_PROPERTY_UFI_PLANNER "ufiPlanner" // merge the void commands of the CIs in the reset sequence
 
 /* Fsim */
+#define DPU_PROFILE_PROPERTY_NR_OF_CIS "nrCis"
 #define DPU_PROFILE_PROPERTY_NR_OF_DPUS_PER_CI "nrDpusPerCI"
 #define DPU_PROFILE_PROPERTY_MRAM_SIZE "mramSize"
 #define DPU_PROFILE_PROPERTY_WRAM_SIZE "wramSize"
@@ -74,9 +81,14 @@
 /* HW */
 #define DPU_PROFILE_PROPERTY_HW_REGION_MODE "regionMode"
 #define DPU_PROFILE_PROPERTY_RANK_PATH "rankPath"
+#define DPU_PROFILE_PROPERTY_RANK_NUMA_NODE "rankNumaNode" // "any" (default) or a node number, whose ranks are allocated first
 #define DPU_PROFILE_PROPERTY_MODULE_COMPAT "ignoreVersion"
 #define DPU_PROFILE_PROPERTY_TRY_REPAIR_IRAM "tryRepairIram"
 #define DPU_PROFILE_PROPERTY_TRY_REPAIR_WRAM "tryRepairWram"
+#define DPU_PROFILE_PROPERTY_XFER_THREADS "xferThreads" // number of PERF mode MRAM transfer threads of the rank
+#define DPU_PROFILE_PROPERTY_XFER_CPUS "xferCpus" // CPU list ("0-3:8"), transfer threads are pinned one per CPU
+#define DPU_PROFILE_PROPERTY_XFER_NUMA_NODE "xferNumaNode" // "local" (default, node of the rank), "none" or a node number
+#define DPU_PROFILE_PROPERTY_SAFE_RING "safeRing" // "off" (default), "auto" (if the driver has rings), "on"/"sqpoll" (required)
 
 /* Backup SPI */
 #define DPU_PROFILE_PROPERTY_BACKUP_SPI_USB_SERIAL "usbSerial"
@@ -0,0 +1,820 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Functional simulator rank backend: the memories of the DPUs, their control interfaces and the run and fault bits
+ * are modeled in host memory, so that the host API (allocation, reset, load, transfers, launch and poll) runs without
+ * any hardware.
+ *
+ * The DPU instructions are stored but not interpreted: a booted thread is considered to reach its stop instruction
+ * before the next poll of the run state. Programs (including the predefined ones run by the API) hence complete
+ * without side effect on the memories, which only change through the host accesses.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dpu_chip_config.h>
+#include <dpu_profile.h>
+#include <dpu_description.h>
+#include <dpu_types.h>
+#include <dpu_log_utils.h>
+#include <dpu_internals.h>
+
+#include "dpu_attributes.h"
+#include "dpu_rank.h"
+
+#include <dpu/ufi_ci_types.h>
+#include <dpu/ufi_ci_commands.h>
+
+#include "static_verbose.h"
+
+static struct verbose_control *this_vc;
+static struct verbose_control *
+__vc()
+{
+    if (this_vc == NULL) {
+        this_vc = get_verbose_control_for("fsim");
+    }
+    return this_vc;
+}
+
+#define FSIM_MAX_NR_DPUS_PER_CI 8
+#define FSIM_MAX_NR_RUN_BITS 64
+#define FSIM_NR_DMA_CTRL_REGISTERS 256
+
+/* Results of the discovery commands for a control interface wired without any byte or bit shuffling */
+#define FSIM_BYTE_ORDER_RESULT 0x000103FF0F8FCFEFULL
+#define FSIM_BIT_ORDER_RESULT 0x00884422U
+
+#define CI_COMMAND_TYPE(command) ((uint8_t)((command) >> 56))
+#define CI_ONE_WORD_TYPE 0x01
+#define CI_BYTE_ORDER_TYPE 0x77
+#define CI_STRUCT_TYPE 0x11
+#define CI_FRAME_TYPE 0x33
+
+#define CI_RESULT_VALID 0x000000FF00000000ULL
+#define CI_RESULT_COLOR_SHIFT 48
+
+/* Bits set in the positions of the parameters of a command encoding */
+#define PARAMETER_MASK(encoding, all_ones) ((encoding(all_ones)) ^ (encoding(0)))
+
+#define IRAM_WRITE_STRUCT_PARAMETER_MASK PARAMETER_MASK(CI_IRAM_WRITE_INSTRUCTION_STRUCT, 0xFFFF)
+#define WRAM_WRITE_STRUCT_PARAMETER_MASK PARAMETER_MASK(CI_WRAM_WRITE_WORD_STRUCT, 0xFFFF)
+#define INSTRUCTION_MASK (CI_IRAM_WRITE_INSTRUCTION_FRAME(0xFFFFFFFFFFFFULL, 0) ^ CI_IRAM_WRITE_INSTRUCTION_FRAME(0ULL, 0))
+#define WRAM_WORD_MASK (CI_WRAM_WRITE_WORD_FRAME(0xFFFFFFFFULL, 0) ^ CI_WRAM_WRITE_WORD_FRAME(0ULL, 0))
+
+#define IRAM_ADDRESS_BITS 16
+#define WRAM_ADDRESS_BITS 16
+#define RUN_BIT_BITS 6
+
+/* DMA control registers */
+#define DMA_CTRL_REGISTER_WRITE 0x20
+#define DMA_CTRL_MUX_REGISTER 0x80
+#define DMA_CTRL_READ_SELECT_REGISTER 0xFF
+#define DMA_CTRL_READ_MUX_STATUS 0x02
+#define MUX_STATUS_DPU_OWNER 0x03
+
+#define FSIM_FAULT_DPU (1 << 0)
+#define FSIM_FAULT_BKP (1 << 1)
+#define FSIM_FAULT_POISON (1 << 2)
+#define FSIM_FAULT_DMA (1 << 3)
+#define FSIM_FAULT_MEM (1 << 4)
+
+enum fsim_ci_operation {
+    FSIM_CI_SELECT_DPU,
+    FSIM_CI_SELECT_GROUP,
+    FSIM_CI_SELECT_ALL,
+    FSIM_CI_WRITE_GROUP,
+    FSIM_CI_DMA_CTRL_READ,
+    FSIM_CI_DMA_CTRL_WRITE,
+    FSIM_CI_READ_ZERO,
+    FSIM_CI_PC_MODE_READ,
+    FSIM_CI_PC_MODE_WRITE,
+    FSIM_CI_FAULT_READ,
+    FSIM_CI_FAULT_CLEAR,
+    FSIM_CI_FAULT_SET,
+    FSIM_CI_FAULT_READ_AND_CLEAR,
+    FSIM_CI_DPU_RUN_READ,
+    FSIM_CI_STACK_UP_READ_AND_CLEAR,
+    FSIM_CI_STACK_UP_READ_AND_SET,
+    FSIM_CI_THREAD_BOOT,
+    FSIM_CI_THREAD_CLEAR_RUN,
+    FSIM_CI_THREAD_READ_RUN,
+    FSIM_CI_IRAM_READ_BYTE,
+    FSIM_CI_WRAM_READ_WORD,
+};
+
+/* A frame is recognized when it matches 'frame' outside of the bits of its parameters. 'argument' refines the operation
+ * (fault kind, IRAM byte index).
+ */
+struct fsim_frame_decoder {
+    enum fsim_ci_operation operation;
+    uint8_t argument;
+    uint64_t frame;
+    uint64_t parameter_mask;
+};
+
+/* clang-format off */
+static const struct fsim_frame_decoder frame_decoders[] = {
+    { FSIM_CI_SELECT_DPU, 0, CI_SELECT_DPU_FRAME(0), PARAMETER_MASK(CI_SELECT_DPU_FRAME, 0xFF) },
+    { FSIM_CI_SELECT_GROUP, 0, CI_SELECT_GROUP_FRAME(0), PARAMETER_MASK(CI_SELECT_GROUP_FRAME, 0xFF) },
+    { FSIM_CI_SELECT_ALL, 0, CI_SELECT_ALL_FRAME, 0 },
+    { FSIM_CI_WRITE_GROUP, 0, CI_WRITE_GROUP_FRAME(0), PARAMETER_MASK(CI_WRITE_GROUP_FRAME, 0xFF) },
+    { FSIM_CI_DMA_CTRL_READ, 0, CI_DMA_CTRL_READ_FRAME, 0 },
+    { FSIM_CI_DMA_CTRL_WRITE, 0, CI_DMA_CTRL_WRITE_FRAME(0, 0, 0, 0, 0, 0),
+        CI_DMA_CTRL_WRITE_FRAME(0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF) ^ CI_DMA_CTRL_WRITE_FRAME(0, 0, 0, 0, 0, 0) },
+    { FSIM_CI_READ_ZERO, 0, CI_DMA_FAULT_THREAD_INDEX_READ_FRAME, 0 },
+    { FSIM_CI_READ_ZERO, 0, CI_BKP_FAULT_THREAD_INDEX_READ_FRAME, 0 },
+    { FSIM_CI_READ_ZERO, 0, CI_MEM_FAULT_THREAD_INDEX_READ_FRAME, 0 },
+    { FSIM_CI_READ_ZERO, 0, CI_PC_LSB_READ_FRAME, 0 },
+    { FSIM_CI_READ_ZERO, 0, CI_PC_MSB_READ_FRAME, 0 },
+    { FSIM_CI_PC_MODE_READ, 0, CI_PC_MODE_READ_FRAME, 0 },
+    { FSIM_CI_PC_MODE_WRITE, 0, CI_PC_MODE_WRITE_FRAME(0), PARAMETER_MASK(CI_PC_MODE_WRITE_FRAME, 0xFF) },
+    { FSIM_CI_FAULT_READ, FSIM_FAULT_DPU, CI_DPU_FAULT_STATE_READ_FRAME, 0 },
+    { FSIM_CI_FAULT_CLEAR, FSIM_FAULT_DPU, CI_DPU_FAULT_STATE_CLR_FRAME, 0 },
+    { FSIM_CI_FAULT_SET, FSIM_FAULT_DPU, CI_DPU_FAULT_STATE_SET_AND_STEP_FRAME, 0 },
+    { FSIM_CI_FAULT_READ, FSIM_FAULT_BKP, CI_BKP_FAULT_READ_FRAME, 0 },
+    { FSIM_CI_FAULT_CLEAR, FSIM_FAULT_BKP, CI_BKP_FAULT_CLEAR_FRAME, 0 },
+    { FSIM_CI_FAULT_SET, FSIM_FAULT_BKP | FSIM_FAULT_DPU, CI_BKP_FAULT_SET_FRAME, 0 },
+    { FSIM_CI_FAULT_READ, FSIM_FAULT_POISON, CI_POISON_FAULT_READ_FRAME, 0 },
+    { FSIM_CI_FAULT_CLEAR, FSIM_FAULT_POISON, CI_POISON_FAULT_CLEAR_FRAME, 0 },
+    { FSIM_CI_FAULT_SET, FSIM_FAULT_POISON | FSIM_FAULT_DPU, CI_POISON_FAULT_SET_FRAME, 0 },
+    { FSIM_CI_FAULT_READ_AND_CLEAR, FSIM_FAULT_DMA, CI_DMA_FAULT_READ_AND_CLR_FRAME, 0 },
+    { FSIM_CI_FAULT_READ_AND_CLEAR, FSIM_FAULT_MEM, CI_MEM_FAULT_READ_AND_CLR_FRAME, 0 },
+    { FSIM_CI_DPU_RUN_READ, 0, CI_DPU_RUN_STATE_READ_FRAME, 0 },
+    { FSIM_CI_STACK_UP_READ_AND_CLEAR, 0, CI_STACK_UP_READ_AND_CLR_FRAME, 0 },
+    { FSIM_CI_STACK_UP_READ_AND_SET, 0, CI_STACK_UP_READ_AND_SET_FRAME, 0 },
+    /* Notify bits are run bits after the thread ones: the notify commands are the thread ones */
+    { FSIM_CI_THREAD_BOOT, 0, CI_THREAD_BOOT_FRAME(0), PARAMETER_MASK(CI_THREAD_BOOT_FRAME, 0x3F) },
+    { FSIM_CI_THREAD_BOOT, 0, CI_THREAD_RESUME_FRAME(0), PARAMETER_MASK(CI_THREAD_RESUME_FRAME, 0x3F) },
+    { FSIM_CI_THREAD_CLEAR_RUN, 0, CI_THREAD_CLR_RUN_FRAME(0), PARAMETER_MASK(CI_THREAD_CLR_RUN_FRAME, 0x3F) },
+    { FSIM_CI_THREAD_READ_RUN, 0, CI_THREAD_READ_RUN_FRAME(0), PARAMETER_MASK(CI_THREAD_READ_RUN_FRAME, 0x3F) },
+    { FSIM_CI_IRAM_READ_BYTE, 0, CI_IRAM_READ_BYTE0_FRAME(0), PARAMETER_MASK(CI_IRAM_READ_BYTE0_FRAME, 0xFFFF) },
+    { FSIM_CI_IRAM_READ_BYTE, 1, CI_IRAM_READ_BYTE1_FRAME(0), PARAMETER_MASK(CI_IRAM_READ_BYTE1_FRAME, 0xFFFF) },
+    { FSIM_CI_IRAM_READ_BYTE, 2, CI_IRAM_READ_BYTE2_FRAME(0), PARAMETER_MASK(CI_IRAM_READ_BYTE2_FRAME, 0xFFFF) },
+    { FSIM_CI_IRAM_READ_BYTE, 3, CI_IRAM_READ_BYTE3_FRAME(0), PARAMETER_MASK(CI_IRAM_READ_BYTE3_FRAME, 0xFFFF) },
+    { FSIM_CI_IRAM_READ_BYTE, 4, CI_IRAM_READ_BYTE4_FRAME(0), PARAMETER_MASK(CI_IRAM_READ_BYTE4_FRAME, 0xFFFF) },
+    { FSIM_CI_IRAM_READ_BYTE, 5, CI_IRAM_READ_BYTE5_FRAME(0), PARAMETER_MASK(CI_IRAM_READ_BYTE5_FRAME, 0xFFFF) },
+    { FSIM_CI_WRAM_READ_WORD, 0, CI_WRAM_READ_WORD_FRAME(0), PARAMETER_MASK(CI_WRAM_READ_WORD_FRAME, 0xFFFF) },
+};
+/* clang-format on */
+
+#define NR_FRAME_DECODERS (sizeof(frame_decoders) / sizeof(frame_decoders[0]))
+
+struct fsim_dpu {
+    uint8_t *mram;
+    dpuword_t *wram;
+    dpuinstruction_t *iram;
+
+    uint64_t run_bits;
+    uint8_t faults;
+    uint8_t group;
+    bool stack_up;
+    uint8_t pc_mode;
+    uint8_t dma_ctrl[FSIM_NR_DMA_CTRL_REGISTERS];
+};
+
+struct fsim_ci {
+    /* Last structure word: it gives the meaning of the following frames */
+    uint64_t structure;
+    uint64_t result;
+    uint8_t color;
+    uint8_t selected_dpus;
+};
+
+typedef struct _fsim_dpu_rank_context_t {
+    struct fsim_ci cis[DPU_MAX_NR_CIS];
+    /* Indexed by slice_id * nr_of_dpus_per_control_interface + dpu_id */
+    struct fsim_dpu *dpus;
+} * fsim_dpu_rank_context_t;
+
+static dpu_rank_status_e
+fsim_allocate(struct dpu_rank_t *rank, dpu_description_t description);
+static dpu_rank_status_e
+fsim_free(struct dpu_rank_t *rank);
+static dpu_rank_status_e
+fsim_commit_commands(struct dpu_rank_t *rank, dpu_rank_buffer_t buffer);
+static dpu_rank_status_e
+fsim_update_commands(struct dpu_rank_t *rank, dpu_rank_buffer_t buffer);
+static dpu_rank_status_e
+fsim_copy_to_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
+static dpu_rank_status_e
+fsim_copy_from_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
+static dpu_rank_status_e
+fsim_fill_description_from_profile(dpu_properties_t properties, dpu_description_t description);
+static dpu_rank_status_e
+fsim_custom_operation(struct dpu_rank_t *rank,
+    dpu_slice_id_t slice_id,
+    dpu_member_id_t member_id,
+    dpu_custom_command_t command,
+    dpu_custom_command_args_t args);
+
+const __API_SYMBOL__ struct dpu_rank_handler fsim_dpu_rank_handler = {
+    .allocate = fsim_allocate,
+    .free = fsim_free,
+    .commit_commands = fsim_commit_commands,
+    .update_commands = fsim_update_commands,
+    .copy_to_rank = fsim_copy_to_rank,
+    .copy_from_rank = fsim_copy_from_rank,
+    .fill_description_from_profile = fsim_fill_description_from_profile,
+    .custom_operation = fsim_custom_operation,
+    .print_lldb_message_on_fault = print_lldb_message_on_fault_do_nothing,
+};
+
+static inline fsim_dpu_rank_context_t
+_this(struct dpu_rank_t *rank)
+{
+    return (fsim_dpu_rank_context_t)(rank->_internals);
+}
+
+static inline struct fsim_dpu *
+get_dpu(struct dpu_rank_t *rank, dpu_slice_id_t slice_id, dpu_member_id_t dpu_id)
+{
+    return &_this(rank)->dpus[slice_id * rank->description->topology.nr_of_dpus_per_control_interface + dpu_id];
+}
+
+static inline int
+get_transfer_matrix_index(struct dpu_rank_t *rank, dpu_slice_id_t slice_id, dpu_id_t dpu_id)
+{
+    return dpu_id * rank->description->topology.nr_of_control_interfaces + slice_id;
+}
+
+/* Encodings of the parameters which are scattered over the structure and the frame of their command */
+static uint64_t
+encode_iram_write_structure(uint32_t address)
+{
+    return CI_IRAM_WRITE_INSTRUCTION_STRUCT(address);
+}
+
+static uint64_t
+encode_iram_write_frame(uint32_t address)
+{
+    return CI_IRAM_WRITE_INSTRUCTION_FRAME(0ULL, address);
+}
+
+static uint64_t
+encode_iram_read_frame(uint32_t address)
+{
+    return CI_IRAM_READ_BYTE0_FRAME(address);
+}
+
+static uint64_t
+encode_wram_write_structure(uint32_t address)
+{
+    return CI_WRAM_WRITE_WORD_STRUCT(address);
+}
+
+static uint64_t
+encode_wram_write_frame(uint32_t address)
+{
+    return CI_WRAM_WRITE_WORD_FRAME(0ULL, address);
+}
+
+static uint64_t
+encode_wram_read_frame(uint32_t address)
+{
+    return CI_WRAM_READ_WORD_FRAME(address);
+}
+
+/* The run bit is at the same place in all the thread commands */
+static uint64_t
+encode_run_bit_frame(uint32_t run_bit)
+{
+    return CI_THREAD_BOOT_FRAME(run_bit);
+}
+
+/* Each bit of the parameter is found back by encoding the parameter with only this bit set. The bits of the command
+ * which do not depend on the parameter are ignored, so that any command of the same layout can be decoded.
+ */
+static uint32_t
+decode_parameter(uint64_t command, uint64_t (*encode)(uint32_t), uint8_t nr_bits)
+{
+    uint64_t zero = encode(0);
+    uint32_t value = 0;
+
+    for (uint8_t each_bit = 0; each_bit < nr_bits; ++each_bit) {
+        if (((command ^ zero) & (encode(1U << each_bit) ^ zero)) != 0) {
+            value |= 1U << each_bit;
+        }
+    }
+
+    return value;
+}
+
+static const struct fsim_frame_decoder *
+decode_frame(uint64_t frame)
+{
+    for (unsigned int each_decoder = 0; each_decoder < NR_FRAME_DECODERS; ++each_decoder) {
+        const struct fsim_frame_decoder *decoder = &frame_decoders[each_decoder];
+
+        if (((frame ^ decoder->frame) & ~decoder->parameter_mask) == 0) {
+            return decoder;
+        }
+    }
+
+    return NULL;
+}
+
+static inline uint64_t
+make_result(struct fsim_ci *ci, uint32_t data)
+{
+    uint64_t color = ci->color ? 0xFFULL : 0x00ULL;
+
+    return (color << CI_RESULT_COLOR_SHIFT) | CI_RESULT_VALID | data;
+}
+
+static uint8_t
+all_dpus_mask(struct dpu_rank_t *rank)
+{
+    return (uint8_t)((1 << rank->description->topology.nr_of_dpus_per_control_interface) - 1);
+}
+
+static void
+reset_ci(struct dpu_rank_t *rank, dpu_slice_id_t slice_id)
+{
+    struct fsim_ci *ci = &_this(rank)->cis[slice_id];
+
+    ci->structure = 0;
+    ci->color = 0;
+    ci->selected_dpus = 0;
+
+    for (dpu_member_id_t each_dpu = 0; each_dpu < rank->description->topology.nr_of_dpus_per_control_interface; ++each_dpu) {
+        struct fsim_dpu *dpu = get_dpu(rank, slice_id, each_dpu);
+
+        /* The memories keep their content */
+        dpu->run_bits = 0;
+        dpu->faults = 0;
+        dpu->group = 0;
+        dpu->stack_up = false;
+        dpu->pc_mode = 0;
+        memset(dpu->dma_ctrl, 0, sizeof(dpu->dma_ctrl));
+    }
+}
+
+static uint8_t
+select_group(struct dpu_rank_t *rank, dpu_slice_id_t slice_id, uint8_t group)
+{
+    uint8_t mask = 0;
+
+    for (dpu_member_id_t each_dpu = 0; each_dpu < rank->description->topology.nr_of_dpus_per_control_interface; ++each_dpu) {
+        if (get_dpu(rank, slice_id, each_dpu)->group == group) {
+            mask |= 1 << each_dpu;
+        }
+    }
+
+    return mask;
+}
+
+static struct fsim_dpu *
+first_selected_dpu(struct dpu_rank_t *rank, dpu_slice_id_t slice_id)
+{
+    uint8_t selected = _this(rank)->cis[slice_id].selected_dpus;
+
+    return (selected == 0) ? NULL : get_dpu(rank, slice_id, __builtin_ctz(selected));
+}
+
+static uint8_t
+read_dma_ctrl(struct fsim_dpu *dpu)
+{
+    if ((dpu->dma_ctrl[DMA_CTRL_READ_SELECT_REGISTER] & 0x7F) == DMA_CTRL_READ_MUX_STATUS) {
+        return (dpu->dma_ctrl[DMA_CTRL_MUX_REGISTER] & 1) ? MUX_STATUS_DPU_OWNER : 0;
+    }
+
+    return 0;
+}
+
+static void
+write_dma_ctrl(struct fsim_dpu *dpu, uint64_t frame)
+{
+    uint8_t b0 = (frame >> 0) & 0xFF, b1 = (frame >> 8) & 0xFF, b2 = (frame >> 16) & 0xFF, b3 = (frame >> 24) & 0xFF;
+    uint8_t b5 = (frame >> 40) & 0xFF;
+
+    /* Only the register writes are modeled (not the WRAM repair configuration) */
+    if (b5 != DMA_CTRL_REGISTER_WRITE) {
+        return;
+    }
+
+    dpu->dma_ctrl[((b0 & 0xF) << 4) | (b1 & 0xF)] = ((b2 & 0xF) << 4) | (b3 & 0xF);
+}
+
+/* Applies the frame to the selected DPUs of the control interface and returns the data of the result */
+static uint32_t
+execute_frame(struct dpu_rank_t *rank, dpu_slice_id_t slice_id, uint64_t frame)
+{
+    dpu_description_t description = rank->description;
+    struct fsim_ci *ci = &_this(rank)->cis[slice_id];
+    const struct fsim_frame_decoder *decoder;
+    uint64_t thread_bits = (1ULL << description->dpu.nr_of_threads) - 1;
+    uint8_t nr_dpus = description->topology.nr_of_dpus_per_control_interface;
+    uint8_t mask = 0;
+    struct fsim_dpu *dpu;
+
+    if ((ci->structure & ~IRAM_WRITE_STRUCT_PARAMETER_MASK) == CI_IRAM_WRITE_INSTRUCTION_STRUCT(0)) {
+        uint32_t address = decode_parameter(ci->structure, encode_iram_write_structure, IRAM_ADDRESS_BITS)
+            | decode_parameter(frame, encode_iram_write_frame, IRAM_ADDRESS_BITS);
+
+        for (dpu_member_id_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+            if ((ci->selected_dpus & (1 << each_dpu)) && (address < description->memories.iram_size)) {
+                get_dpu(rank, slice_id, each_dpu)->iram[address] = frame & INSTRUCTION_MASK;
+            }
+        }
+
+        return ci->selected_dpus;
+    }
+
+    if ((ci->structure & ~WRAM_WRITE_STRUCT_PARAMETER_MASK) == CI_WRAM_WRITE_WORD_STRUCT(0)) {
+        uint32_t address = decode_parameter(ci->structure, encode_wram_write_structure, WRAM_ADDRESS_BITS)
+            | decode_parameter(frame, encode_wram_write_frame, WRAM_ADDRESS_BITS);
+
+        for (dpu_member_id_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+            if ((ci->selected_dpus & (1 << each_dpu)) && (address < description->memories.wram_size)) {
+                get_dpu(rank, slice_id, each_dpu)->wram[address] = (dpuword_t)(frame & WRAM_WORD_MASK);
+            }
+        }
+
+        return ci->selected_dpus;
+    }
+
+    if ((decoder = decode_frame(frame)) == NULL) {
+        /* Configuration frames (repair, carousel, timings...) have no effect on the model */
+        return ci->selected_dpus;
+    }
+
+    switch (decoder->operation) {
+        case FSIM_CI_SELECT_DPU:
+            ci->selected_dpus = (1 << ((frame >> 8) & 0xFF)) & all_dpus_mask(rank);
+            return ci->selected_dpus;
+        case FSIM_CI_SELECT_GROUP:
+            ci->selected_dpus = select_group(rank, slice_id, (frame >> 8) & 0xFF);
+            return ci->selected_dpus;
+        case FSIM_CI_SELECT_ALL:
+            ci->selected_dpus = all_dpus_mask(rank);
+            return ci->selected_dpus;
+        case FSIM_CI_DMA_CTRL_READ:
+            dpu = first_selected_dpu(rank, slice_id);
+            return (dpu == NULL) ? 0 : read_dma_ctrl(dpu);
+        case FSIM_CI_READ_ZERO:
+            return 0;
+        case FSIM_CI_PC_MODE_READ:
+            dpu = first_selected_dpu(rank, slice_id);
+            return (dpu == NULL) ? 0 : dpu->pc_mode;
+        case FSIM_CI_IRAM_READ_BYTE: {
+            uint32_t address = decode_parameter(frame, encode_iram_read_frame, IRAM_ADDRESS_BITS);
+
+            dpu = first_selected_dpu(rank, slice_id);
+            if ((dpu == NULL) || (address >= description->memories.iram_size)) {
+                return 0;
+            }
+            return (dpu->iram[address] >> (decoder->argument * 8)) & 0xFF;
+        }
+        case FSIM_CI_WRAM_READ_WORD: {
+            uint32_t address = decode_parameter(frame, encode_wram_read_frame, WRAM_ADDRESS_BITS);
+
+            dpu = first_selected_dpu(rank, slice_id);
+            if ((dpu == NULL) || (address >= description->memories.wram_size)) {
+                return 0;
+            }
+            return dpu->wram[address];
+        }
+        default:
+            break;
+    }
+
+    /* The other operations apply to each selected DPU and return the mask of the DPUs for which the bit they access
+     * was set before the operation.
+     */
+    for (dpu_member_id_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        uint64_t run_bit;
+        bool previous = false;
+
+        if ((ci->selected_dpus & (1 << each_dpu)) == 0) {
+            continue;
+        }
+
+        dpu = get_dpu(rank, slice_id, each_dpu);
+
+        switch (decoder->operation) {
+            case FSIM_CI_WRITE_GROUP:
+                dpu->group = (frame >> 8) & 0xFF;
+                previous = true;
+                break;
+            case FSIM_CI_DMA_CTRL_WRITE:
+                write_dma_ctrl(dpu, frame);
+                previous = true;
+                break;
+            case FSIM_CI_PC_MODE_WRITE:
+                dpu->pc_mode = frame & 0xFF;
+                previous = true;
+                break;
+            case FSIM_CI_FAULT_READ:
+                previous = (dpu->faults & decoder->argument) != 0;
+                break;
+            case FSIM_CI_FAULT_CLEAR:
+                previous = (dpu->faults & decoder->argument) != 0;
+                dpu->faults &= ~decoder->argument;
+                break;
+            case FSIM_CI_FAULT_SET:
+                previous = (dpu->faults & decoder->argument) != 0;
+                dpu->faults |= decoder->argument;
+                break;
+            case FSIM_CI_FAULT_READ_AND_CLEAR:
+                previous = (dpu->faults & decoder->argument) != 0;
+                dpu->faults &= ~decoder->argument;
+                break;
+            case FSIM_CI_DPU_RUN_READ:
+                /* The booted threads run to their stop until the next poll */
+                previous = (dpu->run_bits & thread_bits) != 0;
+                dpu->run_bits &= ~thread_bits;
+                break;
+            case FSIM_CI_STACK_UP_READ_AND_CLEAR:
+                previous = dpu->stack_up;
+                dpu->stack_up = false;
+                break;
+            case FSIM_CI_STACK_UP_READ_AND_SET:
+                previous = dpu->stack_up;
+                dpu->stack_up = true;
+                break;
+            case FSIM_CI_THREAD_BOOT:
+                run_bit = 1ULL << decode_parameter(frame, encode_run_bit_frame, RUN_BIT_BITS);
+                previous = (dpu->run_bits & run_bit) != 0;
+                dpu->run_bits |= run_bit;
+                break;
+            case FSIM_CI_THREAD_CLEAR_RUN:
+                run_bit = 1ULL << decode_parameter(frame, encode_run_bit_frame, RUN_BIT_BITS);
+                previous = (dpu->run_bits & run_bit) != 0;
+                dpu->run_bits &= ~run_bit;
+                break;
+            case FSIM_CI_THREAD_READ_RUN:
+                run_bit = 1ULL << decode_parameter(frame, encode_run_bit_frame, RUN_BIT_BITS);
+                previous = (dpu->run_bits & run_bit) != 0;
+                break;
+            default:
+                break;
+        }
+
+        if (previous) {
+            mask |= 1 << each_dpu;
+        }
+    }
+
+    return mask;
+}
+
+static uint64_t
+execute_command(struct dpu_rank_t *rank, dpu_slice_id_t slice_id, uint64_t command)
+{
+    struct fsim_ci *ci = &_this(rank)->cis[slice_id];
+    uint64_t result;
+
+    switch (CI_COMMAND_TYPE(command)) {
+        case CI_BYTE_ORDER_TYPE:
+            result = FSIM_BYTE_ORDER_RESULT;
+            break;
+        case CI_ONE_WORD_TYPE:
+            if ((command & ~0xFFULL) == (CI_SOFTWARE_RESET(0, 0) & ~0xFFULL)) {
+                reset_ci(rank, slice_id);
+                /* The host resets its color after the command */
+                return make_result(ci, 0);
+            }
+
+            if (command == CI_IDENTITY) {
+                result = make_result(ci, rank->description->signature.chip_id);
+            } else if ((command >> 48) == (CI_BIT_ORDER(0, 0, 0, 0) >> 48)) {
+                result = make_result(ci, FSIM_BIT_ORDER_RESULT);
+            } else {
+                result = make_result(ci, 0);
+            }
+            break;
+        case CI_STRUCT_TYPE:
+            ci->structure = command;
+            result = make_result(ci, ci->selected_dpus);
+            break;
+        case CI_FRAME_TYPE:
+            result = make_result(ci, execute_frame(rank, slice_id, command));
+            break;
+        default:
+            LOG_CI(WARNING, rank, slice_id, "unknown command 0x%016" PRIx64, command);
+            result = make_result(ci, 0);
+            break;
+    }
+
+    ci->color ^= 1;
+
+    return result;
+}
+
+static dpu_rank_status_e
+fsim_commit_commands(struct dpu_rank_t *rank, dpu_rank_buffer_t buffer)
+{
+    fsim_dpu_rank_context_t rank_context = _this(rank);
+
+    for (dpu_slice_id_t each_ci = 0; each_ci < rank->description->topology.nr_of_control_interfaces; ++each_ci) {
+        if (buffer[each_ci] != CI_EMPTY) {
+            rank_context->cis[each_ci].result = execute_command(rank, each_ci, buffer[each_ci]);
+        }
+    }
+
+    return DPU_RANK_SUCCESS;
+}
+
+static dpu_rank_status_e
+fsim_update_commands(struct dpu_rank_t *rank, dpu_rank_buffer_t buffer)
+{
+    fsim_dpu_rank_context_t rank_context = _this(rank);
+
+    for (dpu_slice_id_t each_ci = 0; each_ci < rank->description->topology.nr_of_control_interfaces; ++each_ci) {
+        buffer[each_ci] = rank_context->cis[each_ci].result;
+    }
+
+    return DPU_RANK_SUCCESS;
+}
+
+static dpu_rank_status_e
+copy_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix, bool to_mram)
+{
+    dpu_description_t description = rank->description;
+
+    for (dpu_slice_id_t each_ci = 0; each_ci < description->topology.nr_of_control_interfaces; ++each_ci) {
+        for (dpu_member_id_t each_dpu = 0; each_dpu < description->topology.nr_of_dpus_per_control_interface; ++each_dpu) {
+            struct dpu_transfer_mram *transfer = &transfer_matrix[get_transfer_matrix_index(rank, each_ci, each_dpu)];
+            uint8_t *mram;
+
+            if (transfer->ptr == NULL) {
+                continue;
+            }
+
+            if ((transfer->mram_number != 0)
+                || ((uint64_t)transfer->offset_in_mram + transfer->size > description->memories.mram_size)) {
+                LOG_CI(WARNING,
+                    rank,
+                    each_ci,
+                    "invalid transfer for DPU %u (MRAM %u, offset 0x%x, size 0x%x)",
+                    each_dpu,
+                    transfer->mram_number,
+                    transfer->offset_in_mram,
+                    transfer->size);
+                return DPU_RANK_BACKEND_ERROR;
+            }
+
+            mram = get_dpu(rank, each_ci, each_dpu)->mram + transfer->offset_in_mram;
+
+            if (to_mram) {
+                memcpy(mram, transfer->ptr, transfer->size);
+            } else {
+                memcpy(transfer->ptr, mram, transfer->size);
+            }
+        }
+    }
+
+    return DPU_RANK_SUCCESS;
+}
+
+static dpu_rank_status_e
+fsim_copy_to_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
+{
+    return copy_rank(rank, transfer_matrix, true);
+}
+
+static dpu_rank_status_e
+fsim_copy_from_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
+{
+    return copy_rank(rank, transfer_matrix, false);
+}
+
+static void
+free_dpus(struct fsim_dpu *dpus, uint32_t nr_dpus)
+{
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        free(dpus[each_dpu].mram);
+        free(dpus[each_dpu].wram);
+        free(dpus[each_dpu].iram);
+    }
+
+    free(dpus);
+}
+
+static dpu_rank_status_e
+fsim_allocate(struct dpu_rank_t *rank, dpu_description_t description)
+{
+    fsim_dpu_rank_context_t rank_context;
+    uint32_t nr_dpus = description->topology.nr_of_control_interfaces * description->topology.nr_of_dpus_per_control_interface;
+
+    if ((rank_context = calloc(1, sizeof(*rank_context))) == NULL) {
+        return DPU_RANK_SYSTEM_ERROR;
+    }
+
+    if ((rank_context->dpus = calloc(nr_dpus, sizeof(*(rank_context->dpus)))) == NULL) {
+        free(rank_context);
+        return DPU_RANK_SYSTEM_ERROR;
+    }
+
+    /* The MRAMs are only backed by physical memory once accessed */
+    for (uint32_t each_dpu = 0; each_dpu < nr_dpus; ++each_dpu) {
+        struct fsim_dpu *dpu = &rank_context->dpus[each_dpu];
+
+        dpu->mram = calloc(description->memories.mram_size, 1);
+        dpu->wram = calloc(description->memories.wram_size, sizeof(*(dpu->wram)));
+        dpu->iram = calloc(description->memories.iram_size, sizeof(*(dpu->iram)));
+
+        if ((dpu->mram == NULL) || (dpu->wram == NULL) || (dpu->iram == NULL)) {
+            free_dpus(rank_context->dpus, nr_dpus);
+            free(rank_context);
+            return DPU_RANK_SYSTEM_ERROR;
+        }
+    }
+
+    rank->_internals = rank_context;
+    rank->description = description;
+
+    /* The MRAM mux is modeled: the API drives it as on hardware */
+    description->configuration.api_must_switch_mram_mux = true;
+    description->configuration.init_mram_mux = true;
+
+    for (dpu_slice_id_t each_ci = 0; each_ci < description->topology.nr_of_control_interfaces; ++each_ci) {
+        reset_ci(rank, each_ci);
+    }
+
+    LOG_RANK(VERBOSE,
+        rank,
+        "%u control interfaces of %u DPUs",
+        description->topology.nr_of_control_interfaces,
+        description->topology.nr_of_dpus_per_control_interface);
+
+    return DPU_RANK_SUCCESS;
+}
+
+static dpu_rank_status_e
+fsim_free(struct dpu_rank_t *rank)
+{
+    fsim_dpu_rank_context_t rank_context = _this(rank);
+
+    free_dpus(rank_context->dpus,
+        rank->description->topology.nr_of_control_interfaces * rank->description->topology.nr_of_dpus_per_control_interface);
+    free(rank_context);
+
+    return DPU_RANK_SUCCESS;
+}
+
+#define validate(p)                                                                                                              \
+    do {                                                                                                                         \
+        if (!(p))                                                                                                                \
+            return DPU_RANK_INVALID_PROPERTY_ERROR;                                                                              \
+    } while (0)
+
+static dpu_rank_status_e
+fsim_fill_description_from_profile(dpu_properties_t properties, dpu_description_t description)
+{
+    dpu_description_t default_description;
+    uint32_t nr_cis, nr_dpus_per_ci, mram_size, wram_size, iram_size;
+
+    if ((default_description = default_description_for_chip(vD_fun)) == NULL) {
+        return DPU_RANK_SYSTEM_ERROR;
+    }
+
+    memcpy(description, default_description, sizeof(*description));
+
+    validate(fetch_integer_property(properties,
+        DPU_PROFILE_PROPERTY_NR_OF_CIS,
+        &nr_cis,
+        description->topology.nr_of_control_interfaces));
+    validate((nr_cis != 0) && (nr_cis <= DPU_MAX_NR_CIS));
+    validate(fetch_integer_property(properties,
+        DPU_PROFILE_PROPERTY_NR_OF_DPUS_PER_CI,
+        &nr_dpus_per_ci,
+        description->topology.nr_of_dpus_per_control_interface));
+    validate((nr_dpus_per_ci != 0) && (nr_dpus_per_ci <= FSIM_MAX_NR_DPUS_PER_CI));
+    validate(fetch_integer_property(properties, DPU_PROFILE_PROPERTY_MRAM_SIZE, &mram_size, description->memories.mram_size));
+    validate((mram_size != 0) && ((mram_size % sizeof(uint64_t)) == 0));
+    validate(fetch_integer_property(properties, DPU_PROFILE_PROPERTY_WRAM_SIZE, &wram_size, description->memories.wram_size));
+    validate((wram_size != 0) && (wram_size <= (1U << WRAM_ADDRESS_BITS)));
+    validate(fetch_integer_property(properties, DPU_PROFILE_PROPERTY_IRAM_SIZE, &iram_size, description->memories.iram_size));
+    validate((iram_size != 0) && (iram_size < (1U << IRAM_ADDRESS_BITS)));
+    validate((description->dpu.nr_of_threads + description->dpu.nr_of_notify_bits) <= FSIM_MAX_NR_RUN_BITS);
+
+    description->topology.nr_of_control_interfaces = (uint8_t)nr_cis;
+    description->topology.nr_of_dpus_per_control_interface = (uint8_t)nr_dpus_per_ci;
+    description->memories.mram_size = mram_size;
+    description->memories.wram_size = wram_size;
+    description->memories.iram_size = (iram_size_t)iram_size;
+    /* No debug MRAM and no SRAM defect to repair */
+    description->memories.dbg_mram_size = 0;
+    description->configuration.do_iram_repair = false;
+    description->configuration.do_wram_repair = false;
+
+    description->_internals.data = NULL;
+    description->_internals.free = free;
+
+    return DPU_RANK_SUCCESS;
+}
+
+static dpu_rank_status_e
+fsim_custom_operation(__attribute__((unused)) struct dpu_rank_t *rank,
+    __attribute__((unused)) dpu_slice_id_t slice_id,
+    __attribute__((unused)) dpu_member_id_t member_id,
+    __attribute__((unused)) dpu_custom_command_t command,
+    __attribute__((unused)) dpu_custom_command_args_t args)
+{
+    return DPU_RANK_SUCCESS;
+}
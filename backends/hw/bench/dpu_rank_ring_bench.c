@@ -0,0 +1,279 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Runs the SAFE mode sequence of the UFI layer (the commit of the commands of every CI, then the read of their
+ * results) and some MRAM transfers against the mock rank device, once with one ioctl per operation, then through the
+ * rings, with and without the polling thread. Each mode is checked:
+ *  - the results read after a commit must be the commands committed, which the mock loops back,
+ *  - the MRAM read back after a write must be the host buffers.
+ * The time and the number of driver entries per operation are then reported.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+
+#include "dpu_region_address_translation.h"
+#include "hw_dpu_ring.h"
+#include "hw_dpu_ring_mock.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NB_CIS 8
+#define NB_DPUS_PER_CI 8
+#define NB_DPUS (NB_CIS * NB_DPUS_PER_CI)
+
+#define NB_RING_ENTRIES 64
+#define DEFAULT_MRAM_SIZE (64 << 10)
+#define DEFAULT_NR_ITERATIONS (1 << 18)
+/* One MRAM write and read back every TRANSFER_PERIOD commit/update pairs */
+#define TRANSFER_PERIOD 1024
+#define TRANSFER_SIZE 2048
+
+enum bench_mode {
+    BENCH_MODE_IOCTL,
+    BENCH_MODE_RING,
+    BENCH_MODE_SQPOLL,
+    NB_BENCH_MODES,
+};
+
+static const char *const mode_names[NB_BENCH_MODES] = { "ioctl", "ring", "sqpoll" };
+
+struct bench_run {
+    enum bench_mode mode;
+    struct dpu_rank_ring_mock *mock;
+    struct dpu_rank_ring ring;
+    struct dpu_transfer_mram matrix[NB_DPUS];
+    uint8_t *buffers;
+    uint32_t transfer_size;
+};
+
+static double
+now_in_us(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static uint64_t
+next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Same operations as hw_dpu_rank.c in SAFE mode: returns 0 or -errno */
+static int
+run_ioctl(struct bench_run *run, unsigned long request, void *arg)
+{
+    if (dpu_rank_ring_mock_device.ioctl(run->mock, request, arg) != 0)
+        return -errno;
+
+    return 0;
+}
+
+static int
+commit_commands(struct bench_run *run, uint64_t *commands)
+{
+    if (run->mode == BENCH_MODE_IOCTL)
+        return run_ioctl(run, DPU_RANK_IOCTL_COMMIT_COMMANDS, commands);
+
+    return dpu_rank_ring_commit_commands(&run->ring, commands, NB_CIS);
+}
+
+static int
+update_commands(struct bench_run *run, uint64_t *results)
+{
+    if (run->mode == BENCH_MODE_IOCTL)
+        return run_ioctl(run, DPU_RANK_IOCTL_UPDATE_COMMANDS, results);
+
+    return dpu_rank_ring_run(&run->ring, DPU_RANK_RING_OP_UPDATE_COMMANDS, results);
+}
+
+static int
+copy_rank(struct bench_run *run, bool to_rank)
+{
+    if (run->mode == BENCH_MODE_IOCTL)
+        return run_ioctl(run, to_rank ? DPU_RANK_IOCTL_WRITE_TO_RANK : DPU_RANK_IOCTL_READ_FROM_RANK, run->matrix);
+
+    return dpu_rank_ring_run(
+        &run->ring, to_rank ? DPU_RANK_RING_OP_WRITE_TO_RANK : DPU_RANK_RING_OP_READ_FROM_RANK, run->matrix);
+}
+
+/* Writes random buffers to the MRAMs, reads them back over the buffers cleared, and compares */
+static bool
+check_transfer(struct bench_run *run, uint32_t mram_size, uint64_t *seed)
+{
+    uint32_t offset = (uint32_t)(next_random(seed) % (mram_size - run->transfer_size + 1)) & ~7u;
+    size_t total_size = (size_t)NB_DPUS * run->transfer_size;
+    uint8_t *expected = malloc(total_size);
+    bool success = false;
+    int ret;
+
+    if (expected == NULL)
+        return false;
+
+    for (size_t i = 0; i < total_size; i += sizeof(uint64_t)) {
+        uint64_t value = next_random(seed);
+
+        memcpy(run->buffers + i, &value, sizeof(value));
+    }
+    memcpy(expected, run->buffers, total_size);
+
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        run->matrix[each_dpu].ptr = run->buffers + (size_t)each_dpu * run->transfer_size;
+        run->matrix[each_dpu].offset_in_mram = offset;
+        run->matrix[each_dpu].mram_number = 0;
+        run->matrix[each_dpu].size = run->transfer_size;
+    }
+
+    if ((ret = copy_rank(run, true)) != 0) {
+        fprintf(stderr, "%s: write_to_rank: %s\n", mode_names[run->mode], strerror(-ret));
+        goto end;
+    }
+    memset(run->buffers, 0, total_size);
+    if ((ret = copy_rank(run, false)) != 0) {
+        fprintf(stderr, "%s: read_from_rank: %s\n", mode_names[run->mode], strerror(-ret));
+        goto end;
+    }
+
+    if (memcmp(run->buffers, expected, total_size) != 0) {
+        fprintf(stderr, "%s: the MRAM read back differs from the MRAM written\n", mode_names[run->mode]);
+        goto end;
+    }
+    if (memcmp(dpu_rank_ring_mock_get_mram(run->mock, NB_DPUS - 1) + offset,
+            expected + (size_t)(NB_DPUS - 1) * run->transfer_size,
+            run->transfer_size)
+        != 0) {
+        fprintf(stderr, "%s: the MRAM of the last DPU differs from its buffer\n", mode_names[run->mode]);
+        goto end;
+    }
+
+    success = true;
+end:
+    free(expected);
+    return success;
+}
+
+static bool
+run_mode(enum bench_mode mode, uint32_t mram_size, uint32_t nr_iterations)
+{
+    struct bench_run run = { .mode = mode };
+    uint64_t commands[NB_CIS], results[NB_CIS];
+    uint64_t seed = 0x5AFE;
+    uint64_t nb_ioctls, nb_ops = 0;
+    bool success = false;
+    double start, end;
+    int ret;
+
+    run.transfer_size = mram_size < TRANSFER_SIZE ? mram_size : TRANSFER_SIZE;
+
+    if ((run.mock = dpu_rank_ring_mock_create(NB_CIS, NB_DPUS_PER_CI, mram_size, mode == BENCH_MODE_SQPOLL)) == NULL) {
+        fprintf(stderr, "%s: cannot create the mock rank\n", mode_names[mode]);
+        return false;
+    }
+    if ((run.buffers = malloc((size_t)NB_DPUS * run.transfer_size)) == NULL)
+        goto destroy_mock;
+
+    if (mode != BENCH_MODE_IOCTL) {
+        ret = dpu_rank_ring_init(&run.ring,
+            &dpu_rank_ring_mock_device,
+            run.mock,
+            NB_RING_ENTRIES,
+            mode == BENCH_MODE_SQPOLL ? DPU_RANK_RING_SETUP_SQPOLL : 0);
+        if (ret != 0) {
+            fprintf(stderr, "%s: cannot set the rings up: %s\n", mode_names[mode], strerror(-ret));
+            goto free_buffers;
+        }
+    }
+
+    nb_ioctls = dpu_rank_ring_mock_get_nb_ioctls(run.mock);
+    start = now_in_us();
+
+    for (uint32_t each_iteration = 0; each_iteration < nr_iterations; ++each_iteration) {
+        for (uint32_t each_ci = 0; each_ci < NB_CIS; ++each_ci)
+            commands[each_ci] = next_random(&seed);
+
+        if ((ret = commit_commands(&run, commands)) != 0 || (ret = update_commands(&run, results)) != 0) {
+            fprintf(stderr, "%s: commit/update: %s\n", mode_names[mode], strerror(-ret));
+            goto destroy_ring;
+        }
+        nb_ops += 2;
+
+        if (memcmp(commands, results, sizeof(commands)) != 0) {
+            fprintf(stderr, "%s: iteration %u: the results differ from the commands\n", mode_names[mode], each_iteration);
+            goto destroy_ring;
+        }
+
+        if ((each_iteration % TRANSFER_PERIOD) == 0) {
+            if (!check_transfer(&run, mram_size, &seed))
+                goto destroy_ring;
+            nb_ops += 2;
+        }
+    }
+
+    end = now_in_us();
+    nb_ioctls = dpu_rank_ring_mock_get_nb_ioctls(run.mock) - nb_ioctls;
+
+    printf("%-8s %14.1f %14.3f\n", mode_names[mode], (end - start) * 1e3 / (double)nb_ops, (double)nb_ioctls / (double)nb_ops);
+    success = true;
+
+destroy_ring:
+    if (mode != BENCH_MODE_IOCTL)
+        dpu_rank_ring_destroy(&run.ring);
+free_buffers:
+    free(run.buffers);
+destroy_mock:
+    dpu_rank_ring_mock_destroy(run.mock);
+    return success;
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s [<mram_size_per_dpu> (default: %u)] [<nr_iterations> (default: %u)]\n",
+        program,
+        DEFAULT_MRAM_SIZE,
+        DEFAULT_NR_ITERATIONS);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t mram_size = DEFAULT_MRAM_SIZE;
+    uint32_t nr_iterations = DEFAULT_NR_ITERATIONS;
+    bool success = true;
+
+    if (argc > 3) {
+        exit_usage(argv[0]);
+    }
+    if (argc > 1) {
+        mram_size = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        nr_iterations = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if ((mram_size < sizeof(uint64_t)) || ((mram_size % sizeof(uint64_t)) != 0) || (nr_iterations == 0)) {
+        exit_usage(argv[0]);
+    }
+
+    printf("%-8s %14s %14s\n", "mode", "ns/op", "ioctls/op");
+
+    for (unsigned int each_mode = 0; each_mode < NB_BENCH_MODES; ++each_mode)
+        success = run_mode((enum bench_mode)each_mode, mram_size, nr_iterations) && success;
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
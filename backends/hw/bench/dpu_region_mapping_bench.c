@@ -0,0 +1,723 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/* Runs the address translation of the region mappings over anonymous memory (hugepages when available) in place of
+ * the DAX region of a rank. Each mapping is checked against a reference decoder of its interleaving, which rebuilds
+ * the MRAM image of every DPU from the region:
+ *  - the MRAM written through write_to_rank must decode to the host buffers,
+ *  - read_from_rank must give them back,
+ *  - for the mappings supporting it, transfers with a size and an offset per DPU must only change their own range,
+ *  - for the mappings supporting it, iovec transfers must only change the segments of each DPU,
+ *  - the commands written through write_to_cis must decode to the commands, and read_from_cis must give them back
+ *    once looped back to where the results are read.
+ * The throughput of the MRAM transfers and of the control interface accesses is then reported, for each byte
+ * interleave variant of the mapping supported by the CPU.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+
+#include "dpu_region_address_translation.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#define NB_CIS 8
+#define NB_DPUS_PER_CI 8
+#define NB_DPUS (NB_CIS * NB_DPUS_PER_CI)
+#define CI_BLOCK_SIZE (NB_CIS * sizeof(uint64_t))
+
+#define DEFAULT_MRAM_SIZE (1 << 20)
+#define DEFAULT_NR_ITERATIONS 10
+#define MAX_NB_IOVEC_SEGMENTS 4
+#define NR_CI_ITERATIONS (1 << 16)
+#define HUGEPAGE_SIZE (2 << 20)
+
+/* Room for the control interfaces and the FIFO flush following them */
+#define MIN_REGION_SIZE (1 << 20)
+
+struct mapping_model {
+    const char *name;
+    struct dpu_region_address_translation *translate;
+
+    /* Region offset of the given byte of an MRAM word of a DPU, NULL when the mapping has no MRAM access */
+    uint64_t (*mram_byte_offset)(uint8_t ci_id, uint8_t dpu_id, uint32_t mram_word, uint8_t byte);
+    /* The DPUs of a line can have their own size and offset */
+    bool ragged_transfers;
+
+    /* The commands are written at ci_write_offset and the results read at ci_read_offset. ci_stride is the offset
+     * between two control interfaces, 0 when their commands are byte interleaved in the same cache line.
+     */
+    uint64_t ci_write_offset;
+    uint64_t ci_read_offset;
+    uint64_t ci_stride;
+    uint8_t nb_cis;
+
+    /* Environment variable forcing the byte interleave variant, and the variants it accepts */
+    const char *variant_env;
+    const char *const *variants;
+};
+
+extern struct dpu_region_address_translation fpga_aws_translate;
+#ifdef __x86_64__
+extern struct dpu_region_address_translation xeon_sp_translate;
+#endif
+#ifdef __powerpc64__
+extern struct dpu_region_address_translation power9_translate;
+#endif
+
+/* Byte j of word i of a block is byte i of the command (or MRAM word) of CI j */
+static uint64_t
+interleaved_byte_offset(uint8_t ci_id, uint8_t byte)
+{
+    return byte * sizeof(uint64_t) + ci_id;
+}
+
+#ifdef __x86_64__
+/* Within the 26 bits of the MRAM address: virtual[20:14] = physical[21:15] and virtual[21] = physical[14] */
+static uint32_t
+xeon_sp_mram_address(uint32_t address)
+{
+    uint32_t virtual_address = address & ~(0xFFU << 14);
+
+    for (uint8_t bit = 15; bit <= 21; ++bit) {
+        virtual_address |= ((address >> bit) & 1) << (bit - 1);
+    }
+    virtual_address |= ((address >> 14) & 1) << 21;
+
+    return virtual_address;
+}
+
+/* Each 64-bit word of the 8 CIs is a cache line, 2 cache lines apart from the next word. A bank is made of chunks of
+ * 128KB every 1MB; the banks of DPUs 0-3 are 256KB apart, DPUs 4-7 use the other cache line of each pair.
+ */
+static uint64_t
+xeon_sp_mram_byte_offset(uint8_t ci_id, uint8_t dpu_id, uint32_t mram_word, uint8_t byte)
+{
+    uint64_t bank_start = 0x40000 * (dpu_id % 4) + (dpu_id >= 4 ? 0x40 : 0);
+    uint64_t line = (uint64_t)(xeon_sp_mram_address(mram_word * sizeof(uint64_t)) / sizeof(uint64_t)) * 0x80;
+
+    return bank_start + (line % 0x20000) + (line / 0x20000) * 0x100000 + interleaved_byte_offset(ci_id, byte);
+}
+
+static const char *const xeon_sp_variants[] = { "scalar", "sse4.1", "avx2", "avx512", "avx512vbmi", NULL };
+#endif
+
+#ifdef __powerpc64__
+/* A 128-byte line holds 2 consecutive words of the 8 CIs, the next pair being 2KB further in the bank */
+static uint64_t
+power9_mram_byte_offset(uint8_t ci_id, uint8_t dpu_id, uint32_t mram_word, uint8_t byte)
+{
+    static const uint64_t bank_starts[NB_DPUS_PER_CI] = { 0x0, 0x400, 0x200, 0x600, 0x100, 0x500, 0x300, 0x700 };
+
+    return bank_starts[dpu_id] + (mram_word / 2) * 0x800 + (mram_word % 2) * 0x40 + interleaved_byte_offset(ci_id, byte);
+}
+
+static const char *const power9_variants[] = { "scalar", "vsx", NULL };
+#endif
+
+static const struct mapping_model models[] = {
+#ifdef __x86_64__
+    {
+        .name = "xeon_sp",
+        .translate = &xeon_sp_translate,
+        .mram_byte_offset = xeon_sp_mram_byte_offset,
+        .ragged_transfers = true,
+        .ci_write_offset = 0x20000,
+        .ci_read_offset = 0x20000 + 0x8000,
+        .ci_stride = 0,
+        .nb_cis = NB_CIS,
+        .variant_env = "UPMEM_XEON_SP_BYTE_INTERLEAVE",
+        .variants = xeon_sp_variants,
+    },
+#endif
+#ifdef __powerpc64__
+    {
+        .name = "power9",
+        .translate = &power9_translate,
+        .mram_byte_offset = power9_mram_byte_offset,
+        .ragged_transfers = false,
+        .ci_write_offset = 0x80,
+        .ci_read_offset = 0x80,
+        .ci_stride = 0,
+        .nb_cis = NB_CIS,
+        .variant_env = "UPMEM_POWER9_BYTE_INTERLEAVE",
+        .variants = power9_variants,
+    },
+#endif
+    {
+        .name = "fpga_aws",
+        .translate = &fpga_aws_translate,
+        .mram_byte_offset = NULL,
+        .ci_write_offset = 0,
+        .ci_read_offset = 0,
+        .ci_stride = 0x1000,
+        .nb_cis = 4,
+    },
+};
+
+#define NB_MODELS (sizeof(models) / sizeof(models[0]))
+
+/* State of one run of a model: the fake region and the MRAM images of the DPUs */
+struct mapping_run {
+    const struct mapping_model *model;
+    struct dpu_region_address_translation translate;
+    struct dpu_region_interleaving interleave;
+
+    uint8_t *region;
+    size_t region_size;
+    bool hugetlb;
+
+    uint32_t mram_size;
+    uint8_t *images[NB_DPUS];
+    uint8_t *buffers[NB_DPUS];
+    struct dpu_transfer_mram matrix[NB_DPUS];
+    struct dpu_transfer_mram_segment segments[NB_DPUS][MAX_NB_IOVEC_SEGMENTS];
+    struct dpu_transfer_mram_iovec iovec_matrix[NB_DPUS];
+};
+
+static double
+now_in_us(void)
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e6 + (double)time.tv_nsec / 1e3;
+}
+
+static uint64_t
+next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void
+fill_random(uint8_t *buffer, uint32_t size, uint64_t seed)
+{
+    for (uint32_t i = 0; i < size; i += sizeof(uint64_t)) {
+        uint64_t value = next_random(&seed);
+
+        memcpy(buffer + i, &value, size - i < sizeof(value) ? size - i : sizeof(value));
+    }
+}
+
+/* Index in the transfer matrix (and in the images) of a DPU */
+static inline uint32_t
+dpu_index(uint8_t ci_id, uint8_t dpu_id)
+{
+    return dpu_id * NB_CIS + ci_id;
+}
+
+/* Smallest region holding the MRAM words of every DPU and the control interfaces */
+static size_t
+get_region_size(const struct mapping_model *model, uint32_t mram_size)
+{
+    uint64_t size = MIN_REGION_SIZE;
+
+    if (model->ci_stride != 0 && model->ci_write_offset + model->nb_cis * model->ci_stride > size)
+        size = model->ci_write_offset + model->nb_cis * model->ci_stride;
+
+    if (model->mram_byte_offset != NULL) {
+        for (uint8_t dpu_id = 0; dpu_id < NB_DPUS_PER_CI; ++dpu_id) {
+            for (uint32_t word = 0; word < mram_size / sizeof(uint64_t); ++word) {
+                uint64_t end = model->mram_byte_offset(NB_CIS - 1, dpu_id, word, sizeof(uint64_t) - 1) + 1;
+
+                if (end > size)
+                    size = end;
+            }
+        }
+    }
+
+    return (size + HUGEPAGE_SIZE - 1) / HUGEPAGE_SIZE * HUGEPAGE_SIZE;
+}
+
+/* Explicit hugepages when the system has some, else transparent hugepages */
+static uint8_t *
+map_fake_region(size_t size, bool *hugetlb)
+{
+    void *region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+    *hugetlb = region != MAP_FAILED;
+    if (region == MAP_FAILED) {
+        region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (region == MAP_FAILED)
+            return NULL;
+        madvise(region, size, MADV_HUGEPAGE);
+    }
+
+    return region;
+}
+
+static void
+decode_mram_image(struct mapping_run *run, uint8_t ci_id, uint8_t dpu_id, uint8_t *image)
+{
+    for (uint32_t word = 0; word < run->mram_size / sizeof(uint64_t); ++word) {
+        for (uint8_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+            image[word * sizeof(uint64_t) + byte] = run->region[run->model->mram_byte_offset(ci_id, dpu_id, word, byte)];
+        }
+    }
+}
+
+/* Compares the images decoded from the region with the expected ones */
+static bool
+check_region(struct mapping_run *run, uint8_t *decoded, const char *step)
+{
+    for (uint8_t ci_id = 0; ci_id < NB_CIS; ++ci_id) {
+        for (uint8_t dpu_id = 0; dpu_id < NB_DPUS_PER_CI; ++dpu_id) {
+            uint8_t *expected = run->images[dpu_index(ci_id, dpu_id)];
+
+            decode_mram_image(run, ci_id, dpu_id, decoded);
+            for (uint32_t i = 0; i < run->mram_size; ++i) {
+                if (decoded[i] != expected[i]) {
+                    fprintf(stderr,
+                        "%s: %s: MRAM of DPU %u.%u differs at offset 0x%x (0x%02x instead of 0x%02x)\n",
+                        run->model->name,
+                        step,
+                        ci_id,
+                        dpu_id,
+                        i,
+                        decoded[i],
+                        expected[i]);
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+static void
+set_full_matrix(struct mapping_run *run, uint8_t **buffers)
+{
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        run->matrix[each_dpu].ptr = buffers[each_dpu];
+        run->matrix[each_dpu].offset_in_mram = 0;
+        run->matrix[each_dpu].mram_number = 0;
+        run->matrix[each_dpu].size = run->mram_size;
+    }
+}
+
+static bool
+check_full_transfers(struct mapping_run *run, uint8_t *decoded)
+{
+    struct dpu_region_address_translation *tr = &run->translate;
+
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        fill_random(run->images[each_dpu], run->mram_size, each_dpu + 1);
+    }
+
+    set_full_matrix(run, run->images);
+    tr->write_to_rank(tr, run->region, 0, 0, run->matrix);
+    if (!check_region(run, decoded, "write_to_rank"))
+        return false;
+
+    set_full_matrix(run, run->buffers);
+    tr->read_from_rank(tr, run->region, 0, 0, run->matrix);
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        if (memcmp(run->buffers[each_dpu], run->images[each_dpu], run->mram_size) != 0) {
+            fprintf(stderr,
+                "%s: read_from_rank: MRAM of DPU %u.%u differs\n",
+                run->model->name,
+                each_dpu % NB_CIS,
+                each_dpu / NB_CIS);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Each DPU writes its own unaligned range (or nothing), the rest of its MRAM must be left as is */
+static bool
+check_ragged_transfers(struct mapping_run *run, uint8_t *decoded)
+{
+    struct dpu_region_address_translation *tr = &run->translate;
+    uint64_t state = 42;
+
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        struct dpu_transfer_mram *xfer = &run->matrix[each_dpu];
+
+        xfer->offset_in_mram = next_random(&state) % (run->mram_size / 2);
+        xfer->size = 1 + next_random(&state) % (run->mram_size / 2);
+        xfer->mram_number = 0;
+        xfer->ptr = (next_random(&state) % 8) != 0 ? run->buffers[each_dpu] : NULL;
+
+        fill_random(run->buffers[each_dpu], xfer->size, ~(uint64_t)each_dpu);
+        if (xfer->ptr != NULL)
+            memcpy(run->images[each_dpu] + xfer->offset_in_mram, xfer->ptr, xfer->size);
+    }
+
+    tr->write_to_rank(tr, run->region, 0, 0, run->matrix);
+    if (!check_region(run, decoded, "ragged write_to_rank"))
+        return false;
+
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        memset(run->buffers[each_dpu], 0, run->mram_size);
+    }
+
+    tr->read_from_rank(tr, run->region, 0, 0, run->matrix);
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        struct dpu_transfer_mram *xfer = &run->matrix[each_dpu];
+
+        if (xfer->ptr != NULL && memcmp(xfer->ptr, run->images[each_dpu] + xfer->offset_in_mram, xfer->size) != 0) {
+            fprintf(stderr,
+                "%s: ragged read_from_rank: MRAM of DPU %u.%u differs\n",
+                run->model->name,
+                each_dpu % NB_CIS,
+                each_dpu / NB_CIS);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Each DPU writes a few unaligned segments (or nothing), some of them sharing a word: the rest of its MRAM must be left
+ * as is. The data of a segment is at the same offset in the buffer of the DPU as in its MRAM.
+ */
+static bool
+check_iovec_transfers(struct mapping_run *run, uint8_t *decoded)
+{
+    struct dpu_region_address_translation *tr = &run->translate;
+    uint32_t part_size = run->mram_size / MAX_NB_IOVEC_SEGMENTS;
+    uint64_t state = 1337;
+
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        struct dpu_transfer_mram_iovec *iovec = &run->iovec_matrix[each_dpu];
+        uint32_t nb_segments = next_random(&state) % (MAX_NB_IOVEC_SEGMENTS + 1);
+
+        fill_random(run->buffers[each_dpu], run->mram_size, ~(uint64_t)each_dpu);
+
+        iovec->segments = run->segments[each_dpu];
+        iovec->nb_segments = 0;
+        iovec->capacity = MAX_NB_IOVEC_SEGMENTS;
+
+        /* Segment k is in the k-th part of the MRAM, and may end where the next one starts */
+        for (uint32_t k = MAX_NB_IOVEC_SEGMENTS - nb_segments; k < MAX_NB_IOVEC_SEGMENTS; ++k) {
+            struct dpu_transfer_mram_segment *segment = &iovec->segments[iovec->nb_segments++];
+            uint32_t offset = k * part_size + next_random(&state) % (part_size / 2);
+
+            segment->offset_in_mram = offset;
+            segment->size = 1 + next_random(&state) % ((k + 1) * part_size - offset);
+            segment->ptr = run->buffers[each_dpu] + offset;
+            memcpy(run->images[each_dpu] + offset, segment->ptr, segment->size);
+        }
+    }
+
+    tr->write_iovec_to_rank(tr, run->region, 0, 0, run->iovec_matrix);
+    if (!check_region(run, decoded, "write_iovec_to_rank"))
+        return false;
+
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        memset(run->buffers[each_dpu], 0, run->mram_size);
+    }
+
+    tr->read_iovec_from_rank(tr, run->region, 0, 0, run->iovec_matrix);
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        struct dpu_transfer_mram_iovec *iovec = &run->iovec_matrix[each_dpu];
+
+        for (uint32_t i = 0; i < iovec->nb_segments; ++i) {
+            struct dpu_transfer_mram_segment *segment = &iovec->segments[i];
+
+            if (memcmp(segment->ptr, run->images[each_dpu] + segment->offset_in_mram, segment->size) != 0) {
+                fprintf(stderr,
+                    "%s: read_iovec_from_rank: MRAM of DPU %u.%u differs\n",
+                    run->model->name,
+                    each_dpu % NB_CIS,
+                    each_dpu / NB_CIS);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void
+decode_commands(struct mapping_run *run, uint64_t *commands)
+{
+    const struct mapping_model *model = run->model;
+
+    for (uint8_t ci_id = 0; ci_id < model->nb_cis; ++ci_id) {
+        if (model->ci_stride != 0) {
+            memcpy(&commands[ci_id], run->region + model->ci_write_offset + ci_id * model->ci_stride, sizeof(uint64_t));
+            continue;
+        }
+
+        for (uint8_t byte = 0; byte < sizeof(uint64_t); ++byte) {
+            ((uint8_t *)&commands[ci_id])[byte] = run->region[model->ci_write_offset + interleaved_byte_offset(ci_id, byte)];
+        }
+    }
+}
+
+/* The device answers at ci_read_offset: the commands are copied there so that they are read back as results */
+static void
+loop_back_commands(struct mapping_run *run)
+{
+    const struct mapping_model *model = run->model;
+
+    if (model->ci_read_offset != model->ci_write_offset)
+        memcpy(run->region + model->ci_read_offset, run->region + model->ci_write_offset, CI_BLOCK_SIZE);
+}
+
+static bool
+check_control_interfaces(struct mapping_run *run)
+{
+    struct dpu_region_address_translation *tr = &run->translate;
+    uint64_t commands[NB_CIS], decoded[NB_CIS], results[NB_CIS];
+    uint64_t state = 7;
+
+    for (uint8_t ci_id = 0; ci_id < NB_CIS; ++ci_id) {
+        /* Non-zero most significant byte: no CI is skipped */
+        commands[ci_id] = next_random(&state) | (0x80ULL << 56);
+    }
+
+    tr->write_to_cis(tr, run->region, 0, 0, commands, CI_BLOCK_SIZE);
+    decode_commands(run, decoded);
+    if (memcmp(decoded, commands, run->model->nb_cis * sizeof(uint64_t)) != 0) {
+        fprintf(stderr, "%s: write_to_cis: commands differ\n", run->model->name);
+        return false;
+    }
+
+    loop_back_commands(run);
+    /* Non-zero entries: the results of every CI are expected */
+    memset(results, 0xFF, sizeof(results));
+    tr->read_from_cis(tr, run->region, 0, 0, results, CI_BLOCK_SIZE);
+    if (memcmp(results, commands, run->model->nb_cis * sizeof(uint64_t)) != 0) {
+        fprintf(stderr, "%s: read_from_cis: results differ\n", run->model->name);
+        return false;
+    }
+
+    return true;
+}
+
+/* MB/s of the MRAM transfers, bytes per microsecond are MB/s */
+static void
+measure_mram_transfers(struct mapping_run *run, uint32_t nr_iterations, double *write_throughput, double *read_throughput)
+{
+    struct dpu_region_address_translation *tr = &run->translate;
+    uint64_t nr_bytes = (uint64_t)NB_DPUS * run->mram_size * nr_iterations;
+    double time;
+
+    set_full_matrix(run, run->images);
+    time = now_in_us();
+    for (uint32_t each_iteration = 0; each_iteration < nr_iterations; ++each_iteration) {
+        tr->write_to_rank(tr, run->region, 0, 0, run->matrix);
+    }
+    *write_throughput = nr_bytes / (now_in_us() - time);
+
+    set_full_matrix(run, run->buffers);
+    time = now_in_us();
+    for (uint32_t each_iteration = 0; each_iteration < nr_iterations; ++each_iteration) {
+        tr->read_from_rank(tr, run->region, 0, 0, run->matrix);
+    }
+    *read_throughput = nr_bytes / (now_in_us() - time);
+}
+
+/* Millions of command blocks per second */
+static void
+measure_control_interfaces(struct mapping_run *run, double *write_throughput, double *read_throughput)
+{
+    struct dpu_region_address_translation *tr = &run->translate;
+    uint64_t commands[NB_CIS];
+    double time;
+
+    for (uint8_t ci_id = 0; ci_id < NB_CIS; ++ci_id) {
+        commands[ci_id] = (0x80ULL << 56) | ci_id;
+    }
+
+    time = now_in_us();
+    for (uint32_t each_iteration = 0; each_iteration < NR_CI_ITERATIONS; ++each_iteration) {
+        commands[0] = (0x80ULL << 56) | each_iteration;
+        tr->write_to_cis(tr, run->region, 0, 0, commands, CI_BLOCK_SIZE);
+    }
+    *write_throughput = NR_CI_ITERATIONS / (now_in_us() - time);
+
+    time = now_in_us();
+    for (uint32_t each_iteration = 0; each_iteration < NR_CI_ITERATIONS; ++each_iteration) {
+        commands[0] = ~0ULL;
+        tr->read_from_cis(tr, run->region, 0, 0, commands, CI_BLOCK_SIZE);
+    }
+    *read_throughput = NR_CI_ITERATIONS / (now_in_us() - time);
+}
+
+static bool
+variant_is_supported(const char *variant)
+{
+#ifdef __x86_64__
+    __builtin_cpu_init();
+
+    if (strcmp(variant, "sse4.1") == 0)
+        return __builtin_cpu_supports("sse4.1");
+    if (strcmp(variant, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+    if (strcmp(variant, "avx512") == 0)
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    if (strcmp(variant, "avx512vbmi") == 0)
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi");
+#elif defined(__powerpc64__) && !defined(__VSX__)
+    if (strcmp(variant, "vsx") == 0)
+        return false;
+#else
+    (void)variant;
+#endif
+    return true;
+}
+
+static bool
+run_model(const struct mapping_model *model, const char *variant, uint32_t mram_size, uint32_t nr_iterations)
+{
+    struct mapping_run run = { .model = model, .mram_size = mram_size };
+    double mram_write = 0, mram_read = 0, ci_write, ci_read;
+    char mram_write_string[32] = "-", mram_read_string[32] = "-";
+    uint8_t *decoded = NULL;
+    bool success = false;
+
+    if (variant != NULL)
+        setenv(model->variant_env, variant, 1);
+
+    /* The rank owns its copy of the translation, as in the hw backend */
+    memcpy(&run.translate, model->translate, sizeof(run.translate));
+    memcpy(&run.interleave, model->translate->interleave, sizeof(run.interleave));
+    run.interleave.nb_real_ci = model->nb_cis;
+    run.translate.interleave = &run.interleave;
+    run.translate.xfer_numa_node = -1;
+
+    run.region_size = get_region_size(model, mram_size);
+    if ((run.region = map_fake_region(run.region_size, &run.hugetlb)) == NULL) {
+        fprintf(stderr, "%s: cannot map a region of %zu bytes\n", model->name, run.region_size);
+        return false;
+    }
+
+    if (run.translate.init_region != NULL && run.translate.init_region(&run.translate) < 0) {
+        fprintf(stderr, "%s: init_region failed\n", model->name);
+        goto unmap;
+    }
+
+    if (model->mram_byte_offset != NULL) {
+        if ((decoded = malloc(mram_size)) == NULL)
+            goto destroy;
+        for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+            if ((run.images[each_dpu] = malloc(mram_size)) == NULL || (run.buffers[each_dpu] = malloc(mram_size)) == NULL)
+                goto free_images;
+        }
+
+        if (!check_full_transfers(&run, decoded))
+            goto free_images;
+        if (model->ragged_transfers && !check_ragged_transfers(&run, decoded))
+            goto free_images;
+        if (run.translate.write_iovec_to_rank != NULL && !check_iovec_transfers(&run, decoded))
+            goto free_images;
+
+        measure_mram_transfers(&run, nr_iterations, &mram_write, &mram_read);
+    }
+
+    if (!check_control_interfaces(&run))
+        goto free_images;
+    measure_control_interfaces(&run, &ci_write, &ci_read);
+
+    if (model->mram_byte_offset != NULL) {
+        snprintf(mram_write_string, sizeof(mram_write_string), "%.1f", mram_write);
+        snprintf(mram_read_string, sizeof(mram_read_string), "%.1f", mram_read);
+    }
+
+    printf("%-10s %-12s %-9s %14s %14s %14.2f %14.2f\n",
+        model->name,
+        variant != NULL ? variant : "-",
+        run.hugetlb ? "hugetlb" : "thp",
+        mram_write_string,
+        mram_read_string,
+        ci_write,
+        ci_read);
+    success = true;
+
+free_images:
+    for (uint32_t each_dpu = 0; each_dpu < NB_DPUS; ++each_dpu) {
+        free(run.images[each_dpu]);
+        free(run.buffers[each_dpu]);
+    }
+    free(decoded);
+destroy:
+    if (run.translate.destroy_region != NULL)
+        run.translate.destroy_region(&run.translate);
+unmap:
+    munmap(run.region, run.region_size);
+
+    return success;
+}
+
+static void
+exit_usage(char *program)
+{
+    fprintf(stderr,
+        "Usage: %s [<mram_size_per_dpu> (default: %u)] [<nr_iterations> (default: %u)] [<mapping>]\n",
+        program,
+        DEFAULT_MRAM_SIZE,
+        DEFAULT_NR_ITERATIONS);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t mram_size = DEFAULT_MRAM_SIZE;
+    uint32_t nr_iterations = DEFAULT_NR_ITERATIONS;
+    const char *mapping = NULL;
+    bool success = true;
+
+    if (argc > 4) {
+        exit_usage(argv[0]);
+    }
+    if (argc > 1) {
+        mram_size = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        nr_iterations = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3) {
+        mapping = argv[3];
+    }
+    /* Ragged and iovec transfers need at least a word in each half (or quarter) of the MRAM */
+    if ((mram_size < MAX_NB_IOVEC_SEGMENTS * sizeof(uint64_t)) || ((mram_size % sizeof(uint64_t)) != 0) || (nr_iterations == 0)) {
+        exit_usage(argv[0]);
+    }
+
+    printf("%-10s %-12s %-9s %14s %14s %14s %14s\n",
+        "mapping",
+        "variant",
+        "memory",
+        "write(MB/s)",
+        "read(MB/s)",
+        "ci_write(M/s)",
+        "ci_read(M/s)");
+
+    for (unsigned int each_model = 0; each_model < NB_MODELS; ++each_model) {
+        const struct mapping_model *model = &models[each_model];
+
+        if (mapping != NULL && strcmp(mapping, model->name) != 0)
+            continue;
+
+        if (model->variants == NULL) {
+            success = run_model(model, NULL, mram_size, nr_iterations) && success;
+            continue;
+        }
+
+        for (const char *const *variant = model->variants; *variant != NULL; ++variant) {
+            if (variant_is_supported(*variant))
+                success = run_model(model, *variant, mram_size, nr_iterations) && success;
+        }
+    }
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -18,5 +18,76 @@
 #define DPU_RANK_IOCTL_COMMIT_COMMANDS _IOW(DPU_RANK_IOCTL_MAGIC, 2, uint64_t *)
 #define DPU_RANK_IOCTL_UPDATE_COMMANDS _IOR(DPU_RANK_IOCTL_MAGIC, 3, uint64_t *)
 #define DPU_RANK_IOCTL_DEBUG_MODE _IOW(DPU_RANK_IOCTL_MAGIC, 4, uint8_t *)
+#define DPU_RANK_IOCTL_RING_SETUP _IOWR(DPU_RANK_IOCTL_MAGIC, 5, struct dpu_rank_ring_params *)
+#define DPU_RANK_IOCTL_RING_ENTER _IOW(DPU_RANK_IOCTL_MAGIC, 6, struct dpu_rank_ring_enter *)
+
+/* Submission and completion rings of a rank, shared with the driver:
+ * - RING_SETUP creates the rings and fills the parameters. The rings are then mapped from the rank device at
+ *   DPU_RANK_RING_MMAP_OFFSET, with mmap_size bytes. Drivers without rings fail with ENOTTY.
+ * - userspace writes the entries in the submission ring and moves sq_tail; the driver executes them in order, moves
+ *   sq_head and writes one completion per entry, in the same order, before moving cq_tail. userspace moves cq_head.
+ * - RING_ENTER submits the new entries, then waits for min_complete completions to be available. With
+ *   DPU_RANK_RING_SETUP_SQPOLL, a kernel thread consumes the submission ring: RING_ENTER is only needed to wake it up
+ *   when it sets DPU_RANK_RING_SQ_NEED_WAKEUP in sq_flags, or to sleep until completions are available.
+ * The completion ring has as many entries as the submission ring: it never overflows as long as userspace does not
+ * submit more entries than it has reaped completions.
+ */
+#define DPU_RANK_RING_MMAP_OFFSET 0x10000000ULL
+#define DPU_RANK_RING_MAX_CIS 8
+
+#define DPU_RANK_RING_OP_COMMIT_COMMANDS 0
+#define DPU_RANK_RING_OP_UPDATE_COMMANDS 1
+#define DPU_RANK_RING_OP_WRITE_TO_RANK 2
+#define DPU_RANK_RING_OP_READ_FROM_RANK 3
+
+/* dpu_rank_ring_params.flags */
+#define DPU_RANK_RING_SETUP_SQPOLL (1 << 0)
+/* sq_flags */
+#define DPU_RANK_RING_SQ_NEED_WAKEUP (1 << 0)
+/* dpu_rank_ring_enter.flags */
+#define DPU_RANK_RING_ENTER_SQ_WAKEUP (1 << 0)
+
+struct dpu_rank_ring_sqe {
+    uint8_t opcode;
+    uint8_t nb_cis;
+    uint16_t reserved0;
+    uint32_t reserved1;
+    uint64_t user_data;
+    /* UPDATE_COMMANDS: buffer of the results, WRITE_TO_RANK/READ_FROM_RANK: transfer matrix */
+    uint64_t addr;
+    /* COMMIT_COMMANDS: the commands are copied into the entry, the buffer of the caller can be reused */
+    uint64_t commands[DPU_RANK_RING_MAX_CIS];
+};
+
+struct dpu_rank_ring_cqe {
+    uint64_t user_data;
+    /* 0 or -errno */
+    int32_t res;
+    uint32_t reserved;
+};
+
+struct dpu_rank_ring_params {
+    /* In: requested number of entries (a power of 2), out: number of entries of each ring */
+    uint32_t nb_entries;
+    /* In: requested DPU_RANK_RING_SETUP_*, out: the ones granted */
+    uint32_t flags;
+    /* Out: offsets in the mapping */
+    uint32_t sq_head;
+    uint32_t sq_tail;
+    uint32_t sq_flags;
+    uint32_t sqes;
+    uint32_t cq_head;
+    uint32_t cq_tail;
+    uint32_t cqes;
+    uint32_t reserved;
+    uint64_t mmap_size;
+};
+
+struct dpu_rank_ring_enter {
+    uint32_t to_submit;
+    uint32_t min_complete;
+    uint32_t flags;
+    uint32_t reserved;
+};
 
 #endif /* DPU_RANK_IOCTL_INCLUDE_H */
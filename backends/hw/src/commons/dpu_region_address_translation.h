@@ -83,6 +83,28 @@ struct dpu_transfer_mram {
 };
 #endif
 
+#ifndef struct_dpu_transfer_mram_iovec_t
+#define struct_dpu_transfer_mram_iovec_t
+struct dpu_transfer_mram_segment {
+    void *ptr;
+    uint32_t offset_in_mram;
+    uint32_t size;
+};
+
+/* Segments of the transfer of one DPU, in its primary MRAM: sorted by offset and disjoint */
+struct dpu_transfer_mram_iovec {
+    struct dpu_transfer_mram_segment *segments;
+    uint32_t nb_segments;
+    uint32_t capacity;
+};
+#endif
+
+/* Host buffer allocated by the API for the transfers: resident, with cache line aligned DPU slots */
+struct dpu_region_host_buffer {
+    void *ptr;
+    uint64_t size;
+};
+
 /* Backend description of the CPU/BIOS configuration address translation:
  * interleave: Describe the machine configuration, retrieved from ACPI table
  *		and dpu_chip_id_info: ACPI table gives info about physical
@@ -106,6 +128,8 @@ struct dpu_transfer_mram {
  *		  transfers for each dpu.
  * read_from_rank: Reads from MRAMs using the matrix of descriptions of
  *		   transfers for each dpu.
+ * write_iovec_to_rank, read_iovec_from_rank: Same as above, with a list
+ *		   of segments for each dpu.
  */
 struct dpu_region_address_translation {
     /* Physical topology */
@@ -168,6 +192,36 @@ struct dpu_region_address_translation {
 #ifdef __KERNEL__
     int (*mmap_hybrid)(struct dpu_region_address_translation *tr, uint8_t rank_id, struct file *filp, struct vm_area_struct *vma);
 #endif
+
+    /* Transfer threads of the region (userspace only), set before init_region:
+     * nb_xfer_threads: number of threads, 0 lets the backend choose
+     * xfer_numa_node: NUMA node whose CPUs run the threads, -1 leaves them unbound
+     * xfer_cpus: list of CPUs ("0-3,8" or "0-3:8") on which the threads are
+     *		pinned one after the other, takes precedence over xfer_numa_node
+     */
+    uint8_t nb_xfer_threads;
+    int xfer_numa_node;
+    const char *xfer_cpus;
+
+    /* Host buffers of the transfers (userspace only): the backend may write
+     * into them with non-temporal stores.
+     */
+    struct dpu_region_host_buffer *host_buffers;
+    uint32_t nb_host_buffers;
+
+    /* Optional (userspace only): same as write_to_rank and read_from_rank,
+     * with several segments for each dpu, in one pass over the rank.
+     */
+    void (*write_iovec_to_rank)(struct dpu_region_address_translation *tr,
+        void *base_region_addr,
+        uint8_t channel_id,
+        uint8_t rank_id,
+        struct dpu_transfer_mram_iovec *iovec_matrix);
+    void (*read_iovec_from_rank)(struct dpu_region_address_translation *tr,
+        void *base_region_addr,
+        uint8_t channel_id,
+        uint8_t rank_id,
+        struct dpu_transfer_mram_iovec *iovec_matrix);
 };
 
 #endif /* DPU_REGION_ADDRESS_TRANSLATION_INCLUDE_H */
@@ -0,0 +1,198 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#define _GNU_SOURCE
+#include <stdint.h>
+
+#include "dpu_region_address_translation.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include "dpu_cpulist.h"
+#include "dpu_region_xfer_threads.h"
+#include "static_verbose.h"
+
+static struct verbose_control *this_vc;
+static struct verbose_control *
+__vc()
+{
+    if (this_vc == NULL) {
+        this_vc = get_verbose_control_for("hw");
+    }
+    return this_vc;
+}
+
+static void *
+xfer_thread(void *arg)
+{
+    struct dpu_region_xfer_threads *xfer_threads = arg;
+    uint8_t first_dpu_id, end_dpu_id;
+
+    while (1) {
+        pthread_mutex_lock(&xfer_threads->mutex_threads);
+
+        while (!xfer_threads->work_to_do && !xfer_threads->threads_shall_exit)
+            pthread_cond_wait(&xfer_threads->cond_threads, &xfer_threads->mutex_threads);
+
+        xfer_threads->nb_threads_awoken++;
+
+        /* Once everyone is awoken, the last thread clears work_to_do: it can't be done by the main thread before the
+         * barrier wait since some threads might not be awoken already.
+         */
+        if (xfer_threads->nb_threads_awoken == xfer_threads->nb_threads) {
+            xfer_threads->work_to_do = false;
+            xfer_threads->nb_threads_awoken = 0;
+        }
+
+        if (xfer_threads->threads_shall_exit)
+            break;
+
+        /* The DPU lines are split as evenly as possible between the threads */
+        first_dpu_id = (xfer_threads->next_thread * xfer_threads->nb_dpus_per_ci) / xfer_threads->nb_threads;
+        end_dpu_id = ((xfer_threads->next_thread + 1) * xfer_threads->nb_dpus_per_ci) / xfer_threads->nb_threads;
+        xfer_threads->next_thread++;
+
+        pthread_mutex_unlock(&xfer_threads->mutex_threads);
+
+        xfer_threads->xfer(xfer_threads->mapping_priv, first_dpu_id, end_dpu_id);
+
+        pthread_barrier_wait(&xfer_threads->barrier_threads);
+    }
+
+    pthread_mutex_unlock(&xfer_threads->mutex_threads);
+
+    return NULL;
+}
+
+/* Pins the threads on the given CPUs, one after the other, or else on the CPUs of the NUMA node that owns the rank.
+ * Failing to pin is not fatal.
+ */
+static void
+bind_threads(struct dpu_region_xfer_threads *xfer_threads, struct dpu_region_address_translation *tr)
+{
+    cpu_set_t cpus, thread_cpus;
+    int i;
+
+    if (tr->xfer_cpus != NULL) {
+        if (dpu_cpulist_parse(tr->xfer_cpus, &cpus) != 0) {
+            LOGW(__vc(), "invalid transfer thread CPU list \"%s\", threads are not pinned", tr->xfer_cpus);
+            return;
+        }
+
+        for (i = 0; i < xfer_threads->nb_threads; ++i) {
+            CPU_ZERO(&thread_cpus);
+            CPU_SET(dpu_cpulist_get_nth_cpu(&cpus, i), &thread_cpus);
+            if (pthread_setaffinity_np(xfer_threads->threads[i], sizeof(thread_cpus), &thread_cpus) != 0)
+                LOGW(__vc(), "cannot pin transfer thread %d", i);
+        }
+        LOGI(__vc(), "%d transfer threads pinned on CPUs %s", xfer_threads->nb_threads, tr->xfer_cpus);
+    } else if (tr->xfer_numa_node >= 0) {
+        if (dpu_cpulist_get_numa_node_cpus(tr->xfer_numa_node, &cpus) != 0) {
+            LOGW(__vc(), "cannot get the CPUs of NUMA node %d, threads are not pinned", tr->xfer_numa_node);
+            return;
+        }
+
+        for (i = 0; i < xfer_threads->nb_threads; ++i) {
+            if (pthread_setaffinity_np(xfer_threads->threads[i], sizeof(cpus), &cpus) != 0)
+                LOGW(__vc(), "cannot pin transfer thread %d", i);
+        }
+        LOGI(__vc(), "%d transfer threads bound to NUMA node %d", xfer_threads->nb_threads, tr->xfer_numa_node);
+    }
+}
+
+static void
+stop_threads(struct dpu_region_xfer_threads *xfer_threads, int nb_threads)
+{
+    pthread_mutex_lock(&xfer_threads->mutex_threads);
+    xfer_threads->threads_shall_exit = true;
+    pthread_cond_broadcast(&xfer_threads->cond_threads);
+    pthread_mutex_unlock(&xfer_threads->mutex_threads);
+
+    while (nb_threads-- > 0)
+        pthread_join(xfer_threads->threads[nb_threads], NULL);
+
+    pthread_barrier_destroy(&xfer_threads->barrier_threads);
+    pthread_cond_destroy(&xfer_threads->cond_threads);
+    pthread_mutex_destroy(&xfer_threads->mutex_threads);
+}
+
+int
+dpu_region_xfer_threads_init(struct dpu_region_xfer_threads *xfer_threads,
+    struct dpu_region_address_translation *tr,
+    uint8_t default_nb_threads,
+    dpu_region_xfer_fct_t xfer,
+    void *mapping_priv)
+{
+    int i, ret;
+
+    xfer_threads->xfer = xfer;
+    xfer_threads->mapping_priv = mapping_priv;
+    xfer_threads->nb_dpus_per_ci = tr->interleave->nb_dpus_per_ci;
+    xfer_threads->threads_shall_exit = false;
+    xfer_threads->work_to_do = false;
+    xfer_threads->nb_threads_awoken = 0;
+    xfer_threads->next_thread = 0;
+
+    /* A thread handles at least one DPU line */
+    xfer_threads->nb_threads = tr->nb_xfer_threads != 0 ? tr->nb_xfer_threads : default_nb_threads;
+    if (xfer_threads->nb_threads > xfer_threads->nb_dpus_per_ci)
+        xfer_threads->nb_threads = xfer_threads->nb_dpus_per_ci;
+
+    xfer_threads->threads = calloc(xfer_threads->nb_threads, sizeof(pthread_t));
+    if (xfer_threads->threads == NULL)
+        return -ENOMEM;
+
+    pthread_mutex_init(&xfer_threads->mutex_threads, NULL);
+    pthread_cond_init(&xfer_threads->cond_threads, NULL);
+
+    ret = pthread_barrier_init(&xfer_threads->barrier_threads, NULL, xfer_threads->nb_threads + 1);
+    if (ret) {
+        pthread_cond_destroy(&xfer_threads->cond_threads);
+        pthread_mutex_destroy(&xfer_threads->mutex_threads);
+        goto free_threads;
+    }
+
+    for (i = 0; i < xfer_threads->nb_threads; ++i) {
+        ret = pthread_create(&xfer_threads->threads[i], NULL, xfer_thread, xfer_threads);
+        if (ret) {
+            stop_threads(xfer_threads, i);
+            goto free_threads;
+        }
+    }
+
+    bind_threads(xfer_threads, tr);
+
+    return 0;
+
+free_threads:
+    free(xfer_threads->threads);
+
+    return -ret;
+}
+
+void
+dpu_region_xfer_threads_run(struct dpu_region_xfer_threads *xfer_threads)
+{
+    pthread_mutex_lock(&xfer_threads->mutex_threads);
+    xfer_threads->work_to_do = true;
+    pthread_cond_broadcast(&xfer_threads->cond_threads);
+    pthread_mutex_unlock(&xfer_threads->mutex_threads);
+
+    pthread_barrier_wait(&xfer_threads->barrier_threads);
+
+    pthread_mutex_lock(&xfer_threads->mutex_threads);
+    xfer_threads->next_thread = 0;
+    pthread_mutex_unlock(&xfer_threads->mutex_threads);
+}
+
+void
+dpu_region_xfer_threads_destroy(struct dpu_region_xfer_threads *xfer_threads)
+{
+    stop_threads(xfer_threads, xfer_threads->nb_threads);
+    free(xfer_threads->threads);
+}
@@ -0,0 +1,56 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef DPU_REGION_XFER_THREADS_H
+#define DPU_REGION_XFER_THREADS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+struct dpu_region_address_translation;
+
+/* Transfers the DPU lines [first_dpu_id, end_dpu_id[ of the rank, with the transfer set up by the mapping */
+typedef void (*dpu_region_xfer_fct_t)(void *mapping_priv, uint8_t first_dpu_id, uint8_t end_dpu_id);
+
+/* Threads of a region mapping that share the DPU lines of each MRAM transfer */
+struct dpu_region_xfer_threads {
+    dpu_region_xfer_fct_t xfer;
+    void *mapping_priv;
+    uint8_t nb_dpus_per_ci;
+
+    pthread_t *threads;
+    uint8_t nb_threads;
+
+    pthread_barrier_t barrier_threads;
+    pthread_mutex_t mutex_threads;
+    pthread_cond_t cond_threads;
+
+    bool threads_shall_exit;
+    bool work_to_do;
+
+    uint8_t nb_threads_awoken;
+    /* Index of the next thread to pick its share of the DPU lines */
+    uint8_t next_thread;
+};
+
+/* Starts the threads configured by the region (nb_xfer_threads, default_nb_threads if it is 0, and at most one
+ * thread per DPU line), then pins them as xfer_cpus or xfer_numa_node ask. Returns 0 or -errno.
+ */
+int
+dpu_region_xfer_threads_init(struct dpu_region_xfer_threads *xfer_threads,
+    struct dpu_region_address_translation *tr,
+    uint8_t default_nb_threads,
+    dpu_region_xfer_fct_t xfer,
+    void *mapping_priv);
+
+/* Runs the transfer on every thread and waits for its completion */
+void
+dpu_region_xfer_threads_run(struct dpu_region_xfer_threads *xfer_threads);
+
+void
+dpu_region_xfer_threads_destroy(struct dpu_region_xfer_threads *xfer_threads);
+
+#endif /* DPU_REGION_XFER_THREADS_H */
@@ -6,6 +6,7 @@
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
@@ -14,6 +15,19 @@
 #include <unistd.h>
 
 #include "dpu_region_address_translation.h"
+#include "dpu_region_xfer_threads.h"
+
+#include "static_verbose.h"
+
+static struct verbose_control *this_vc;
+static struct verbose_control *
+__vc()
+{
+    if (this_vc == NULL) {
+        this_vc = get_verbose_control_for("hw");
+    }
+    return this_vc;
+}
 
 #define NB_ELEM_MATRIX 8
 #define NB_WRQ_FIFO_ENTRIES 17
@@ -25,6 +39,36 @@
     for (dpu = 0, idx = 0; dpu < nb_dpus_per_ci; ++dpu)                                                                          \
         for (ci = 0; ci < nb_cis; ++ci, ++idx)
 
+/* Used when the rank profile does not set the number of transfer threads */
+#define DEFAULT_NB_THREADS 8
+
+/* Lines of a DPU line written (or invalidated) before being flushed with a single sync */
+#define NB_LINES_PER_FLUSH 16
+
+#define THREAD_MRAM_READ 0
+#define THREAD_MRAM_WRITE 1
+
+/* Forces the byte_interleave variant: "scalar" or "vsx" */
+#define POWER9_BYTE_INTERLEAVE_ENV "UPMEM_POWER9_BYTE_INTERLEAVE"
+
+/* Transpose the two 8x8 byte matrices of a 128-byte line of the region, from or to the cache line of the CIs */
+typedef void (*write_line_fct_t)(uint64_t *cache_line, uint8_t *line);
+typedef void (*read_line_fct_t)(uint8_t *line, uint64_t *cache_line);
+
+struct power9_private {
+    struct dpu_region_address_translation *tr;
+
+    void *base_region_addr;
+    uint8_t direction;
+    struct dpu_transfer_mram *xfer_matrix;
+
+    struct dpu_region_xfer_threads xfer_threads;
+
+    /* Selected at init_region */
+    write_line_fct_t write_line;
+    read_line_fct_t read_line;
+};
+
 void
 byte_interleave(uint64_t *input, uint64_t *output)
 {
@@ -35,6 +79,112 @@ byte_interleave(uint64_t *input, uint64_t *output)
             ((uint8_t *)&output[i])[j] = ((uint8_t *)&input[j])[i];
 }
 
+static void
+write_line_scalar(uint64_t *cache_line, uint8_t *line)
+{
+    uint64_t cache_line_interleave[16];
+    int i;
+
+    byte_interleave(cache_line, cache_line_interleave);
+    byte_interleave(&cache_line[8], &cache_line_interleave[8]);
+
+    for (i = 0; i < 16; ++i)
+        *((volatile uint64_t *)line + i) = cache_line_interleave[i];
+}
+
+static void
+read_line_scalar(uint8_t *line, uint64_t *cache_line_interleave)
+{
+    uint64_t cache_line[16];
+    int i;
+
+    for (i = 0; i < 16; ++i)
+        cache_line[i] = *((volatile uint64_t *)line + i);
+
+    byte_interleave(cache_line, cache_line_interleave);
+    byte_interleave(&cache_line[8], &cache_line_interleave[8]);
+}
+
+#ifdef __VSX__
+typedef uint8_t vector_u8 __attribute__((vector_size(16)));
+
+/* The 4 vectors of a matrix are transposed with 8 two-vector permutations, which GCC lowers to vperm/xxperm: the
+ * first ones gather the bytes 0-3 and 4-7 of the rows from each half of the matrix, the last ones merge the halves.
+ * The line of the region is loaded or stored with 16-byte accesses.
+ */
+static inline void
+byte_interleave_vsx(void *input, void *output)
+{
+    const vector_u8 rows_0_3 = { 0, 8, 16, 24, 1, 9, 17, 25, 2, 10, 18, 26, 3, 11, 19, 27 };
+    const vector_u8 rows_4_7 = { 4, 12, 20, 28, 5, 13, 21, 29, 6, 14, 22, 30, 7, 15, 23, 31 };
+    const vector_u8 low_rows = { 0, 1, 2, 3, 16, 17, 18, 19, 4, 5, 6, 7, 20, 21, 22, 23 };
+    const vector_u8 high_rows = { 8, 9, 10, 11, 24, 25, 26, 27, 12, 13, 14, 15, 28, 29, 30, 31 };
+    vector_u8 in[4], low_0_3, low_4_7, high_0_3, high_4_7, out[4];
+
+    memcpy(in, input, sizeof(in));
+
+    low_0_3 = __builtin_shuffle(in[0], in[1], rows_0_3);
+    low_4_7 = __builtin_shuffle(in[0], in[1], rows_4_7);
+    high_0_3 = __builtin_shuffle(in[2], in[3], rows_0_3);
+    high_4_7 = __builtin_shuffle(in[2], in[3], rows_4_7);
+
+    out[0] = __builtin_shuffle(low_0_3, high_0_3, low_rows);
+    out[1] = __builtin_shuffle(low_0_3, high_0_3, high_rows);
+    out[2] = __builtin_shuffle(low_4_7, high_4_7, low_rows);
+    out[3] = __builtin_shuffle(low_4_7, high_4_7, high_rows);
+
+    memcpy(output, out, sizeof(out));
+}
+
+static void
+write_line_vsx(uint64_t *cache_line, uint8_t *line)
+{
+    byte_interleave_vsx(cache_line, line);
+    byte_interleave_vsx(&cache_line[8], line + 8 * sizeof(uint64_t));
+}
+
+static void
+read_line_vsx(uint8_t *line, uint64_t *cache_line_interleave)
+{
+    byte_interleave_vsx(line, cache_line_interleave);
+    byte_interleave_vsx(line + 8 * sizeof(uint64_t), &cache_line_interleave[8]);
+}
+#endif
+
+/* Fastest first */
+static const struct {
+    const char *name;
+    write_line_fct_t write_line;
+    read_line_fct_t read_line;
+} line_interleave_variants[] = {
+#ifdef __VSX__
+    { "vsx", write_line_vsx, read_line_vsx },
+#endif
+    { "scalar", write_line_scalar, read_line_scalar },
+};
+
+#define NB_LINE_INTERLEAVE_VARIANTS (sizeof(line_interleave_variants) / sizeof(line_interleave_variants[0]))
+
+static const char *
+select_line_interleave(struct power9_private *power9_priv, const char *requested)
+{
+    unsigned int i;
+
+    for (i = 0; i < NB_LINE_INTERLEAVE_VARIANTS; ++i) {
+        if (requested == NULL || strcmp(requested, line_interleave_variants[i].name) == 0)
+            break;
+    }
+
+    if (i == NB_LINE_INTERLEAVE_VARIANTS) {
+        LOGW(__vc(), "cannot use byte_interleave variant '%s', selecting the fastest one", requested);
+        i = 0;
+    }
+
+    power9_priv->write_line = line_interleave_variants[i].write_line;
+    power9_priv->read_line = line_interleave_variants[i].read_line;
+    return line_interleave_variants[i].name;
+}
+
 /* Write NB_WRQ_FIFO_ENTRIES of 0 right after the CI */
 // TODO check with Fabrice that it is not a problem to write 0 right
 // after a command: will the first command be correctly sampled ?
@@ -200,164 +350,198 @@ power9_write_to_cis(__attribute__((unused)) struct dpu_region_address_translatio
 #define BANK_CHUNK_SIZE 0x80
 #define BANK_NEXT_CHUNK_OFFSET 0x800
 
-void
-power9_write_to_rank(struct dpu_region_address_translation *tr,
-    void *base_region_addr,
-    __attribute__((unused)) uint8_t channel_id,
-    __attribute__((unused)) uint8_t rank_id,
-    struct dpu_transfer_mram *xfer_matrix)
+/* Offset in the bank of the line holding the MRAM words i and i + 1 of the 8 CIs */
+static inline uint64_t
+mram_line_offset(uint32_t i, uint32_t offset_in_mram)
 {
-    uint64_t cache_line[16], cache_line_interleave[16];
-    uint8_t idx, ci_id, dpu_id, nb_cis, nb_dpus_per_ci;
+    uint64_t next_data = BANK_OFFSET_NEXT_DATA(i + offset_in_mram / 8);
 
-    nb_cis = tr->interleave->nb_real_ci;
-    nb_dpus_per_ci = tr->interleave->nb_dpus_per_ci;
-
-    /* Works only for transfers of same size and same offset on the
-     * same line
-     */
-    for (dpu_id = 0, idx = 0; dpu_id < nb_dpus_per_ci; ++dpu_id, idx += 8) {
-        uint8_t *ptr_dest = (uint8_t *)base_region_addr;
-        uint32_t bank_start;
-        uint32_t size_transfer = 0, i;
+    return (next_data % BANK_CHUNK_SIZE) + (next_data / BANK_CHUNK_SIZE) * BANK_NEXT_CHUNK_OFFSET;
+}
+
+static inline void
+flush_line(uint8_t *line)
+{
+    __asm__ __volatile__("dcbf %y0" : : "Z"(*line) : "memory");
+}
+
+/* Size and offset of the transfers of a DPU line, 0 when the line has no transfer */
+static uint32_t
+get_line_transfer(struct dpu_transfer_mram *line_xfers, uint8_t nb_cis, uint32_t *offset_in_mram)
+{
+    uint8_t ci_id;
+
+    for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
+        if (line_xfers[ci_id].ptr) {
+            *offset_in_mram = line_xfers[ci_id].offset_in_mram;
+            return line_xfers[ci_id].size;
+        }
+    }
+
+    return 0;
+}
+
+/* Works only for transfers of same size and same offset on the same line */
+static void
+threads_write_to_rank(struct power9_private *power9_priv, uint8_t first_dpu_id, uint8_t end_dpu_id)
+{
+    struct dpu_transfer_mram *xfer_matrix = power9_priv->xfer_matrix;
+    uint64_t cache_line[16];
+    uint8_t idx, ci_id, dpu_id, nb_cis;
+
+    nb_cis = power9_priv->tr->interleave->nb_real_ci;
+
+    for (dpu_id = first_dpu_id, idx = first_dpu_id * 8; dpu_id < end_dpu_id; ++dpu_id, idx += 8) {
+        uint8_t *ptr_dest = (uint8_t *)power9_priv->base_region_addr;
+        uint32_t bank_start = 0, nb_words, first_word, end_word, i;
         uint32_t offset_in_mram = 0;
 
         BANK_START(bank_start, dpu_id);
         ptr_dest += bank_start;
 
-        for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
-            if (xfer_matrix[idx + ci_id].ptr) {
-                size_transfer = xfer_matrix[idx + ci_id].size;
-                offset_in_mram = xfer_matrix[idx + ci_id].offset_in_mram;
-                break;
-            }
-        }
+        nb_words = get_line_transfer(&xfer_matrix[idx], nb_cis, &offset_in_mram) / sizeof(uint64_t);
 
-        if (!size_transfer)
-            continue;
+        /* The lines of a batch are written, then flushed together: a single sync per batch */
+        for (first_word = 0; first_word < nb_words; first_word = end_word) {
+            end_word = first_word + 2 * NB_LINES_PER_FLUSH < nb_words ? first_word + 2 * NB_LINES_PER_FLUSH : nb_words;
 
-        for (i = 0; i < size_transfer / sizeof(uint64_t); i += 2) {
-            uint64_t next_data = BANK_OFFSET_NEXT_DATA(i + offset_in_mram / 8);
-            uint64_t offset = (next_data % BANK_CHUNK_SIZE) + (next_data / BANK_CHUNK_SIZE) * BANK_NEXT_CHUNK_OFFSET;
+            for (i = first_word; i < end_word; i += 2) {
+                for (ci_id = 0; ci_id < nb_cis * 2; ++ci_id) {
+                    if (xfer_matrix[idx + ci_id % nb_cis].ptr)
+                        cache_line[ci_id] = *((uint64_t *)xfer_matrix[idx + ci_id % nb_cis].ptr + i + ci_id / nb_cis);
+                }
 
-            for (ci_id = 0; ci_id < nb_cis * 2; ++ci_id) {
-                if (xfer_matrix[idx + ci_id % nb_cis].ptr)
-                    cache_line[ci_id] = *((uint64_t *)xfer_matrix[idx + ci_id % nb_cis].ptr + i + ci_id / nb_cis);
+                power9_priv->write_line(cache_line, ptr_dest + mram_line_offset(i, offset_in_mram));
             }
 
-            byte_interleave(cache_line, cache_line_interleave);
-            byte_interleave(&cache_line[8], &cache_line_interleave[8]);
-
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 0 * sizeof(uint64_t))) = cache_line_interleave[0];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 1 * sizeof(uint64_t))) = cache_line_interleave[1];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 2 * sizeof(uint64_t))) = cache_line_interleave[2];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 3 * sizeof(uint64_t))) = cache_line_interleave[3];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 4 * sizeof(uint64_t))) = cache_line_interleave[4];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 5 * sizeof(uint64_t))) = cache_line_interleave[5];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 6 * sizeof(uint64_t))) = cache_line_interleave[6];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 7 * sizeof(uint64_t))) = cache_line_interleave[7];
-
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 8 * sizeof(uint64_t))) = cache_line_interleave[8];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 9 * sizeof(uint64_t))) = cache_line_interleave[9];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 10 * sizeof(uint64_t))) = cache_line_interleave[10];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 11 * sizeof(uint64_t))) = cache_line_interleave[11];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 12 * sizeof(uint64_t))) = cache_line_interleave[12];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 13 * sizeof(uint64_t))) = cache_line_interleave[13];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 14 * sizeof(uint64_t))) = cache_line_interleave[14];
-            *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 15 * sizeof(uint64_t))) = cache_line_interleave[15];
-
-            __asm__ __volatile__("isync; sync; dcbf %y0; sync; isync; eieio;"
-                                 :
-                                 : "Z"(*((uint8_t *)ptr_dest + offset))
-                                 : "memory");
+            for (i = first_word; i < end_word; i += 2)
+                flush_line(ptr_dest + mram_line_offset(i, offset_in_mram));
+
+            __asm__ __volatile__("sync" : : : "memory");
         }
     }
 }
 
-void
-power9_read_from_rank(struct dpu_region_address_translation *tr,
-    void *base_region_addr,
-    __attribute__((unused)) uint8_t channel_id,
-    __attribute__((unused)) uint8_t rank_id,
-    struct dpu_transfer_mram *xfer_matrix)
+/* Works only for transfers of same size and same offset on the same line */
+static void
+threads_read_from_rank(struct power9_private *power9_priv, uint8_t first_dpu_id, uint8_t end_dpu_id)
 {
-    uint64_t cache_line[16], cache_line_interleave[16];
-    uint8_t idx, ci_id, dpu_id, nb_cis, nb_dpus_per_ci;
+    struct dpu_transfer_mram *xfer_matrix = power9_priv->xfer_matrix;
+    uint64_t cache_line_interleave[16];
+    uint8_t idx, ci_id, dpu_id, nb_cis;
 
-    nb_cis = tr->interleave->nb_real_ci;
-    nb_dpus_per_ci = tr->interleave->nb_dpus_per_ci;
-
-    /* Works only for transfers of same size and same offset on the
-     * same line
-     */
-    for (dpu_id = 0, idx = 0; dpu_id < nb_dpus_per_ci; ++dpu_id, idx += 8) {
-        uint32_t bank_start;
-        uint8_t *ptr_dest = (uint8_t *)base_region_addr;
-        uint32_t size_transfer = 0, i;
+    nb_cis = power9_priv->tr->interleave->nb_real_ci;
+
+    for (dpu_id = first_dpu_id, idx = first_dpu_id * 8; dpu_id < end_dpu_id; ++dpu_id, idx += 8) {
+        uint8_t *ptr_dest = (uint8_t *)power9_priv->base_region_addr;
+        uint32_t bank_start = 0, nb_words, first_word, end_word, i;
         uint32_t offset_in_mram = 0;
 
         BANK_START(bank_start, dpu_id);
         ptr_dest += bank_start;
 
-        for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
-            if (xfer_matrix[idx + ci_id].ptr) {
-                size_transfer = xfer_matrix[idx + ci_id].size;
-                offset_in_mram = xfer_matrix[idx + ci_id].offset_in_mram;
-                break;
-            }
-        }
+        nb_words = get_line_transfer(&xfer_matrix[idx], nb_cis, &offset_in_mram) / sizeof(uint64_t);
+
+        for (first_word = 0; first_word < nb_words; first_word = end_word) {
+            end_word = first_word + 2 * NB_LINES_PER_FLUSH < nb_words ? first_word + 2 * NB_LINES_PER_FLUSH : nb_words;
+
+            /* Invalidates possible prefetched cache lines or old cache lines of the whole batch */
+            for (i = first_word; i < end_word; i += 2)
+                flush_line(ptr_dest + mram_line_offset(i, offset_in_mram));
+
+            __asm__ __volatile__("sync" : : : "memory");
 
-        if (!size_transfer)
-            continue;
-
-        for (i = 0; i < size_transfer / sizeof(uint64_t); i += 2) {
-            uint64_t next_data = BANK_OFFSET_NEXT_DATA(i + offset_in_mram / 8);
-            uint64_t offset = (next_data % BANK_CHUNK_SIZE) + (next_data / BANK_CHUNK_SIZE) * BANK_NEXT_CHUNK_OFFSET;
-
-            /* Invalidates possible prefetched cache line or old cache line */
-            __asm__ __volatile__("isync; sync; dcbf %y0; sync; isync" : : "Z"(*(uint8_t *)ptr_dest + offset) : "memory");
-
-            cache_line[0] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 0 * sizeof(uint64_t)));
-            cache_line[1] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 1 * sizeof(uint64_t)));
-            cache_line[2] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 2 * sizeof(uint64_t)));
-            cache_line[3] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 3 * sizeof(uint64_t)));
-            cache_line[4] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 4 * sizeof(uint64_t)));
-            cache_line[5] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 5 * sizeof(uint64_t)));
-            cache_line[6] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 6 * sizeof(uint64_t)));
-            cache_line[7] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 7 * sizeof(uint64_t)));
-
-            cache_line[8] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 8 * sizeof(uint64_t)));
-            cache_line[9] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 9 * sizeof(uint64_t)));
-            cache_line[10] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 10 * sizeof(uint64_t)));
-            cache_line[11] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 11 * sizeof(uint64_t)));
-            cache_line[12] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 12 * sizeof(uint64_t)));
-            cache_line[13] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 13 * sizeof(uint64_t)));
-            cache_line[14] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 14 * sizeof(uint64_t)));
-            cache_line[15] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 15 * sizeof(uint64_t)));
-
-            byte_interleave(cache_line, cache_line_interleave);
-            byte_interleave(&cache_line[8], &cache_line_interleave[8]);
-
-            for (ci_id = 0; ci_id < 2 * nb_cis; ++ci_id) {
-                if (xfer_matrix[idx + ci_id % nb_cis].ptr) {
-                    *((uint64_t *)xfer_matrix[idx + ci_id % nb_cis].ptr + i + ci_id / nb_cis) = cache_line_interleave[ci_id];
+            for (i = first_word; i < end_word; i += 2) {
+                power9_priv->read_line(ptr_dest + mram_line_offset(i, offset_in_mram), cache_line_interleave);
+
+                for (ci_id = 0; ci_id < 2 * nb_cis; ++ci_id) {
+                    if (xfer_matrix[idx + ci_id % nb_cis].ptr) {
+                        *((uint64_t *)xfer_matrix[idx + ci_id % nb_cis].ptr + i + ci_id / nb_cis) = cache_line_interleave[ci_id];
+                    }
                 }
             }
         }
     }
+}
+
+/* Runs the transfer on every thread and waits for its completion */
+static void
+run_xfer_threads(struct power9_private *power9_priv, void *base_region_addr, struct dpu_transfer_mram *xfer_matrix, uint8_t direction)
+{
+    power9_priv->direction = direction;
+    power9_priv->base_region_addr = base_region_addr;
+    power9_priv->xfer_matrix = xfer_matrix;
+
+    dpu_region_xfer_threads_run(&power9_priv->xfer_threads);
+}
+
+void
+power9_write_to_rank(struct dpu_region_address_translation *tr,
+    void *base_region_addr,
+    __attribute__((unused)) uint8_t channel_id,
+    __attribute__((unused)) uint8_t rank_id,
+    struct dpu_transfer_mram *xfer_matrix)
+{
+    run_xfer_threads(tr->private, base_region_addr, xfer_matrix, THREAD_MRAM_WRITE);
+}
+
+void
+power9_read_from_rank(struct dpu_region_address_translation *tr,
+    void *base_region_addr,
+    __attribute__((unused)) uint8_t channel_id,
+    __attribute__((unused)) uint8_t rank_id,
+    struct dpu_transfer_mram *xfer_matrix)
+{
+    run_xfer_threads(tr->private, base_region_addr, xfer_matrix, THREAD_MRAM_READ);
 
     __asm__ __volatile__("isync; sync; eieio;" : : : "memory");
 }
 
+static void
+xfer_dpu_lines(void *mapping_priv, uint8_t first_dpu_id, uint8_t end_dpu_id)
+{
+    struct power9_private *power9_priv = mapping_priv;
+
+    if (power9_priv->direction == THREAD_MRAM_WRITE)
+        threads_write_to_rank(power9_priv, first_dpu_id, end_dpu_id);
+    else
+        threads_read_from_rank(power9_priv, first_dpu_id, end_dpu_id);
+}
+
 int
-power9_init_region(__attribute__((unused)) struct dpu_region_address_translation *tr)
+power9_init_region(struct dpu_region_address_translation *tr)
 {
+    struct power9_private *power9_priv;
+    const char *line_interleave_name;
+    int ret;
+
+    power9_priv = calloc(1, sizeof(struct power9_private));
+    if (power9_priv == NULL)
+        return -ENOMEM;
+
+    line_interleave_name = select_line_interleave(power9_priv, getenv(POWER9_BYTE_INTERLEAVE_ENV));
+    LOGI(__vc(), "byte_interleave variant: %s", line_interleave_name);
+
+    power9_priv->tr = tr;
+    tr->private = power9_priv;
+
+    ret = dpu_region_xfer_threads_init(&power9_priv->xfer_threads, tr, DEFAULT_NB_THREADS, xfer_dpu_lines, power9_priv);
+    if (ret) {
+        free(power9_priv);
+        return ret;
+    }
+
     return 0;
 }
 
 void
-power9_destroy_region(__attribute__((unused)) struct dpu_region_address_translation *tr)
+power9_destroy_region(struct dpu_region_address_translation *tr)
 {
+    struct power9_private *power9_priv = tr->private;
+
+    dpu_region_xfer_threads_destroy(&power9_priv->xfer_threads);
+
+    free(power9_priv);
 }
 
 struct dpu_region_interleaving power9_interleave = {
@@ -7,9 +7,11 @@
 #include <stdint.h>
 
 #include "dpu_region_address_translation.h"
+#include "dpu_region_xfer_threads.h"
 
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
 #include <sched.h>
@@ -37,9 +39,30 @@ __vc()
     for (dpu = 0, idx = 0; dpu < nb_dpus_per_ci; ++dpu)                                                                          \
         for (ci = 0; ci < nb_cis; ++ci, ++idx)
 
-#define NB_THREADS 8
+/* Used when the rank profile does not set the number of transfer threads */
+#define DEFAULT_NB_THREADS 8
+
+/* The MRAM address translation keeps the bits [12:0] of the offset and a bank chunk holds the cache lines of 8KB of
+ * MRAM: the lines of the words of such a span are evenly spaced in the bank.
+ */
+#define MRAM_ADDRESS_BITS 26
+#define MRAM_SPAN_SIZE 0x2000
+#define MRAM_SPAN_NB_WORDS (MRAM_SPAN_SIZE / sizeof(uint64_t))
+#define NB_MRAM_SPANS ((1 << MRAM_ADDRESS_BITS) / MRAM_SPAN_SIZE)
+
 #define THREAD_MRAM_READ 0
 #define THREAD_MRAM_WRITE 1
+#define THREAD_MRAM_READ_IOVEC 2
+#define THREAD_MRAM_WRITE_IOVEC 3
+
+/* Forces the byte_interleave variant: "scalar", "sse4.1", "avx2", "avx512" or "avx512vbmi" */
+#define XEON_SP_BYTE_INTERLEAVE_ENV "UPMEM_XEON_SP_BYTE_INTERLEAVE"
+
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#define TARGET_AVX512VBMI __attribute__((target("avx512f,avx512bw,avx512vbmi")))
+
+/* Transposes the 8x8 byte matrix; use_stream bypasses the cache when writing to the output */
+typedef void (*byte_interleave_fct_t)(uint64_t *input, uint64_t *output, bool use_stream);
 
 struct xeon_sp_private {
     struct dpu_region_address_translation *tr;
@@ -47,19 +70,19 @@ struct xeon_sp_private {
     void *base_region_addr;
     uint8_t direction;
     struct dpu_transfer_mram *xfer_matrix;
+    struct dpu_transfer_mram_iovec *iovec_matrix;
 
-    pthread_t threads[NB_THREADS];
+    struct dpu_region_xfer_threads xfer_threads;
 
-    pthread_barrier_t barrier_threads;
-    pthread_mutex_t mutex_threads;
-    pthread_cond_t cond_threads;
+    /* Ranks can be accessed concurrently: this state must not be global */
+    bool one_read;
 
-    bool threads_shall_exit;
-    bool work_to_do;
+    /* Selected at init_region from the CPU features */
+    byte_interleave_fct_t byte_interleave;
+    void (*flush_cache_line)(void *address);
 
-    uint8_t nb_threads_awoken;
-    uint8_t nb_dpus_per_thread;
-    uint8_t dpu_id_thread;
+    /* Offset in the bank of the first cache line of each MRAM span, filled at init_region */
+    uint64_t mram_span_offsets[NB_MRAM_SPANS];
 };
 
 /* Write NB_WRQ_FIFO_ENTRIES of 0 right after the CI */
@@ -80,6 +103,28 @@ flush_mc_fifo(void *base_ci_address)
     }
 }
 
+__attribute__((target("clflushopt"))) static void
+flush_cache_line_clflushopt(void *address)
+{
+    __builtin_ia32_clflushopt(address);
+}
+
+static void
+flush_cache_line_clflush(void *address)
+{
+    __builtin_ia32_clflush(address);
+}
+
+/* Non-temporal store of a whole cache line, SSE2 is always available on x86_64 */
+static void
+stream_block_sse2(uint64_t *output, uint64_t *block)
+{
+    _mm_stream_si128((__m128i *)&output[0], _mm_loadu_si128((__m128i *)&block[0]));
+    _mm_stream_si128((__m128i *)&output[2], _mm_loadu_si128((__m128i *)&block[2]));
+    _mm_stream_si128((__m128i *)&output[4], _mm_loadu_si128((__m128i *)&block[4]));
+    _mm_stream_si128((__m128i *)&output[6], _mm_loadu_si128((__m128i *)&block[6]));
+}
+
 void
 byte_interleave(uint64_t *input, uint64_t *output)
 {
@@ -93,7 +138,7 @@ byte_interleave(uint64_t *input, uint64_t *output)
 /* SSE4.1 and AVX2 implementations come from:
  * https://stackoverflow.com/questions/42162270/a-better-8x8-bytes-matrix-transpose-with-sse
  */
-void
+__attribute__((target("sse4.1"))) void
 byte_interleave_sse4_1(uint64_t *input, uint64_t *output)
 {
     char *A = (char *)input;
@@ -138,7 +183,7 @@ byte_interleave_sse4_1(uint64_t *input, uint64_t *output)
     _mm_storeu_ps((float *)&B[48], T3);
 }
 
-void
+__attribute__((target("avx2"))) void
 byte_interleave_avx2(uint64_t *input, uint64_t *output)
 {
     __m256i tm = _mm256_set_epi8(15,
@@ -192,7 +237,7 @@ byte_interleave_avx2(uint64_t *input, uint64_t *output)
     _mm256_storeu_si256((__m256i *)&dst1[32], final1);
 }
 
-void
+TARGET_AVX512 void
 byte_interleave_avx512(uint64_t *input, uint64_t *output, bool use_stream)
 {
     __m512i mask;
@@ -224,21 +269,18 @@ byte_interleave_avx512(uint64_t *input, uint64_t *output, bool use_stream)
     _mm512_storeu_si512((void *)output, final);
 }
 
-#ifdef __AVX512VBMI__
-void
+TARGET_AVX512VBMI void
 byte_interleave_avx512vbmi(uint64_t *src, uint64_t *dst, bool use_stream)
 {
-    const __m512i trans8x8shuf = _mm512_set_epi64(0x0f0b07030e0a0602ULL,
-        0x0d0905010c080400ULL,
-
-        0x0f0b07030e0a0602ULL,
-        0x0d0905010c080400ULL,
-
-        0x0f0b07030e0a0602ULL,
-        0x0d0905010c080400ULL,
-
-        0x0f0b07030e0a0602ULL,
-        0x0d0905010c080400ULL);
+    /* Byte j of output word i is byte i of input word j: the permutation crosses the 128-bit lanes */
+    const __m512i trans8x8shuf = _mm512_set_epi64(0x3f372f271f170f07ULL,
+        0x3e362e261e160e06ULL,
+        0x3d352d251d150d05ULL,
+        0x3c342c241c140c04ULL,
+        0x3b332b231b130b03ULL,
+        0x3a322a221a120a02ULL,
+        0x3931292119110901ULL,
+        0x3830282018100800ULL);
 
     __m512i vsrc = _mm512_loadu_si512(src);
     __m512i shuffled = _mm512_permutexvar_epi8(trans8x8shuf, vsrc);
@@ -250,7 +292,143 @@ byte_interleave_avx512vbmi(uint64_t *src, uint64_t *dst, bool use_stream)
 
     _mm512_storeu_si512(dst, shuffled);
 }
-#endif
+
+static void
+byte_interleave_then_store(void (*interleave)(uint64_t *, uint64_t *), uint64_t *input, uint64_t *output, bool use_stream)
+{
+    uint64_t block[NB_ELEM_MATRIX];
+
+    if (!use_stream) {
+        interleave(input, output);
+        return;
+    }
+
+    interleave(input, block);
+    stream_block_sse2(output, block);
+}
+
+static void
+byte_interleave_scalar_variant(uint64_t *input, uint64_t *output, bool use_stream)
+{
+    byte_interleave_then_store(byte_interleave, input, output, use_stream);
+}
+
+static void
+byte_interleave_sse4_1_variant(uint64_t *input, uint64_t *output, bool use_stream)
+{
+    byte_interleave_then_store(byte_interleave_sse4_1, input, output, use_stream);
+}
+
+static void
+byte_interleave_avx2_variant(uint64_t *input, uint64_t *output, bool use_stream)
+{
+    byte_interleave_then_store(byte_interleave_avx2, input, output, use_stream);
+}
+
+enum byte_interleave_isa {
+    ISA_NONE,
+    ISA_SSE4_1,
+    ISA_AVX2,
+    ISA_AVX512,
+    ISA_AVX512VBMI,
+};
+
+/* Fastest first */
+static const struct {
+    const char *name;
+    enum byte_interleave_isa isa;
+    byte_interleave_fct_t fct;
+} byte_interleave_variants[] = {
+    { "avx512vbmi", ISA_AVX512VBMI, byte_interleave_avx512vbmi },
+    { "avx512", ISA_AVX512, byte_interleave_avx512 },
+    { "avx2", ISA_AVX2, byte_interleave_avx2_variant },
+    { "sse4.1", ISA_SSE4_1, byte_interleave_sse4_1_variant },
+    { "scalar", ISA_NONE, byte_interleave_scalar_variant },
+};
+
+#define NB_BYTE_INTERLEAVE_VARIANTS (sizeof(byte_interleave_variants) / sizeof(byte_interleave_variants[0]))
+
+static bool
+cpu_supports_isa(enum byte_interleave_isa isa)
+{
+    __builtin_cpu_init();
+
+    switch (isa) {
+        case ISA_NONE:
+            return true;
+        case ISA_SSE4_1:
+            return __builtin_cpu_supports("sse4.1");
+        case ISA_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case ISA_AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        case ISA_AVX512VBMI:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+                && __builtin_cpu_supports("avx512vbmi");
+        default:
+            return false;
+    }
+}
+
+/* Compares the variant with the scalar reference, with and without streaming stores */
+static bool
+byte_interleave_self_check(byte_interleave_fct_t fct)
+{
+    uint64_t input[NB_ELEM_MATRIX], expected[NB_ELEM_MATRIX];
+    uint64_t output[NB_ELEM_MATRIX] __attribute__((aligned(64)));
+
+    for (unsigned int round = 0; round < 4; ++round) {
+        /* 37 is odd: the 64 bytes of the matrix are all different */
+        for (unsigned int i = 0; i < sizeof(input); ++i)
+            ((uint8_t *)input)[i] = (uint8_t)(i * 37 + round * 101 + 11);
+
+        byte_interleave(input, expected);
+
+        for (unsigned int use_stream = 0; use_stream < 2; ++use_stream) {
+            memset(output, 0, sizeof(output));
+            fct(input, output, use_stream);
+            __builtin_ia32_mfence();
+
+            if (memcmp(output, expected, sizeof(expected)) != 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static const char *
+select_byte_interleave(struct xeon_sp_private *xeon_sp_priv, const char *requested)
+{
+    unsigned int i;
+
+    for (i = 0; i < NB_BYTE_INTERLEAVE_VARIANTS; ++i) {
+        if (requested != NULL && strcmp(requested, byte_interleave_variants[i].name) != 0)
+            continue;
+
+        if (!cpu_supports_isa(byte_interleave_variants[i].isa)) {
+            if (requested != NULL)
+                LOGW(__vc(), "byte_interleave variant '%s' is not supported by this CPU", requested);
+            continue;
+        }
+
+        if (!byte_interleave_self_check(byte_interleave_variants[i].fct)) {
+            LOGW(__vc(), "byte_interleave variant '%s' failed its self-check, skipping it", byte_interleave_variants[i].name);
+            continue;
+        }
+
+        xeon_sp_priv->byte_interleave = byte_interleave_variants[i].fct;
+        return byte_interleave_variants[i].name;
+    }
+
+    if (requested != NULL) {
+        LOGW(__vc(), "cannot use byte_interleave variant '%s', selecting it from the CPU features", requested);
+        return select_byte_interleave(xeon_sp_priv, NULL);
+    }
+
+    /* The scalar reference always passes its self-check */
+    return NULL;
+}
 
 void
 write_block_sse4_1(uint8_t *ci_address, uint64_t *data)
@@ -266,7 +444,7 @@ write_block_sse4_1(uint8_t *ci_address, uint64_t *data)
     _mm_stream_si128((__m128i *)&ci_address[48], v3);
 }
 
-void
+TARGET_AVX512 void
 write_block_avx512(uint64_t *ci_address, uint64_t *data)
 {
     volatile __m512i zmm;
@@ -275,7 +453,7 @@ write_block_avx512(uint64_t *ci_address, uint64_t *data)
     _mm512_stream_si512((void *)ci_address, zmm);
 }
 
-void
+TARGET_AVX512 void
 read_block_avx512(uint64_t *ci_address, uint64_t *output)
 {
     volatile __m512i zmm;
@@ -293,27 +471,26 @@ read_block_avx512(uint64_t *ci_address, uint64_t *output)
     output[7] = o[7];
 }
 
-static bool one_read = false;
-
 void
-xeon_sp_write_to_cis(__attribute__((unused)) struct dpu_region_address_translation *tr,
+xeon_sp_write_to_cis(struct dpu_region_address_translation *tr,
     void *base_region_addr,
     __attribute__((unused)) uint8_t channel_id,
     __attribute__((unused)) uint8_t rank_id,
     void *block_data,
     __attribute__((unused)) uint32_t block_size)
 {
+    struct xeon_sp_private *xeon_sp_priv = tr->private;
     uint64_t *ci_address;
 
     ci_address = (uint64_t *)((uint8_t *)base_region_addr + 0x20000);
 
-    byte_interleave_avx512(block_data, ci_address, true);
+    xeon_sp_priv->byte_interleave(block_data, ci_address, true);
 
-    one_read = false;
+    xeon_sp_priv->one_read = false;
 }
 
 void
-xeon_sp_read_from_cis(__attribute__((unused)) struct dpu_region_address_translation *tr,
+xeon_sp_read_from_cis(struct dpu_region_address_translation *tr,
     void *base_region_addr,
     __attribute__((unused)) uint8_t channel_id,
     __attribute__((unused)) uint8_t rank_id,
@@ -324,7 +501,8 @@ xeon_sp_read_from_cis(__attribute__((unused)) struct dpu_region_address_translat
     uint64_t input[NB_ELEM_MATRIX];
     uint64_t *ci_address;
     int i;
-    uint8_t nb_reads = one_read ? NB_READS - 1 : NB_READS;
+    struct xeon_sp_private *xeon_sp_priv = tr->private;
+    uint8_t nb_reads = xeon_sp_priv->one_read ? NB_READS - 1 : NB_READS;
 
     ci_address = (uint64_t *)((uint8_t *)base_region_addr + 0x20000 + 32 * 1024);
 
@@ -334,7 +512,7 @@ xeon_sp_read_from_cis(__attribute__((unused)) struct dpu_region_address_translat
          * references the cache line", Volume 2 of the Intel Architectures SW
          * Developer's Manual.
          */
-        __builtin_ia32_clflushopt((uint8_t *)ci_address);
+        xeon_sp_priv->flush_cache_line((uint8_t *)ci_address);
         __builtin_ia32_mfence();
 
         ((volatile uint64_t *)input)[0] = *(ci_address + 0);
@@ -353,9 +531,9 @@ xeon_sp_read_from_cis(__attribute__((unused)) struct dpu_region_address_translat
      * dpu_planner is quite slowed down when it reads packet->data if
      * packet->data is not cached by this access./
      */
-    byte_interleave_avx512(input, block_data, false);
+    xeon_sp_priv->byte_interleave(input, block_data, false);
 
-    one_read = true;
+    xeon_sp_priv->one_read = true;
 }
 
 #define BANK_START(dpu_id) (0x40000 * ((dpu_id) % 4) + ((dpu_id >= 4) ? 0x40 : 0))
@@ -385,6 +563,16 @@ apply_address_translation_on_mram_offset(uint32_t byte_offset)
     return unchanged_bits | (bits_21_to_15 << 14) | (bit_14 << 21);
 }
 
+/* Runs the transfer on every thread and waits for its completion, the matrix of the transfer is already set */
+static void
+run_xfer_threads(struct xeon_sp_private *xeon_sp_priv, void *base_region_addr, uint8_t direction)
+{
+    xeon_sp_priv->direction = direction;
+    xeon_sp_priv->base_region_addr = base_region_addr;
+
+    dpu_region_xfer_threads_run(&xeon_sp_priv->xfer_threads);
+}
+
 void
 xeon_sp_write_to_rank(struct dpu_region_address_translation *tr,
     void *base_region_addr,
@@ -394,21 +582,8 @@ xeon_sp_write_to_rank(struct dpu_region_address_translation *tr,
 {
     struct xeon_sp_private *xeon_sp_priv = tr->private;
 
-    pthread_mutex_lock(&xeon_sp_priv->mutex_threads);
-    /* Init transfer */
-    xeon_sp_priv->direction = THREAD_MRAM_WRITE;
     xeon_sp_priv->xfer_matrix = xfer_matrix;
-    xeon_sp_priv->base_region_addr = base_region_addr;
-    xeon_sp_priv->work_to_do = true;
-    /* Signal every thread */
-    pthread_cond_broadcast(&xeon_sp_priv->cond_threads);
-    pthread_mutex_unlock(&xeon_sp_priv->mutex_threads);
-
-    pthread_barrier_wait(&xeon_sp_priv->barrier_threads);
-
-    pthread_mutex_lock(&xeon_sp_priv->mutex_threads);
-    xeon_sp_priv->dpu_id_thread = 0;
-    pthread_mutex_unlock(&xeon_sp_priv->mutex_threads);
+    run_xfer_threads(xeon_sp_priv, base_region_addr, THREAD_MRAM_WRITE);
 }
 
 void
@@ -420,77 +595,259 @@ xeon_sp_read_from_rank(struct dpu_region_address_translation *tr,
 {
     struct xeon_sp_private *xeon_sp_priv = tr->private;
 
-    pthread_mutex_lock(&xeon_sp_priv->mutex_threads);
-    /* Init transfer */
-    xeon_sp_priv->direction = THREAD_MRAM_READ;
     xeon_sp_priv->xfer_matrix = xfer_matrix;
-    xeon_sp_priv->base_region_addr = base_region_addr;
-    xeon_sp_priv->work_to_do = true;
-    /* Signal every thread */
-    pthread_cond_broadcast(&xeon_sp_priv->cond_threads);
-    pthread_mutex_unlock(&xeon_sp_priv->mutex_threads);
+    run_xfer_threads(xeon_sp_priv, base_region_addr, THREAD_MRAM_READ);
+}
+
+void
+xeon_sp_write_iovec_to_rank(struct dpu_region_address_translation *tr,
+    void *base_region_addr,
+    __attribute__((unused)) uint8_t channel_id,
+    __attribute__((unused)) uint8_t rank_id,
+    struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    struct xeon_sp_private *xeon_sp_priv = tr->private;
+
+    xeon_sp_priv->iovec_matrix = iovec_matrix;
+    run_xfer_threads(xeon_sp_priv, base_region_addr, THREAD_MRAM_WRITE_IOVEC);
+}
+
+void
+xeon_sp_read_iovec_from_rank(struct dpu_region_address_translation *tr,
+    void *base_region_addr,
+    __attribute__((unused)) uint8_t channel_id,
+    __attribute__((unused)) uint8_t rank_id,
+    struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    struct xeon_sp_private *xeon_sp_priv = tr->private;
+
+    xeon_sp_priv->iovec_matrix = iovec_matrix;
+    run_xfer_threads(xeon_sp_priv, base_region_addr, THREAD_MRAM_READ_IOVEC);
+}
+
+/* Offset, from the start of the DPU bank, of the cache line holding the given 64-bit MRAM word of the 8 CIs */
+static uint64_t
+mram_word_line_offset(uint32_t mram_word)
+{
+    uint32_t mram_64_bit_word_offset = apply_address_translation_on_mram_offset(mram_word * sizeof(uint64_t)) / 8;
+    uint64_t next_data = BANK_OFFSET_NEXT_DATA(mram_64_bit_word_offset * sizeof(uint64_t));
+
+    return (next_data % BANK_CHUNK_SIZE) + (next_data / BANK_CHUNK_SIZE) * BANK_NEXT_CHUNK_OFFSET;
+}
+
+#define MRAM_LINE_STRIDE BANK_OFFSET_NEXT_DATA(sizeof(uint64_t))
+
+static void
+init_mram_span_offsets(struct xeon_sp_private *xeon_sp_priv)
+{
+    uint32_t span;
+
+    for (span = 0; span < NB_MRAM_SPANS; ++span)
+        xeon_sp_priv->mram_span_offsets[span] = mram_word_line_offset(span * MRAM_SPAN_NB_WORDS);
+}
+
+/* Returns the number of words, from mram_word to at most end_word, whose cache lines start at line_offset and are
+ * MRAM_LINE_STRIDE bytes apart.
+ */
+static inline uint32_t
+get_mram_span(struct xeon_sp_private *xeon_sp_priv, uint32_t mram_word, uint32_t end_word, uint64_t *line_offset)
+{
+    uint32_t span_end_word = (mram_word / MRAM_SPAN_NB_WORDS + 1) * MRAM_SPAN_NB_WORDS;
+
+    *line_offset = xeon_sp_priv->mram_span_offsets[mram_word / MRAM_SPAN_NB_WORDS]
+        + (mram_word % MRAM_SPAN_NB_WORDS) * MRAM_LINE_STRIDE;
+
+    return (end_word < span_end_word ? end_word : span_end_word) - mram_word;
+}
+
+static void
+flush_mram_words(struct xeon_sp_private *xeon_sp_priv, uint8_t *ptr_dest, uint32_t first_word, uint32_t end_word)
+{
+    uint32_t w, nb_words;
+    uint64_t line_offset;
+
+    for (w = first_word; w < end_word; w += nb_words) {
+        uint8_t *line;
+        uint32_t i;
+
+        nb_words = get_mram_span(xeon_sp_priv, w, end_word, &line_offset);
+        for (i = 0, line = ptr_dest + line_offset; i < nb_words; ++i, line += MRAM_LINE_STRIDE)
+            xeon_sp_priv->flush_cache_line(line);
+    }
+}
+
+/* MRAM words touched by the transfers of one DPU line (the DPUs with the same id on each CI) */
+struct xfer_line_shape {
+    /* Disjoint word ranges [first_word, end_word), sorted */
+    uint8_t nb_segments;
+    struct {
+        uint32_t first_word;
+        uint32_t end_word;
+    } segments[NB_ELEM_MATRIX];
+
+    /* Words entirely covered by a transfer of every DPU of the line: they need neither merge nor byte copy */
+    uint32_t full_first_word;
+    uint32_t full_end_word;
+};
+
+static bool
+compute_xfer_line_shape(struct dpu_transfer_mram *line_xfers, uint8_t nb_cis, struct xfer_line_shape *shape)
+{
+    uint8_t ci_id, i, nb_ranges = 0;
+    uint32_t first_words[NB_ELEM_MATRIX], end_words[NB_ELEM_MATRIX];
+
+    shape->nb_segments = 0;
+    shape->full_first_word = 0;
+    shape->full_end_word = UINT32_MAX;
+
+    for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
+        struct dpu_transfer_mram *xfer = &line_xfers[ci_id];
+        uint32_t first_word, end_word;
+
+        /* The MRAM of a DPU without transfer must be preserved: every word of the line is merged */
+        if (!xfer->ptr || !xfer->size) {
+            shape->full_end_word = 0;
+            continue;
+        }
+
+        first_word = xfer->offset_in_mram / sizeof(uint64_t);
+        end_word = (xfer->offset_in_mram + xfer->size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        /* Sorted insertion, there are at most 8 ranges */
+        for (i = nb_ranges; i > 0 && first_words[i - 1] > first_word; --i) {
+            first_words[i] = first_words[i - 1];
+            end_words[i] = end_words[i - 1];
+        }
+        first_words[i] = first_word;
+        end_words[i] = end_word;
+        nb_ranges++;
+
+        /* Partially covered head and tail words are excluded */
+        first_word = (xfer->offset_in_mram + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        end_word = (xfer->offset_in_mram + xfer->size) / sizeof(uint64_t);
+        if (first_word > shape->full_first_word)
+            shape->full_first_word = first_word;
+        if (end_word < shape->full_end_word)
+            shape->full_end_word = end_word;
+    }
+
+    if (nb_ranges == 0)
+        return false;
+
+    for (i = 0; i < nb_ranges; ++i) {
+        uint8_t last = shape->nb_segments - 1;
+
+        if (shape->nb_segments != 0 && first_words[i] <= shape->segments[last].end_word) {
+            if (end_words[i] > shape->segments[last].end_word)
+                shape->segments[last].end_word = end_words[i];
+        } else {
+            shape->segments[shape->nb_segments].first_word = first_words[i];
+            shape->segments[shape->nb_segments].end_word = end_words[i];
+            shape->nb_segments++;
+        }
+    }
+
+    return true;
+}
 
-    pthread_barrier_wait(&xeon_sp_priv->barrier_threads);
+static inline bool
+is_full_line_word(const struct xfer_line_shape *shape, uint32_t mram_word)
+{
+    return mram_word >= shape->full_first_word && mram_word < shape->full_end_word;
+}
+
+/* Copies the part of the 64-bit MRAM word covered by [offset_in_mram, offset_in_mram + size), between the host buffer
+ * and the word.
+ */
+static void
+copy_word_bytes(uint8_t *ptr, uint32_t offset_in_mram, uint32_t size, uint32_t mram_word, uint64_t *word, bool to_mram)
+{
+    uint32_t word_start = mram_word * sizeof(uint64_t);
+    uint32_t start, end;
+
+    start = word_start > offset_in_mram ? word_start : offset_in_mram;
+    end = word_start + sizeof(uint64_t) < offset_in_mram + size ? word_start + sizeof(uint64_t) : offset_in_mram + size;
+    if (start >= end)
+        return;
+
+    if (to_mram)
+        memcpy((uint8_t *)word + (start - word_start), ptr + (start - offset_in_mram), end - start);
+    else
+        memcpy(ptr + (start - offset_in_mram), (uint8_t *)word + (start - word_start), end - start);
+}
+
+static void
+copy_xfer_word(struct dpu_transfer_mram *xfer, uint32_t mram_word, uint64_t *word, bool to_mram)
+{
+    if (xfer->ptr)
+        copy_word_bytes(xfer->ptr, xfer->offset_in_mram, xfer->size, mram_word, word, to_mram);
+}
 
-    pthread_mutex_lock(&xeon_sp_priv->mutex_threads);
-    xeon_sp_priv->dpu_id_thread = 0;
-    pthread_mutex_unlock(&xeon_sp_priv->mutex_threads);
+static void
+read_line(uint8_t *line_address, uint64_t *cache_line)
+{
+    cache_line[0] = *((volatile uint64_t *)(line_address + 0 * sizeof(uint64_t)));
+    cache_line[1] = *((volatile uint64_t *)(line_address + 1 * sizeof(uint64_t)));
+    cache_line[2] = *((volatile uint64_t *)(line_address + 2 * sizeof(uint64_t)));
+    cache_line[3] = *((volatile uint64_t *)(line_address + 3 * sizeof(uint64_t)));
+    cache_line[4] = *((volatile uint64_t *)(line_address + 4 * sizeof(uint64_t)));
+    cache_line[5] = *((volatile uint64_t *)(line_address + 5 * sizeof(uint64_t)));
+    cache_line[6] = *((volatile uint64_t *)(line_address + 6 * sizeof(uint64_t)));
+    cache_line[7] = *((volatile uint64_t *)(line_address + 7 * sizeof(uint64_t)));
 }
 
 void
-threads_write_to_rank(struct xeon_sp_private *xeon_sp_priv, uint8_t dpu_id_thread)
+threads_write_to_rank(struct xeon_sp_private *xeon_sp_priv, uint8_t first_dpu_id, uint8_t end_dpu_id)
 {
     struct dpu_transfer_mram *xfer_matrix = xeon_sp_priv->xfer_matrix;
-    uint64_t cache_line[8];
-    uint8_t idx, ci_id, dpu_id, nb_cis;
+    uint64_t cache_line[8], cache_line_interleave[8];
+    uint8_t idx, ci_id, dpu_id, nb_cis, seg;
+    struct xfer_line_shape shape;
 
     nb_cis = xeon_sp_priv->tr->interleave->nb_real_ci;
 
-    /* Works only for transfers:
-     * - of same size and same offset on the same line
-     * - size and offset are aligned on 8B
+    /* Each DPU of the line can have its own size and offset: the words where all the transfers of the line are
+     * complete are written directly, the other ones (unaligned heads and tails, words out of the range of some
+     * DPUs) are merged with the current content of the MRAMs.
      */
-    for (dpu_id = dpu_id_thread, idx = dpu_id_thread * 8; dpu_id < dpu_id_thread + xeon_sp_priv->nb_dpus_per_thread;
-         ++dpu_id, idx += 8) {
+    for (dpu_id = first_dpu_id, idx = first_dpu_id * 8; dpu_id < end_dpu_id; ++dpu_id, idx += 8) {
         uint8_t *ptr_dest = (uint8_t *)xeon_sp_priv->base_region_addr + BANK_START(dpu_id);
-        uint32_t size_transfer = 0, i;
-        uint32_t offset_in_mram = 0;
-
-        for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
-            if (xfer_matrix[idx + ci_id].ptr) {
-                if (!size_transfer && !offset_in_mram) {
-                    /* Check that access is aligned on 8B */
-                    if (xfer_matrix[idx + ci_id].size & 0x7 || xfer_matrix[idx + ci_id].offset_in_mram & 0x7) {
-                        LOGW(__vc(), "ERROR: MRAM transfer not aligned on 8B is not supported.");
-                        return;
-                    }
-                    size_transfer = xfer_matrix[idx + ci_id].size;
-                    offset_in_mram = xfer_matrix[idx + ci_id].offset_in_mram;
-                } else {
-                    /* Check that accesses are indeed all aligned with each other */
-                    if (xfer_matrix[idx + ci_id].size != size_transfer
-                        || xfer_matrix[idx + ci_id].offset_in_mram != offset_in_mram) {
-                        LOGW(__vc(), "ERROR: MRAM transfers not aligned with each other is not supported.");
-                        return;
-                    }
-                }
-            }
-        }
+        uint64_t line_offset;
+        uint32_t w;
 
-        if (!size_transfer)
+        if (!compute_xfer_line_shape(&xfer_matrix[idx], nb_cis, &shape))
             continue;
 
-        for (i = 0; i < size_transfer / sizeof(uint64_t); ++i) {
-            uint32_t mram_64_bit_word_offset = apply_address_translation_on_mram_offset(i * 8 + offset_in_mram) / 8;
-            uint64_t next_data = BANK_OFFSET_NEXT_DATA(mram_64_bit_word_offset * sizeof(uint64_t));
-            uint64_t offset = (next_data % BANK_CHUNK_SIZE) + (next_data / BANK_CHUNK_SIZE) * BANK_NEXT_CHUNK_OFFSET;
+        for (seg = 0; seg < shape.nb_segments; ++seg) {
+            uint32_t end_word = shape.segments[seg].end_word;
+
+            for (w = shape.segments[seg].first_word; w < end_word;) {
+                uint32_t nb_words = get_mram_span(xeon_sp_priv, w, end_word, &line_offset);
+                uint8_t *line = ptr_dest + line_offset;
+
+                for (; nb_words != 0; --nb_words, ++w, line += MRAM_LINE_STRIDE) {
+                    if (is_full_line_word(&shape, w)) {
+                        for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
+                            struct dpu_transfer_mram *xfer = &xfer_matrix[idx + ci_id];
+
+                            if (xfer->ptr)
+                                cache_line[ci_id] = *(
+                                    (uint64_t *)((uint8_t *)xfer->ptr + (w * sizeof(uint64_t) - xfer->offset_in_mram)));
+                        }
+                    } else {
+                        /* Read-modify-write: fetch the words of the line from the MRAMs first */
+                        xeon_sp_priv->flush_cache_line(line);
+                        __builtin_ia32_mfence();
+                        read_line(line, cache_line_interleave);
+                        xeon_sp_priv->byte_interleave(cache_line_interleave, cache_line, false);
+
+                        for (ci_id = 0; ci_id < nb_cis; ++ci_id)
+                            copy_xfer_word(&xfer_matrix[idx + ci_id], w, &cache_line[ci_id], true);
+                    }
 
-            for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
-                if (xfer_matrix[idx + ci_id].ptr)
-                    cache_line[ci_id] = *((uint64_t *)xfer_matrix[idx + ci_id].ptr + i);
+                    xeon_sp_priv->byte_interleave(cache_line, (uint64_t *)line, true);
+                }
             }
-
-            byte_interleave_avx512(cache_line, (uint64_t *)((uint8_t *)ptr_dest + offset), true);
         }
 
         __builtin_ia32_mfence();
@@ -505,13 +862,8 @@ threads_write_to_rank(struct xeon_sp_private *xeon_sp_priv, uint8_t dpu_id_threa
          * invalidation and wait for the responses from all the other caches."
          * https://software.intel.com/en-us/forums/software-tuning-performance-optimization-platform-monitoring/topic/699950
          */
-        for (i = 0; i < size_transfer / sizeof(uint64_t); ++i) {
-            uint32_t mram_64_bit_word_offset = apply_address_translation_on_mram_offset(i * 8 + offset_in_mram) / 8;
-            uint64_t next_data = BANK_OFFSET_NEXT_DATA(mram_64_bit_word_offset * sizeof(uint64_t));
-            uint64_t offset = (next_data % BANK_CHUNK_SIZE) + (next_data / BANK_CHUNK_SIZE) * BANK_NEXT_CHUNK_OFFSET;
-
-            __builtin_ia32_clflushopt((uint8_t *)ptr_dest + offset);
-        }
+        for (seg = 0; seg < shape.nb_segments; ++seg)
+            flush_mram_words(xeon_sp_priv, ptr_dest, shape.segments[seg].first_word, shape.segments[seg].end_word);
 
         __builtin_ia32_mfence();
     }
@@ -519,198 +871,405 @@ threads_write_to_rank(struct xeon_sp_private *xeon_sp_priv, uint8_t dpu_id_threa
     flush_mc_fifo((uint8_t *)xeon_sp_priv->base_region_addr + 0x20000);
 }
 
+/* The host buffers registered by the API are resident and cache line aligned: the words read from the MRAMs are
+ * stored into them without going through the caches, which saves reading the destination lines first.
+ */
+static bool
+is_line_into_host_buffers(struct dpu_region_address_translation *tr, struct dpu_transfer_mram *line_xfers, uint8_t nb_cis)
+{
+    uint8_t ci_id;
+    uint32_t i;
+
+    if (tr->nb_host_buffers == 0)
+        return false;
+
+    for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
+        uint8_t *ptr = line_xfers[ci_id].ptr;
+
+        if (!ptr)
+            continue;
+
+        for (i = 0; i < tr->nb_host_buffers; ++i) {
+            uint8_t *host_buffer = tr->host_buffers[i].ptr;
+
+            if (ptr >= host_buffer && ptr + line_xfers[ci_id].size <= host_buffer + tr->host_buffers[i].size)
+                break;
+        }
+
+        if (i == tr->nb_host_buffers)
+            return false;
+    }
+
+    return true;
+}
+
 void
-threads_read_from_rank(struct xeon_sp_private *xeon_sp_priv, uint8_t dpu_id_thread)
+threads_read_from_rank(struct xeon_sp_private *xeon_sp_priv, uint8_t first_dpu_id, uint8_t end_dpu_id)
 {
     struct dpu_transfer_mram *xfer_matrix = xeon_sp_priv->xfer_matrix;
     uint64_t cache_line[8], cache_line_interleave[8];
-    uint8_t idx, ci_id, dpu_id, nb_cis;
+    uint8_t idx, ci_id, dpu_id, nb_cis, seg;
+    struct xfer_line_shape shape;
 
     nb_cis = xeon_sp_priv->tr->interleave->nb_real_ci;
 
-    /* Works only for transfers of same size and same offset on the
-     * same line
+    /* Each DPU of the line can have its own size and offset: every word touched by one of the transfers is read
+     * once, and only the bytes requested by each DPU are copied to its buffer.
      */
-    for (dpu_id = dpu_id_thread, idx = dpu_id_thread * 8; dpu_id < dpu_id_thread + xeon_sp_priv->nb_dpus_per_thread;
-         ++dpu_id, idx += 8) {
+    for (dpu_id = first_dpu_id, idx = first_dpu_id * 8; dpu_id < end_dpu_id; ++dpu_id, idx += 8) {
         uint8_t *ptr_dest = (uint8_t *)xeon_sp_priv->base_region_addr + BANK_START(dpu_id);
-        uint32_t size_transfer = 0, i;
-        uint32_t offset_in_mram = 0;
-
-        for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
-            if (xfer_matrix[idx + ci_id].ptr) {
-                if (!size_transfer && !offset_in_mram) {
-                    /* Check that access is aligned on 8B */
-                    if (xfer_matrix[idx + ci_id].size & 0x7 || xfer_matrix[idx + ci_id].offset_in_mram & 0x7) {
-                        LOGW(__vc(), "ERROR: MRAM transfer not aligned on 8B is not supported.");
-                        return;
-                    }
-                    size_transfer = xfer_matrix[idx + ci_id].size;
-                    offset_in_mram = xfer_matrix[idx + ci_id].offset_in_mram;
-                } else {
-                    /* Check that accesses are indeed all aligned with each other */
-                    if (xfer_matrix[idx + ci_id].size != size_transfer
-                        || xfer_matrix[idx + ci_id].offset_in_mram != offset_in_mram) {
-                        LOGW(__vc(), "ERROR: MRAM transfers not aligned with each other is not supported.");
-                        return;
+        uint64_t line_offset;
+        uint32_t w;
+        bool use_stream;
+
+        if (!compute_xfer_line_shape(&xfer_matrix[idx], nb_cis, &shape))
+            continue;
+
+        use_stream = is_line_into_host_buffers(xeon_sp_priv->tr, &xfer_matrix[idx], nb_cis);
+
+        __builtin_ia32_mfence();
+
+        /* Invalidates possible prefetched cache line or old cache line */
+        for (seg = 0; seg < shape.nb_segments; ++seg)
+            flush_mram_words(xeon_sp_priv, ptr_dest, shape.segments[seg].first_word, shape.segments[seg].end_word);
+
+        __builtin_ia32_mfence();
+
+        for (seg = 0; seg < shape.nb_segments; ++seg) {
+            uint32_t end_word = shape.segments[seg].end_word;
+
+            for (w = shape.segments[seg].first_word; w < end_word;) {
+                uint32_t nb_words = get_mram_span(xeon_sp_priv, w, end_word, &line_offset);
+                uint8_t *line = ptr_dest + line_offset;
+
+                for (; nb_words != 0; --nb_words, ++w, line += MRAM_LINE_STRIDE) {
+                    read_line(line, cache_line);
+
+                    xeon_sp_priv->byte_interleave(cache_line, cache_line_interleave, false);
+
+                    if (is_full_line_word(&shape, w)) {
+                        for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
+                            struct dpu_transfer_mram *xfer = &xfer_matrix[idx + ci_id];
+
+                            uint64_t *dst;
+
+                            if (!xfer->ptr)
+                                continue;
+
+                            dst = (uint64_t *)((uint8_t *)xfer->ptr + (w * sizeof(uint64_t) - xfer->offset_in_mram));
+                            if (use_stream)
+                                __builtin_ia32_movnti64((long long *)dst, (long long)cache_line_interleave[ci_id]);
+                            else
+                                *dst = cache_line_interleave[ci_id];
+                        }
+                    } else {
+                        for (ci_id = 0; ci_id < nb_cis; ++ci_id)
+                            copy_xfer_word(&xfer_matrix[idx + ci_id], w, &cache_line_interleave[ci_id], false);
                     }
                 }
             }
         }
 
-        if (!size_transfer)
-            continue;
+        /* Non-temporal stores are weakly ordered */
+        if (use_stream)
+            __builtin_ia32_sfence();
+    }
+}
 
-        __builtin_ia32_mfence();
+/* Position in the segments of the DPUs of one line, for an iovec transfer. The runs are the word ranges touched by
+ * at least one segment of the line, merged across the DPUs so that each cache line is accessed once.
+ */
+struct iovec_line_cursor {
+    struct dpu_transfer_mram_iovec *iovecs;
+    uint8_t nb_cis;
+    /* Next segment of each DPU to merge into a run */
+    uint32_t run_segment[NB_ELEM_MATRIX];
+    /* First segment of each DPU which ends after the current word */
+    uint32_t word_segment[NB_ELEM_MATRIX];
+};
+
+static void
+init_iovec_line_cursor(struct iovec_line_cursor *cursor, struct dpu_transfer_mram_iovec *iovecs, uint8_t nb_cis)
+{
+    cursor->iovecs = iovecs;
+    cursor->nb_cis = nb_cis;
+    memset(cursor->run_segment, 0, sizeof(cursor->run_segment));
+    memset(cursor->word_segment, 0, sizeof(cursor->word_segment));
+}
+
+/* Segments of a DPU are sorted and disjoint: a k-way merge of the DPUs of the line gives the runs in order */
+static bool
+next_iovec_line_run(struct iovec_line_cursor *cursor, uint32_t *first_word, uint32_t *end_word)
+{
+    uint8_t ci_id;
+    bool extended;
+
+    *first_word = UINT32_MAX;
+    for (ci_id = 0; ci_id < cursor->nb_cis; ++ci_id) {
+        struct dpu_transfer_mram_iovec *iovec = &cursor->iovecs[ci_id];
 
-        for (i = 0; i < size_transfer / sizeof(uint64_t); ++i) {
-            uint32_t mram_64_bit_word_offset = apply_address_translation_on_mram_offset(i * 8 + offset_in_mram) / 8;
-            uint64_t next_data = BANK_OFFSET_NEXT_DATA(mram_64_bit_word_offset * sizeof(uint64_t));
-            uint64_t offset = (next_data % BANK_CHUNK_SIZE) + (next_data / BANK_CHUNK_SIZE) * BANK_NEXT_CHUNK_OFFSET;
+        if (cursor->run_segment[ci_id] < iovec->nb_segments) {
+            uint32_t word = iovec->segments[cursor->run_segment[ci_id]].offset_in_mram / sizeof(uint64_t);
 
-            /* Invalidates possible prefetched cache line or old cache line */
-            __builtin_ia32_clflushopt((uint8_t *)ptr_dest + offset);
+            if (word < *first_word)
+                *first_word = word;
         }
+    }
 
-        __builtin_ia32_mfence();
+    if (*first_word == UINT32_MAX)
+        return false;
 
-        for (i = 0; i < size_transfer / sizeof(uint64_t); ++i) {
-            uint32_t mram_64_bit_word_offset = apply_address_translation_on_mram_offset(i * 8 + offset_in_mram) / 8;
-            uint64_t next_data = BANK_OFFSET_NEXT_DATA(mram_64_bit_word_offset * sizeof(uint64_t));
-            uint64_t offset = (next_data % BANK_CHUNK_SIZE) + (next_data / BANK_CHUNK_SIZE) * BANK_NEXT_CHUNK_OFFSET;
-
-            cache_line[0] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 0 * sizeof(uint64_t)));
-            cache_line[1] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 1 * sizeof(uint64_t)));
-            cache_line[2] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 2 * sizeof(uint64_t)));
-            cache_line[3] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 3 * sizeof(uint64_t)));
-            cache_line[4] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 4 * sizeof(uint64_t)));
-            cache_line[5] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 5 * sizeof(uint64_t)));
-            cache_line[6] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 6 * sizeof(uint64_t)));
-            cache_line[7] = *((volatile uint64_t *)((uint8_t *)ptr_dest + offset + 7 * sizeof(uint64_t)));
-
-            byte_interleave_avx2(cache_line, cache_line_interleave);
-
-            for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
-                if (xfer_matrix[idx + ci_id].ptr) {
-                    *((uint64_t *)xfer_matrix[idx + ci_id].ptr + i) = cache_line_interleave[ci_id];
-                }
+    *end_word = *first_word;
+    do {
+        extended = false;
+        for (ci_id = 0; ci_id < cursor->nb_cis; ++ci_id) {
+            struct dpu_transfer_mram_iovec *iovec = &cursor->iovecs[ci_id];
+
+            while (cursor->run_segment[ci_id] < iovec->nb_segments) {
+                struct dpu_transfer_mram_segment *segment = &iovec->segments[cursor->run_segment[ci_id]];
+                uint32_t segment_end_word = (segment->offset_in_mram + segment->size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+                if (segment->offset_in_mram / sizeof(uint64_t) > *end_word)
+                    break;
+
+                if (segment_end_word > *end_word)
+                    *end_word = segment_end_word;
+                cursor->run_segment[ci_id]++;
+                extended = true;
             }
         }
+    } while (extended);
+
+    return true;
+}
+
+/* Moves to mram_word, which must not be before the previous one, and returns whether one segment of the DPU covers
+ * the whole word.
+ */
+static bool
+seek_iovec_word(struct iovec_line_cursor *cursor, uint8_t ci_id, uint32_t mram_word)
+{
+    struct dpu_transfer_mram_iovec *iovec = &cursor->iovecs[ci_id];
+    uint32_t word_start = mram_word * sizeof(uint64_t);
+    struct dpu_transfer_mram_segment *segment;
+
+    while (cursor->word_segment[ci_id] < iovec->nb_segments) {
+        segment = &iovec->segments[cursor->word_segment[ci_id]];
+        if (segment->offset_in_mram + segment->size > word_start)
+            break;
+        cursor->word_segment[ci_id]++;
     }
+
+    if (cursor->word_segment[ci_id] == iovec->nb_segments)
+        return false;
+
+    segment = &iovec->segments[cursor->word_segment[ci_id]];
+
+    return segment->offset_in_mram <= word_start && segment->offset_in_mram + segment->size >= word_start + sizeof(uint64_t);
+}
+
+/* Copies the bytes of every segment of the DPU in the word: an unaligned word can be shared by two segments */
+static void
+copy_iovec_word(struct iovec_line_cursor *cursor, uint8_t ci_id, uint32_t mram_word, uint64_t *word, bool to_mram)
+{
+    struct dpu_transfer_mram_iovec *iovec = &cursor->iovecs[ci_id];
+    uint32_t word_end = (mram_word + 1) * sizeof(uint64_t);
+    uint32_t i;
+
+    for (i = cursor->word_segment[ci_id]; i < iovec->nb_segments && iovec->segments[i].offset_in_mram < word_end; ++i)
+        copy_word_bytes(
+            iovec->segments[i].ptr, iovec->segments[i].offset_in_mram, iovec->segments[i].size, mram_word, word, to_mram);
 }
 
-void *
-thread_mram(void *arg)
+static inline uint64_t *
+get_iovec_word_ptr(struct iovec_line_cursor *cursor, uint8_t ci_id, uint32_t mram_word)
 {
-    struct xeon_sp_private *xeon_sp_priv = arg;
-    uint8_t cur_dpu_id;
+    struct dpu_transfer_mram_segment *segment = &cursor->iovecs[ci_id].segments[cursor->word_segment[ci_id]];
 
-    while (1) {
-        pthread_mutex_lock(&xeon_sp_priv->mutex_threads);
+    return (uint64_t *)((uint8_t *)segment->ptr + (mram_word * sizeof(uint64_t) - segment->offset_in_mram));
+}
 
-        if (!xeon_sp_priv->work_to_do)
-            pthread_cond_wait(&xeon_sp_priv->cond_threads, &xeon_sp_priv->mutex_threads);
+void
+threads_write_iovec_to_rank(struct xeon_sp_private *xeon_sp_priv, uint8_t first_dpu_id, uint8_t end_dpu_id)
+{
+    struct dpu_transfer_mram_iovec *iovec_matrix = xeon_sp_priv->iovec_matrix;
+    uint64_t cache_line[8], cache_line_interleave[8];
+    uint8_t idx, ci_id, dpu_id, nb_cis;
+    struct iovec_line_cursor cursor;
+    uint32_t first_word, end_word;
 
-        xeon_sp_priv->nb_threads_awoken++;
+    nb_cis = xeon_sp_priv->tr->interleave->nb_real_ci;
 
-        /* Once everyone is awoken, the last thread clears work_to_do: we must
-         * clear work_to_do here, since it can't be done by main thread before
-         * the barrier wait since some threads might not be awoken already.
-         */
-        if (xeon_sp_priv->nb_threads_awoken == NB_THREADS) {
-            xeon_sp_priv->work_to_do = false;
-            xeon_sp_priv->nb_threads_awoken = 0;
+    /* Same as threads_write_to_rank, the words entirely covered by a segment of each DPU of the line are written
+     * directly, the other ones are merged with the current content of the MRAMs.
+     */
+    for (dpu_id = first_dpu_id, idx = first_dpu_id * 8; dpu_id < end_dpu_id; ++dpu_id, idx += 8) {
+        uint8_t *ptr_dest = (uint8_t *)xeon_sp_priv->base_region_addr + BANK_START(dpu_id);
+        uint64_t line_offset;
+        bool wrote = false;
+        uint32_t w;
+
+        init_iovec_line_cursor(&cursor, &iovec_matrix[idx], nb_cis);
+
+        while (next_iovec_line_run(&cursor, &first_word, &end_word)) {
+            for (w = first_word; w < end_word;) {
+                uint32_t nb_words = get_mram_span(xeon_sp_priv, w, end_word, &line_offset);
+                uint8_t *line = ptr_dest + line_offset;
+
+                for (; nb_words != 0; --nb_words, ++w, line += MRAM_LINE_STRIDE) {
+                    bool is_full_word = true;
+
+                    for (ci_id = 0; ci_id < nb_cis; ++ci_id)
+                        if (!seek_iovec_word(&cursor, ci_id, w))
+                            is_full_word = false;
+
+                    if (is_full_word) {
+                        for (ci_id = 0; ci_id < nb_cis; ++ci_id)
+                            cache_line[ci_id] = *get_iovec_word_ptr(&cursor, ci_id, w);
+                    } else {
+                        /* Read-modify-write: fetch the words of the line from the MRAMs first */
+                        xeon_sp_priv->flush_cache_line(line);
+                        __builtin_ia32_mfence();
+                        read_line(line, cache_line_interleave);
+                        xeon_sp_priv->byte_interleave(cache_line_interleave, cache_line, false);
+
+                        for (ci_id = 0; ci_id < nb_cis; ++ci_id)
+                            copy_iovec_word(&cursor, ci_id, w, &cache_line[ci_id], true);
+                    }
+
+                    xeon_sp_priv->byte_interleave(cache_line, (uint64_t *)line, true);
+                }
+            }
+            wrote = true;
         }
 
-        if (xeon_sp_priv->threads_shall_exit)
-            break;
+        if (!wrote)
+            continue;
+
+        __builtin_ia32_mfence();
 
-        cur_dpu_id = xeon_sp_priv->dpu_id_thread;
-        xeon_sp_priv->dpu_id_thread += xeon_sp_priv->nb_dpus_per_thread;
+        init_iovec_line_cursor(&cursor, &iovec_matrix[idx], nb_cis);
+        while (next_iovec_line_run(&cursor, &first_word, &end_word))
+            flush_mram_words(xeon_sp_priv, ptr_dest, first_word, end_word);
 
-        pthread_mutex_unlock(&xeon_sp_priv->mutex_threads);
+        __builtin_ia32_mfence();
+    }
 
-        if (xeon_sp_priv->direction == THREAD_MRAM_READ)
-            threads_read_from_rank(xeon_sp_priv, cur_dpu_id);
-        else
-            threads_write_to_rank(xeon_sp_priv, cur_dpu_id);
+    flush_mc_fifo((uint8_t *)xeon_sp_priv->base_region_addr + 0x20000);
+}
+
+void
+threads_read_iovec_from_rank(struct xeon_sp_private *xeon_sp_priv, uint8_t first_dpu_id, uint8_t end_dpu_id)
+{
+    struct dpu_transfer_mram_iovec *iovec_matrix = xeon_sp_priv->iovec_matrix;
+    uint64_t cache_line[8], cache_line_interleave[8];
+    uint8_t idx, ci_id, dpu_id, nb_cis;
+    struct iovec_line_cursor cursor;
+    uint32_t first_word, end_word;
+
+    nb_cis = xeon_sp_priv->tr->interleave->nb_real_ci;
 
-        pthread_barrier_wait(&xeon_sp_priv->barrier_threads);
+    for (dpu_id = first_dpu_id, idx = first_dpu_id * 8; dpu_id < end_dpu_id; ++dpu_id, idx += 8) {
+        uint8_t *ptr_dest = (uint8_t *)xeon_sp_priv->base_region_addr + BANK_START(dpu_id);
+        uint64_t line_offset;
+        uint32_t w;
+
+        __builtin_ia32_mfence();
+
+        /* Invalidates possible prefetched cache line or old cache line */
+        init_iovec_line_cursor(&cursor, &iovec_matrix[idx], nb_cis);
+        while (next_iovec_line_run(&cursor, &first_word, &end_word))
+            flush_mram_words(xeon_sp_priv, ptr_dest, first_word, end_word);
+
+        __builtin_ia32_mfence();
+
+        init_iovec_line_cursor(&cursor, &iovec_matrix[idx], nb_cis);
+        while (next_iovec_line_run(&cursor, &first_word, &end_word)) {
+            for (w = first_word; w < end_word;) {
+                uint32_t nb_words = get_mram_span(xeon_sp_priv, w, end_word, &line_offset);
+                uint8_t *line = ptr_dest + line_offset;
+
+                for (; nb_words != 0; --nb_words, ++w, line += MRAM_LINE_STRIDE) {
+                    read_line(line, cache_line);
+
+                    xeon_sp_priv->byte_interleave(cache_line, cache_line_interleave, false);
+
+                    for (ci_id = 0; ci_id < nb_cis; ++ci_id) {
+                        if (seek_iovec_word(&cursor, ci_id, w))
+                            *get_iovec_word_ptr(&cursor, ci_id, w) = cache_line_interleave[ci_id];
+                        else
+                            copy_iovec_word(&cursor, ci_id, w, &cache_line_interleave[ci_id], false);
+                    }
+                }
+            }
+        }
     }
+}
 
-    pthread_mutex_unlock(&xeon_sp_priv->mutex_threads);
+static void
+xfer_dpu_lines(void *mapping_priv, uint8_t first_dpu_id, uint8_t end_dpu_id)
+{
+    struct xeon_sp_private *xeon_sp_priv = mapping_priv;
 
-    return NULL;
+    switch (xeon_sp_priv->direction) {
+        case THREAD_MRAM_READ:
+            threads_read_from_rank(xeon_sp_priv, first_dpu_id, end_dpu_id);
+            break;
+        case THREAD_MRAM_WRITE:
+            threads_write_to_rank(xeon_sp_priv, first_dpu_id, end_dpu_id);
+            break;
+        case THREAD_MRAM_READ_IOVEC:
+            threads_read_iovec_from_rank(xeon_sp_priv, first_dpu_id, end_dpu_id);
+            break;
+        case THREAD_MRAM_WRITE_IOVEC:
+            threads_write_iovec_to_rank(xeon_sp_priv, first_dpu_id, end_dpu_id);
+            break;
+    }
 }
 
-// TODO retrieve environment variable that decides which byte_interleave function
-// to use.
 int
 xeon_sp_init_region(struct dpu_region_address_translation *tr)
 {
     struct xeon_sp_private *xeon_sp_priv;
-    int i, ret;
-    uint8_t nb_dpus_per_ci;
-
-    nb_dpus_per_ci = tr->interleave->nb_dpus_per_ci;
+    const char *byte_interleave_name;
+    int ret;
 
     xeon_sp_priv = calloc(1, sizeof(struct xeon_sp_private));
     if (xeon_sp_priv == NULL)
         return -ENOMEM;
 
     tr->private = xeon_sp_priv;
+    xeon_sp_priv->tr = tr;
 
-    xeon_sp_priv->threads_shall_exit = false;
-    xeon_sp_priv->work_to_do = false;
-    pthread_mutex_init(&xeon_sp_priv->mutex_threads, NULL);
-    pthread_cond_init(&xeon_sp_priv->cond_threads, NULL);
+    byte_interleave_name = select_byte_interleave(xeon_sp_priv, getenv(XEON_SP_BYTE_INTERLEAVE_ENV));
+    if (byte_interleave_name == NULL) {
+        free(xeon_sp_priv);
+        return -ENOTSUP;
+    }
 
-    ret = pthread_barrier_init(&xeon_sp_priv->barrier_threads, NULL, NB_THREADS + 1);
-    if (ret)
-        goto err;
+    __builtin_cpu_init();
+    xeon_sp_priv->flush_cache_line
+        = __builtin_cpu_supports("clflushopt") ? flush_cache_line_clflushopt : flush_cache_line_clflush;
 
-    xeon_sp_priv->tr = tr;
-    xeon_sp_priv->dpu_id_thread = 0;
-    xeon_sp_priv->nb_dpus_per_thread = nb_dpus_per_ci / NB_THREADS;
-    xeon_sp_priv->nb_threads_awoken = 0;
-
-    for (i = 0; i < NB_THREADS; ++i) {
-        ret = pthread_create(&xeon_sp_priv->threads[i], NULL, thread_mram, xeon_sp_priv);
-        if (ret)
-            goto kill_threads;
-    }
+    LOGI(__vc(), "byte_interleave variant: %s", byte_interleave_name);
 
-    return 0;
+    init_mram_span_offsets(xeon_sp_priv);
 
-kill_threads:
-    pthread_mutex_lock(&xeon_sp_priv->mutex_threads);
-    xeon_sp_priv->threads_shall_exit = true;
-    pthread_cond_broadcast(&xeon_sp_priv->cond_threads);
-    pthread_mutex_unlock(&xeon_sp_priv->mutex_threads);
-err:
-    free(xeon_sp_priv);
+    ret = dpu_region_xfer_threads_init(&xeon_sp_priv->xfer_threads, tr, DEFAULT_NB_THREADS, xfer_dpu_lines, xeon_sp_priv);
+    if (ret) {
+        free(xeon_sp_priv);
+        return ret;
+    }
 
-    return ret;
+    return 0;
 }
 
 void
 xeon_sp_destroy_region(struct dpu_region_address_translation *tr)
 {
-    struct xeon_sp_private *xeon_sp_priv;
-    int i;
-
-    xeon_sp_priv = tr->private;
-
-    pthread_mutex_lock(&xeon_sp_priv->mutex_threads);
-    xeon_sp_priv->threads_shall_exit = true;
-    pthread_cond_broadcast(&xeon_sp_priv->cond_threads);
-    pthread_mutex_unlock(&xeon_sp_priv->mutex_threads);
-
-    for (i = 0; i < NB_THREADS; ++i) {
-        pthread_join(xeon_sp_priv->threads[i], NULL);
-    }
+    struct xeon_sp_private *xeon_sp_priv = tr->private;
 
-    pthread_barrier_destroy(&xeon_sp_priv->barrier_threads);
+    dpu_region_xfer_threads_destroy(&xeon_sp_priv->xfer_threads);
 
     free(xeon_sp_priv);
 }
@@ -737,6 +1296,8 @@ struct dpu_region_address_translation xeon_sp_translate = {
     //.destroy_rank         = xeon_sp_destroy_rank,
     .write_to_rank = xeon_sp_write_to_rank,
     .read_from_rank = xeon_sp_read_from_rank,
+    .write_iovec_to_rank = xeon_sp_write_iovec_to_rank,
+    .read_iovec_from_rank = xeon_sp_read_iovec_from_rank,
     .write_to_cis = xeon_sp_write_to_cis,
     .read_from_cis = xeon_sp_read_from_cis,
 };
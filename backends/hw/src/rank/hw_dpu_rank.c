@@ -6,6 +6,7 @@
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <dpu_chip_config.h>
 #include <string.h>
 #include <dpu_profile.h>
@@ -32,6 +33,7 @@
 #include "dpu_region_address_translation.h"
 #include "dpu_region_constants.h"
 #include "hw_dpu_sysfs.h"
+#include "hw_dpu_ring.h"
 #include "dpu_rank_ioctl.h"
 #include "dpu_fpga_ila.h"
 
@@ -39,6 +41,9 @@
 
 #include "static_verbose.h"
 
+/* Entries of the SAFE mode rings: enough for the commits queued between two updates */
+#define NB_RING_ENTRIES 64
+
 const char *
 get_rank_path(dpu_description_t description);
 
@@ -85,6 +90,18 @@ hw_copy_to_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matr
 static dpu_rank_status_e
 hw_copy_from_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
 static dpu_rank_status_e
+hw_copy_iovec_to_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix);
+static dpu_rank_status_e
+hw_copy_iovec_from_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix);
+static dpu_rank_status_e
+hw_register_transfer_matrix(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
+static void
+hw_unregister_transfer_matrix(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix);
+static dpu_rank_status_e
+hw_register_host_buffer(struct dpu_rank_t *rank, void *buffer, size_t size);
+static void
+hw_unregister_host_buffer(struct dpu_rank_t *rank, void *buffer);
+static dpu_rank_status_e
 hw_fill_description_from_profile(dpu_properties_t properties, dpu_description_t description);
 static dpu_rank_status_e
 hw_custom_operation(struct dpu_rank_t *rank,
@@ -105,6 +122,19 @@ const __API_SYMBOL__ struct dpu_rank_handler hw_dpu_rank_handler = {
     .fill_description_from_profile = hw_fill_description_from_profile,
     .custom_operation = hw_custom_operation,
     .print_lldb_message_on_fault = hw_print_lldb_message_on_fault,
+    .copy_iovec_to_rank = hw_copy_iovec_to_rank,
+    .copy_iovec_from_rank = hw_copy_iovec_from_rank,
+    .register_transfer_matrix = hw_register_transfer_matrix,
+    .unregister_transfer_matrix = hw_unregister_transfer_matrix,
+    .register_host_buffer = hw_register_host_buffer,
+    .unregister_host_buffer = hw_unregister_host_buffer,
+};
+
+/* Expanded copy of a transfer matrix that the API pushes several times without modifying it */
+struct hw_registered_transfer_matrix {
+    struct dpu_transfer_mram *transfer_matrix;
+    struct dpu_transfer_mram *real_transfer_matrix;
+    struct hw_registered_transfer_matrix *next;
 };
 
 typedef struct _hw_dpu_rank_context_t {
@@ -121,6 +151,10 @@ typedef struct _hw_dpu_rank_context_t {
      */
     uint64_t *real_buffer_control_interfaces;
     struct dpu_transfer_mram *real_transfer_matrix;
+    struct hw_registered_transfer_matrix *registered_transfer_matrices;
+    /* Safe mode: the operations go through the rings shared with the driver, instead of one ioctl each */
+    struct dpu_rank_ring ring;
+    bool use_ring;
 } * hw_dpu_rank_context_t;
 
 typedef struct _fpga_allocation_parameters_t {
@@ -142,10 +176,23 @@ typedef struct _hw_dpu_rank_allocation_parameters_t {
     uint8_t channel_id, rank_id;
     uint8_t *ptr_region;
     bool bypass_module_compatibility;
+    /* PERF mode transfer threads */
+    uint8_t nb_xfer_threads;
+    char *xfer_cpus;
+    char *xfer_numa_node;
+    /* NUMA node whose ranks are allocated first, -1 for none */
+    int rank_numa_node;
+    /* SAFE mode rings: DPU_RANK_RING_SETUP_* flags when enabled, requested when the profile asks for them explicitly */
+    bool safe_ring;
+    bool safe_ring_requested;
+    uint32_t safe_ring_flags;
     /* Backends specific */
     fpga_allocation_parameters_t fpga;
 } * hw_dpu_rank_allocation_parameters_t;
 
+static bool
+is_transfer_translated(hw_dpu_rank_allocation_parameters_t params);
+
 static inline hw_dpu_rank_context_t
 _this(struct dpu_rank_t *rank)
 {
@@ -220,12 +267,85 @@ fill_address_translation_backend(hw_dpu_rank_allocation_parameters_t params)
     return true;
 }
 
+/* The transfer threads run by default on the NUMA node that owns the rank */
+static int
+get_xfer_numa_node(struct dpu_rank_t *rank, const char *xfer_numa_node)
+{
+    char *end;
+    long numa_node;
+
+    if (xfer_numa_node == NULL || !strcmp(xfer_numa_node, "local"))
+        return rank->numa_node;
+
+    if (!strcmp(xfer_numa_node, "none"))
+        return -1;
+
+    numa_node = strtol(xfer_numa_node, &end, 10);
+    if (end == xfer_numa_node || *end != '\0' || numa_node < 0 || numa_node > INT_MAX) {
+        LOG_RANK(WARNING, rank, "Invalid transfer thread NUMA node \"%s\", using the node of the rank", xfer_numa_node);
+        return rank->numa_node;
+    }
+
+    return (int)numa_node;
+}
+
+/* The ranks are allocated in the order of the devices by default */
+static int
+get_rank_numa_node(const char *rank_numa_node)
+{
+    char *end;
+    long numa_node;
+
+    if (rank_numa_node == NULL || !strcmp(rank_numa_node, "any"))
+        return -1;
+
+    numa_node = strtol(rank_numa_node, &end, 10);
+    if (end == rank_numa_node || *end != '\0' || numa_node < 0 || numa_node > INT_MAX) {
+        LOG_FN(WARNING, "Invalid rank NUMA node \"%s\", allocating ranks from any node", rank_numa_node);
+        return -1;
+    }
+
+    return (int)numa_node;
+}
+
+/* The rings stay off by default until the driver ABI is released: "auto" uses them when the driver has them */
+static bool
+get_safe_ring(const char *safe_ring, uint32_t *flags, bool *requested)
+{
+    *flags = 0;
+    *requested = false;
+
+    if (safe_ring == NULL || !strcmp(safe_ring, "off"))
+        return false;
+
+    if (!strcmp(safe_ring, "auto"))
+        return true;
+
+    if (!strcmp(safe_ring, "on")) {
+        *requested = true;
+        return true;
+    }
+
+    if (!strcmp(safe_ring, "sqpoll")) {
+        *flags = DPU_RANK_RING_SETUP_SQPOLL;
+        *requested = true;
+        return true;
+    }
+
+    LOG_FN(WARNING, "Invalid SAFE mode ring \"%s\", using the default (off)", safe_ring);
+    return false;
+}
+
 __attribute__((used)) static void
 hw_set_debug_mode(struct dpu_rank_t *rank, uint8_t mode)
 {
     hw_dpu_rank_allocation_parameters_t params = _this_params(rank->description);
     int ret;
 
+    /* The queued commits must reach the rank before the mode changes */
+    if (_this(rank)->use_ring && (ret = dpu_rank_ring_flush(&_this(rank)->ring)) != 0)
+        LOG_RANK(WARNING, rank, "Failed to flush the ring (%s)", strerror(-ret));
+
     ret = ioctl(params->rank_fs.fd_rank, DPU_RANK_IOCTL_DEBUG_MODE, mode);
     if (ret)
         LOG_RANK(WARNING, rank, "Failed to change debug mode (%s)", strerror(errno));
@@ -450,7 +570,7 @@ hw_allocate(struct dpu_rank_t *rank, dpu_description_t description)
      * TODO: Maybe user wants to have a specific dpu_chip_id passed as argument,
      * so we could enforce the allocation for this specific id.
      */
-    ret = dpu_sysfs_get_available_rank(params->rank_fs.rank_path, &params->rank_fs);
+    ret = dpu_sysfs_get_available_rank(params->rank_fs.rank_path, params->rank_numa_node, &params->rank_fs);
     if (ret) {
         LOG_RANK(WARNING,
             rank,
@@ -468,6 +588,8 @@ hw_allocate(struct dpu_rank_t *rank, dpu_description_t description)
     }
 
     rank->_internals = rank_context;
+    rank_context->registered_transfer_matrices = NULL;
+    rank_context->use_ring = false;
 
     params->dpu_chip_id = dpu_sysfs_get_dpu_chip_id(&params->rank_fs);
 
@@ -478,6 +600,7 @@ hw_allocate(struct dpu_rank_t *rank, dpu_description_t description)
     }
 
     rank->description = description;
+    rank->numa_node = dpu_sysfs_get_numa_node(&params->rank_fs);
 
     // TODO: When driver safe mode is fully implemented, this must be set at false in this case.
     rank->description->configuration.api_must_switch_mram_mux = true;
@@ -492,6 +615,22 @@ hw_allocate(struct dpu_rank_t *rank, dpu_description_t description)
             goto free_rank_context;
         }
 
+        if (params->safe_ring) {
+            ret = dpu_rank_ring_init(&rank_context->ring,
+                &dpu_rank_ring_fd_device,
+                &params->rank_fs.fd_rank,
+                NB_RING_ENTRIES,
+                params->safe_ring_flags);
+            /* In auto mode, a driver without rings rejects the setup: ENOTTY for an unknown ioctl, EINVAL when it refuses
+             * the parameters.
+             */
+            if (ret == 0)
+                rank_context->use_ring = true;
+            else if (!params->safe_ring_requested && (ret == -ENOTTY || ret == -EINVAL))
+                LOG_RANK(DEBUG, rank, "No rings (%s), using one ioctl per operation", strerror(-ret));
+            else
+                LOG_RANK(WARNING, rank, "Failed to set the rings up (%s), using one ioctl per operation", strerror(-ret));
+        }
     } else if (params->mode == DPU_REGION_MODE_PERF || params->mode == DPU_REGION_MODE_HYBRID) {
         /* 4/ Retrieve interleaving infos */
         if (!fill_dpu_region_interleaving_values(description)) {
@@ -508,6 +647,12 @@ hw_allocate(struct dpu_rank_t *rank, dpu_description_t description)
             goto free_rank_context;
         }
 
+        params->translate.nb_xfer_threads = params->nb_xfer_threads;
+        params->translate.xfer_cpus = params->xfer_cpus;
+        params->translate.xfer_numa_node = get_xfer_numa_node(rank, params->xfer_numa_node);
+        params->translate.host_buffers = NULL;
+        params->translate.nb_host_buffers = 0;
+
         // TODO implement init/destroy_rank
         // params->translate.init_rank(&params->translate, params->channel_id, params->rank_id);
         if (params->translate.init_region) {
@@ -612,6 +757,8 @@ free_ptr_region:
         if (params->mode == DPU_REGION_MODE_PERF)
             munmap(params->ptr_region, params->region_size);
 free_ci:
+    if (rank_context->use_ring)
+        dpu_rank_ring_destroy(&rank_context->ring);
     if (params->mode == DPU_REGION_MODE_SAFE
         || (params->mode == DPU_REGION_MODE_HYBRID && (params->translate.capabilities & CAP_HYBRID_CONTROL_INTERFACE) == 0))
         free(rank_context->control_interfaces);
@@ -648,6 +795,16 @@ hw_free(struct dpu_rank_t *rank)
     } else
         free(rank_context->control_interfaces);
 
+    if (rank_context->use_ring)
+        dpu_rank_ring_destroy(&rank_context->ring);
+
+    while (rank_context->registered_transfer_matrices != NULL) {
+        hw_unregister_transfer_matrix(rank, rank_context->registered_transfer_matrices->transfer_matrix);
+    }
+
+    if (is_transfer_translated(params))
+        free(params->translate.host_buffers);
+
     if (params->mode == DPU_REGION_MODE_PERF || params->mode == DPU_REGION_MODE_HYBRID) {
         if (params->interleave.nb_real_ci != rank->description->topology.nr_of_control_interfaces) {
             free(rank_context->real_buffer_control_interfaces);
@@ -741,6 +898,17 @@ hw_commit_commands(struct dpu_rank_t *rank, dpu_rank_buffer_t buffer)
             }
             /* fall through */
         case DPU_REGION_MODE_SAFE:
+            if (rank_context->use_ring) {
+                /* Submitted with the next update, which the UFI layer always issues after a commit */
+                ret = dpu_rank_ring_commit_commands(
+                    &rank_context->ring, ptr_buffer, rank->description->topology.nr_of_control_interfaces);
+                if (ret) {
+                    LOG_RANK(WARNING, rank, "%s", strerror(-ret));
+                    return DPU_RANK_SYSTEM_ERROR;
+                }
+                break;
+            }
+
             ret = ioctl(params->rank_fs.fd_rank, DPU_RANK_IOCTL_COMMIT_COMMANDS, ptr_buffer);
             if (ret) {
                 LOG_RANK(WARNING, rank, "%s", strerror(errno));
@@ -789,6 +957,15 @@ hw_update_commands(struct dpu_rank_t *rank, dpu_rank_buffer_t buffer)
             }
             /* fall through */
         case DPU_REGION_MODE_SAFE:
+            if (rank_context->use_ring) {
+                ret = dpu_rank_ring_run(&rank_context->ring, DPU_RANK_RING_OP_UPDATE_COMMANDS, ptr_buffer);
+                if (ret) {
+                    LOG_RANK(WARNING, rank, "%s", strerror(-ret));
+                    return DPU_RANK_SYSTEM_ERROR;
+                }
+                break;
+            }
+
             ret = ioctl(params->rank_fs.fd_rank, DPU_RANK_IOCTL_UPDATE_COMMANDS, ptr_buffer);
             if (ret) {
                 LOG_RANK(WARNING, rank, "%s", strerror(errno));
@@ -817,14 +994,34 @@ hw_update_commands(struct dpu_rank_t *rank, dpu_rank_buffer_t buffer)
     return DPU_RANK_SUCCESS;
 }
 
-static struct dpu_transfer_mram *
-expand_transfer_matrix(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
+/* MRAM transfers go through the address translation backend, instead of the driver */
+static bool
+is_transfer_translated(hw_dpu_rank_allocation_parameters_t params)
+{
+    return params->mode == DPU_REGION_MODE_PERF
+        || (params->mode == DPU_REGION_MODE_HYBRID && (params->translate.capabilities & CAP_HYBRID_CONTROL_INTERFACE) == 0);
+}
+
+static bool
+must_expand_transfer_matrix(struct dpu_rank_t *rank)
+{
+    hw_dpu_rank_allocation_parameters_t params = _this_params(rank->description);
+
+    if (is_transfer_translated(params))
+        return params->interleave.nb_real_ci != rank->description->topology.nr_of_control_interfaces;
+
+    return false;
+}
+
+static void
+expand_transfer_matrix_into(struct dpu_rank_t *rank,
+    struct dpu_transfer_mram *transfer_matrix,
+    struct dpu_transfer_mram *real_transfer_matrix)
 {
-    hw_dpu_rank_context_t rank_context = _this(rank);
     hw_dpu_rank_allocation_parameters_t params = _this_params(rank->description);
     int xfer_idx, real_xfer_idx;
 
-    memset(rank_context->real_transfer_matrix,
+    memset(real_transfer_matrix,
         0,
         params->interleave.nb_real_ci * rank->description->topology.nr_of_dpus_per_control_interface
             * sizeof(struct dpu_transfer_mram));
@@ -838,16 +1035,117 @@ expand_transfer_matrix(struct dpu_rank_t *rank, struct dpu_transfer_mram *transf
 
             real_xfer_idx = get_real_transfer_matrix_index(rank, get_real_slice_id(rank, slice_id), dpu_id);
 
-            rank_context->real_transfer_matrix[real_xfer_idx].mram_number = transfer_matrix[xfer_idx].mram_number;
-            rank_context->real_transfer_matrix[real_xfer_idx].size = transfer_matrix[xfer_idx].size;
-            rank_context->real_transfer_matrix[real_xfer_idx].offset_in_mram = transfer_matrix[xfer_idx].offset_in_mram;
-            rank_context->real_transfer_matrix[real_xfer_idx].ptr = transfer_matrix[xfer_idx].ptr;
+            real_transfer_matrix[real_xfer_idx].mram_number = transfer_matrix[xfer_idx].mram_number;
+            real_transfer_matrix[real_xfer_idx].size = transfer_matrix[xfer_idx].size;
+            real_transfer_matrix[real_xfer_idx].offset_in_mram = transfer_matrix[xfer_idx].offset_in_mram;
+            real_transfer_matrix[real_xfer_idx].ptr = transfer_matrix[xfer_idx].ptr;
         }
     }
+}
+
+static struct dpu_transfer_mram *
+expand_transfer_matrix(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
+{
+    hw_dpu_rank_context_t rank_context = _this(rank);
+
+    /* Registered matrices are not modified until they are unregistered: their expansion is done once */
+    for (struct hw_registered_transfer_matrix *registered = rank_context->registered_transfer_matrices; registered != NULL;
+         registered = registered->next) {
+        if (registered->transfer_matrix == transfer_matrix)
+            return registered->real_transfer_matrix;
+    }
+
+    expand_transfer_matrix_into(rank, transfer_matrix, rank_context->real_transfer_matrix);
 
     return rank_context->real_transfer_matrix;
 }
 
+static dpu_rank_status_e
+hw_register_transfer_matrix(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
+{
+    hw_dpu_rank_context_t rank_context = _this(rank);
+    hw_dpu_rank_allocation_parameters_t params = _this_params(rank->description);
+    struct hw_registered_transfer_matrix *registered;
+
+    if (!must_expand_transfer_matrix(rank))
+        return DPU_RANK_SUCCESS;
+
+    if ((registered = malloc(sizeof(*registered))) == NULL)
+        return DPU_RANK_SYSTEM_ERROR;
+
+    registered->real_transfer_matrix = malloc(params->interleave.nb_real_ci
+        * rank->description->topology.nr_of_dpus_per_control_interface * sizeof(struct dpu_transfer_mram));
+    if (!registered->real_transfer_matrix) {
+        free(registered);
+        return DPU_RANK_SYSTEM_ERROR;
+    }
+
+    expand_transfer_matrix_into(rank, transfer_matrix, registered->real_transfer_matrix);
+    registered->transfer_matrix = transfer_matrix;
+    registered->next = rank_context->registered_transfer_matrices;
+    rank_context->registered_transfer_matrices = registered;
+
+    return DPU_RANK_SUCCESS;
+}
+
+static void
+hw_unregister_transfer_matrix(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
+{
+    hw_dpu_rank_context_t rank_context = _this(rank);
+    struct hw_registered_transfer_matrix **registered = &rank_context->registered_transfer_matrices;
+
+    for (; *registered != NULL; registered = &(*registered)->next) {
+        if ((*registered)->transfer_matrix == transfer_matrix) {
+            struct hw_registered_transfer_matrix *unregistered = *registered;
+
+            *registered = unregistered->next;
+            free(unregistered->real_transfer_matrix);
+            free(unregistered);
+            return;
+        }
+    }
+}
+
+static dpu_rank_status_e
+hw_register_host_buffer(struct dpu_rank_t *rank, void *buffer, size_t size)
+{
+    hw_dpu_rank_allocation_parameters_t params = _this_params(rank->description);
+    struct dpu_region_host_buffer *host_buffers;
+
+    /* The driver does not use the hint */
+    if (!is_transfer_translated(params))
+        return DPU_RANK_SUCCESS;
+
+    host_buffers = realloc(params->translate.host_buffers, (params->translate.nb_host_buffers + 1) * sizeof(*host_buffers));
+    if (!host_buffers)
+        return DPU_RANK_SYSTEM_ERROR;
+
+    host_buffers[params->translate.nb_host_buffers].ptr = buffer;
+    host_buffers[params->translate.nb_host_buffers].size = size;
+    params->translate.host_buffers = host_buffers;
+    params->translate.nb_host_buffers++;
+
+    return DPU_RANK_SUCCESS;
+}
+
+static void
+hw_unregister_host_buffer(struct dpu_rank_t *rank, void *buffer)
+{
+    hw_dpu_rank_allocation_parameters_t params = _this_params(rank->description);
+    uint32_t i;
+
+    if (!is_transfer_translated(params))
+        return;
+
+    for (i = 0; i < params->translate.nb_host_buffers; ++i) {
+        if (params->translate.host_buffers[i].ptr == buffer) {
+            params->translate.host_buffers[i] = params->translate.host_buffers[params->translate.nb_host_buffers - 1];
+            params->translate.nb_host_buffers--;
+            return;
+        }
+    }
+}
+
 static dpu_rank_status_e
 hw_copy_to_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matrix)
 {
@@ -855,11 +1153,8 @@ hw_copy_to_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matr
     struct dpu_transfer_mram *ptr_transfer_matrix = transfer_matrix;
     int ret;
 
-    if (params->mode == DPU_REGION_MODE_PERF
-        || (params->mode == DPU_REGION_MODE_HYBRID && (params->translate.capabilities & CAP_HYBRID_CONTROL_INTERFACE) == 0)) {
-        if (params->interleave.nb_real_ci != rank->description->topology.nr_of_control_interfaces)
-            ptr_transfer_matrix = expand_transfer_matrix(rank, transfer_matrix);
-    }
+    if (must_expand_transfer_matrix(rank))
+        ptr_transfer_matrix = expand_transfer_matrix(rank, transfer_matrix);
 
     switch (params->mode) {
         case DPU_REGION_MODE_PERF:
@@ -876,6 +1171,15 @@ hw_copy_to_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_matr
             }
             /* fall through */
         case DPU_REGION_MODE_SAFE:
+            if (_this(rank)->use_ring) {
+                ret = dpu_rank_ring_run(&_this(rank)->ring, DPU_RANK_RING_OP_WRITE_TO_RANK, ptr_transfer_matrix);
+                if (ret) {
+                    LOG_RANK(WARNING, rank, "%s", strerror(-ret));
+                    return DPU_RANK_SYSTEM_ERROR;
+                }
+                break;
+            }
+
             ret = ioctl(params->rank_fs.fd_rank, DPU_RANK_IOCTL_WRITE_TO_RANK, ptr_transfer_matrix);
             if (ret) {
                 LOG_RANK(WARNING, rank, "%s", strerror(errno));
@@ -897,11 +1201,8 @@ hw_copy_from_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_ma
     struct dpu_transfer_mram *ptr_transfer_matrix = transfer_matrix;
     int ret;
 
-    if (params->mode == DPU_REGION_MODE_PERF
-        || (params->mode == DPU_REGION_MODE_HYBRID && (params->translate.capabilities & CAP_HYBRID_CONTROL_INTERFACE) == 0)) {
-        if (params->interleave.nb_real_ci != rank->description->topology.nr_of_control_interfaces)
-            ptr_transfer_matrix = expand_transfer_matrix(rank, transfer_matrix);
-    }
+    if (must_expand_transfer_matrix(rank))
+        ptr_transfer_matrix = expand_transfer_matrix(rank, transfer_matrix);
 
     switch (params->mode) {
         case DPU_REGION_MODE_PERF:
@@ -918,6 +1219,15 @@ hw_copy_from_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_ma
             }
             /* fall through */
         case DPU_REGION_MODE_SAFE:
+            if (_this(rank)->use_ring) {
+                ret = dpu_rank_ring_run(&_this(rank)->ring, DPU_RANK_RING_OP_READ_FROM_RANK, ptr_transfer_matrix);
+                if (ret) {
+                    LOG_RANK(WARNING, rank, "%s", strerror(-ret));
+                    return DPU_RANK_SYSTEM_ERROR;
+                }
+                break;
+            }
+
             ret = ioctl(params->rank_fs.fd_rank, DPU_RANK_IOCTL_READ_FROM_RANK, ptr_transfer_matrix);
             if (ret) {
                 LOG_RANK(WARNING, rank, "%s", strerror(errno));
@@ -932,6 +1242,102 @@ hw_copy_from_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram *transfer_ma
     return DPU_RANK_SUCCESS;
 }
 
+/* The driver and the mappings without iovec support transfer the n-th segment of every DPU at each pass */
+static dpu_rank_status_e
+copy_iovec_by_segments(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix, bool to_rank)
+{
+    uint32_t nr_dpus = rank->description->topology.nr_of_control_interfaces
+        * rank->description->topology.nr_of_dpus_per_control_interface;
+    dpu_rank_status_e status = DPU_RANK_SUCCESS;
+    struct dpu_transfer_mram *transfer_matrix;
+    uint32_t max_nb_segments = 0;
+    uint32_t i, segment;
+
+    for (i = 0; i < nr_dpus; ++i)
+        if (iovec_matrix[i].nb_segments > max_nb_segments)
+            max_nb_segments = iovec_matrix[i].nb_segments;
+
+    transfer_matrix = malloc(nr_dpus * sizeof(struct dpu_transfer_mram));
+    if (!transfer_matrix)
+        return DPU_RANK_SYSTEM_ERROR;
+
+    for (segment = 0; segment < max_nb_segments && status == DPU_RANK_SUCCESS; ++segment) {
+        /* Segments are in the primary MRAM (mram_number 0) */
+        memset(transfer_matrix, 0, nr_dpus * sizeof(struct dpu_transfer_mram));
+
+        for (i = 0; i < nr_dpus; ++i) {
+            if (segment >= iovec_matrix[i].nb_segments)
+                continue;
+
+            transfer_matrix[i].ptr = iovec_matrix[i].segments[segment].ptr;
+            transfer_matrix[i].offset_in_mram = iovec_matrix[i].segments[segment].offset_in_mram;
+            transfer_matrix[i].size = iovec_matrix[i].segments[segment].size;
+        }
+
+        status = to_rank ? hw_copy_to_rank(rank, transfer_matrix) : hw_copy_from_rank(rank, transfer_matrix);
+    }
+
+    free(transfer_matrix);
+
+    return status;
+}
+
+static struct dpu_transfer_mram_iovec *
+expand_iovec_matrix(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    hw_dpu_rank_allocation_parameters_t params = _this_params(rank->description);
+    struct dpu_transfer_mram_iovec *real_iovec_matrix;
+
+    real_iovec_matrix = calloc(
+        params->interleave.nb_real_ci * rank->description->topology.nr_of_dpus_per_control_interface, sizeof(*real_iovec_matrix));
+    if (!real_iovec_matrix)
+        return NULL;
+
+    for (dpu_id_t dpu_id = 0; dpu_id < rank->description->topology.nr_of_dpus_per_control_interface; ++dpu_id)
+        for (dpu_slice_id_t slice_id = 0; slice_id < rank->description->topology.nr_of_control_interfaces; ++slice_id)
+            real_iovec_matrix[get_real_transfer_matrix_index(rank, get_real_slice_id(rank, slice_id), dpu_id)]
+                = iovec_matrix[get_transfer_matrix_index(rank, slice_id, dpu_id)];
+
+    return real_iovec_matrix;
+}
+
+static dpu_rank_status_e
+copy_iovec(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix, bool to_rank)
+{
+    hw_dpu_rank_allocation_parameters_t params = _this_params(rank->description);
+    struct dpu_transfer_mram_iovec *ptr_iovec_matrix = iovec_matrix;
+    void (*copy)(struct dpu_region_address_translation *, void *, uint8_t, uint8_t, struct dpu_transfer_mram_iovec *)
+        = to_rank ? params->translate.write_iovec_to_rank : params->translate.read_iovec_from_rank;
+
+    if (!is_transfer_translated(params) || !copy)
+        return copy_iovec_by_segments(rank, iovec_matrix, to_rank);
+
+    if (must_expand_transfer_matrix(rank)) {
+        ptr_iovec_matrix = expand_iovec_matrix(rank, iovec_matrix);
+        if (!ptr_iovec_matrix)
+            return DPU_RANK_SYSTEM_ERROR;
+    }
+
+    copy(&params->translate, params->ptr_region, params->channel_id, params->rank_id, ptr_iovec_matrix);
+
+    if (ptr_iovec_matrix != iovec_matrix)
+        free(ptr_iovec_matrix);
+
+    return DPU_RANK_SUCCESS;
+}
+
+static dpu_rank_status_e
+hw_copy_iovec_to_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    return copy_iovec(rank, iovec_matrix, true);
+}
+
+static dpu_rank_status_e
+hw_copy_iovec_from_rank(struct dpu_rank_t *rank, struct dpu_transfer_mram_iovec *iovec_matrix)
+{
+    return copy_iovec(rank, iovec_matrix, false);
+}
+
 #define validate(p)                                                                                                              \
     do {                                                                                                                         \
         if (!(p))                                                                                                                \
@@ -945,6 +1351,10 @@ free_hw_parameters(void *description)
 
     if (params->fpga.report_path)
         free(params->fpga.report_path);
+    if (params->xfer_cpus)
+        free(params->xfer_cpus);
+    if (params->xfer_numa_node)
+        free(params->xfer_numa_node);
 
     free(params);
 }
@@ -953,9 +1363,9 @@ static dpu_rank_status_e
 hw_fill_description_from_profile(dpu_properties_t properties, dpu_description_t description)
 {
     hw_dpu_rank_allocation_parameters_t parameters;
-    uint32_t clock_division, refresh_emulation_period, fck_frequency;
+    uint32_t clock_division, refresh_emulation_period, fck_frequency, nb_xfer_threads;
     int ret;
-    char *report_path, *rank_path, *region_mode_input = NULL;
+    char *report_path, *rank_path, *rank_numa_node, *safe_ring, *region_mode_input = NULL;
     bool activate_ila = false, activate_filtering_ila = false, activate_mram_bypass = false, cycle_accurate = false;
     bool mram_access_by_dpu_only;
     uint8_t chip_id, capabilities_mode;
@@ -982,6 +1392,8 @@ hw_fill_description_from_profile(dpu_properties_t properties, dpu_description_t
 
     validate(fetch_string_property(properties, DPU_PROFILE_PROPERTY_HW_REGION_MODE, &region_mode_input, NULL));
     validate(fetch_string_property(properties, DPU_PROFILE_PROPERTY_RANK_PATH, &rank_path, NULL));
+    validate(fetch_string_property(properties, DPU_PROFILE_PROPERTY_RANK_NUMA_NODE, &rank_numa_node, NULL));
+    validate(fetch_string_property(properties, DPU_PROFILE_PROPERTY_SAFE_RING, &safe_ring, NULL));
     validate(fetch_integer_property(
         properties, DPU_PROFILE_PROPERTY_CLOCK_DIVISION, &clock_division, description->timings.clock_division));
     validate((clock_division & ~0xFF) == 0);
@@ -1008,12 +1420,23 @@ hw_fill_description_from_profile(dpu_properties_t properties, dpu_description_t
 
     validate(fetch_boolean_property(properties, DPU_PROFILE_PROPERTY_MODULE_COMPAT, &bypass_module_compatibility, false));
 
+    validate(fetch_integer_property(properties, DPU_PROFILE_PROPERTY_XFER_THREADS, &nb_xfer_threads, 0));
+    validate((nb_xfer_threads & ~0xFF) == 0);
+    validate(fetch_string_property(properties, DPU_PROFILE_PROPERTY_XFER_CPUS, &parameters->xfer_cpus, NULL));
+    validate(fetch_string_property(properties, DPU_PROFILE_PROPERTY_XFER_NUMA_NODE, &parameters->xfer_numa_node, "local"));
+
     memset(&parameters->rank_fs, 0, sizeof(struct dpu_rank_fs));
     if (rank_path) {
         strcpy(parameters->rank_fs.rank_path, rank_path);
         free(rank_path);
     }
 
+    parameters->rank_numa_node = get_rank_numa_node(rank_numa_node);
+    free(rank_numa_node);
+
+    parameters->safe_ring = get_safe_ring(safe_ring, &parameters->safe_ring_flags, &parameters->safe_ring_requested);
+    free(safe_ring);
+
     if (region_mode_input) {
         if (!strcmp(region_mode_input, "safe"))
             parameters->mode = (uint8_t)DPU_REGION_MODE_SAFE;
@@ -1046,6 +1469,7 @@ hw_fill_description_from_profile(dpu_properties_t properties, dpu_description_t
     parameters->fpga.report_path = report_path;
 
     parameters->bypass_module_compatibility = bypass_module_compatibility;
+    parameters->nb_xfer_threads = (uint8_t)nb_xfer_threads;
 
     description->configuration.enable_cycle_accurate_behavior = cycle_accurate;
     description->timings.clock_division = clock_division;
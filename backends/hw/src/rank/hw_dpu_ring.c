@@ -0,0 +1,245 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "hw_dpu_ring.h"
+
+/* Iterations spent polling the completion ring, when the driver polls the submission ring, before sleeping in the
+ * driver
+ */
+#define RING_SPIN_ITERATIONS (1 << 10)
+
+static int
+fd_ioctl(void *context, unsigned long request, void *arg)
+{
+    return ioctl(*(int *)context, request, arg);
+}
+
+static void *
+fd_mmap(void *context, size_t size, off_t offset)
+{
+    return mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, *(int *)context, offset);
+}
+
+static void
+fd_munmap(__attribute__((unused)) void *context, void *addr, size_t size)
+{
+    munmap(addr, size);
+}
+
+const struct dpu_rank_ring_device dpu_rank_ring_fd_device = {
+    .ioctl = fd_ioctl,
+    .mmap = fd_mmap,
+    .munmap = fd_munmap,
+};
+
+int
+dpu_rank_ring_init(struct dpu_rank_ring *ring,
+    const struct dpu_rank_ring_device *device,
+    void *device_context,
+    uint32_t nb_entries,
+    uint32_t flags)
+{
+    struct dpu_rank_ring_params params = { .nb_entries = nb_entries, .flags = flags };
+    uint8_t *map;
+
+    memset(ring, 0, sizeof(*ring));
+    ring->device = device;
+    ring->device_context = device_context;
+
+    if (device->ioctl(device_context, DPU_RANK_IOCTL_RING_SETUP, &params) != 0)
+        return -errno;
+
+    if ((params.nb_entries == 0) || ((params.nb_entries & (params.nb_entries - 1)) != 0))
+        return -EINVAL;
+
+    map = device->mmap(device_context, params.mmap_size, DPU_RANK_RING_MMAP_OFFSET);
+    if (map == MAP_FAILED)
+        return -errno;
+
+    ring->map = map;
+    ring->map_size = params.mmap_size;
+    ring->flags = params.flags;
+    ring->nb_entries = params.nb_entries;
+    ring->mask = params.nb_entries - 1;
+
+    ring->sq_head = (uint32_t *)(map + params.sq_head);
+    ring->sq_tail = (uint32_t *)(map + params.sq_tail);
+    ring->sq_flags = (uint32_t *)(map + params.sq_flags);
+    ring->sqes = (struct dpu_rank_ring_sqe *)(map + params.sqes);
+    ring->cq_head = (uint32_t *)(map + params.cq_head);
+    ring->cq_tail = (uint32_t *)(map + params.cq_tail);
+    ring->cqes = (struct dpu_rank_ring_cqe *)(map + params.cqes);
+
+    return 0;
+}
+
+void
+dpu_rank_ring_destroy(struct dpu_rank_ring *ring)
+{
+    if (ring->map == NULL)
+        return;
+
+    dpu_rank_ring_flush(ring);
+
+    /* The driver frees the rings with the file of the rank */
+    ring->device->munmap(ring->device_context, ring->map, ring->map_size);
+    ring->map = NULL;
+}
+
+static int
+enter(struct dpu_rank_ring *ring, uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+{
+    struct dpu_rank_ring_enter enter = { .to_submit = to_submit, .min_complete = min_complete, .flags = flags };
+
+    if (ring->device->ioctl(ring->device_context, DPU_RANK_IOCTL_RING_ENTER, &enter) != 0)
+        return -errno;
+
+    return 0;
+}
+
+static inline bool
+sq_poller_needs_wakeup(struct dpu_rank_ring *ring)
+{
+    /* Orders the store of the tail with the load of the flags, which the poller sets before checking the tail a last
+     * time
+     */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return (__atomic_load_n(ring->sq_flags, __ATOMIC_RELAXED) & DPU_RANK_RING_SQ_NEED_WAKEUP) != 0;
+}
+
+/* Makes the entry at the tail visible to the driver. When the driver polls the ring, it is submitted at once. */
+static int
+publish_entry(struct dpu_rank_ring *ring)
+{
+    __atomic_store_n(ring->sq_tail, *ring->sq_tail + 1, __ATOMIC_RELEASE);
+
+    if ((ring->flags & DPU_RANK_RING_SETUP_SQPOLL) == 0) {
+        ring->nb_unsubmitted++;
+        return 0;
+    }
+
+    ring->nb_in_flight++;
+    if (sq_poller_needs_wakeup(ring))
+        return enter(ring, 0, 0, DPU_RANK_RING_ENTER_SQ_WAKEUP);
+
+    return 0;
+}
+
+static inline uint32_t
+get_nb_completions(struct dpu_rank_ring *ring)
+{
+    return __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE) - *ring->cq_head;
+}
+
+/* Submits the entries written since the last submission, and waits for the completion of all the entries in flight */
+static int
+submit_and_wait(struct dpu_rank_ring *ring)
+{
+    uint32_t nb_expected = ring->nb_unsubmitted + ring->nb_in_flight;
+    uint32_t head, tail;
+    int ret, first_error = 0;
+
+    if ((ring->flags & DPU_RANK_RING_SETUP_SQPOLL) == 0) {
+        /* On error, the driver did not take the entries: they are submitted again by the next call */
+        if ((ret = enter(ring, ring->nb_unsubmitted, nb_expected, 0)) != 0)
+            return ret;
+
+        ring->nb_in_flight += ring->nb_unsubmitted;
+        ring->nb_unsubmitted = 0;
+    } else {
+        uint32_t nb_spins = RING_SPIN_ITERATIONS;
+
+        while ((get_nb_completions(ring) < nb_expected) && (nb_spins-- != 0))
+            ;
+
+        if (get_nb_completions(ring) < nb_expected) {
+            ret = enter(ring, 0, nb_expected, sq_poller_needs_wakeup(ring) ? DPU_RANK_RING_ENTER_SQ_WAKEUP : 0);
+            if (ret != 0)
+                return ret;
+        }
+    }
+
+    head = *ring->cq_head;
+    tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        struct dpu_rank_ring_cqe *cqe = &ring->cqes[head & ring->mask];
+
+        if ((cqe->res < 0) && (first_error == 0))
+            first_error = cqe->res;
+        ring->nb_in_flight--;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+    return first_error;
+}
+
+/* Returns the free entry at the tail, after waiting for the queued entries when the ring is full */
+static struct dpu_rank_ring_sqe *
+get_free_entry(struct dpu_rank_ring *ring, int *ret)
+{
+    struct dpu_rank_ring_sqe *sqe;
+
+    *ret = 0;
+    if (ring->nb_unsubmitted + ring->nb_in_flight == ring->nb_entries) {
+        if ((*ret = submit_and_wait(ring)) != 0)
+            return NULL;
+    }
+
+    sqe = &ring->sqes[*ring->sq_tail & ring->mask];
+    memset(sqe, 0, sizeof(*sqe));
+
+    return sqe;
+}
+
+int
+dpu_rank_ring_commit_commands(struct dpu_rank_ring *ring, const uint64_t *commands, uint8_t nb_cis)
+{
+    struct dpu_rank_ring_sqe *sqe;
+    int ret;
+
+    if (nb_cis > DPU_RANK_RING_MAX_CIS)
+        return -EINVAL;
+
+    if ((sqe = get_free_entry(ring, &ret)) == NULL)
+        return ret;
+
+    sqe->opcode = DPU_RANK_RING_OP_COMMIT_COMMANDS;
+    sqe->nb_cis = nb_cis;
+    memcpy(sqe->commands, commands, nb_cis * sizeof(uint64_t));
+
+    return publish_entry(ring);
+}
+
+int
+dpu_rank_ring_run(struct dpu_rank_ring *ring, uint8_t opcode, void *addr)
+{
+    struct dpu_rank_ring_sqe *sqe;
+    int ret;
+
+    if ((sqe = get_free_entry(ring, &ret)) == NULL)
+        return ret;
+
+    sqe->opcode = opcode;
+    sqe->addr = (uint64_t)(uintptr_t)addr;
+
+    if ((ret = publish_entry(ring)) != 0)
+        return ret;
+
+    return submit_and_wait(ring);
+}
+
+int
+dpu_rank_ring_flush(struct dpu_rank_ring *ring)
+{
+    if (ring->nb_unsubmitted + ring->nb_in_flight == 0)
+        return 0;
+
+    return submit_and_wait(ring);
+}
@@ -0,0 +1,74 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef HW_DPU_RING_H
+#define HW_DPU_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/types.h>
+
+#include "dpu_rank_ioctl.h"
+
+/* Device operations used by the rings: the rank device, or the mock device */
+struct dpu_rank_ring_device {
+    /* Returns 0, or -1 with errno set */
+    int (*ioctl)(void *context, unsigned long request, void *arg);
+    /* Returns MAP_FAILED with errno set on error */
+    void *(*mmap)(void *context, size_t size, off_t offset);
+    void (*munmap)(void *context, void *addr, size_t size);
+};
+
+/* The context of this device is a pointer to the file descriptor of the rank */
+extern const struct dpu_rank_ring_device dpu_rank_ring_fd_device;
+
+struct dpu_rank_ring {
+    const struct dpu_rank_ring_device *device;
+    void *device_context;
+
+    void *map;
+    size_t map_size;
+    uint32_t flags;
+    uint32_t nb_entries;
+    uint32_t mask;
+
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_flags;
+    struct dpu_rank_ring_sqe *sqes;
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    struct dpu_rank_ring_cqe *cqes;
+
+    /* Entries written but not yet submitted (no RING_ENTER yet), and entries submitted but not yet completed */
+    uint32_t nb_unsubmitted;
+    uint32_t nb_in_flight;
+};
+
+/* Returns 0, or -errno: -ENOTTY when the driver has no rings */
+int
+dpu_rank_ring_init(struct dpu_rank_ring *ring,
+    const struct dpu_rank_ring_device *device,
+    void *device_context,
+    uint32_t nb_entries,
+    uint32_t flags);
+/* Waits for the operations in flight */
+void
+dpu_rank_ring_destroy(struct dpu_rank_ring *ring);
+
+/* Queues the commit of the commands: it is submitted with the next operation waiting for its completion, or as soon
+ * as it is written when the driver polls the ring. Errors are reported by that operation.
+ */
+int
+dpu_rank_ring_commit_commands(struct dpu_rank_ring *ring, const uint64_t *commands, uint8_t nb_cis);
+/* Submits the queued operations and this one, then waits for all of them. Returns the first error (-errno). */
+int
+dpu_rank_ring_run(struct dpu_rank_ring *ring, uint8_t opcode, void *addr);
+/* Same as dpu_rank_ring_run, for the queued operations only */
+int
+dpu_rank_ring_flush(struct dpu_rank_ring *ring);
+
+#endif /* HW_DPU_RING_H */
@@ -0,0 +1,367 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "dpu_region_address_translation.h"
+#include "hw_dpu_ring_mock.h"
+
+/* Offsets of the indexes in the mapping: one cache line each, like the driver */
+#define MOCK_SQ_HEAD_OFFSET 0
+#define MOCK_SQ_TAIL_OFFSET 64
+#define MOCK_SQ_FLAGS_OFFSET 128
+#define MOCK_CQ_HEAD_OFFSET 192
+#define MOCK_CQ_TAIL_OFFSET 256
+#define MOCK_SQES_OFFSET 320
+
+/* Iterations the polling thread spins on an empty ring before sleeping */
+#define MOCK_SQPOLL_IDLE_ITERATIONS (1 << 12)
+
+struct dpu_rank_ring_mock {
+    uint8_t nb_cis;
+    uint8_t nb_dpus_per_ci;
+    uint32_t mram_size;
+    uint8_t *mrams;
+    uint64_t results[DPU_RANK_RING_MAX_CIS];
+    uint64_t nb_ioctls;
+
+    bool sqpoll;
+    bool ring_is_setup;
+    uint8_t *map;
+    size_t map_size;
+    uint32_t nb_entries;
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_flags;
+    struct dpu_rank_ring_sqe *sqes;
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    struct dpu_rank_ring_cqe *cqes;
+
+    /* Polling thread: the submitter wakes it up through submitted, it signals completions through completed */
+    pthread_t poller;
+    pthread_mutex_t lock;
+    pthread_cond_t submitted;
+    pthread_cond_t completed;
+    bool poller_shall_exit;
+};
+
+static void
+enter_driver(struct dpu_rank_ring_mock *mock)
+{
+    /* Stands for the cost of the system call of the real ioctl */
+    syscall(SYS_getppid);
+    __atomic_add_fetch(&mock->nb_ioctls, 1, __ATOMIC_RELAXED);
+}
+
+static int
+transfer(struct dpu_rank_ring_mock *mock, struct dpu_transfer_mram *transfer_matrix, bool to_rank)
+{
+    uint32_t nb_dpus = mock->nb_cis * mock->nb_dpus_per_ci;
+
+    for (uint32_t each_dpu = 0; each_dpu < nb_dpus; ++each_dpu) {
+        struct dpu_transfer_mram *xfer = &transfer_matrix[each_dpu];
+        uint8_t *mram = mock->mrams + (size_t)each_dpu * mock->mram_size;
+
+        if (xfer->ptr == NULL || xfer->size == 0)
+            continue;
+        if ((uint64_t)xfer->offset_in_mram + xfer->size > mock->mram_size)
+            return -EINVAL;
+
+        if (to_rank)
+            memcpy(mram + xfer->offset_in_mram, xfer->ptr, xfer->size);
+        else
+            memcpy(xfer->ptr, mram + xfer->offset_in_mram, xfer->size);
+    }
+
+    return 0;
+}
+
+/* The control interfaces loop the committed commands back to their results */
+static int
+execute(struct dpu_rank_ring_mock *mock, uint8_t opcode, void *addr, const uint64_t *commands, uint8_t nb_cis)
+{
+    switch (opcode) {
+        case DPU_RANK_RING_OP_COMMIT_COMMANDS:
+            if (nb_cis != mock->nb_cis)
+                return -EINVAL;
+            memcpy(mock->results, commands, nb_cis * sizeof(uint64_t));
+            return 0;
+        case DPU_RANK_RING_OP_UPDATE_COMMANDS:
+            memcpy(addr, mock->results, mock->nb_cis * sizeof(uint64_t));
+            return 0;
+        case DPU_RANK_RING_OP_WRITE_TO_RANK:
+            return transfer(mock, addr, true);
+        case DPU_RANK_RING_OP_READ_FROM_RANK:
+            return transfer(mock, addr, false);
+        default:
+            return -EINVAL;
+    }
+}
+
+/* Executes the entries up to the tail, returns the number of entries consumed */
+static uint32_t
+consume_sq(struct dpu_rank_ring_mock *mock, uint32_t max_entries)
+{
+    uint32_t head = *mock->sq_head;
+    uint32_t tail = __atomic_load_n(mock->sq_tail, __ATOMIC_ACQUIRE);
+    uint32_t cq_tail = *mock->cq_tail;
+    uint32_t mask = mock->nb_entries - 1;
+    uint32_t nb_consumed = 0;
+
+    for (; head != tail && nb_consumed < max_entries; ++head, ++cq_tail, ++nb_consumed) {
+        struct dpu_rank_ring_sqe *sqe = &mock->sqes[head & mask];
+        struct dpu_rank_ring_cqe *cqe = &mock->cqes[cq_tail & mask];
+
+        cqe->user_data = sqe->user_data;
+        cqe->res = execute(mock, sqe->opcode, (void *)(uintptr_t)sqe->addr, sqe->commands, sqe->nb_cis);
+    }
+
+    __atomic_store_n(mock->sq_head, head, __ATOMIC_RELEASE);
+    __atomic_store_n(mock->cq_tail, cq_tail, __ATOMIC_RELEASE);
+
+    return nb_consumed;
+}
+
+static uint32_t
+get_nb_completions(struct dpu_rank_ring_mock *mock)
+{
+    return __atomic_load_n(mock->cq_tail, __ATOMIC_ACQUIRE) - __atomic_load_n(mock->cq_head, __ATOMIC_ACQUIRE);
+}
+
+static void *
+sqpoll_thread(void *arg)
+{
+    struct dpu_rank_ring_mock *mock = arg;
+    uint32_t nb_idle = 0;
+
+    while (true) {
+        if (consume_sq(mock, UINT32_MAX) != 0) {
+            nb_idle = 0;
+            pthread_mutex_lock(&mock->lock);
+            pthread_cond_broadcast(&mock->completed);
+            pthread_mutex_unlock(&mock->lock);
+            continue;
+        }
+
+        if (__atomic_load_n(&mock->poller_shall_exit, __ATOMIC_ACQUIRE))
+            break;
+
+        if (++nb_idle < MOCK_SQPOLL_IDLE_ITERATIONS)
+            continue;
+
+        /* Same protocol as the kernel thread: flag, then look at the tail a last time before sleeping */
+        pthread_mutex_lock(&mock->lock);
+        __atomic_or_fetch(mock->sq_flags, DPU_RANK_RING_SQ_NEED_WAKEUP, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(mock->sq_tail, __ATOMIC_SEQ_CST) == *mock->sq_head
+            && !__atomic_load_n(&mock->poller_shall_exit, __ATOMIC_ACQUIRE))
+            pthread_cond_wait(&mock->submitted, &mock->lock);
+        __atomic_and_fetch(mock->sq_flags, ~DPU_RANK_RING_SQ_NEED_WAKEUP, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&mock->lock);
+        nb_idle = 0;
+    }
+
+    return NULL;
+}
+
+static int
+ring_setup(struct dpu_rank_ring_mock *mock, struct dpu_rank_ring_params *params)
+{
+    uint32_t nb_entries = params->nb_entries;
+
+    if (mock->ring_is_setup)
+        return -EBUSY;
+    if (nb_entries == 0 || (nb_entries & (nb_entries - 1)) != 0)
+        return -EINVAL;
+
+    memset(params, 0, sizeof(*params));
+    params->nb_entries = nb_entries;
+    params->flags = mock->sqpoll ? DPU_RANK_RING_SETUP_SQPOLL : 0;
+    params->sq_head = MOCK_SQ_HEAD_OFFSET;
+    params->sq_tail = MOCK_SQ_TAIL_OFFSET;
+    params->sq_flags = MOCK_SQ_FLAGS_OFFSET;
+    params->cq_head = MOCK_CQ_HEAD_OFFSET;
+    params->cq_tail = MOCK_CQ_TAIL_OFFSET;
+    params->sqes = MOCK_SQES_OFFSET;
+    params->cqes = MOCK_SQES_OFFSET + nb_entries * sizeof(struct dpu_rank_ring_sqe);
+    params->mmap_size = params->cqes + nb_entries * sizeof(struct dpu_rank_ring_cqe);
+
+    mock->map_size = params->mmap_size;
+    mock->map = mmap(NULL, mock->map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mock->map == MAP_FAILED)
+        return -errno;
+
+    mock->nb_entries = nb_entries;
+    mock->sq_head = (uint32_t *)(mock->map + params->sq_head);
+    mock->sq_tail = (uint32_t *)(mock->map + params->sq_tail);
+    mock->sq_flags = (uint32_t *)(mock->map + params->sq_flags);
+    mock->sqes = (struct dpu_rank_ring_sqe *)(mock->map + params->sqes);
+    mock->cq_head = (uint32_t *)(mock->map + params->cq_head);
+    mock->cq_tail = (uint32_t *)(mock->map + params->cq_tail);
+    mock->cqes = (struct dpu_rank_ring_cqe *)(mock->map + params->cqes);
+
+    if (mock->sqpoll && pthread_create(&mock->poller, NULL, sqpoll_thread, mock) != 0) {
+        munmap(mock->map, mock->map_size);
+        return -EAGAIN;
+    }
+
+    mock->ring_is_setup = true;
+
+    return 0;
+}
+
+static int
+ring_enter(struct dpu_rank_ring_mock *mock, struct dpu_rank_ring_enter *enter)
+{
+    if (!mock->ring_is_setup)
+        return -EINVAL;
+
+    if (!mock->sqpoll) {
+        consume_sq(mock, enter->to_submit);
+        return get_nb_completions(mock) >= enter->min_complete ? 0 : -EAGAIN;
+    }
+
+    pthread_mutex_lock(&mock->lock);
+    if (enter->flags & DPU_RANK_RING_ENTER_SQ_WAKEUP)
+        pthread_cond_signal(&mock->submitted);
+    while (get_nb_completions(mock) < enter->min_complete)
+        pthread_cond_wait(&mock->completed, &mock->lock);
+    pthread_mutex_unlock(&mock->lock);
+
+    return 0;
+}
+
+static int
+mock_ioctl(void *context, unsigned long request, void *arg)
+{
+    struct dpu_rank_ring_mock *mock = context;
+    int ret;
+
+    enter_driver(mock);
+
+    switch (request) {
+        case DPU_RANK_IOCTL_RING_SETUP:
+            ret = ring_setup(mock, arg);
+            break;
+        case DPU_RANK_IOCTL_RING_ENTER:
+            ret = ring_enter(mock, arg);
+            break;
+        case DPU_RANK_IOCTL_COMMIT_COMMANDS:
+            ret = execute(mock, DPU_RANK_RING_OP_COMMIT_COMMANDS, NULL, arg, mock->nb_cis);
+            break;
+        case DPU_RANK_IOCTL_UPDATE_COMMANDS:
+            ret = execute(mock, DPU_RANK_RING_OP_UPDATE_COMMANDS, arg, NULL, 0);
+            break;
+        case DPU_RANK_IOCTL_WRITE_TO_RANK:
+            ret = execute(mock, DPU_RANK_RING_OP_WRITE_TO_RANK, arg, NULL, 0);
+            break;
+        case DPU_RANK_IOCTL_READ_FROM_RANK:
+            ret = execute(mock, DPU_RANK_RING_OP_READ_FROM_RANK, arg, NULL, 0);
+            break;
+        default:
+            ret = -ENOTTY;
+            break;
+    }
+
+    if (ret < 0) {
+        errno = -ret;
+        return -1;
+    }
+
+    return 0;
+}
+
+static void *
+mock_mmap(void *context, size_t size, off_t offset)
+{
+    struct dpu_rank_ring_mock *mock = context;
+
+    if (!mock->ring_is_setup || offset != (off_t)DPU_RANK_RING_MMAP_OFFSET || size != mock->map_size) {
+        errno = EINVAL;
+        return MAP_FAILED;
+    }
+
+    return mock->map;
+}
+
+static void
+mock_munmap(__attribute__((unused)) void *context, __attribute__((unused)) void *addr, __attribute__((unused)) size_t size)
+{
+    /* The rings live as long as the mock, like they live as long as the file of the rank */
+}
+
+const struct dpu_rank_ring_device dpu_rank_ring_mock_device = {
+    .ioctl = mock_ioctl,
+    .mmap = mock_mmap,
+    .munmap = mock_munmap,
+};
+
+struct dpu_rank_ring_mock *
+dpu_rank_ring_mock_create(uint8_t nb_cis, uint8_t nb_dpus_per_ci, uint32_t mram_size, bool sqpoll)
+{
+    struct dpu_rank_ring_mock *mock;
+
+    if (nb_cis == 0 || nb_cis > DPU_RANK_RING_MAX_CIS)
+        return NULL;
+
+    if ((mock = calloc(1, sizeof(*mock))) == NULL)
+        return NULL;
+
+    if ((mock->mrams = calloc((size_t)nb_cis * nb_dpus_per_ci, mram_size)) == NULL) {
+        free(mock);
+        return NULL;
+    }
+
+    mock->nb_cis = nb_cis;
+    mock->nb_dpus_per_ci = nb_dpus_per_ci;
+    mock->mram_size = mram_size;
+    mock->sqpoll = sqpoll;
+    pthread_mutex_init(&mock->lock, NULL);
+    pthread_cond_init(&mock->submitted, NULL);
+    pthread_cond_init(&mock->completed, NULL);
+
+    return mock;
+}
+
+void
+dpu_rank_ring_mock_destroy(struct dpu_rank_ring_mock *mock)
+{
+    if (mock->ring_is_setup) {
+        if (mock->sqpoll) {
+            pthread_mutex_lock(&mock->lock);
+            __atomic_store_n(&mock->poller_shall_exit, true, __ATOMIC_RELEASE);
+            pthread_cond_signal(&mock->submitted);
+            pthread_mutex_unlock(&mock->lock);
+            pthread_join(mock->poller, NULL);
+        }
+        munmap(mock->map, mock->map_size);
+    }
+
+    pthread_cond_destroy(&mock->completed);
+    pthread_cond_destroy(&mock->submitted);
+    pthread_mutex_destroy(&mock->lock);
+    free(mock->mrams);
+    free(mock);
+}
+
+uint64_t
+dpu_rank_ring_mock_get_nb_ioctls(struct dpu_rank_ring_mock *mock)
+{
+    return __atomic_load_n(&mock->nb_ioctls, __ATOMIC_RELAXED);
+}
+
+uint8_t *
+dpu_rank_ring_mock_get_mram(struct dpu_rank_ring_mock *mock, uint32_t dpu_index)
+{
+    return mock->mrams + (size_t)dpu_index * mock->mram_size;
+}
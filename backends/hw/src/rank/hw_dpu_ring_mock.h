@@ -0,0 +1,33 @@
+/* Copyright 2020 UPMEM. All rights reserved.
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef HW_DPU_RING_MOCK_H
+#define HW_DPU_RING_MOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hw_dpu_ring.h"
+
+/* In-process rank device, for testing: it implements the driver side of the rings and of the SAFE mode ioctls, over
+ * a rank whose control interfaces loop the commands back to their results and whose MRAMs are host buffers. Each
+ * ioctl makes one real system call, standing for the entry into the driver.
+ */
+extern const struct dpu_rank_ring_device dpu_rank_ring_mock_device;
+
+struct dpu_rank_ring_mock;
+
+/* The mock is the context of dpu_rank_ring_mock_device. With sqpoll, a thread plays the kernel polling thread. */
+struct dpu_rank_ring_mock *
+dpu_rank_ring_mock_create(uint8_t nb_cis, uint8_t nb_dpus_per_ci, uint32_t mram_size, bool sqpoll);
+void
+dpu_rank_ring_mock_destroy(struct dpu_rank_ring_mock *mock);
+
+uint64_t
+dpu_rank_ring_mock_get_nb_ioctls(struct dpu_rank_ring_mock *mock);
+uint8_t *
+dpu_rank_ring_mock_get_mram(struct dpu_rank_ring_mock *mock, uint32_t dpu_index);
+
+#endif /* HW_DPU_RING_MOCK_H */
@@ -16,6 +16,8 @@
 #include <errno.h>
 #include <string.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <dpu_description.h>
 
 /* Header shared with driver */
@@ -120,6 +122,22 @@ uint64_t dpu_sysfs_get_capabilities(struct dpu_rank_fs *rank_fs)
     dpu_sys_get_integer_sysattr("capabilities", udev_region, uint64_t, "%" SCNx64)
 }
 
+/* The NUMA node is an attribute of the region (platform) device, not of
+ * the rank device.
+ */
+int
+dpu_sysfs_get_numa_node(struct dpu_rank_fs *rank_fs)
+{
+    const char *str;
+    int numa_node;
+
+    str = udev_device_get_sysattr_value(rank_fs->udev_region.dev, "numa_node");
+    if (str == NULL || sscanf(str, "%d", &numa_node) != 1)
+        return -1;
+
+    return numa_node;
+}
+
 int
 dpu_sysfs_set_reset_ila(struct dpu_rank_fs *rank_fs,
     uint8_t val) { dpu_sys_set_integer_sysattr("reset_ila", udev_region, val, "%hhu") }
@@ -238,9 +256,252 @@ err:
     return -EINVAL;
 }
 
+/* The dpu_rank devices are enumerated once, into this table. The allocations sweep the table from where the previous
+ * one stopped, and skip the ranks that could not be opened, so that allocating N ranks neither enumerates the devices
+ * N times nor tries to open the ranks taken by other processes N times.
+ */
+struct dpu_sysfs_rank_entry {
+    char *syspath;
+    /* Read when the sweep first reaches the rank */
+    bool described;
+    char devnode[128];
+    int numa_node;
+    /* Error of the last failed open (-errno), 0 when the rank can be tried */
+    int open_error;
+};
+
+/* We assume the topology is identical for all the ranks: it is read once, from the first rank */
+struct dpu_sysfs_hardware_description {
+    uint8_t dpu_chip_id;
+    uint8_t nb_ci;
+    uint8_t nb_dpus_per_ci;
+    uint32_t mram_size;
+    uint32_t clock_division_min;
+    uint32_t fck_frequency;
+    uint64_t capabilities;
+};
+
+static struct {
+    pthread_mutex_t mutex;
+    struct udev *udev;
+    struct dpu_sysfs_rank_entry *entries;
+    uint32_t nr_entries;
+    uint32_t next_entry;
+    bool scanned;
+    struct dpu_sysfs_hardware_description hardware;
+} rank_table = { .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+static void
+clear_rank_table(void)
+{
+    for (uint32_t each_entry = 0; each_entry < rank_table.nr_entries; ++each_entry) {
+        free(rank_table.entries[each_entry].syspath);
+    }
+    free(rank_table.entries);
+    rank_table.entries = NULL;
+    rank_table.nr_entries = 0;
+    rank_table.next_entry = 0;
+    rank_table.scanned = false;
+}
+
+static void __attribute__((destructor, used)) rank_table_destructor()
+{
+    clear_rank_table();
+    if (rank_table.udev)
+        udev_unref(rank_table.udev);
+}
+
+/* Must be called with the rank table locked */
+static int
+scan_rank_table(void)
+{
+    struct udev_list_entry *dev_rank_list_entry;
+    struct udev_enumerate *enumerate;
+    struct udev_list_entry *devices;
+    struct dpu_rank_fs rank_fs;
+    uint32_t nr_entries = 0;
+
+    clear_rank_table();
+
+    if (rank_table.udev == NULL) {
+        rank_table.udev = udev_new();
+        if (!rank_table.udev) {
+            printf("%s: can't create udev.\n", __FUNCTION__);
+            return -ENOMEM;
+        }
+    }
+
+    enumerate = udev_enumerate_new(rank_table.udev);
+    udev_enumerate_add_match_subsystem(enumerate, "dpu_rank");
+    udev_enumerate_scan_devices(enumerate);
+    devices = udev_enumerate_get_list_entry(enumerate);
+
+    udev_list_entry_foreach(dev_rank_list_entry, devices)
+    {
+        nr_entries++;
+    }
+
+    if ((nr_entries != 0) && ((rank_table.entries = calloc(nr_entries, sizeof(*rank_table.entries))) == NULL)) {
+        udev_enumerate_unref(enumerate);
+        return -ENOMEM;
+    }
+
+    udev_list_entry_foreach(dev_rank_list_entry, devices)
+    {
+        struct dpu_sysfs_rank_entry *entry = &rank_table.entries[rank_table.nr_entries];
+
+        if ((entry->syspath = strdup(udev_list_entry_get_name(dev_rank_list_entry))) != NULL)
+            rank_table.nr_entries++;
+    }
+    udev_enumerate_unref(enumerate);
+
+    if (rank_table.nr_entries != 0) {
+        rank_fs.udev.dev = udev_device_new_from_syspath(rank_table.udev, rank_table.entries[0].syspath);
+        if (rank_fs.udev.dev != NULL) {
+            rank_fs.udev_region.dev = udev_device_get_parent(rank_fs.udev.dev);
+            rank_table.hardware.dpu_chip_id = dpu_sysfs_get_dpu_chip_id(&rank_fs);
+            rank_table.hardware.nb_ci = dpu_sysfs_get_nb_ci(&rank_fs);
+            rank_table.hardware.nb_dpus_per_ci = dpu_sysfs_get_nb_dpus_per_ci(&rank_fs);
+            rank_table.hardware.mram_size = dpu_sysfs_get_mram_size(&rank_fs);
+            rank_table.hardware.clock_division_min = dpu_sysfs_get_clock_division_min(&rank_fs);
+            rank_table.hardware.fck_frequency = dpu_sysfs_get_fck_frequency(&rank_fs);
+            rank_table.hardware.capabilities = dpu_sysfs_get_capabilities(&rank_fs);
+            udev_device_unref(rank_fs.udev.dev);
+        }
+    }
+
+    rank_table.scanned = true;
+
+    return 0;
+}
+
+/* Must be called with the rank table locked */
+static int
+describe_rank_table_entry(struct dpu_sysfs_rank_entry *entry, struct udev_device *dev)
+{
+    struct dpu_rank_fs rank_fs;
+    const char *dev_rank_path;
+
+    if (entry->described)
+        return 0;
+
+    dev_rank_path = udev_device_get_devnode(dev);
+    if ((dev_rank_path == NULL) || (strlen(dev_rank_path) >= sizeof(entry->devnode)))
+        return -ENODEV;
+
+    rank_fs.udev.dev = dev;
+    /* udev_device_get_parent does not take a reference as stated in header */
+    rank_fs.udev_region.dev = udev_device_get_parent(dev);
+
+    strcpy(entry->devnode, dev_rank_path);
+    entry->numa_node = dpu_sysfs_get_numa_node(&rank_fs);
+    entry->described = true;
+
+    return 0;
+}
+
+/* Must be called with the rank table locked */
+static struct dpu_sysfs_rank_entry *
+get_rank_table_entry(const char *rank_path)
+{
+    for (uint32_t each_entry = 0; each_entry < rank_table.nr_entries; ++each_entry) {
+        struct dpu_sysfs_rank_entry *entry = &rank_table.entries[each_entry];
+
+        if (!entry->described) {
+            struct udev_device *dev = udev_device_new_from_syspath(rank_table.udev, entry->syspath);
+
+            if (dev == NULL)
+                continue;
+            describe_rank_table_entry(entry, dev);
+            udev_device_unref(dev);
+        }
+
+        if (entry->described && !strcmp(entry->devnode, rank_path))
+            return entry;
+    }
+
+    return NULL;
+}
+
+/* Must be called with the rank table locked. Returns -EAGAIN, without trying to open it, when the rank is not on the
+ * requested NUMA node.
+ */
+static int
+dpu_sysfs_allocate_rank_entry(struct dpu_sysfs_rank_entry *entry, int numa_node, struct dpu_rank_fs *rank_fs)
+{
+    int res;
+
+    if (entry->described && (numa_node >= 0) && (entry->numa_node != numa_node))
+        return -EAGAIN;
+
+    rank_fs->udev.udev = udev_new();
+    if (!rank_fs->udev.udev) {
+        printf("%s: can't create udev.\n", __FUNCTION__);
+        return -ENOMEM;
+    }
+    rank_fs->udev.enumerate = NULL;
+    rank_fs->udev.dev = udev_device_new_from_syspath(rank_fs->udev.udev, entry->syspath);
+    if (!rank_fs->udev.dev) {
+        res = -ENODEV;
+        goto free_udev;
+    }
+
+    if ((res = describe_rank_table_entry(entry, rank_fs->udev.dev)) != 0)
+        goto free_dev;
+
+    if ((numa_node >= 0) && (entry->numa_node != numa_node)) {
+        res = -EAGAIN;
+        goto free_dev;
+    }
+
+    if ((res = dpu_sysfs_try_to_allocate_rank(entry->devnode, rank_fs)) != 0)
+        goto free_dev;
+
+    strcpy(rank_fs->rank_path, entry->devnode);
+
+    return 0;
+
+free_dev:
+    udev_device_unref(rank_fs->udev.dev);
+free_udev:
+    udev_unref(rank_fs->udev.udev);
+    return res;
+}
+
+/* Must be called with the rank table locked */
+static int
+sweep_rank_table(int numa_node, struct dpu_rank_fs *rank_fs)
+{
+    uint32_t nr_entries = rank_table.nr_entries;
+
+    /* The ranks of the requested NUMA node are tried first */
+    for (int each_pass = (numa_node >= 0) ? 0 : 1; each_pass < 2; ++each_pass) {
+        for (uint32_t each_entry = 0; each_entry < nr_entries; ++each_entry) {
+            uint32_t entry_index = (rank_table.next_entry + each_entry) % nr_entries;
+            struct dpu_sysfs_rank_entry *entry = &rank_table.entries[entry_index];
+            int res;
+
+            if (entry->open_error != 0)
+                continue;
+
+            res = dpu_sysfs_allocate_rank_entry(entry, (each_pass == 0) ? numa_node : -1, rank_fs);
+            if (res == 0) {
+                rank_table.next_entry = (entry_index + 1) % nr_entries;
+                return 0;
+            }
+            if (res != -EAGAIN)
+                entry->open_error = res;
+        }
+    }
+
+    return -ENODEV;
+}
+
 void
 dpu_sysfs_free_rank_fs(struct dpu_rank_fs *rank_fs)
 {
+    struct dpu_sysfs_rank_entry *entry;
+
     if (rank_fs->fd_dax)
         close(rank_fs->fd_dax);
 
@@ -255,6 +516,12 @@ dpu_sysfs_free_rank_fs(struct dpu_rank_fs *rank_fs)
     udev_unref(rank_fs->udev.udev);
     udev_device_unref(rank_fs->udev.dev);
     udev_enumerate_unref(rank_fs->udev.enumerate);
+
+    /* The rank can be allocated again, even if another allocation found it taken meanwhile */
+    pthread_mutex_lock(&rank_table.mutex);
+    if ((entry = get_rank_table_entry(rank_fs->rank_path)) != NULL)
+        entry->open_error = 0;
+    pthread_mutex_unlock(&rank_table.mutex);
 }
 
 void
@@ -268,50 +535,49 @@ dpu_sysfs_free_rank(struct dpu_rank_fs *rank_fs)
 // from unused channels rather than allocating ranks of a same channel
 // (memory bandwidth is limited at a channel level)
 int
-dpu_sysfs_get_available_rank(const char *rank_path, struct dpu_rank_fs *rank_fs)
+dpu_sysfs_get_available_rank(const char *rank_path, int numa_node, struct dpu_rank_fs *rank_fs)
 {
-    struct udev_list_entry *dev_rank_list_entry;
-    int eacces_count = 0;
+    struct dpu_sysfs_rank_entry *entry;
+    int res;
 
-    init_udev_enumerator(rank_fs->udev.enumerate, rank_fs->udev.udev, NULL, "dpu_rank", NULL, rank_fs->udev.devices, end);
+    pthread_mutex_lock(&rank_table.mutex);
 
-    udev_list_entry_foreach(dev_rank_list_entry, rank_fs->udev.devices)
-    {
-        const char *path_rank, *dev_rank_path;
-
-        path_rank = udev_list_entry_get_name(dev_rank_list_entry);
-        rank_fs->udev.dev = udev_device_new_from_syspath(rank_fs->udev.udev, path_rank);
-        dev_rank_path = udev_device_get_devnode(rank_fs->udev.dev);
-
-        if (strlen(rank_path)) {
-            if (!strcmp(dev_rank_path, rank_path)) {
-                if (!dpu_sysfs_try_to_allocate_rank(dev_rank_path, rank_fs)) {
-                    strcpy(rank_fs->rank_path, dev_rank_path);
-                    return 0;
-                } else {
-                    printf("%s: Allocation of requested %s rank failed\n", __FUNCTION__, rank_path);
-                    udev_device_unref(rank_fs->udev.dev);
-                    break;
-                }
-            }
+    if (!rank_table.scanned && ((res = scan_rank_table()) != 0))
+        goto end;
+
+    if (strlen(rank_path)) {
+        if (((entry = get_rank_table_entry(rank_path)) == NULL)
+            || (dpu_sysfs_allocate_rank_entry(entry, -1, rank_fs) != 0)) {
+            printf("%s: Allocation of requested %s rank failed\n", __FUNCTION__, rank_path);
+            res = -ENODEV;
         } else {
-            int res = dpu_sysfs_try_to_allocate_rank(dev_rank_path, rank_fs);
-            if (!res) {
-                strcpy(rank_fs->rank_path, dev_rank_path);
-                return 0;
-            }
-            /* record whether we have found something that we cannot access */
-            if (res == -EACCES)
-                eacces_count++;
+            res = 0;
         }
+        goto end;
+    }
 
-        udev_device_unref(rank_fs->udev.dev);
+    if ((res = sweep_rank_table(numa_node, rank_fs)) == 0)
+        goto end;
+
+    /* The ranks skipped by the sweep may have been released since they were tried, and devices may have been added:
+     * enumerate them again before giving up.
+     */
+    if ((res = scan_rank_table()) != 0)
+        goto end;
+
+    if ((res = sweep_rank_table(numa_node, rank_fs)) != 0) {
+        /* record whether we have found something that we cannot access */
+        for (uint32_t each_entry = 0; each_entry < rank_table.nr_entries; ++each_entry) {
+            if (rank_table.entries[each_entry].open_error == -EACCES) {
+                res = -EACCES;
+                break;
+            }
+        }
     }
-    udev_enumerate_unref(rank_fs->udev.enumerate);
-    udev_unref(rank_fs->udev.udev);
 
 end:
-    return eacces_count ? -EACCES : -ENODEV;
+    pthread_mutex_unlock(&rank_table.mutex);
+    return res;
 }
 
 // We assume there is only one chip id per machine: so we just need to get that info
@@ -319,33 +585,19 @@ end:
 int
 dpu_sysfs_get_hardware_chip_id(uint8_t *chip_id)
 {
-    struct udev_list_entry *dev_rank_list_entry;
-    struct dpu_rank_fs rank_fs;
+    int res = 0;
 
-    init_udev_enumerator(rank_fs.udev.enumerate, rank_fs.udev.udev, NULL, "dpu_rank", NULL, rank_fs.udev.devices, end);
-
-    udev_list_entry_foreach(dev_rank_list_entry, rank_fs.udev.devices)
-    {
-        const char *path_rank;
-
-        path_rank = udev_list_entry_get_name(dev_rank_list_entry);
-        rank_fs.udev.dev = udev_device_new_from_syspath(rank_fs.udev.udev, path_rank);
-        rank_fs.udev_region.dev = udev_device_get_parent(rank_fs.udev.dev);
+    pthread_mutex_lock(&rank_table.mutex);
 
+    if (!rank_table.scanned && (scan_rank_table() != 0)) {
+        res = -1;
+    } else if (rank_table.nr_entries != 0) {
         /* Get the chip id from the driver */
-        *chip_id = dpu_sysfs_get_dpu_chip_id(&rank_fs);
-
-        udev_device_unref(rank_fs.udev.dev);
-
-        break;
+        *chip_id = rank_table.hardware.dpu_chip_id;
     }
-    udev_enumerate_unref(rank_fs.udev.enumerate);
-    udev_unref(rank_fs.udev.udev);
-
-    return 0;
 
-end:
-    return -1;
+    pthread_mutex_unlock(&rank_table.mutex);
+    return res;
 }
 
 // We assume the topology is identical for all the ranks: so we just need to get that info
@@ -353,46 +605,28 @@ end:
 int
 dpu_sysfs_get_hardware_description(dpu_description_t description, uint8_t *capabilities_mode)
 {
-    struct udev_list_entry *dev_rank_list_entry;
-    struct dpu_rank_fs rank_fs;
+    int res = 0;
 
-    init_udev_enumerator(rank_fs.udev.enumerate, rank_fs.udev.udev, NULL, "dpu_rank", NULL, rank_fs.udev.devices, end);
-
-    udev_list_entry_foreach(dev_rank_list_entry, rank_fs.udev.devices)
-    {
-        const char *path_rank;
-
-        path_rank = udev_list_entry_get_name(dev_rank_list_entry);
-        rank_fs.udev.dev = udev_device_new_from_syspath(rank_fs.udev.udev, path_rank);
-        rank_fs.udev_region.dev = udev_device_get_parent(rank_fs.udev.dev);
+    pthread_mutex_lock(&rank_table.mutex);
 
+    if (!rank_table.scanned && (scan_rank_table() != 0)) {
+        res = -1;
+    } else if (rank_table.nr_entries != 0) {
         /* Get the real topology from the driver */
-        uint8_t clock_division;
-        uint32_t fck_frequency_in_mhz;
-        description->topology.nr_of_dpus_per_control_interface = dpu_sysfs_get_nb_dpus_per_ci(&rank_fs);
-        description->topology.nr_of_control_interfaces = dpu_sysfs_get_nb_ci(&rank_fs);
-        description->memories.mram_size = dpu_sysfs_get_mram_size(&rank_fs);
-        clock_division = dpu_sysfs_get_clock_division_min(&rank_fs);
-        fck_frequency_in_mhz = dpu_sysfs_get_fck_frequency(&rank_fs);
+        description->topology.nr_of_dpus_per_control_interface = rank_table.hardware.nb_dpus_per_ci;
+        description->topology.nr_of_control_interfaces = rank_table.hardware.nb_ci;
+        description->memories.mram_size = rank_table.hardware.mram_size;
         /* Keep clock_division and fck_frequency_in_mhz default value if sysfs returns 0 */
-        if (clock_division)
-            description->timings.clock_division = clock_division;
-        if (fck_frequency_in_mhz)
-            description->configuration.fck_frequency_in_mhz = fck_frequency_in_mhz;
-
-        *capabilities_mode = dpu_sysfs_get_capabilities(&rank_fs);
+        if (rank_table.hardware.clock_division_min)
+            description->timings.clock_division = rank_table.hardware.clock_division_min;
+        if (rank_table.hardware.fck_frequency)
+            description->configuration.fck_frequency_in_mhz = rank_table.hardware.fck_frequency;
 
-        udev_device_unref(rank_fs.udev.dev);
-
-        break;
+        *capabilities_mode = rank_table.hardware.capabilities;
     }
-    udev_enumerate_unref(rank_fs.udev.enumerate);
-    udev_unref(rank_fs.udev.udev);
-
-    return 0;
 
-end:
-    return -1;
+    pthread_mutex_unlock(&rank_table.mutex);
+    return res;
 }
 
 int
@@ -24,7 +24,7 @@ struct dpu_rank_fs {
 };
 
 int
-dpu_sysfs_get_available_rank(const char *rank_path, struct dpu_rank_fs *rank_fs);
+dpu_sysfs_get_available_rank(const char *rank_path, int numa_node, struct dpu_rank_fs *rank_fs);
 void
 dpu_sysfs_free_rank(struct dpu_rank_fs *rank_fs);
 
@@ -59,6 +59,8 @@ dpu_sysfs_get_ci_mapping(struct dpu_rank_fs *rank_fs);
 uint64_t
 dpu_sysfs_get_capabilities(struct dpu_rank_fs *rank_fs);
 int
+dpu_sysfs_get_numa_node(struct dpu_rank_fs *rank_fs);
+int
 dpu_sysfs_set_reset_ila(struct dpu_rank_fs *rank_fs, uint8_t val);
 
 uint32_t
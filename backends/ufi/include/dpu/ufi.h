@@ -19,6 +19,14 @@
 #define DPU_ENABLED_GROUP 0
 #define DPU_DISABLED_GROUP 1
 
+/* With the ufiPlanner profile property, the void commands issued until ufi_end_plan are merged
+ * across the CIs, and committed before the next command returning results. ufi_abort_plan closes
+ * the plan without committing the commands still pending, after a failure.
+ */
+u32 ufi_begin_plan(struct dpu_rank_t *rank);
+u32 ufi_end_plan(struct dpu_rank_t *rank);
+void ufi_abort_plan(struct dpu_rank_t *rank);
+
 u32 ufi_byte_order(struct dpu_rank_t *rank, u8 ci_mask, u64 *results);
 u32 ufi_soft_reset(struct dpu_rank_t *rank, u8 ci_mask, u8 clock_division,
 		   u8 cycle_accurate);
@@ -27,4 +27,8 @@ u32 ci_exec_32bit_cmd(struct dpu_rank_t *rank, u64 *commands, u32 *results);
 u32 ci_exec_void_cmd(struct dpu_rank_t *rank, u64 *commands);
 u32 ci_exec_wait_mask_cmd(struct dpu_rank_t *rank, u64 *commands);
 
+u32 ci_begin_plan(struct dpu_rank_t *rank);
+u32 ci_end_plan(struct dpu_rank_t *rank);
+void ci_abort_plan(struct dpu_rank_t *rank);
+
 #endif /* __CI_H__ */
@@ -54,6 +54,21 @@ static u32 UFI_exec_8bit_frame(struct dpu_rank_t *rank, u8 ci_mask,
 static u32 UFI_exec_32bit_frame(struct dpu_rank_t *rank, u8 ci_mask,
 				u64 structure, u64 frame, u32 *results);
 
+__API_SYMBOL__ u32 ufi_begin_plan(struct dpu_rank_t *rank)
+{
+	return ci_begin_plan(rank);
+}
+
+__API_SYMBOL__ u32 ufi_end_plan(struct dpu_rank_t *rank)
+{
+	return ci_end_plan(rank);
+}
+
+__API_SYMBOL__ void ufi_abort_plan(struct dpu_rank_t *rank)
+{
+	ci_abort_plan(rank);
+}
+
 __API_SYMBOL__ u32 ufi_byte_order(struct dpu_rank_t *rank, u8 ci_mask,
 				  u64 *results)
 {
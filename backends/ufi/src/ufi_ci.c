@@ -19,6 +19,21 @@ static u8 compute_ci_mask(struct dpu_rank_t *rank, const u64 *commands);
 static u32 compute_masks(struct dpu_rank_t *rank, const u64 *commands,
 			 u64 *masks, u64 *expected, u8 *cis,
 			 bool add_select_mask, bool *is_done);
+static void set_ci_result_masks(struct dpu_rank_t *rank, bool add_select_mask,
+				u8 dpu_mask, u64 *mask, u64 *expected);
+static u32 commit_and_wait_masked_cmd(struct dpu_rank_t *rank, u64 *commands,
+				      u64 *data, const u64 *result_masks,
+				      const u64 *expected, u8 ci_mask,
+				      bool *is_done);
+static u32 commit_and_wait_cmd(struct dpu_rank_t *rank, u64 *commands,
+			       u64 *data, bool add_select_mask);
+static bool plan_is_open(struct dpu_rank_t *rank);
+static u32 plan_cmd(struct dpu_rank_t *rank, u64 *commands,
+		    bool add_select_mask);
+static u32 execute_plan(struct dpu_rank_t *rank);
+static u32 complete_cmds(struct dpu_rank_t *rank, u64 *data,
+			 dpu_ci_bitfield_t previous_faults,
+			 const struct timespec *start, u32 nr_commands);
 static u32 exec_cmd(struct dpu_rank_t *rank, u64 *commands, u64 *data,
 		    bool add_select_mask);
 static bool determine_if_byte_discoveries_are_finished(struct dpu_rank_t *rank,
@@ -87,6 +102,8 @@ __API_SYMBOL__ u32 ci_update_commands(struct dpu_rank_t *rank, u64 *commands)
 		return DPU_ERR_DRIVER;
 	}
 
+	GET_CI_CONTEXT(rank)->command_stats.nr_reads++;
+
 	ret = debug_record_last_cmd(rank, READ, commands);
 	if (ret != DPU_OK)
 		return ret;
@@ -138,6 +155,10 @@ __API_SYMBOL__ u32 ci_exec_void_cmd(struct dpu_rank_t *rank, u64 *commands)
 {
 	u64 ignored[DPU_MAX_NR_CIS];
 
+	if (plan_is_open(rank)) {
+		return plan_cmd(rank, commands, false);
+	}
+
 	return exec_cmd(rank, commands, ignored, false);
 }
 
@@ -145,6 +166,10 @@ __API_SYMBOL__ u32 ci_exec_wait_mask_cmd(struct dpu_rank_t *rank, u64 *commands)
 {
 	u64 ignored[DPU_MAX_NR_CIS];
 
+	if (plan_is_open(rank)) {
+		return plan_cmd(rank, commands, true);
+	}
+
 	return exec_cmd(rank, commands, ignored, true);
 }
 
@@ -156,6 +181,10 @@ __API_SYMBOL__ u32 ci_exec_8bit_cmd(struct dpu_rank_t *rank, u64 *commands,
 	u8 each_ci;
 	u32 status;
 
+	if ((status = execute_plan(rank)) != DPU_OK) {
+		return status;
+	}
+
 	if ((status = exec_cmd(rank, commands, data, false)) != DPU_OK) {
 		return status;
 	}
@@ -177,6 +206,10 @@ __API_SYMBOL__ u32 ci_exec_32bit_cmd(struct dpu_rank_t *rank, u64 *commands,
 	u8 each_ci;
 	u32 status;
 
+	if ((status = execute_plan(rank)) != DPU_OK) {
+		return status;
+	}
+
 	if ((status = exec_cmd(rank, commands, data, false)) != DPU_OK) {
 		return status;
 	}
@@ -198,6 +231,10 @@ __API_SYMBOL__ u32 ci_exec_byte_discovery(struct dpu_rank_t *rank,
 	bool in_progress, timeout;
 	u32 status;
 
+	if ((status = execute_plan(rank)) != DPU_OK) {
+		return status;
+	}
+
 	LOGV_PACKET(rank, commands, WRITE);
 
 	invert_color(rank, ci_mask);
@@ -240,6 +277,10 @@ __API_SYMBOL__ u32 ci_exec_reset_cmd(struct dpu_rank_t *rank, u64 *commands)
 
 	u8 reset_mask = compute_ci_mask(rank, commands);
 
+	if ((status = execute_plan(rank)) != DPU_OK) {
+		return status;
+	}
+
 	LOGV_PACKET(rank, commands, WRITE);
 
 	invert_color(rank, reset_mask);
@@ -280,19 +321,14 @@ __API_SYMBOL__ u32 ci_exec_reset_cmd(struct dpu_rank_t *rank, u64 *commands)
 	return DPU_OK;
 }
 
-static u32 exec_cmd(struct dpu_rank_t *rank, u64 *commands, u64 *data,
-		    bool add_select_mask)
+static u32 commit_and_wait_cmd(struct dpu_rank_t *rank, u64 *commands,
+			       u64 *data, bool add_select_mask)
 {
-	u8 expected_color;
 	u64 result_masks[DPU_MAX_NR_CIS] = {};
 	u64 expected[DPU_MAX_NR_CIS] = {};
 	bool is_done[DPU_MAX_NR_CIS] = {};
 	u8 ci_mask;
 	u32 status;
-	bool in_progress, timeout;
-	u32 nr_retries = NB_RETRY_FOR_VALID_RESULT;
-
-	LOGV_PACKET(rank, commands, WRITE);
 
 	if ((status = compute_masks(rank, commands, result_masks, expected,
 				    &ci_mask, add_select_mask, is_done)) !=
@@ -300,6 +336,22 @@ static u32 exec_cmd(struct dpu_rank_t *rank, u64 *commands, u64 *data,
 		return status;
 	}
 
+	return commit_and_wait_masked_cmd(rank, commands, data, result_masks,
+					  expected, ci_mask, is_done);
+}
+
+static u32 commit_and_wait_masked_cmd(struct dpu_rank_t *rank, u64 *commands,
+				      u64 *data, const u64 *result_masks,
+				      const u64 *expected, u8 ci_mask,
+				      bool *is_done)
+{
+	u8 expected_color;
+	u32 status;
+	bool in_progress, timeout;
+	u32 nr_retries = NB_RETRY_FOR_VALID_RESULT;
+
+	LOGV_PACKET(rank, commands, WRITE);
+
 	expected_color = GET_CI_CONTEXT(rank)->color & ci_mask;
 	invert_color(rank, ci_mask);
 
@@ -332,14 +384,70 @@ static u32 exec_cmd(struct dpu_rank_t *rank, u64 *commands, u64 *data,
 		return DPU_ERR_TIMEOUT;
 	}
 
-	/* All results are ready here, and still present when reading the control interfaces.
-     * We make sure that we have the correct results by reading again (we may have timing issues).
-     * todo(#85): this can be somewhat costly. We should try to integrate this additional read in a lower layer.
-     */
-	if ((status = ci_update_commands(rank, data)) != DPU_OK) {
+	return DPU_OK;
+}
+
+static u32 exec_cmd(struct dpu_rank_t *rank, u64 *commands, u64 *data,
+		    bool add_select_mask)
+{
+	struct dpu_control_interface_context *context = GET_CI_CONTEXT(rank);
+	dpu_ci_bitfield_t previous_faults =
+		context->fault_decode | context->fault_collide;
+	struct timespec start;
+	u32 status;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	if ((status = commit_and_wait_cmd(rank, commands, data,
+					  add_select_mask)) != DPU_OK) {
 		return status;
 	}
 
+	return complete_cmds(rank, data, previous_faults, &start, 1);
+}
+
+static bool must_confirm_results(struct dpu_rank_t *rank,
+				 dpu_ci_bitfield_t previous_faults)
+{
+	struct dpu_control_interface_context *context = GET_CI_CONTEXT(rank);
+
+	if (GET_DESC(rank)->configuration.confirm_ci_results)
+		return true;
+
+	/* The result of each control interface has the color toggled by the commit of the
+	 * commands, so it cannot be the result of a previous command: a single valid read is
+	 * trusted. A color that reports a new decoding error or collision is the only case
+	 * where the result is read again.
+	 */
+	return ((context->fault_decode | context->fault_collide) &
+		~previous_faults) != 0;
+}
+
+static u32 complete_cmds(struct dpu_rank_t *rank, u64 *data,
+			 dpu_ci_bitfield_t previous_faults,
+			 const struct timespec *start, u32 nr_commands)
+{
+	struct dpu_ci_command_stats *stats =
+		&GET_CI_CONTEXT(rank)->command_stats;
+	struct timespec end;
+	u32 status;
+
+	/* All results are ready here, and still present when reading the control interfaces.
+	 * With the confirmCiResults profile property, we make sure that we have the correct
+	 * results by reading again (we may have timing issues).
+	 */
+	if (must_confirm_results(rank, previous_faults)) {
+		if ((status = ci_update_commands(rank, data)) != DPU_OK) {
+			return status;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	stats->nr_commands += nr_commands;
+	stats->total_latency_in_ns +=
+		(end.tv_sec - start->tv_sec) * 1000000000ULL + end.tv_nsec -
+		start->tv_nsec;
+
 	LOGV_PACKET(rank, data, READ);
 
 	log_temperature(rank, data);
@@ -374,30 +482,27 @@ static u32 compute_masks(struct dpu_rank_t *rank, const u64 *commands,
 	u8 ci_mask = 0;
 
 	u8 nr_cis = GET_DESC(rank)->topology.nr_of_control_interfaces;
-	u8 nr_dpus = GET_DESC(rank)->topology.nr_of_dpus_per_control_interface;
 
 	u8 each_ci;
 
-	u8 dpu_mask;
+	u8 dpu_mask = 0;
 	u32 status;
 
 	for (each_ci = 0; each_ci < nr_cis; ++each_ci) {
 		if (commands[each_ci] != CI_EMPTY) {
 			ci_mask |= (1 << each_ci);
-			masks[each_ci] |= 0xFF0000FF00000000l;
-			expected[each_ci] |= 0x000000FF00000000l;
 
 			if (add_select_mask) {
-				masks[each_ci] |= (1 << nr_dpus) - 1;
-
 				if ((status = ci_fill_selected_dpu_mask(
 					     rank, each_ci, &dpu_mask)) !=
 				    DPU_OK) {
 					return status;
 				}
-
-				expected[each_ci] |= dpu_mask;
 			}
+
+			set_ci_result_masks(rank, add_select_mask, dpu_mask,
+					    &masks[each_ci],
+					    &expected[each_ci]);
 		} else
 			is_done[each_ci] = true;
 	}
@@ -407,6 +512,176 @@ static u32 compute_masks(struct dpu_rank_t *rank, const u64 *commands,
 	return DPU_OK;
 }
 
+static void set_ci_result_masks(struct dpu_rank_t *rank, bool add_select_mask,
+				u8 dpu_mask, u64 *mask, u64 *expected)
+{
+	u8 nr_dpus = GET_DESC(rank)->topology.nr_of_dpus_per_control_interface;
+
+	*mask |= 0xFF0000FF00000000l;
+	*expected |= 0x000000FF00000000l;
+
+	if (add_select_mask) {
+		*mask |= (1 << nr_dpus) - 1;
+		*expected |= dpu_mask;
+	}
+}
+
+static bool plan_is_open(struct dpu_rank_t *rank)
+{
+	return GET_CI_CONTEXT(rank)->plan.nesting != 0;
+}
+
+static u32 plan_cmd(struct dpu_rank_t *rank, u64 *commands,
+		    bool add_select_mask)
+{
+	struct dpu_ci_plan *plan = &GET_CI_CONTEXT(rank)->plan;
+	u8 nr_cis = GET_DESC(rank)->topology.nr_of_control_interfaces;
+	u8 each_ci;
+	u32 status;
+
+	for (each_ci = 0; each_ci < nr_cis; ++each_ci) {
+		if ((commands[each_ci] != CI_EMPTY) &&
+		    (plan->nr_entries[each_ci] == DPU_CI_PLAN_DEPTH)) {
+			if ((status = execute_plan(rank)) != DPU_OK) {
+				return status;
+			}
+			break;
+		}
+	}
+
+	for (each_ci = 0; each_ci < nr_cis; ++each_ci) {
+		struct dpu_ci_plan_entry *entry;
+
+		if (commands[each_ci] == CI_EMPTY) {
+			continue;
+		}
+
+		entry = &plan->entries[each_ci][plan->nr_entries[each_ci]++];
+		entry->command = commands[each_ci];
+		entry->add_select_mask = add_select_mask;
+
+		/* The selection may have changed when the command is committed */
+		if (add_select_mask) {
+			if ((status = ci_fill_selected_dpu_mask(
+				     rank, each_ci, &entry->select_mask)) !=
+			    DPU_OK) {
+				return status;
+			}
+		}
+	}
+
+	return DPU_OK;
+}
+
+/* Commits the n-th planned commands of all the CIs together */
+static u32 execute_plan(struct dpu_rank_t *rank)
+{
+	struct dpu_control_interface_context *context = GET_CI_CONTEXT(rank);
+	struct dpu_ci_plan *plan = &context->plan;
+	dpu_ci_bitfield_t previous_faults =
+		context->fault_decode | context->fault_collide;
+	u8 nr_cis = GET_DESC(rank)->topology.nr_of_control_interfaces;
+	u64 commands[DPU_MAX_NR_CIS];
+	u64 data[DPU_MAX_NR_CIS];
+	struct timespec start;
+	u32 nr_slots = 0;
+	u32 each_slot;
+	u8 each_ci;
+	u32 status = DPU_OK;
+
+	for (each_ci = 0; each_ci < nr_cis; ++each_ci) {
+		if (plan->nr_entries[each_ci] > nr_slots) {
+			nr_slots = plan->nr_entries[each_ci];
+		}
+	}
+
+	if (nr_slots == 0) {
+		return DPU_OK;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (each_slot = 0; each_slot < nr_slots; ++each_slot) {
+		u64 result_masks[DPU_MAX_NR_CIS] = {};
+		u64 expected[DPU_MAX_NR_CIS] = {};
+		bool is_done[DPU_MAX_NR_CIS] = {};
+		u8 ci_mask = 0;
+
+		for (each_ci = 0; each_ci < DPU_MAX_NR_CIS; ++each_ci) {
+			struct dpu_ci_plan_entry *entry =
+				&plan->entries[each_ci][each_slot];
+
+			if ((each_ci >= nr_cis) ||
+			    (each_slot >= plan->nr_entries[each_ci])) {
+				commands[each_ci] = CI_EMPTY;
+				is_done[each_ci] = true;
+				continue;
+			}
+
+			commands[each_ci] = entry->command;
+			ci_mask |= (1 << each_ci);
+			set_ci_result_masks(rank, entry->add_select_mask,
+					    entry->select_mask,
+					    &result_masks[each_ci],
+					    &expected[each_ci]);
+		}
+
+		if ((status = commit_and_wait_masked_cmd(
+			     rank, commands, data, result_masks, expected,
+			     ci_mask, is_done)) != DPU_OK) {
+			break;
+		}
+	}
+
+	memset(plan->nr_entries, 0, sizeof(plan->nr_entries));
+
+	if (status != DPU_OK) {
+		return status;
+	}
+
+	return complete_cmds(rank, data, previous_faults, &start, nr_slots);
+}
+
+__API_SYMBOL__ u32 ci_begin_plan(struct dpu_rank_t *rank)
+{
+	if (GET_DESC(rank)->configuration.enable_ufi_planner) {
+		GET_CI_CONTEXT(rank)->plan.nesting++;
+	}
+
+	return DPU_OK;
+}
+
+__API_SYMBOL__ u32 ci_end_plan(struct dpu_rank_t *rank)
+{
+	struct dpu_ci_plan *plan = &GET_CI_CONTEXT(rank)->plan;
+
+	if ((plan->nesting == 0) || (--plan->nesting != 0)) {
+		return DPU_OK;
+	}
+
+	return execute_plan(rank);
+}
+
+/* Drops the planned commands: the structures they would have written are no longer known */
+__API_SYMBOL__ void ci_abort_plan(struct dpu_rank_t *rank)
+{
+	struct dpu_control_interface_context *context = GET_CI_CONTEXT(rank);
+	struct dpu_ci_plan *plan = &context->plan;
+	u8 each_ci;
+
+	if (plan->nesting == 0) {
+		return;
+	}
+
+	plan->nesting--;
+	for (each_ci = 0; each_ci < DPU_MAX_NR_CIS; ++each_ci) {
+		if (plan->nr_entries[each_ci] != 0) {
+			context->slice_info[each_ci].structure_value = 0ULL;
+		}
+	}
+	memset(plan->nr_entries, 0, sizeof(plan->nr_entries));
+}
+
 static bool determine_if_byte_discoveries_are_finished(struct dpu_rank_t *rank,
 						       const u64 *data)
 {